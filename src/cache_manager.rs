@@ -0,0 +1,473 @@
+// Memory-budgeted caches
+//
+// Every cache the server keeps registers with one `CacheManager`, which holds
+// them to a shared byte budget and, optionally, a hard ceiling on the
+// process's resident set. Eviction is GreedyDual-Size: an entry's priority is
+// the manager's floor at its last use plus its rebuild cost per byte, the
+// lowest priority across all caches goes first, and the floor rises to each
+// evicted priority. Expensive and recently used entries survive; big, cheap
+// and stale ones do not.
+
+use std::collections::{BTreeMap, HashMap};
+use std::ffi::{CString, OsString};
+use std::hash::Hash;
+use std::os::unix::ffi::OsStringExt;
+use std::os::unix::fs::{DirBuilderExt, MetadataExt};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex, Weak};
+
+use serde_json::{json, Value};
+use tracing::{debug, info};
+
+/// Limits for the cache manager
+#[derive(Debug, Clone)]
+pub struct CacheConfig {
+    /// Bytes all caches together may hold
+    pub budget_bytes: usize,
+    /// Resident set size past which caches are emptied regardless of budget
+    pub rss_limit_bytes: Option<u64>,
+    /// Sessions without a live process are spilled to disk after this long
+    pub idle_session_secs: u64,
+    /// Where idle sessions are spilled; unset, a private directory is created
+    /// on first use
+    pub spill_dir: Option<PathBuf>,
+}
+
+impl Default for CacheConfig {
+    fn default() -> Self {
+        Self {
+            budget_bytes: 256 * 1024 * 1024,
+            rss_limit_bytes: None,
+            idle_session_secs: 15 * 60,
+            spill_dir: None,
+        }
+    }
+}
+
+impl CacheConfig {
+    /// Defaults overridden by INCODE_CACHE_BUDGET_MB, INCODE_RSS_LIMIT_MB and
+    /// INCODE_IDLE_SESSION_SECS
+    pub fn from_env() -> Self {
+        let var = |name: &str| std::env::var(name).ok().and_then(|value| value.trim().parse::<u64>().ok());
+        let mut config = Self::default();
+        if let Some(mb) = var("INCODE_CACHE_BUDGET_MB") {
+            config.budget_bytes = (mb * 1024 * 1024) as usize;
+        }
+        if let Some(mb) = var("INCODE_RSS_LIMIT_MB") {
+            config.rss_limit_bytes = Some(mb * 1024 * 1024);
+        }
+        if let Some(secs) = var("INCODE_IDLE_SESSION_SECS") {
+            config.idle_session_secs = secs;
+        }
+        config
+    }
+}
+
+/// Point-in-time size and effectiveness of one cache
+#[derive(Debug, Clone, Default)]
+pub struct CacheUsage {
+    pub name: &'static str,
+    pub entries: usize,
+    pub bytes: usize,
+    pub hits: u64,
+    pub misses: u64,
+    pub evictions: u64,
+}
+
+impl CacheUsage {
+    pub fn to_json(&self) -> Value {
+        let lookups = self.hits + self.misses;
+        json!({
+            "name": self.name,
+            "entries": self.entries,
+            "bytes": self.bytes,
+            "hits": self.hits,
+            "misses": self.misses,
+            "hit_rate": if lookups > 0 { self.hits as f64 / lookups as f64 } else { 0.0 },
+            "evictions": self.evictions
+        })
+    }
+}
+
+/// A cache whose entries the manager may evict
+pub trait ManagedCache: Send + Sync {
+    fn usage(&self) -> CacheUsage;
+    /// Priority of the entry this cache would give up next, `floor` being the
+    /// manager's current floor; the lowest across all caches is evicted first
+    fn coldest(&self, floor: u64) -> Option<u64>;
+    /// Drop that entry, returning the bytes freed
+    fn evict_coldest(&self) -> usize;
+}
+
+/// Rebuild cost per byte, the part of an entry's priority earned by being expensive
+pub fn cost_weight(cost_us: u64, size: usize) -> u64 {
+    cost_us.saturating_mul(1024) / size.max(1) as u64
+}
+
+/// Outcome of one enforcement pass
+#[derive(Debug, Clone, Default)]
+pub struct EnforceReport {
+    pub evicted_entries: usize,
+    pub freed_bytes: usize,
+    pub used_bytes: usize,
+    pub rss_bytes: Option<u64>,
+    /// The RSS ceiling, not the budget, forced this pass
+    pub rss_limited: bool,
+    pub spilled_sessions: usize,
+}
+
+impl EnforceReport {
+    pub fn to_json(&self) -> Value {
+        json!({
+            "evicted_entries": self.evicted_entries,
+            "freed_bytes": self.freed_bytes,
+            "used_bytes": self.used_bytes,
+            "rss_bytes": self.rss_bytes,
+            "rss_limited": self.rss_limited,
+            "spilled_sessions": self.spilled_sessions
+        })
+    }
+}
+
+pub struct CacheManager {
+    config: Mutex<CacheConfig>,
+    caches: Mutex<Vec<Weak<dyn ManagedCache>>>,
+    floor: AtomicU64,
+    /// Bytes inserted since the last enforcement pass
+    growth: AtomicUsize,
+    evictions: AtomicU64,
+    freed_bytes: AtomicU64,
+    /// Serializes enforcement; concurrent passes would evict twice as much
+    enforcing: Mutex<()>,
+}
+
+impl CacheManager {
+    pub fn new(config: CacheConfig) -> Arc<Self> {
+        Arc::new(Self {
+            config: Mutex::new(config),
+            caches: Mutex::new(Vec::new()),
+            floor: AtomicU64::new(0),
+            growth: AtomicUsize::new(0),
+            evictions: AtomicU64::new(0),
+            freed_bytes: AtomicU64::new(0),
+            enforcing: Mutex::new(()),
+        })
+    }
+
+    /// Track `cache` until it is dropped
+    pub fn register(&self, cache: Arc<dyn ManagedCache>) {
+        self.caches.lock().unwrap().push(Arc::downgrade(&cache));
+    }
+
+    pub fn config(&self) -> CacheConfig {
+        self.config.lock().unwrap().clone()
+    }
+
+    pub fn set_config(&self, config: CacheConfig) {
+        *self.config.lock().unwrap() = config;
+    }
+
+    /// Priority floor; entries used now start from here
+    pub fn floor(&self) -> u64 {
+        self.floor.load(Ordering::Relaxed)
+    }
+
+    fn live_caches(&self) -> Vec<Arc<dyn ManagedCache>> {
+        let mut caches = self.caches.lock().unwrap();
+        caches.retain(|cache| cache.strong_count() > 0);
+        caches.iter().filter_map(Weak::upgrade).collect()
+    }
+
+    pub fn usage(&self) -> Vec<CacheUsage> {
+        self.live_caches().iter().map(|cache| cache.usage()).collect()
+    }
+
+    pub fn used_bytes(&self) -> usize {
+        self.usage().iter().map(|usage| usage.bytes).sum()
+    }
+
+    /// Called by caches as they grow; enforces once enough has accumulated
+    /// that the budget may be exceeded by more than a sixteenth
+    pub(crate) fn note_growth(&self, bytes: usize) {
+        let budget = self.config.lock().unwrap().budget_bytes;
+        let grown = self.growth.fetch_add(bytes, Ordering::Relaxed) + bytes;
+        if grown > budget / 16 {
+            self.enforce();
+        }
+    }
+
+    /// Evict until the caches fit the budget and, when a ceiling is set, the
+    /// process fits under it
+    pub fn enforce(&self) -> EnforceReport {
+        let _guard = self.enforcing.lock().unwrap();
+        self.growth.store(0, Ordering::Relaxed);
+        let config = self.config();
+        let caches = self.live_caches();
+
+        let mut report = EnforceReport::default();
+        let mut used: usize = caches.iter().map(|cache| cache.usage().bytes).sum();
+        report.rss_bytes = current_rss();
+
+        // Caches are the only memory that can be given back here, so an RSS
+        // overrun comes out of them byte for byte
+        let mut target = config.budget_bytes;
+        if let (Some(limit), Some(rss)) = (config.rss_limit_bytes, report.rss_bytes) {
+            if rss > limit {
+                let overrun = (rss - limit) as usize;
+                if used.saturating_sub(overrun) < target {
+                    target = used.saturating_sub(overrun);
+                    report.rss_limited = true;
+                }
+            }
+        }
+
+        while used > target {
+            let floor = self.floor();
+            let victim = caches.iter()
+                .filter_map(|cache| cache.coldest(floor).map(|priority| (priority, cache)))
+                .min_by_key(|(priority, _)| *priority);
+            let Some((priority, cache)) = victim else {
+                break;
+            };
+            let freed = cache.evict_coldest();
+            self.floor.fetch_max(priority, Ordering::Relaxed);
+            report.evicted_entries += 1;
+            report.freed_bytes += freed;
+            used = used.saturating_sub(freed);
+        }
+        report.used_bytes = used;
+
+        if report.evicted_entries > 0 {
+            self.evictions.fetch_add(report.evicted_entries as u64, Ordering::Relaxed);
+            self.freed_bytes.fetch_add(report.freed_bytes as u64, Ordering::Relaxed);
+            if report.rss_limited {
+                release_freed_memory();
+                report.rss_bytes = current_rss();
+            }
+            debug!("Evicted {} cache entries ({} bytes), {} bytes cached", report.evicted_entries, report.freed_bytes, used);
+        }
+        report
+    }
+
+    pub fn report(&self) -> Value {
+        let config = self.config();
+        let usage = self.usage();
+        json!({
+            "budget_bytes": config.budget_bytes,
+            "rss_limit_bytes": config.rss_limit_bytes,
+            "idle_session_secs": config.idle_session_secs,
+            "used_bytes": usage.iter().map(|usage| usage.bytes).sum::<usize>(),
+            "rss_bytes": current_rss(),
+            "evictions": self.evictions.load(Ordering::Relaxed),
+            "freed_bytes": self.freed_bytes.load(Ordering::Relaxed),
+            "caches": usage.iter().map(CacheUsage::to_json).collect::<Vec<_>>()
+        })
+    }
+}
+
+/// Resident set size of this process
+pub fn current_rss() -> Option<u64> {
+    let statm = std::fs::read_to_string("/proc/self/statm").ok()?;
+    let pages: u64 = statm.split_whitespace().nth(1)?.parse().ok()?;
+    Some(pages * page_size())
+}
+
+fn page_size() -> u64 {
+    match unsafe { libc::sysconf(libc::_SC_PAGESIZE) } {
+        size if size > 0 => size as u64,
+        _ => 4096,
+    }
+}
+
+/// Create a fresh directory only this user can enter, under XDG_RUNTIME_DIR
+/// when set and the system temp directory otherwise. mkdtemp picks the name
+/// and creates it 0700, so nothing can be planted at the path beforehand.
+pub fn private_dir(prefix: &str) -> std::io::Result<PathBuf> {
+    let base = std::env::var_os("XDG_RUNTIME_DIR")
+        .map(PathBuf::from)
+        .filter(|dir| dir.is_dir())
+        .unwrap_or_else(std::env::temp_dir);
+    let template = CString::new(base.join(format!("{}-XXXXXX", prefix)).into_os_string().into_vec())?;
+
+    let raw = template.into_raw();
+    let created = unsafe { libc::mkdtemp(raw) };
+    let error = std::io::Error::last_os_error();
+    let path = unsafe { CString::from_raw(raw) };
+    if created.is_null() {
+        return Err(error);
+    }
+    Ok(PathBuf::from(OsString::from_vec(path.into_bytes())))
+}
+
+/// Create `dir` 0700 if it is missing, and refuse it unless it is a real
+/// directory owned by this user that no one else can write to
+pub fn ensure_private_dir(dir: &Path) -> std::io::Result<()> {
+    std::fs::DirBuilder::new().recursive(true).mode(0o700).create(dir)?;
+    let meta = std::fs::symlink_metadata(dir)?;
+    if !meta.is_dir() || meta.uid() != unsafe { libc::geteuid() } || meta.mode() & 0o022 != 0 {
+        return Err(std::io::Error::new(
+            std::io::ErrorKind::PermissionDenied,
+            format!("{} is not a directory private to this user", dir.display()),
+        ));
+    }
+    Ok(())
+}
+
+/// Hand freed heap back to the kernel; glibc keeps it otherwise and RSS never drops
+fn release_freed_memory() {
+    #[cfg(all(target_os = "linux", target_env = "gnu"))]
+    unsafe {
+        libc::malloc_trim(0);
+    }
+}
+
+struct Slot<V> {
+    value: V,
+    size: usize,
+    cost_us: u64,
+    rank: (u64, u64),
+}
+
+struct Entries<K, V> {
+    slots: HashMap<K, Slot<V>>,
+    /// (priority, insertion sequence) -> key, coldest first
+    order: BTreeMap<(u64, u64), K>,
+    bytes: usize,
+    seq: u64,
+}
+
+/// Key-value cache held to the manager's budget. Each entry carries its size
+/// and the time it took to compute, so cheap entries are evicted before
+/// expensive ones of the same age.
+pub struct BudgetedCache<K, V> {
+    name: &'static str,
+    manager: Weak<CacheManager>,
+    entries: Mutex<Entries<K, V>>,
+    hits: AtomicU64,
+    misses: AtomicU64,
+    evictions: AtomicU64,
+}
+
+impl<K, V> BudgetedCache<K, V>
+where
+    K: Eq + Hash + Clone + Send + 'static,
+    V: Clone + Send + 'static,
+{
+    pub fn new(name: &'static str, manager: &Arc<CacheManager>) -> Arc<Self> {
+        let cache = Arc::new(Self {
+            name,
+            manager: Arc::downgrade(manager),
+            entries: Mutex::new(Entries { slots: HashMap::new(), order: BTreeMap::new(), bytes: 0, seq: 0 }),
+            hits: AtomicU64::new(0),
+            misses: AtomicU64::new(0),
+            evictions: AtomicU64::new(0),
+        });
+        manager.register(cache.clone());
+        cache
+    }
+
+    fn floor(&self) -> u64 {
+        self.manager.upgrade().map_or(0, |manager| manager.floor())
+    }
+
+    pub fn get(&self, key: &K) -> Option<V> {
+        let floor = self.floor();
+        let mut entries = self.entries.lock().unwrap();
+        let entries = &mut *entries;
+        let Some(slot) = entries.slots.get_mut(key) else {
+            self.misses.fetch_add(1, Ordering::Relaxed);
+            return None;
+        };
+        self.hits.fetch_add(1, Ordering::Relaxed);
+
+        // A hit renews the entry's credit from the current floor
+        entries.seq += 1;
+        let rank = (floor + cost_weight(slot.cost_us, slot.size), entries.seq);
+        if let Some(key) = entries.order.remove(&slot.rank) {
+            entries.order.insert(rank, key);
+        }
+        slot.rank = rank;
+        Some(slot.value.clone())
+    }
+
+    /// Insert `value`, `size` bytes large and `cost_us` microseconds to recompute
+    pub fn insert(&self, key: K, value: V, size: usize, cost_us: u64) {
+        let floor = self.floor();
+        {
+            let mut entries = self.entries.lock().unwrap();
+            entries.seq += 1;
+            let rank = (floor + cost_weight(cost_us, size), entries.seq);
+            if let Some(old) = entries.slots.insert(key.clone(), Slot { value, size, cost_us, rank }) {
+                entries.order.remove(&old.rank);
+                entries.bytes -= old.size;
+            }
+            entries.order.insert(rank, key);
+            entries.bytes += size;
+        }
+        // Outside the lock: enforcement may evict from this cache
+        if let Some(manager) = self.manager.upgrade() {
+            manager.note_growth(size);
+        }
+    }
+
+    /// Keep only entries for which `keep` holds
+    pub fn retain(&self, mut keep: impl FnMut(&K, &V) -> bool) {
+        let mut entries = self.entries.lock().unwrap();
+        let entries = &mut *entries;
+        let order = &mut entries.order;
+        let mut freed = 0;
+        entries.slots.retain(|key, slot| {
+            let kept = keep(key, &slot.value);
+            if !kept {
+                order.remove(&slot.rank);
+                freed += slot.size;
+            }
+            kept
+        });
+        entries.bytes -= freed;
+    }
+}
+
+impl<K, V> ManagedCache for BudgetedCache<K, V>
+where
+    K: Eq + Hash + Clone + Send + 'static,
+    V: Clone + Send + 'static,
+{
+    fn usage(&self) -> CacheUsage {
+        let entries = self.entries.lock().unwrap();
+        CacheUsage {
+            name: self.name,
+            entries: entries.slots.len(),
+            bytes: entries.bytes,
+            hits: self.hits.load(Ordering::Relaxed),
+            misses: self.misses.load(Ordering::Relaxed),
+            evictions: self.evictions.load(Ordering::Relaxed),
+        }
+    }
+
+    fn coldest(&self, _floor: u64) -> Option<u64> {
+        self.entries.lock().unwrap().order.keys().next().map(|(priority, _)| *priority)
+    }
+
+    fn evict_coldest(&self) -> usize {
+        let mut entries = self.entries.lock().unwrap();
+        let Some((_, key)) = entries.order.pop_first() else {
+            return 0;
+        };
+        let size = entries.slots.remove(&key).map_or(0, |slot| slot.size);
+        entries.bytes -= size;
+        self.evictions.fetch_add(1, Ordering::Relaxed);
+        size
+    }
+}
+
+/// Log the limits the caches are held to
+pub(crate) fn log_config(manager: &CacheManager) {
+    let config = manager.config();
+    info!(
+        "Cache budget {} MiB{}",
+        config.budget_bytes / (1024 * 1024),
+        config.rss_limit_bytes.map(|limit| format!(", RSS ceiling {} MiB", limit / (1024 * 1024))).unwrap_or_default()
+    );
+}
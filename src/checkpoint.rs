@@ -0,0 +1,195 @@
+// fork()-based checkpoints
+//
+// A checkpoint is a copy-on-write clone of the stopped debuggee: the server
+// runs fork() inside the inferior and the child immediately stops itself with
+// SIGSTOP, so it sits frozen with the parent's memory as it was at that moment.
+// Restoring attaches to the frozen child and puts back the register state the
+// forking thread had before the injected call. As with gdb's checkpoints, only
+// the thread that forked exists in the clone.
+
+use std::collections::BTreeMap;
+use std::time::SystemTime;
+
+use lldb_sys::*;
+use tracing::{debug, warn};
+
+use crate::error::{IncodeError, IncodeResult};
+use crate::lldb_manager::sb_error_message;
+
+/// A frozen clone of the debuggee
+#[derive(Debug, Clone)]
+pub struct Checkpoint {
+    pub id: u32,
+    /// PID of the stopped fork holding the saved state
+    pub pid: u32,
+    /// Process the checkpoint was taken from
+    pub origin_pid: u32,
+    pub thread_id: u32,
+    pub pc: u64,
+    pub description: Option<String>,
+    pub created_at: SystemTime,
+    /// Register values (as LLDB formats them) of the forking thread
+    pub registers: Vec<(String, String)>,
+}
+
+/// Checkpoints owned by one debugging session, numbered from 1
+#[derive(Debug, Default)]
+pub struct CheckpointStore {
+    checkpoints: BTreeMap<u32, Checkpoint>,
+    next_id: u32,
+}
+
+impl CheckpointStore {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    pub fn next_id(&mut self) -> u32 {
+        self.next_id += 1;
+        self.next_id
+    }
+
+    pub fn insert(&mut self, checkpoint: Checkpoint) {
+        self.checkpoints.insert(checkpoint.id, checkpoint);
+    }
+
+    pub fn remove(&mut self, id: u32) -> Option<Checkpoint> {
+        self.checkpoints.remove(&id)
+    }
+
+    pub fn list(&self) -> Vec<Checkpoint> {
+        self.checkpoints.values().cloned().collect()
+    }
+
+    /// Kill every frozen clone; they would otherwise stay stopped forever
+    pub fn discard_all(&mut self) {
+        for checkpoint in std::mem::take(&mut self.checkpoints).into_values() {
+            kill_clone(checkpoint.pid);
+        }
+    }
+}
+
+impl Drop for CheckpointStore {
+    fn drop(&mut self) {
+        self.discard_all();
+    }
+}
+
+/// Terminate a checkpoint's frozen process
+pub fn kill_clone(pid: u32) {
+    debug!("Discarding checkpoint process {}", pid);
+    unsafe {
+        libc::kill(pid as libc::pid_t, libc::SIGKILL);
+    }
+}
+
+/// Whether the checkpoint's process still exists
+pub fn clone_alive(pid: u32) -> bool {
+    unsafe { libc::kill(pid as libc::pid_t, 0) == 0 }
+}
+
+/// Run fork() in the stopped inferior; the child stops itself before it can
+/// return into the expression trampoline. Returns the child's PID.
+pub fn fork_inferior(frame: SBFrameRef) -> IncodeResult<u32> {
+    let expression = format!(
+        "int __incode_ckpt = (int)fork(); if (__incode_ckpt == 0) {{ (int)raise({}); }} __incode_ckpt",
+        libc::SIGSTOP
+    );
+    let expression_cstr = std::ffi::CString::new(expression)
+        .map_err(|_| IncodeError::expression("Invalid checkpoint expression"))?;
+
+    let value = unsafe { SBFrameEvaluateExpression(frame, expression_cstr.as_ptr()) };
+    if value.is_null() {
+        return Err(IncodeError::expression("fork() could not be called in the debuggee"));
+    }
+
+    let pid = forked_pid(value);
+    unsafe { DisposeSBValue(value) };
+    pid
+}
+
+/// The child PID the injected fork() returned
+fn forked_pid(value: SBValueRef) -> IncodeResult<u32> {
+    let error = unsafe { SBValueGetError(value) };
+    if !error.is_null() && unsafe { SBErrorFail(error) } {
+        return Err(IncodeError::expression(format!("fork() failed in the debuggee: {}", sb_error_message(error))));
+    }
+
+    let error = unsafe { CreateSBError() };
+    let pid = unsafe { SBValueGetValueAsSigned(value, error, -1) };
+    unsafe { DisposeSBError(error) };
+    if pid <= 0 {
+        return Err(IncodeError::expression(format!("fork() returned {} in the debuggee", pid)));
+    }
+    Ok(pid as u32)
+}
+
+/// Every register of the thread's top frame, formatted by LLDB
+pub fn capture_registers(thread: SBThreadRef) -> Vec<(String, String)> {
+    let mut registers = Vec::new();
+    for_each_register(thread, |name, register| {
+        let value_ptr = unsafe { SBValueGetValue(register) };
+        if !value_ptr.is_null() {
+            let value = unsafe { std::ffi::CStr::from_ptr(value_ptr) }.to_string_lossy().into_owned();
+            registers.push((name.to_string(), value));
+        }
+    });
+    registers
+}
+
+/// Write saved register values back into the thread's top frame.
+/// Returns how many registers were written and which could not be.
+pub fn restore_registers(thread: SBThreadRef, saved: &[(String, String)]) -> (usize, Vec<String>) {
+    let saved: BTreeMap<&str, &str> = saved.iter().map(|(n, v)| (n.as_str(), v.as_str())).collect();
+    let mut restored = 0;
+    let mut failed = Vec::new();
+
+    for_each_register(thread, |name, register| {
+        let Some(value) = saved.get(name) else {
+            return;
+        };
+        let written = std::ffi::CString::new(*value)
+            .map(|value| unsafe { SBValueSetValueFromCString(register, value.as_ptr()) })
+            .unwrap_or(false);
+        if written {
+            restored += 1;
+        } else {
+            failed.push(name.to_string());
+        }
+    });
+
+    if !failed.is_empty() {
+        warn!("Could not restore {} registers: {:?}", failed.len(), failed);
+    }
+    (restored, failed)
+}
+
+fn for_each_register(thread: SBThreadRef, mut visit: impl FnMut(&str, SBValueRef)) {
+    let frame = unsafe { SBThreadGetFrameAtIndex(thread, 0) };
+    if frame.is_null() {
+        return;
+    }
+    let register_list = unsafe { SBFrameGetRegisters(frame) };
+    if register_list.is_null() {
+        return;
+    }
+
+    for i in 0..unsafe { SBValueListGetSize(register_list) } {
+        let register_set = unsafe { SBValueListGetValueAtIndex(register_list, i) };
+        if register_set.is_null() {
+            continue;
+        }
+        for j in 0..unsafe { SBValueGetNumChildren(register_set) } {
+            let register = unsafe { SBValueGetChildAtIndex(register_set, j) };
+            if register.is_null() {
+                continue;
+            }
+            let name_ptr = unsafe { SBValueGetName(register) };
+            if name_ptr.is_null() {
+                continue;
+            }
+            let name = unsafe { std::ffi::CStr::from_ptr(name_ptr) }.to_string_lossy();
+            visit(&name, register);
+        }
+    }
+}
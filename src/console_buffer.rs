@@ -0,0 +1,387 @@
+// Debuggee console capture
+//
+// LLDB only hands out process stdout/stderr through polling reads into a caller
+// buffer. A background drainer pulls both streams continuously into a bounded
+// ring buffer where every byte has a sequence number, so readers can resume from
+// a cursor and receive exactly the data they have not seen yet.
+
+use std::collections::VecDeque;
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::{Arc, Mutex};
+use std::thread::JoinHandle;
+use std::time::Duration;
+
+use lldb_sys::*;
+use tracing::debug;
+
+use crate::cache_manager::{cost_weight, CacheUsage, ManagedCache};
+
+/// Which process stream a piece of output came from
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ConsoleStream {
+    Stdout,
+    Stderr,
+}
+
+impl ConsoleStream {
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            ConsoleStream::Stdout => "stdout",
+            ConsoleStream::Stderr => "stderr",
+        }
+    }
+}
+
+/// A contiguous run of output from one stream
+#[derive(Debug, Clone)]
+pub struct ConsoleSegment {
+    pub stream: ConsoleStream,
+    /// Sequence number of the first byte of `text`
+    pub seq: u64,
+    pub text: String,
+}
+
+/// Result of reading the console buffer from a cursor
+#[derive(Debug, Clone)]
+pub struct ConsoleRead {
+    pub segments: Vec<ConsoleSegment>,
+    /// Cursor to pass to the next read
+    pub next_cursor: u64,
+    /// Bytes evicted from the buffer before the reader got to them
+    pub dropped_bytes: u64,
+    /// Whether more data was already buffered past `next_cursor`
+    pub has_more: bool,
+}
+
+impl ConsoleRead {
+    /// All returned output concatenated in sequence order
+    pub fn text(&self) -> String {
+        self.segments.iter().map(|segment| segment.text.as_str()).collect()
+    }
+}
+
+#[derive(Debug)]
+struct Chunk {
+    stream: ConsoleStream,
+    seq: u64,
+    data: Vec<u8>,
+}
+
+impl Chunk {
+    fn end(&self) -> u64 {
+        self.seq + self.data.len() as u64
+    }
+}
+
+#[derive(Debug, Default)]
+struct Ring {
+    chunks: VecDeque<Chunk>,
+    /// Sequence number of the oldest retained byte
+    start_seq: u64,
+    /// Sequence number one past the newest byte
+    end_seq: u64,
+}
+
+impl Ring {
+    fn byte_at(&self, seq: u64) -> Option<u8> {
+        self.chunks
+            .iter()
+            .find(|chunk| seq >= chunk.seq && seq < chunk.end())
+            .map(|chunk| chunk.data[(seq - chunk.seq) as usize])
+    }
+
+    /// Retained bytes of `stream` after its last newline before `before`, with
+    /// the sequence number of the first of them
+    fn partial_line(&self, stream: ConsoleStream, before: u64) -> (u64, Vec<u8>) {
+        let mut seq = before;
+        let mut pieces = Vec::new();
+        for chunk in self.chunks.iter().rev().filter(|chunk| chunk.stream == stream && chunk.seq < before) {
+            let data = &chunk.data[..(before.min(chunk.end()) - chunk.seq) as usize];
+            match data.iter().rposition(|&b| b == b'\n') {
+                Some(newline) => {
+                    seq = chunk.seq + newline as u64 + 1;
+                    pieces.push(&data[newline + 1..]);
+                    break;
+                }
+                None => {
+                    seq = chunk.seq;
+                    pieces.push(data);
+                }
+            }
+        }
+        (seq, pieces.into_iter().rev().flatten().copied().collect())
+    }
+}
+
+/// Bounded, sequence-numbered buffer of debuggee console output
+#[derive(Debug)]
+pub struct ConsoleBuffer {
+    capacity: usize,
+    ring: Mutex<Ring>,
+    /// Chunks given up to the cache manager
+    evictions: AtomicU64,
+}
+
+impl Default for ConsoleBuffer {
+    fn default() -> Self {
+        Self::new(Self::DEFAULT_CAPACITY)
+    }
+}
+
+impl ConsoleBuffer {
+    /// Bytes retained before the oldest output is evicted
+    pub const DEFAULT_CAPACITY: usize = 4 * 1024 * 1024;
+    /// Chunks are not grown past this so eviction stays cheap
+    const MAX_CHUNK: usize = 64 * 1024;
+
+    pub fn new(capacity: usize) -> Self {
+        Self {
+            capacity: capacity.max(1),
+            ring: Mutex::new(Ring::default()),
+            evictions: AtomicU64::new(0),
+        }
+    }
+
+    /// Sequence number one past the newest buffered byte
+    pub fn end_cursor(&self) -> u64 {
+        self.ring.lock().unwrap().end_seq
+    }
+
+    /// Drop all buffered output, e.g. when a new process replaces the old one.
+    /// Sequence numbers keep counting so old cursors read as dropped output.
+    pub fn clear(&self) {
+        let mut ring = self.ring.lock().unwrap();
+        ring.chunks.clear();
+        ring.start_seq = ring.end_seq;
+    }
+
+    /// Append output, evicting the oldest bytes once over capacity
+    pub fn append(&self, stream: ConsoleStream, data: &[u8]) {
+        if data.is_empty() {
+            return;
+        }
+
+        let mut ring = self.ring.lock().unwrap();
+        let seq = ring.end_seq;
+        match ring.chunks.back_mut() {
+            Some(last) if last.stream == stream && last.data.len() + data.len() <= Self::MAX_CHUNK => {
+                last.data.extend_from_slice(data);
+            }
+            _ => ring.chunks.push_back(Chunk { stream, seq, data: data.to_vec() }),
+        }
+        ring.end_seq += data.len() as u64;
+
+        while ring.end_seq - ring.start_seq > self.capacity as u64 {
+            let excess = (ring.end_seq - ring.start_seq - self.capacity as u64) as usize;
+            let front = ring.chunks.front_mut().expect("non-empty ring has a chunk");
+            if front.data.len() <= excess {
+                let len = front.data.len() as u64;
+                ring.chunks.pop_front();
+                ring.start_seq += len;
+            } else {
+                front.data.drain(..excess);
+                front.seq += excess as u64;
+                ring.start_seq += excess as u64;
+            }
+        }
+    }
+
+    /// Read up to `max_bytes` starting at `cursor`.
+    ///
+    /// With a `pattern`, only complete lines containing it are returned, each
+    /// reported by the read that covers its newline. Lines are assembled per
+    /// stream, so a line split across chunks, interleaved with the other
+    /// stream or started by an earlier read is still matched as a whole; a
+    /// trailing line without its newline waits for a later read.
+    pub fn read(&self, cursor: u64, max_bytes: usize, pattern: Option<&str>) -> ConsoleRead {
+        let ring = self.ring.lock().unwrap();
+
+        let dropped_bytes = ring.start_seq.saturating_sub(cursor);
+        let from = cursor.clamp(ring.start_seq, ring.end_seq);
+        let mut to = from.saturating_add(max_bytes.max(1) as u64).min(ring.end_seq);
+
+        if to < ring.end_seq {
+            // Never split a UTF-8 sequence
+            let mut back = to;
+            while back > from && ring.byte_at(back).map_or(false, |b| b & 0xC0 == 0x80) {
+                back -= 1;
+            }
+            if back > from {
+                to = back;
+            }
+        }
+
+        let mut segments = Vec::new();
+        // Line being assembled for stdout and stderr: first byte's seq and bytes so far
+        let mut lines: [Option<(u64, Vec<u8>)>; 2] = [None, None];
+        for chunk in ring.chunks.iter().filter(|chunk| chunk.end() > from && chunk.seq < to) {
+            let start = from.max(chunk.seq);
+            let end = to.min(chunk.end());
+            let bytes = &chunk.data[(start - chunk.seq) as usize..(end - chunk.seq) as usize];
+
+            let Some(pattern) = pattern else {
+                segments.push(ConsoleSegment {
+                    stream: chunk.stream,
+                    seq: start,
+                    text: String::from_utf8_lossy(bytes).into_owned(),
+                });
+                continue;
+            };
+
+            let line = lines[chunk.stream as usize].get_or_insert_with(|| ring.partial_line(chunk.stream, from));
+            let mut piece_seq = start;
+            for piece in bytes.split_inclusive(|&b| b == b'\n') {
+                if line.1.is_empty() {
+                    line.0 = piece_seq;
+                }
+                line.1.extend_from_slice(piece);
+                piece_seq += piece.len() as u64;
+
+                if piece.ends_with(b"\n") {
+                    let text = String::from_utf8_lossy(&line.1);
+                    if text.contains(pattern) {
+                        segments.push(ConsoleSegment {
+                            stream: chunk.stream,
+                            seq: line.0,
+                            text: text.into_owned(),
+                        });
+                    }
+                    line.1.clear();
+                }
+            }
+        }
+
+        ConsoleRead {
+            segments,
+            next_cursor: to,
+            dropped_bytes,
+            has_more: to < ring.end_seq,
+        }
+    }
+}
+
+/// Output cannot be read from the process again, so it is priced far above
+/// anything rebuildable and only goes once the other caches are empty
+const OUTPUT_COST_US: u64 = 1_000_000_000;
+
+/// Under memory pressure the oldest output is dropped first, exactly as when
+/// the ring overflows; readers see it as `dropped_bytes`
+impl ManagedCache for ConsoleBuffer {
+    fn usage(&self) -> CacheUsage {
+        let ring = self.ring.lock().unwrap();
+        CacheUsage {
+            name: "console",
+            entries: ring.chunks.len(),
+            bytes: (ring.end_seq - ring.start_seq) as usize,
+            evictions: self.evictions.load(Ordering::Relaxed),
+            ..Default::default()
+        }
+    }
+
+    fn coldest(&self, floor: u64) -> Option<u64> {
+        let ring = self.ring.lock().unwrap();
+        ring.chunks.front().map(|chunk| floor + cost_weight(OUTPUT_COST_US, chunk.data.len()))
+    }
+
+    fn evict_coldest(&self) -> usize {
+        let mut ring = self.ring.lock().unwrap();
+        let Some(chunk) = ring.chunks.pop_front() else {
+            return 0;
+        };
+        ring.start_seq = chunk.end();
+        self.evictions.fetch_add(1, Ordering::Relaxed);
+        chunk.data.len()
+    }
+}
+
+/// SBProcess handle moved onto the drainer thread
+struct DrainerProcess(SBProcessRef);
+
+// SAFETY: the drainer owns its own SBProcess clone and only calls the
+// thread-safe stdio accessors and state query on it
+unsafe impl Send for DrainerProcess {}
+
+/// Background thread copying process stdout/stderr into a `ConsoleBuffer`
+pub struct ConsoleDrainer {
+    stop: Arc<AtomicBool>,
+    handle: Option<JoinHandle<()>>,
+}
+
+impl ConsoleDrainer {
+    /// Delay between polls when both streams were empty
+    const POLL_INTERVAL: Duration = Duration::from_millis(20);
+    const READ_SIZE: usize = 16 * 1024;
+
+    pub fn spawn(process: SBProcessRef, buffer: Arc<ConsoleBuffer>) -> Self {
+        let stop = Arc::new(AtomicBool::new(false));
+        let process = DrainerProcess(unsafe { CloneSBProcess(process) });
+        let thread_stop = stop.clone();
+
+        let handle = std::thread::Builder::new()
+            .name("console-drainer".to_string())
+            .spawn(move || {
+                let process = process;
+                Self::run(process.0, &buffer, &thread_stop);
+                unsafe { DisposeSBProcess(process.0) };
+            })
+            .ok();
+
+        Self { stop, handle }
+    }
+
+    fn run(process: SBProcessRef, buffer: &ConsoleBuffer, stop: &AtomicBool) {
+        let mut scratch = vec![0u8; Self::READ_SIZE];
+        loop {
+            let stopping = stop.load(Ordering::SeqCst);
+            let drained = Self::drain(process, buffer, &mut scratch);
+            if stopping {
+                break;
+            }
+
+            if drained == 0 {
+                let state = unsafe { SBProcessGetState(process) };
+                if matches!(state, StateType::Exited | StateType::Detached | StateType::Invalid) {
+                    // Anything written before exit has been collected by now
+                    debug!("Console drainer finished: process state {:?}", state);
+                    break;
+                }
+                std::thread::sleep(Self::POLL_INTERVAL);
+            }
+        }
+    }
+
+    /// Pull everything currently available from both streams
+    fn drain(process: SBProcessRef, buffer: &ConsoleBuffer, scratch: &mut [u8]) -> usize {
+        let mut total = 0;
+        for stream in [ConsoleStream::Stdout, ConsoleStream::Stderr] {
+            loop {
+                let len = unsafe {
+                    match stream {
+                        ConsoleStream::Stdout => SBProcessGetSTDOUT(process, scratch.as_mut_ptr() as *mut i8, scratch.len()),
+                        ConsoleStream::Stderr => SBProcessGetSTDERR(process, scratch.as_mut_ptr() as *mut i8, scratch.len()),
+                    }
+                };
+                if len == 0 {
+                    break;
+                }
+                buffer.append(stream, &scratch[..len.min(scratch.len())]);
+                total += len;
+            }
+        }
+        total
+    }
+
+    /// Collect any remaining output and stop the thread
+    pub fn stop(&mut self) {
+        self.stop.store(true, Ordering::SeqCst);
+        if let Some(handle) = self.handle.take() {
+            let _ = handle.join();
+        }
+    }
+}
+
+impl Drop for ConsoleDrainer {
+    fn drop(&mut self) {
+        self.stop();
+    }
+}
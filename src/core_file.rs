@@ -0,0 +1,506 @@
+// Native ELF core file reader
+//
+// Production cores run to tens of gigabytes, so the file is never read up front:
+// it is mapped read-only and only the ELF header, program headers and notes are
+// touched when opening. Memory reads fault in just the pages of the PT_LOAD
+// segment they land in. The notes provide what LLDB's SB API does not expose
+// directly: the full siginfo (si_code, fault address) and the NT_FILE mappings.
+
+use std::fs::File;
+use std::os::unix::io::AsRawFd;
+use std::path::{Path, PathBuf};
+
+use crate::error::{IncodeError, IncodeResult};
+
+pub(crate) const ET_CORE: u16 = 4;
+pub(crate) const PT_LOAD: u32 = 1;
+pub(crate) const PT_NOTE: u32 = 4;
+/// e_phnum value meaning the real count is in section header 0's sh_info
+pub(crate) const PN_XNUM: u16 = 0xffff;
+pub(crate) const PF_X: u32 = 1;
+pub(crate) const PF_W: u32 = 2;
+pub(crate) const PF_R: u32 = 4;
+
+pub(crate) const NT_PRSTATUS: u32 = 1;
+pub(crate) const NT_PRPSINFO: u32 = 3;
+const NT_SIGINFO: u32 = 0x5349_4749;
+pub(crate) const NT_FILE: u32 = 0x4649_4c45;
+
+/// Notes under the "INCODE" name, written by compact dumps
+pub(crate) const INCODE_NOTE_NAME: &str = "INCODE";
+pub(crate) const NT_INCODE_MODULES: u32 = 1;
+pub(crate) const NT_INCODE_REGIONS: u32 = 2;
+
+pub(crate) const EM_X86_64: u16 = 62;
+pub(crate) const EM_AARCH64: u16 = 183;
+
+/// Offset of pr_reg in the 64-bit Linux elf_prstatus
+pub(crate) const PRSTATUS_REGS_OFFSET: usize = 112;
+
+/// Read-only mapping of the whole core file
+struct Mapping {
+    ptr: *const u8,
+    len: usize,
+}
+
+// SAFETY: the mapping is private, read-only and never remapped while alive
+unsafe impl Send for Mapping {}
+unsafe impl Sync for Mapping {}
+
+impl Mapping {
+    fn new(file: &File, len: usize) -> std::io::Result<Self> {
+        let ptr = unsafe {
+            libc::mmap(std::ptr::null_mut(), len, libc::PROT_READ, libc::MAP_PRIVATE, file.as_raw_fd(), 0)
+        };
+        if ptr == libc::MAP_FAILED {
+            return Err(std::io::Error::last_os_error());
+        }
+        // Accesses jump around the address space; readahead would only pull in
+        // pages nobody asked for
+        unsafe { libc::madvise(ptr, len, libc::MADV_RANDOM) };
+        Ok(Self { ptr: ptr as *const u8, len })
+    }
+
+    fn bytes(&self) -> &[u8] {
+        unsafe { std::slice::from_raw_parts(self.ptr, self.len) }
+    }
+}
+
+impl Drop for Mapping {
+    fn drop(&mut self) {
+        unsafe { libc::munmap(self.ptr as *mut libc::c_void, self.len) };
+    }
+}
+
+/// A PT_LOAD segment: process memory captured in the core
+#[derive(Debug, Clone)]
+pub struct CoreSegment {
+    pub vaddr: u64,
+    pub memsz: u64,
+    pub offset: u64,
+    /// Bytes present in the file; the rest of `memsz` reads as zeros
+    pub filesz: u64,
+    pub flags: u32,
+}
+
+impl CoreSegment {
+    pub fn end(&self) -> u64 {
+        self.vaddr + self.memsz
+    }
+
+    pub fn contains(&self, address: u64) -> bool {
+        address >= self.vaddr && address < self.end()
+    }
+
+    /// Permissions in /proc/<pid>/maps style, e.g. "r-x"
+    pub fn permissions(&self) -> String {
+        let mut permissions = String::with_capacity(3);
+        permissions.push(if self.flags & PF_R != 0 { 'r' } else { '-' });
+        permissions.push(if self.flags & PF_W != 0 { 'w' } else { '-' });
+        permissions.push(if self.flags & PF_X != 0 { 'x' } else { '-' });
+        permissions
+    }
+}
+
+/// One thread's NT_PRSTATUS
+#[derive(Debug, Clone)]
+pub struct CoreThread {
+    pub tid: u32,
+    /// Signal pending for this thread when the core was written
+    pub signal: i32,
+    pub pc: Option<u64>,
+    pub sp: Option<u64>,
+}
+
+/// The signal that terminated the process, from NT_SIGINFO
+#[derive(Debug, Clone)]
+pub struct CoreSignal {
+    pub signo: i32,
+    pub errno: i32,
+    pub code: i32,
+    /// si_addr, for signals that carry a faulting address
+    pub fault_address: Option<u64>,
+    /// si_pid, for signals sent by another process
+    pub sender_pid: Option<u32>,
+}
+
+/// A file-backed mapping from NT_FILE
+#[derive(Debug, Clone)]
+pub struct MappedFile {
+    pub start: u64,
+    pub end: u64,
+    pub file_offset: u64,
+    pub path: String,
+}
+
+/// A loaded module recorded by a compact dump
+#[derive(Debug, Clone)]
+pub struct CoreModule {
+    pub build_id: Option<String>,
+    pub path: String,
+}
+
+/// An address-space mapping recorded by a compact dump, whether or not its
+/// memory was captured
+#[derive(Debug, Clone)]
+pub struct CoreRegion {
+    pub start: u64,
+    pub end: u64,
+    pub permissions: String,
+    pub path: Option<String>,
+}
+
+/// An opened ELF core file
+pub struct CoreFile {
+    path: PathBuf,
+    map: Mapping,
+    pub pid: Option<u32>,
+    /// Short command name from NT_PRPSINFO
+    pub command: Option<String>,
+    pub segments: Vec<CoreSegment>,
+    /// Threads in note order; the kernel writes the signalled thread first
+    pub threads: Vec<CoreThread>,
+    pub signal: Option<CoreSignal>,
+    pub mapped_files: Vec<MappedFile>,
+    /// Only present in incode compact dumps
+    pub modules: Vec<CoreModule>,
+    /// Full region map at dump time; only present in incode compact dumps,
+    /// whose PT_LOAD segments cover just a fraction of it
+    pub region_map: Vec<CoreRegion>,
+}
+
+impl std::fmt::Debug for CoreFile {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("CoreFile")
+            .field("path", &self.path)
+            .field("size", &self.map.len)
+            .field("segments", &self.segments.len())
+            .field("threads", &self.threads.len())
+            .field("signal", &self.signal)
+            .finish()
+    }
+}
+
+impl CoreFile {
+    /// Map a core file and parse its headers and notes
+    pub fn open(path: impl AsRef<Path>) -> IncodeResult<Self> {
+        let path = path.as_ref();
+        let file = File::open(path)
+            .map_err(|e| IncodeError::invalid_parameter(format!("Cannot open core file {}: {}", path.display(), e)))?;
+        let len = file.metadata()
+            .map_err(|e| IncodeError::invalid_parameter(format!("Cannot stat core file {}: {}", path.display(), e)))?
+            .len() as usize;
+        if len < 64 {
+            return Err(IncodeError::invalid_parameter(format!("{} is too small to be a core file", path.display())));
+        }
+        let map = Mapping::new(&file, len)
+            .map_err(|e| IncodeError::lldb_op(format!("Cannot map core file {}: {}", path.display(), e)))?;
+
+        let layout = Layout::parse(map.bytes())
+            .map_err(|what| IncodeError::invalid_parameter(format!("{}: {}", path.display(), what)))?;
+        Ok(Self {
+            path: path.to_path_buf(),
+            map,
+            pid: layout.pid,
+            command: layout.command,
+            segments: layout.segments,
+            threads: layout.threads,
+            signal: layout.signal,
+            mapped_files: layout.mapped_files,
+            modules: layout.modules,
+            region_map: layout.region_map,
+        })
+    }
+
+    pub fn path(&self) -> &Path {
+        &self.path
+    }
+
+    pub fn file_size(&self) -> u64 {
+        self.map.len as u64
+    }
+
+    /// The thread that received the fatal signal
+    pub fn faulting_thread(&self) -> Option<&CoreThread> {
+        self.threads.iter().find(|thread| thread.signal != 0).or_else(|| self.threads.first())
+    }
+
+    /// Path of the main executable, taken from the first file mapping
+    pub fn executable_path(&self) -> Option<&str> {
+        self.mapped_files.first().map(|file| file.path.as_str()).filter(|path| !path.is_empty())
+    }
+
+    pub fn segment_at(&self, address: u64) -> Option<&CoreSegment> {
+        let index = self.segments.partition_point(|segment| segment.vaddr <= address);
+        index.checked_sub(1).map(|i| &self.segments[i]).filter(|segment| segment.contains(address))
+    }
+
+    /// File mapped at `address`, if any
+    pub fn mapped_file_at(&self, address: u64) -> Option<&MappedFile> {
+        self.mapped_files.iter().find(|file| address >= file.start && address < file.end)
+    }
+
+    /// Copy memory at `address` into `buffer`, stopping at the end of the
+    /// containing segment. Returns the number of bytes copied.
+    pub fn read_memory(&self, address: u64, buffer: &mut [u8]) -> usize {
+        let Some(segment) = self.segment_at(address) else {
+            return 0;
+        };
+        let start = address - segment.vaddr;
+        let len = (buffer.len() as u64).min(segment.memsz - start) as usize;
+
+        // Only the part of the segment the file holds is copied; the rest was
+        // never dumped (e.g. untouched bss) and reads as zeros
+        let in_file = segment.filesz.saturating_sub(start).min(len as u64) as usize;
+        let data = self.map.bytes();
+        let file_start = (segment.offset + start) as usize;
+        let copied = data.get(file_start..file_start + in_file).map_or(0, |bytes| {
+            buffer[..in_file].copy_from_slice(bytes);
+            in_file
+        });
+        if copied < in_file {
+            // Truncated core: stop at what is actually there
+            return copied;
+        }
+        buffer[in_file..len].fill(0);
+        len
+    }
+}
+
+/// Everything read from the headers and notes when a core is opened
+#[derive(Default)]
+struct Layout {
+    machine: u16,
+    pid: Option<u32>,
+    command: Option<String>,
+    segments: Vec<CoreSegment>,
+    threads: Vec<CoreThread>,
+    signal: Option<CoreSignal>,
+    mapped_files: Vec<MappedFile>,
+    modules: Vec<CoreModule>,
+    region_map: Vec<CoreRegion>,
+}
+
+impl Layout {
+    fn parse(data: &[u8]) -> Result<Self, &'static str> {
+        if &data[..4] != b"\x7fELF" {
+            return Err("not an ELF file");
+        }
+        if data[4] != 2 || data[5] != 1 {
+            return Err("only 64-bit little-endian cores are supported");
+        }
+        if read_u16(data, 16) != Some(ET_CORE) {
+            return Err("ELF file is not a core dump");
+        }
+        let mut layout = Self {
+            machine: read_u16(data, 18).unwrap_or(0),
+            ..Self::default()
+        };
+
+        let phoff = read_u64(data, 32).ok_or("truncated ELF header")? as usize;
+        let phentsize = read_u16(data, 54).unwrap_or(0) as usize;
+        let mut phnum = read_u16(data, 56).unwrap_or(0) as usize;
+        if phnum == PN_XNUM as usize {
+            let shoff = read_u64(data, 40).ok_or("truncated ELF header")? as usize;
+            phnum = shoff.checked_add(44)
+                .and_then(|offset| read_u32(data, offset))
+                .ok_or("truncated section header")? as usize;
+        }
+        if phentsize < 56 {
+            return Err("bad program header size");
+        }
+
+        let mut notes = Vec::new();
+        for i in 0..phnum {
+            let ph = i.checked_mul(phentsize)
+                .and_then(|rel| phoff.checked_add(rel))
+                .filter(|ph| ph.checked_add(phentsize).map_or(false, |end| end <= data.len()))
+                .ok_or("truncated program headers")?;
+            let (Some(p_type), Some(flags), Some(offset), Some(vaddr), Some(filesz), Some(memsz)) = (
+                read_u32(data, ph),
+                read_u32(data, ph + 4),
+                read_u64(data, ph + 8),
+                read_u64(data, ph + 16),
+                read_u64(data, ph + 32),
+                read_u64(data, ph + 40),
+            ) else {
+                return Err("truncated program headers");
+            };
+            match p_type {
+                PT_LOAD => layout.segments.push(CoreSegment { vaddr, memsz, offset, filesz, flags }),
+                PT_NOTE => notes.push((offset as usize, filesz as usize)),
+                _ => {}
+            }
+        }
+        layout.segments.sort_by_key(|segment| segment.vaddr);
+
+        for (offset, size) in notes {
+            let Some(region) = data.get(offset..offset.saturating_add(size)) else {
+                continue;
+            };
+            for (name, note_type, desc) in (NoteIter { data: region, pos: 0 }) {
+                if name == INCODE_NOTE_NAME.as_bytes() {
+                    layout.parse_incode_note(note_type, desc);
+                } else {
+                    layout.parse_note(note_type, desc);
+                }
+            }
+        }
+        Ok(layout)
+    }
+
+    fn parse_incode_note(&mut self, note_type: u32, desc: &[u8]) {
+        let text = String::from_utf8_lossy(desc);
+        // Tab-separated lines: addresses in hex, then the remaining fields
+        for line in text.lines() {
+            let fields: Vec<&str> = line.splitn(4, '\t').collect();
+            let [start, end, third, path] = fields[..] else {
+                continue;
+            };
+            let (Ok(start), Ok(end)) = (u64::from_str_radix(start, 16), u64::from_str_radix(end, 16)) else {
+                continue;
+            };
+            let path = (!path.is_empty()).then(|| path.to_string());
+            match note_type {
+                NT_INCODE_MODULES => self.modules.push(CoreModule {
+                    build_id: (!third.is_empty()).then(|| third.to_string()),
+                    path: path.unwrap_or_default(),
+                }),
+                NT_INCODE_REGIONS => self.region_map.push(CoreRegion {
+                    start,
+                    end,
+                    permissions: third.to_string(),
+                    path,
+                }),
+                _ => {}
+            }
+        }
+    }
+
+    fn parse_note(&mut self, note_type: u32, desc: &[u8]) {
+        match note_type {
+            NT_PRSTATUS => {
+                let reg = |index: usize| read_u64(desc, PRSTATUS_REGS_OFFSET + index * 8);
+                let (pc, sp) = match self.machine {
+                    EM_X86_64 => (reg(16), reg(19)),
+                    EM_AARCH64 => (reg(32), reg(31)),
+                    _ => (None, None),
+                };
+                self.threads.push(CoreThread {
+                    tid: read_u32(desc, 32).unwrap_or(0),
+                    signal: read_u16(desc, 12).unwrap_or(0) as i16 as i32,
+                    pc,
+                    sp,
+                });
+            }
+            NT_PRPSINFO => {
+                self.pid = read_u32(desc, 24);
+                self.command = desc.get(40..56).map(c_string);
+            }
+            NT_SIGINFO if self.signal.is_none() => {
+                let signo = read_u32(desc, 0).unwrap_or(0) as i32;
+                let code = read_u32(desc, 8).unwrap_or(0) as i32;
+                let faulting = matches!(signo, libc::SIGSEGV | libc::SIGBUS | libc::SIGILL | libc::SIGFPE | libc::SIGTRAP);
+                // si_code <= 0 means the signal was sent, not raised by a fault
+                self.signal = Some(CoreSignal {
+                    signo,
+                    errno: read_u32(desc, 4).unwrap_or(0) as i32,
+                    code,
+                    fault_address: if faulting && code > 0 { read_u64(desc, 16) } else { None },
+                    sender_pid: if code <= 0 { read_u32(desc, 16) } else { None },
+                });
+            }
+            NT_FILE => {
+                let count = read_u64(desc, 0).unwrap_or(0) as usize;
+                let page_size = read_u64(desc, 8).unwrap_or(1);
+                let names_start = 16 + count.saturating_mul(24);
+                let mut names = desc.get(names_start..).unwrap_or_default().split(|&b| b == 0);
+                for i in 0..count {
+                    let entry = 16 + i * 24;
+                    let (Some(start), Some(end), Some(page_offset)) =
+                        (read_u64(desc, entry), read_u64(desc, entry + 8), read_u64(desc, entry + 16))
+                    else {
+                        break;
+                    };
+                    self.mapped_files.push(MappedFile {
+                        start,
+                        end,
+                        file_offset: page_offset.saturating_mul(page_size),
+                        path: names.next().map(|name| String::from_utf8_lossy(name).into_owned()).unwrap_or_default(),
+                    });
+                }
+            }
+            _ => {}
+        }
+    }
+}
+
+/// Iterates (name, type, descriptor) triples of an ELF note section
+struct NoteIter<'a> {
+    data: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Iterator for NoteIter<'a> {
+    type Item = (&'a [u8], u32, &'a [u8]);
+
+    fn next(&mut self) -> Option<Self::Item> {
+        let namesz = read_u32(self.data, self.pos)? as usize;
+        let descsz = read_u32(self.data, self.pos + 4)? as usize;
+        let note_type = read_u32(self.data, self.pos + 8)?;
+        let name = self.data.get(self.pos + 12..self.pos + 12 + namesz)?;
+        let desc_start = self.pos + 12 + align4(namesz);
+        let desc = self.data.get(desc_start..desc_start.checked_add(descsz)?)?;
+        self.pos = desc_start + align4(descsz);
+        // The name's terminating NUL is counted in namesz
+        let name = name.strip_suffix(b"\0").unwrap_or(name);
+        Some((name, note_type, desc))
+    }
+}
+
+pub(crate) fn align4(n: usize) -> usize {
+    (n + 3) & !3
+}
+
+fn read_u16(data: &[u8], offset: usize) -> Option<u16> {
+    data.get(offset..offset.checked_add(2)?).map(|b| u16::from_le_bytes([b[0], b[1]]))
+}
+
+fn read_u32(data: &[u8], offset: usize) -> Option<u32> {
+    data.get(offset..offset.checked_add(4)?).map(|b| u32::from_le_bytes(b.try_into().unwrap()))
+}
+
+fn read_u64(data: &[u8], offset: usize) -> Option<u64> {
+    data.get(offset..offset.checked_add(8)?).map(|b| u64::from_le_bytes(b.try_into().unwrap()))
+}
+
+fn c_string(bytes: &[u8]) -> String {
+    let end = bytes.iter().position(|&b| b == 0).unwrap_or(bytes.len());
+    String::from_utf8_lossy(&bytes[..end]).into_owned()
+}
+
+/// Conventional name of a POSIX signal number
+pub fn signal_name(signo: i32) -> &'static str {
+    match signo {
+        libc::SIGHUP => "SIGHUP",
+        libc::SIGINT => "SIGINT",
+        libc::SIGQUIT => "SIGQUIT",
+        libc::SIGILL => "SIGILL",
+        libc::SIGTRAP => "SIGTRAP",
+        libc::SIGABRT => "SIGABRT",
+        libc::SIGBUS => "SIGBUS",
+        libc::SIGFPE => "SIGFPE",
+        libc::SIGKILL => "SIGKILL",
+        libc::SIGUSR1 => "SIGUSR1",
+        libc::SIGSEGV => "SIGSEGV",
+        libc::SIGUSR2 => "SIGUSR2",
+        libc::SIGPIPE => "SIGPIPE",
+        libc::SIGALRM => "SIGALRM",
+        libc::SIGTERM => "SIGTERM",
+        libc::SIGSYS => "SIGSYS",
+        libc::SIGXCPU => "SIGXCPU",
+        libc::SIGXFSZ => "SIGXFSZ",
+        0 => "none",
+        _ => "unknown",
+    }
+}
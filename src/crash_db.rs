@@ -0,0 +1,614 @@
+// Persistent crash signature database
+//
+// Two files in one directory. `records.log` is append-only: every observation
+// of a crash appends a complete, self-describing snapshot of its bucket, so the
+// newest record for a signature is all a lookup needs. `index.bin` is an
+// open-addressing hash table on disk mapping a signature to the offset of that
+// newest record. Lookups and updates read a handful of slots with pread and
+// never load either file, which keeps them O(1) at millions of buckets.
+//
+// The log is the source of truth: if the process dies between appending a
+// record and updating the index, the next open replays the unindexed tail.
+
+use std::fs::{File, OpenOptions};
+use std::io::Write;
+use std::os::unix::fs::{FileExt, MetadataExt};
+use std::os::unix::io::{AsRawFd, RawFd};
+use std::path::{Path, PathBuf};
+use std::time::{SystemTime, UNIX_EPOCH};
+
+use tracing::{debug, info, warn};
+
+use crate::error::{IncodeError, IncodeResult};
+use crate::lldb_manager::CrashAnalysis;
+
+const INDEX_MAGIC: &[u8; 8] = b"ICDXv001";
+const RECORD_MAGIC: u32 = 0x4345_5243; // "CREC"
+const HEADER_SIZE: u64 = 64;
+const SLOT_SIZE: u64 = 16;
+const INITIAL_CAPACITY: u64 = 1 << 16;
+/// Slot value marking a core that has already been counted
+const CORE_SEEN: u64 = u64::MAX;
+/// Slots read per pread while rehashing
+const REHASH_BATCH: u64 = 4096;
+/// Largest record body accepted from the log; real records are a few KiB
+const MAX_RECORD_SIZE: u64 = 1 << 20;
+/// Bytes scanned per pread when looking for the record after a corrupt one
+const RESYNC_CHUNK: usize = 64 * 1024;
+
+/// Current state of one crash bucket
+#[derive(Debug, Clone)]
+pub struct CrashRecord {
+    /// Sequential bucket number, stable for the life of the database
+    pub bucket_id: u64,
+    pub signature: u64,
+    pub count: u64,
+    /// Unix seconds
+    pub first_seen: u64,
+    pub last_seen: u64,
+    pub signal: i32,
+    /// Build ID of the executable when the crash was first and last seen
+    pub first_build: Option<String>,
+    pub last_build: Option<String>,
+    /// First core recorded for the bucket
+    pub representative: Option<String>,
+    pub last_core: Option<String>,
+    pub frames: Vec<String>,
+    pub summary: String,
+}
+
+impl CrashRecord {
+    /// One-line history, e.g. "matches bucket #412, seen 93 times since build 3f2a..."
+    pub fn describe(&self) -> String {
+        match self.first_build.as_deref() {
+            Some(build) => format!("matches bucket #{}, seen {} times since build {}", self.bucket_id, self.count, build),
+            None => format!("matches bucket #{}, seen {} times", self.bucket_id, self.count),
+        }
+    }
+
+    fn encode(&self) -> Vec<u8> {
+        let mut body = Vec::with_capacity(128);
+        for value in [self.bucket_id, self.signature, self.count, self.first_seen, self.last_seen] {
+            body.extend_from_slice(&value.to_le_bytes());
+        }
+        body.extend_from_slice(&self.signal.to_le_bytes());
+        for text in [
+            self.first_build.as_deref().unwrap_or(""),
+            self.last_build.as_deref().unwrap_or(""),
+            self.representative.as_deref().unwrap_or(""),
+            self.last_core.as_deref().unwrap_or(""),
+            &self.frames.join("\n"),
+            &self.summary,
+        ] {
+            body.extend_from_slice(&(text.len() as u32).to_le_bytes());
+            body.extend_from_slice(text.as_bytes());
+        }
+
+        let mut record = Vec::with_capacity(body.len() + 8);
+        record.extend_from_slice(&RECORD_MAGIC.to_le_bytes());
+        record.extend_from_slice(&(body.len() as u32).to_le_bytes());
+        record.extend_from_slice(&body);
+        record
+    }
+
+    fn decode(body: &[u8]) -> Option<Self> {
+        let u64_at = |offset: usize| body.get(offset..offset + 8).map(|b| u64::from_le_bytes(b.try_into().unwrap()));
+        let mut pos = 44;
+        let mut next_text = || -> Option<String> {
+            let len = u32::from_le_bytes(body.get(pos..pos + 4)?.try_into().unwrap()) as usize;
+            let text = std::str::from_utf8(body.get(pos + 4..pos + 4 + len)?).ok()?.to_string();
+            pos += 4 + len;
+            Some(text)
+        };
+        let non_empty = |text: String| (!text.is_empty()).then_some(text);
+
+        let first_build = non_empty(next_text()?);
+        let last_build = non_empty(next_text()?);
+        let representative = non_empty(next_text()?);
+        let last_core = non_empty(next_text()?);
+        let frames = next_text()?;
+        let summary = next_text()?;
+        Some(Self {
+            bucket_id: u64_at(0)?,
+            signature: u64_at(8)?,
+            count: u64_at(16)?,
+            first_seen: u64_at(24)?,
+            last_seen: u64_at(32)?,
+            signal: i32::from_le_bytes(body.get(40..44)?.try_into().unwrap()),
+            first_build,
+            last_build,
+            representative,
+            last_core,
+            frames: if frames.is_empty() { Vec::new() } else { frames.lines().map(String::from).collect() },
+            summary,
+        })
+    }
+}
+
+/// One sighting of a crash to fold into the database
+#[derive(Debug, Clone)]
+pub struct CrashObservation<'a> {
+    pub signature: u64,
+    pub signal: i32,
+    pub frames: &'a [String],
+    pub core_path: Option<&'a str>,
+    pub build: Option<&'a str>,
+    pub summary: &'a str,
+}
+
+#[derive(Debug, Clone, Copy)]
+struct IndexHeader {
+    capacity: u64,
+    entries: u64,
+    next_bucket_id: u64,
+    /// Log bytes reflected in the index
+    log_len: u64,
+}
+
+/// Handle on a crash database directory. Every operation locks the index, so
+/// several handles (including other processes) can share one database.
+pub struct CrashDatabase {
+    dir: PathBuf,
+    log: File,
+    index: File,
+}
+
+/// Exclusive or shared flock on the index, held for one operation. The index
+/// file is never replaced, so its descriptor outlives every lock.
+struct IndexLock(RawFd);
+
+impl IndexLock {
+    fn acquire(file: &File, exclusive: bool) -> IncodeResult<Self> {
+        let operation = if exclusive { libc::LOCK_EX } else { libc::LOCK_SH };
+        if unsafe { libc::flock(file.as_raw_fd(), operation) } != 0 {
+            return Err(io_error("lock crash index", std::io::Error::last_os_error()));
+        }
+        Ok(Self(file.as_raw_fd()))
+    }
+}
+
+impl Drop for IndexLock {
+    fn drop(&mut self) {
+        unsafe { libc::flock(self.0, libc::LOCK_UN) };
+    }
+}
+
+impl CrashDatabase {
+    /// Open the database in `dir`, creating it if needed
+    pub fn open(dir: impl AsRef<Path>) -> IncodeResult<Self> {
+        let dir = dir.as_ref().to_path_buf();
+        std::fs::create_dir_all(&dir).map_err(|e| io_error("create crash database directory", e))?;
+        let log = OpenOptions::new()
+            .read(true)
+            .append(true)
+            .create(true)
+            .open(dir.join("records.log"))
+            .map_err(|e| io_error("open crash log", e))?;
+        let index = OpenOptions::new()
+            .read(true)
+            .write(true)
+            .create(true)
+            .open(dir.join("index.bin"))
+            .map_err(|e| io_error("open crash index", e))?;
+
+        let mut db = Self { dir, log, index };
+        let lock = IndexLock::acquire(&db.index, true)?;
+        let header = match db.read_header()? {
+            // log_len 0 over a non-empty log means a resize was interrupted
+            Some(header) if header.log_len > 0 || db.log_len()? == 0 => header,
+            Some(header) => db.reset_index(header.capacity)?,
+            None => db.reset_index(INITIAL_CAPACITY)?,
+        };
+        db.replay_log(header)?;
+        drop(lock);
+        Ok(db)
+    }
+
+    /// Open the database only if it already exists; lookups never create one
+    pub fn open_existing(dir: impl AsRef<Path>) -> IncodeResult<Option<Self>> {
+        if dir.as_ref().join("index.bin").exists() {
+            Self::open(dir).map(Some)
+        } else {
+            Ok(None)
+        }
+    }
+
+    /// Number of buckets
+    pub fn len(&self) -> IncodeResult<u64> {
+        let _lock = IndexLock::acquire(&self.index, false)?;
+        Ok(self.read_header()?.map_or(0, |header| header.next_bucket_id - 1))
+    }
+
+    /// Current state of the bucket for `signature`
+    pub fn lookup(&self, signature: u64) -> IncodeResult<Option<CrashRecord>> {
+        let _lock = IndexLock::acquire(&self.index, false)?;
+        let Some(header) = self.read_header()? else {
+            return Ok(None);
+        };
+        self.bucket(&header, signature)
+    }
+
+    /// Count one sighting. A core that was already recorded is not counted
+    /// again, so re-triaging a directory leaves the counts alone.
+    pub fn observe(&mut self, observation: &CrashObservation) -> IncodeResult<CrashRecord> {
+        let _lock = IndexLock::acquire(&self.index, true)?;
+        let mut header = self.read_header()?.ok_or_else(|| IncodeError::session("Crash index is missing its header"))?;
+        let key = signature_key(observation.signature);
+
+        let core_key = observation.core_path.map(core_key);
+        let existing = self.bucket(&header, observation.signature)?;
+        if let Some(core_key) = core_key {
+            if let (_, Some(_)) = self.find_slot(&header, core_key)? {
+                if let Some(record) = existing {
+                    return Ok(record);
+                }
+            }
+        }
+
+        let now = unix_now();
+        let record = match existing {
+            Some(mut record) => {
+                record.count += 1;
+                record.last_seen = now;
+                if observation.build.is_some() {
+                    record.last_build = observation.build.map(String::from);
+                }
+                if observation.core_path.is_some() {
+                    record.last_core = observation.core_path.map(String::from);
+                }
+                if record.representative.is_none() {
+                    record.representative = record.last_core.clone();
+                }
+                record
+            }
+            None => {
+                header.next_bucket_id += 1;
+                CrashRecord {
+                    bucket_id: header.next_bucket_id - 1,
+                    signature: observation.signature,
+                    count: 1,
+                    first_seen: now,
+                    last_seen: now,
+                    signal: observation.signal,
+                    first_build: observation.build.map(String::from),
+                    last_build: observation.build.map(String::from),
+                    representative: observation.core_path.map(String::from),
+                    last_core: observation.core_path.map(String::from),
+                    frames: observation.frames.to_vec(),
+                    summary: observation.summary.to_string(),
+                }
+            }
+        };
+
+        let (offset, len) = self.append_record(&record)?;
+        header.log_len = offset + len;
+        self.put(&mut header, key, offset + 1)?;
+        if let Some(core_key) = core_key {
+            self.put(&mut header, core_key, CORE_SEEN)?;
+        }
+        self.write_header(&header)?;
+        Ok(record)
+    }
+
+    /// Fold a crash analysis in; `None` when it has no signature
+    pub fn record(&mut self, analysis: &CrashAnalysis, core_path: Option<&str>, build: Option<&str>) -> IncodeResult<Option<CrashRecord>> {
+        let Some(signature) = analysis.signature else {
+            return Ok(None);
+        };
+        self.observe(&CrashObservation {
+            signature,
+            signal: analysis.signal_number,
+            frames: &analysis.signature_frames,
+            core_path,
+            build,
+            summary: &analysis.crash_summary,
+        })
+        .map(Some)
+    }
+
+    fn read_header(&self) -> IncodeResult<Option<IndexHeader>> {
+        let mut raw = [0u8; HEADER_SIZE as usize];
+        match self.index.read_exact_at(&mut raw, 0) {
+            Ok(()) => {}
+            Err(e) if e.kind() == std::io::ErrorKind::UnexpectedEof => return Ok(None),
+            Err(e) => return Err(io_error("read crash index", e)),
+        }
+        if &raw[..8] != INDEX_MAGIC {
+            return Err(IncodeError::session(format!("{} is not a crash index", self.dir.join("index.bin").display())));
+        }
+        let field = |i: usize| u64::from_le_bytes(raw[8 + i * 8..16 + i * 8].try_into().unwrap());
+        Ok(Some(IndexHeader { capacity: field(0), entries: field(1), next_bucket_id: field(2), log_len: field(3) }))
+    }
+
+    fn write_header(&self, header: &IndexHeader) -> IncodeResult<()> {
+        write_header_to(&self.index, header)
+    }
+
+    /// Newest record of the bucket for `signature`. Index keys are hashes, so
+    /// the record is checked against the signature before it is trusted.
+    fn bucket(&self, header: &IndexHeader, signature: u64) -> IncodeResult<Option<CrashRecord>> {
+        let (_, Some(value)) = self.find_slot(header, signature_key(signature))? else {
+            return Ok(None);
+        };
+        let record = self.read_record(value - 1)?;
+        if record.signature != signature {
+            return Err(IncodeError::session(format!(
+                "Crash index entry for signature {:016x} points at a record for {:016x}; delete {} to rebuild it",
+                signature, record.signature, self.dir.join("index.bin").display()
+            )));
+        }
+        Ok(Some(record))
+    }
+
+    /// Slot index for `key` and its value, if present
+    fn find_slot(&self, header: &IndexHeader, key: u64) -> IncodeResult<(u64, Option<u64>)> {
+        find_slot_in(&self.index, header.capacity, key)
+    }
+
+    fn put(&mut self, header: &mut IndexHeader, key: u64, value: u64) -> IncodeResult<()> {
+        let (slot, existing) = self.find_slot(header, key)?;
+        write_slot(&self.index, slot, key, value)?;
+        if existing.is_none() {
+            header.entries += 1;
+            // Keep probe sequences short
+            if header.entries * 10 > header.capacity * 7 {
+                self.grow(header)?;
+            }
+        }
+        Ok(())
+    }
+
+    /// Rehash into a table twice the size. The old slots are spilled to a
+    /// side file and reinserted, so memory use stays at one batch.
+    fn grow(&mut self, header: &mut IndexHeader) -> IncodeResult<()> {
+        // Mark the index dirty first: a crash mid-resize rebuilds it from the log
+        let log_len = header.log_len;
+        header.log_len = 0;
+        self.write_header(header)?;
+
+        let spill_path = self.dir.join("index.grow");
+        let spill = OpenOptions::new()
+            .read(true)
+            .write(true)
+            .create(true)
+            .truncate(true)
+            .open(&spill_path)
+            .map_err(|e| io_error("create crash index spill", e))?;
+        let old_capacity = header.capacity;
+        let mut batch = vec![0u8; (REHASH_BATCH * SLOT_SIZE) as usize];
+        let mut start = 0;
+        while start < old_capacity {
+            let count = REHASH_BATCH.min(old_capacity - start);
+            let bytes = &mut batch[..(count * SLOT_SIZE) as usize];
+            self.index
+                .read_exact_at(bytes, HEADER_SIZE + start * SLOT_SIZE)
+                .map_err(|e| io_error("read crash index", e))?;
+            spill.write_all_at(bytes, start * SLOT_SIZE).map_err(|e| io_error("write crash index spill", e))?;
+            start += count;
+        }
+
+        header.capacity = old_capacity * 2;
+        self.zero_slots(header.capacity)?;
+        let mut start = 0;
+        while start < old_capacity {
+            let count = REHASH_BATCH.min(old_capacity - start);
+            let bytes = &mut batch[..(count * SLOT_SIZE) as usize];
+            spill.read_exact_at(bytes, start * SLOT_SIZE).map_err(|e| io_error("read crash index spill", e))?;
+            for slot in bytes.chunks_exact(SLOT_SIZE as usize) {
+                let key = u64::from_le_bytes(slot[..8].try_into().unwrap());
+                let value = u64::from_le_bytes(slot[8..].try_into().unwrap());
+                if value != 0 {
+                    let (target, _) = self.find_slot(header, key)?;
+                    write_slot(&self.index, target, key, value)?;
+                }
+            }
+            start += count;
+        }
+        drop(spill);
+        let _ = std::fs::remove_file(&spill_path);
+
+        header.log_len = log_len;
+        self.write_header(header)?;
+        info!("Crash index grown to {} slots", header.capacity);
+        Ok(())
+    }
+
+    /// Clear every slot and size the table for `capacity`
+    fn zero_slots(&self, capacity: u64) -> IncodeResult<()> {
+        self.index.set_len(HEADER_SIZE).map_err(|e| io_error("size crash index", e))?;
+        self.index.set_len(HEADER_SIZE + capacity * SLOT_SIZE).map_err(|e| io_error("size crash index", e))
+    }
+
+    /// Empty index that replay_log will fill from the start of the log
+    fn reset_index(&self, capacity: u64) -> IncodeResult<IndexHeader> {
+        let header = IndexHeader { capacity, entries: 0, next_bucket_id: 1, log_len: 0 };
+        self.zero_slots(capacity)?;
+        self.write_header(&header)?;
+        Ok(header)
+    }
+
+    fn log_len(&self) -> IncodeResult<u64> {
+        self.log.metadata().map(|m| m.len()).map_err(|e| io_error("stat crash log", e))
+    }
+
+    /// Append a record; returns its offset and length
+    fn append_record(&mut self, record: &CrashRecord) -> IncodeResult<(u64, u64)> {
+        let encoded = record.encode();
+        let offset = self.log_len()?;
+        self.log.write_all(&encoded).map_err(|e| io_error("append crash log", e))?;
+        Ok((offset, encoded.len() as u64))
+    }
+
+    fn read_record(&self, offset: u64) -> IncodeResult<CrashRecord> {
+        self.read_framed(offset).map(|(record, _)| record)
+    }
+
+    /// Record at `offset` and its length on disk
+    fn read_framed(&self, offset: u64) -> IncodeResult<(CrashRecord, u64)> {
+        let mut frame = [0u8; 8];
+        self.log.read_exact_at(&mut frame, offset).map_err(|e| io_error("read crash log", e))?;
+        let magic = u32::from_le_bytes(frame[..4].try_into().unwrap());
+        let len = u32::from_le_bytes(frame[4..].try_into().unwrap()) as u64;
+        if magic != RECORD_MAGIC {
+            return Err(IncodeError::session(format!("Corrupt crash record at offset {}", offset)));
+        }
+        // A corrupt length must not turn into a huge allocation
+        if len > MAX_RECORD_SIZE || offset + 8 + len > self.log_len()? {
+            return Err(IncodeError::session(format!("Crash record at offset {} claims {} bytes", offset, len)));
+        }
+        let len = len as usize;
+        let mut body = vec![0u8; len];
+        self.log.read_exact_at(&mut body, offset + 8).map_err(|e| io_error("read crash log", e))?;
+        let record = CrashRecord::decode(&body).ok_or_else(|| IncodeError::session(format!("Corrupt crash record at offset {}", offset)))?;
+        Ok((record, 8 + len as u64))
+    }
+
+    /// Index records appended after the index was last written
+    fn replay_log(&mut self, mut header: IndexHeader) -> IncodeResult<()> {
+        let log_len = self.log_len()?;
+        if log_len <= header.log_len {
+            return Ok(());
+        }
+        warn!("Crash index is behind its log by {} bytes; replaying", log_len - header.log_len);
+
+        let mut offset = header.log_len;
+        let mut skipped = 0;
+        while offset < log_len {
+            let Ok((record, len)) = self.read_framed(offset) else {
+                // Resume at the next readable record. With none left this was a
+                // torn final append; drop it so new records stay reachable.
+                match self.next_record_after(offset, log_len)? {
+                    Some(next) => {
+                        warn!("Skipping {} unreadable bytes of crash log at offset {}", next - offset, offset);
+                        skipped += 1;
+                        offset = next;
+                        continue;
+                    }
+                    None => {
+                        warn!("Truncating unreadable crash record at offset {}", offset);
+                        self.log.set_len(offset).map_err(|e| io_error("truncate crash log", e))?;
+                        break;
+                    }
+                }
+            };
+            header.next_bucket_id = header.next_bucket_id.max(record.bucket_id + 1);
+            header.log_len = offset + len;
+            self.put(&mut header, signature_key(record.signature), offset + 1)?;
+            if let Some(core) = record.last_core.as_deref() {
+                self.put(&mut header, core_key(core), CORE_SEEN)?;
+            }
+            offset += len;
+        }
+        header.log_len = offset;
+        self.write_header(&header)?;
+        if skipped > 0 {
+            warn!("Crash log replay skipped {} corrupt regions", skipped);
+        }
+        debug!("Crash index caught up to offset {}", offset);
+        Ok(())
+    }
+
+    /// Offset of the first readable record after the corrupt one at `offset`
+    fn next_record_after(&self, offset: u64, log_len: u64) -> IncodeResult<Option<u64>> {
+        let magic = RECORD_MAGIC.to_le_bytes();
+        let mut chunk = vec![0u8; RESYNC_CHUNK];
+        let mut start = offset + 1;
+        while start < log_len {
+            let len = (RESYNC_CHUNK as u64).min(log_len - start) as usize;
+            self.log.read_exact_at(&mut chunk[..len], start).map_err(|e| io_error("read crash log", e))?;
+            let candidates = chunk[..len].windows(magic.len()).enumerate().filter(|(_, window)| *window == magic);
+            for (at, _) in candidates {
+                if self.read_framed(start + at as u64).is_ok() {
+                    return Ok(Some(start + at as u64));
+                }
+            }
+            // Overlap so a magic split across chunks is still seen
+            start += (len as u64).saturating_sub(magic.len() as u64 - 1).max(1);
+        }
+        Ok(None)
+    }
+}
+
+fn find_slot_in(index: &File, capacity: u64, key: u64) -> IncodeResult<(u64, Option<u64>)> {
+    let mut slot = key % capacity;
+    let mut raw = [0u8; SLOT_SIZE as usize];
+    loop {
+        index.read_exact_at(&mut raw, HEADER_SIZE + slot * SLOT_SIZE).map_err(|e| io_error("read crash index", e))?;
+        let slot_key = u64::from_le_bytes(raw[..8].try_into().unwrap());
+        let value = u64::from_le_bytes(raw[8..].try_into().unwrap());
+        if value == 0 {
+            return Ok((slot, None));
+        }
+        if slot_key == key {
+            return Ok((slot, Some(value)));
+        }
+        slot = (slot + 1) % capacity;
+    }
+}
+
+fn write_slot(index: &File, slot: u64, key: u64, value: u64) -> IncodeResult<()> {
+    let mut raw = [0u8; SLOT_SIZE as usize];
+    raw[..8].copy_from_slice(&key.to_le_bytes());
+    raw[8..].copy_from_slice(&value.to_le_bytes());
+    index.write_all_at(&raw, HEADER_SIZE + slot * SLOT_SIZE).map_err(|e| io_error("write crash index", e))
+}
+
+fn write_header_to(index: &File, header: &IndexHeader) -> IncodeResult<()> {
+    let mut raw = [0u8; HEADER_SIZE as usize];
+    raw[..8].copy_from_slice(INDEX_MAGIC);
+    for (i, value) in [header.capacity, header.entries, header.next_bucket_id, header.log_len].iter().enumerate() {
+        raw[8 + i * 8..16 + i * 8].copy_from_slice(&value.to_le_bytes());
+    }
+    index.write_all_at(&raw, 0).map_err(|e| io_error("write crash index", e))
+}
+
+/// Signatures and core paths share the table; the tag keeps them apart
+fn signature_key(signature: u64) -> u64 {
+    fnv1a(&[b"sig:".as_slice(), &signature.to_le_bytes()])
+}
+
+/// A core is the file at its path, so a new dump written over an old one's
+/// name is a new sighting. Falls back to the path alone once it is gone.
+fn core_key(core_path: &str) -> u64 {
+    let identity = std::fs::metadata(core_path).map(|meta| {
+        let mut identity = Vec::with_capacity(40);
+        for value in [meta.dev(), meta.ino(), meta.size(), meta.mtime() as u64, meta.mtime_nsec() as u64] {
+            identity.extend_from_slice(&value.to_le_bytes());
+        }
+        identity
+    });
+    fnv1a(&[b"core:".as_slice(), core_path.as_bytes(), identity.as_deref().unwrap_or_default()])
+}
+
+fn fnv1a(parts: &[&[u8]]) -> u64 {
+    let mut hash: u64 = 0xcbf2_9ce4_8422_2325;
+    for part in parts {
+        for &byte in *part {
+            hash ^= byte as u64;
+            hash = hash.wrapping_mul(0x0000_0100_0000_01b3);
+        }
+    }
+    hash
+}
+
+fn unix_now() -> u64 {
+    SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0)
+}
+
+fn io_error(action: &str, error: std::io::Error) -> IncodeError {
+    IncodeError::session(format!("Failed to {}: {}", action, error))
+}
+
+/// Where the crash database lives unless configured otherwise
+pub fn default_location() -> PathBuf {
+    if let Some(path) = std::env::var_os("INCODE_CRASH_DB") {
+        return PathBuf::from(path);
+    }
+    let data_home = std::env::var_os("XDG_DATA_HOME")
+        .map(PathBuf::from)
+        .or_else(|| std::env::var_os("HOME").map(|home| PathBuf::from(home).join(".local/share")));
+    match data_home {
+        Some(data_home) => data_home.join("incode").join("crashdb"),
+        None => std::env::temp_dir().join("incode-crashdb"),
+    }
+}
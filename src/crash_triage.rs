@@ -0,0 +1,580 @@
+// Batch crash triage
+//
+// Every core in a directory is reduced to a signature (the top frames of the
+// faulting thread, symbol names only) by worker processes, so a core that
+// crashes LLDB or eats memory takes down only its worker. Cores with the same
+// signature land in one bucket, and the full crash analysis runs once per
+// bucket on its most recent core rather than once per core. With a crash
+// database configured, buckets report their history from it, and when asked
+// to record, every core is also folded into its persistent bucket.
+
+use std::collections::HashMap;
+use std::io::Read;
+use std::path::{Path, PathBuf};
+use std::process::{Command, Stdio};
+use std::sync::{Mutex, Once};
+use std::time::{Duration, Instant, SystemTime};
+
+use lldb_sys::*;
+use serde_json::{json, Value};
+use tracing::{debug, info, warn};
+
+use crate::core_file::{self, CoreFile};
+use crate::crash_db::{CrashDatabase, CrashObservation, CrashRecord};
+use crate::error::{IncodeError, IncodeResult};
+use crate::fault_decode::fault_json;
+use crate::fleet_snapshot::thread_stack;
+use crate::lldb_manager::{sb_error_message, CrashAnalysis, LldbManager};
+
+/// Frames that belong to signal delivery or abort() rather than to the crash
+const SIGNAL_MACHINERY: &[&str] = &[
+    "__restore_rt",
+    "raise",
+    "gsignal",
+    "abort",
+    "pthread_kill",
+    "__pthread_kill",
+    "__pthread_kill_implementation",
+    "__pthread_kill_internal",
+    "__assert_fail",
+    "__assert_fail_base",
+    "__GI_raise",
+    "__GI_abort",
+    "__GI___pthread_kill",
+];
+
+/// Frames in a crash signature unless configured otherwise
+pub const SIGNATURE_FRAMES: usize = 5;
+
+/// How many cores to triage and how hard to work at it
+#[derive(Debug, Clone)]
+pub struct TriageOptions {
+    /// Frames that make up a signature
+    pub frames: usize,
+    /// Upper bound on concurrent workers; defaults to the CPU count
+    pub max_workers: Option<usize>,
+    /// Memory a worker is assumed to need, used to bound concurrency
+    pub worker_memory_bytes: u64,
+    /// Only files whose name contains this are considered
+    pub name_pattern: Option<String>,
+    pub max_cores: usize,
+    /// A worker is killed after this long on one core
+    pub timeout: Duration,
+    /// Run the full crash analysis on each bucket's representative
+    pub analyze: bool,
+    /// incode binary to run workers with; defaults to the running executable
+    pub worker_exe: Option<PathBuf>,
+    /// Crash database to report bucket history from
+    pub database: Option<PathBuf>,
+    /// Also count every triaged core in `database`
+    pub record: bool,
+}
+
+impl Default for TriageOptions {
+    fn default() -> Self {
+        Self {
+            frames: SIGNATURE_FRAMES,
+            max_workers: None,
+            worker_memory_bytes: 1024 * 1024 * 1024,
+            name_pattern: None,
+            max_cores: 1000,
+            timeout: Duration::from_secs(120),
+            analyze: true,
+            worker_exe: None,
+            database: None,
+            record: false,
+        }
+    }
+}
+
+/// Signature of one core, as reported by a worker
+#[derive(Debug, Clone)]
+pub struct CoreSignature {
+    pub core_path: String,
+    /// Normalized top frames, e.g. `parse_header (libproto.so)`
+    pub frames: Vec<String>,
+    pub signal: i32,
+    /// Stable hash of the signal and frames
+    pub hash: u64,
+    /// Build ID of the crashed executable
+    pub build: Option<String>,
+    pub error: Option<String>,
+}
+
+/// Cores that crashed the same way
+#[derive(Debug, Clone)]
+pub struct CrashBucket {
+    pub hash: u64,
+    pub frames: Vec<String>,
+    pub signal: i32,
+    pub count: usize,
+    /// Most recently written core in the bucket
+    pub representative: String,
+    pub cores: Vec<String>,
+    /// Full analysis of the representative, when requested
+    pub analysis: Option<Value>,
+    /// Persistent bucket after recording these cores
+    pub history: Option<CrashRecord>,
+}
+
+#[derive(Debug, Clone)]
+pub struct TriageReport {
+    pub directory: String,
+    pub cores_found: usize,
+    pub cores_triaged: usize,
+    /// Buckets ordered by size, largest first
+    pub buckets: Vec<CrashBucket>,
+    /// Cores that could not be reduced to a signature
+    pub failures: Vec<CoreSignature>,
+    pub workers: usize,
+    pub out_of_process: bool,
+    /// Buckets in the crash database after this run, if there is one
+    pub database_buckets: Option<u64>,
+    pub elapsed_ms: u64,
+}
+
+/// Triage every core in `directory`
+pub fn triage_cores(directory: &str, options: &TriageOptions) -> IncodeResult<TriageReport> {
+    let started = Instant::now();
+    let cores = find_cores(Path::new(directory), options)?;
+    let cores_found = cores.len();
+    if cores.is_empty() {
+        return Err(IncodeError::invalid_parameter(format!("No core files found in {}", directory)));
+    }
+    let cores: Vec<PathBuf> = cores.into_iter().take(options.max_cores).collect();
+
+    let workers = worker_count(options).min(cores.len());
+    let worker_exe = options.worker_exe.clone().or_else(default_worker_exe);
+    info!(
+        "Triaging {} cores in {} with {} {}",
+        cores.len(), directory, workers,
+        if worker_exe.is_some() { "worker processes" } else { "worker threads" }
+    );
+
+    // Phase 1: signatures for every core
+    let signatures = run_pool(&cores, workers, |core| {
+        let result = match worker_exe.as_deref() {
+            Some(exe) => run_worker_process(exe, core, options.frames, false, options.timeout),
+            None => Ok(triage_worker(core, options.frames, false)),
+        };
+        let value = result.unwrap_or_else(|e| json!({ "core": core.to_string_lossy(), "error": e.to_string() }));
+        signature_from_json(core, &value)
+    });
+
+    // Newest first, so each bucket's representative is its most recent core
+    let mut signatures: Vec<(SystemTime, CoreSignature)> = signatures
+        .into_iter()
+        .map(|signature| (modified(Path::new(&signature.core_path)), signature))
+        .collect();
+    signatures.sort_by(|a, b| b.0.cmp(&a.0));
+
+    // Only recording creates the database; history is read from one that exists
+    let mut database = match options.database.as_deref() {
+        Some(path) if options.record => Some(CrashDatabase::open(path)?),
+        Some(path) => CrashDatabase::open_existing(path)?,
+        None => None,
+    };
+    let mut failures = Vec::new();
+    let mut buckets: Vec<CrashBucket> = Vec::new();
+    let mut by_hash: HashMap<u64, usize> = HashMap::new();
+    // Oldest first into the database, so first_seen and first_build are right
+    for (_, signature) in signatures.iter().rev() {
+        let Some(db) = database.as_mut().filter(|_| options.record && signature.error.is_none()) else {
+            continue;
+        };
+        let observation = CrashObservation {
+            signature: signature.hash,
+            signal: signature.signal,
+            frames: &signature.frames,
+            core_path: Some(&signature.core_path),
+            build: signature.build.as_deref(),
+            summary: &format!("{} in {}", core_file::signal_name(signature.signal), signature.frames.first().map_or("?", String::as_str)),
+        };
+        if let Err(e) = db.observe(&observation) {
+            warn!("Failed to record {} in the crash database: {}", signature.core_path, e);
+        }
+    }
+    for (_, signature) in signatures {
+        if signature.error.is_some() {
+            failures.push(signature);
+            continue;
+        }
+        match by_hash.get(&signature.hash) {
+            Some(&index) => {
+                buckets[index].count += 1;
+                buckets[index].cores.push(signature.core_path);
+            }
+            None => {
+                by_hash.insert(signature.hash, buckets.len());
+                buckets.push(CrashBucket {
+                    hash: signature.hash,
+                    frames: signature.frames,
+                    signal: signature.signal,
+                    count: 1,
+                    representative: signature.core_path.clone(),
+                    cores: vec![signature.core_path],
+                    analysis: None,
+                    history: None,
+                });
+            }
+        }
+    }
+    buckets.sort_by(|a, b| b.count.cmp(&a.count).then(a.hash.cmp(&b.hash)));
+    if let Some(db) = database.as_ref() {
+        for bucket in &mut buckets {
+            bucket.history = db.lookup(bucket.hash).unwrap_or_else(|e| {
+                warn!("Crash database lookup failed: {}", e);
+                None
+            });
+        }
+    }
+
+    // Phase 2: the expensive analysis, once per bucket
+    if options.analyze && !buckets.is_empty() {
+        let representatives: Vec<PathBuf> = buckets.iter().map(|bucket| PathBuf::from(&bucket.representative)).collect();
+        let analyses = run_pool(&representatives, workers.min(representatives.len()), |core| {
+            let result = match worker_exe.as_deref() {
+                Some(exe) => run_worker_process(exe, core, options.frames, true, options.timeout),
+                None => Ok(triage_worker(core, options.frames, true)),
+            };
+            (core.to_string_lossy().into_owned(), result.ok().and_then(|value| value.get("analysis").cloned()))
+        });
+        let mut analyses: HashMap<String, Option<Value>> = analyses.into_iter().collect();
+        for bucket in &mut buckets {
+            bucket.analysis = analyses.remove(&bucket.representative).flatten();
+        }
+    }
+
+    Ok(TriageReport {
+        directory: directory.to_string(),
+        cores_found,
+        cores_triaged: cores.len(),
+        buckets,
+        failures,
+        workers,
+        out_of_process: worker_exe.is_some(),
+        database_buckets: database.as_ref().and_then(|db| db.len().ok()),
+        elapsed_ms: started.elapsed().as_millis() as u64,
+    })
+}
+
+/// Body of a triage worker: signature (and optionally full analysis) of one
+/// core as JSON. Run by `incode --triage-worker`, or on a thread in-process.
+pub fn triage_worker(core_path: &Path, frames: usize, analyze: bool) -> Value {
+    let core_str = core_path.to_string_lossy().into_owned();
+    let (raw_frames, signal, fault_address, build) = match core_stack(core_path, frames + SIGNAL_MACHINERY.len()) {
+        Ok(stack) => stack,
+        Err(e) => return json!({ "core": core_str, "error": e.to_string() }),
+    };
+    let frames = normalize_frames(raw_frames, frames);
+
+    let mut result = json!({
+        "core": core_str,
+        "frames": frames,
+        "signal": signal,
+        "fault_address": fault_address,
+        "build": build,
+        "hash": format!("{:016x}", signature_hash(signal, &frames))
+    });
+    if analyze {
+        match LldbManager::new(None).and_then(|mut manager| manager.analyze_crash(Some(&core_str))) {
+            Ok(analysis) => result["analysis"] = crash_analysis_json(&analysis),
+            Err(e) => result["analysis_error"] = json!(e.to_string()),
+        }
+    }
+    result
+}
+
+/// Drop signal-delivery frames from the top of the stack and keep `frames`
+pub fn normalize_frames(stack: Vec<String>, frames: usize) -> Vec<String> {
+    stack
+        .into_iter()
+        .map(|frame| match frame.split_once(" + ") {
+            // Offsets differ between builds and would split buckets
+            Some((name, rest)) => match rest.find(" (") {
+                Some(module) => format!("{}{}", name, &rest[module..]),
+                None => name.to_string(),
+            },
+            None => frame,
+        })
+        .skip_while(|frame| {
+            let name = frame.split(" (").next().unwrap_or(frame);
+            SIGNAL_MACHINERY.contains(&name)
+        })
+        .take(frames)
+        .collect()
+}
+
+/// Normalized signature frames of a live or core thread and their hash
+pub fn thread_signature(thread: SBThreadRef, signal: i32, frames: usize) -> (Vec<String>, u64) {
+    let frames = normalize_frames(thread_stack(thread, (frames + SIGNAL_MACHINERY.len()) as u32), frames);
+    let hash = signature_hash(signal, &frames);
+    (frames, hash)
+}
+
+/// FNV-1a over the signal and frames; stable across runs and builds of incode
+pub fn signature_hash(signal: i32, frames: &[String]) -> u64 {
+    let mut hash: u64 = 0xcbf2_9ce4_8422_2325;
+    let mut feed = |bytes: &[u8]| {
+        for &byte in bytes {
+            hash ^= byte as u64;
+            hash = hash.wrapping_mul(0x0000_0100_0000_01b3);
+        }
+    };
+    feed(core_file::signal_name(signal).as_bytes());
+    for frame in frames {
+        feed(b"\n");
+        feed(frame.as_bytes());
+    }
+    hash
+}
+
+/// Faulting thread's stack, signal, fault address and executable build ID,
+/// using a private debugger
+fn core_stack(core_path: &Path, max_frames: usize) -> IncodeResult<(Vec<String>, i32, Option<u64>, Option<String>)> {
+    let core = CoreFile::open(core_path)?;
+    let signal = core.signal.as_ref().map_or(0, |signal| signal.signo);
+    let fault_address = core.signal.as_ref().and_then(|signal| signal.fault_address);
+
+    // A worker process has not set LLDB up; in-process this is a no-op
+    static LLDB_INIT: Once = Once::new();
+    LLDB_INIT.call_once(|| unsafe { SBDebuggerInitialize() });
+    let debugger = unsafe { SBDebuggerCreate() };
+    if debugger.is_null() {
+        return Err(IncodeError::lldb_init("Failed to create debugger"));
+    }
+    unsafe { SBDebuggerSetAsync(debugger, false) };
+    let stack = load_core_stack(debugger, &core, max_frames);
+    unsafe { SBDebuggerDestroy(debugger) };
+    let (stack, build) = stack?;
+    Ok((stack, signal, fault_address, build))
+}
+
+fn load_core_stack(debugger: SBDebuggerRef, core: &CoreFile, max_frames: usize) -> IncodeResult<(Vec<String>, Option<String>)> {
+    let exe_cstr = core.executable_path()
+        .filter(|path| Path::new(path).exists())
+        .and_then(|path| std::ffi::CString::new(path).ok());
+    let target = unsafe {
+        SBDebuggerCreateTarget2(debugger, exe_cstr.as_ref().map_or(std::ptr::null(), |exe| exe.as_ptr()))
+    };
+    if target.is_null() {
+        return Err(IncodeError::lldb_op("Failed to create target"));
+    }
+
+    let core_cstr = std::ffi::CString::new(core.path().to_string_lossy().as_bytes())
+        .map_err(|_| IncodeError::invalid_parameter("Invalid core file path"))?;
+    let error = unsafe { CreateSBError() };
+    let process = unsafe { SBTargetLoadCore2(target, core_cstr.as_ptr(), error) };
+    let load_error = if process.is_null() || unsafe { SBErrorFail(error) } {
+        Some(sb_error_message(error))
+    } else {
+        None
+    };
+    unsafe { DisposeSBError(error) };
+    if let Some(message) = load_error {
+        return Err(IncodeError::lldb_op(format!("Failed to load core: {}", message)));
+    }
+
+    if let Some(thread) = core.faulting_thread() {
+        unsafe { SBProcessSetSelectedThreadByID(process, thread.tid as lldb_tid_t) };
+    }
+    let thread = unsafe { SBProcessGetSelectedThread(process) };
+    if thread.is_null() {
+        return Err(IncodeError::thread("Core has no threads"));
+    }
+    Ok((thread_stack(thread, max_frames as u32), executable_build_id(target)))
+}
+
+/// UUID of the target's main module, e.g. the GNU build ID on Linux
+pub fn executable_build_id(target: SBTargetRef) -> Option<String> {
+    let module = unsafe { SBTargetGetModuleAtIndex(target, 0) };
+    if module.is_null() {
+        return None;
+    }
+    let uuid = unsafe { SBModuleGetUUIDString(module) };
+    if uuid.is_null() {
+        return None;
+    }
+    let uuid = unsafe { std::ffi::CStr::from_ptr(uuid) }.to_string_lossy().into_owned();
+    (!uuid.is_empty()).then_some(uuid)
+}
+
+/// Run `work` over `items` on `workers` threads pulling from a shared queue
+fn run_pool<T: Send>(items: &[PathBuf], workers: usize, work: impl Fn(&Path) -> T + Sync) -> Vec<T> {
+    let queue = Mutex::new(items.iter().collect::<Vec<_>>());
+    let results = Mutex::new(Vec::with_capacity(items.len()));
+    std::thread::scope(|scope| {
+        for _ in 0..workers.max(1) {
+            scope.spawn(|| loop {
+                let Some(item) = queue.lock().unwrap().pop() else {
+                    break;
+                };
+                let result = work(item);
+                results.lock().unwrap().push(result);
+            });
+        }
+    });
+    results.into_inner().unwrap()
+}
+
+/// Run one core through `incode --triage-worker`, killing it past `timeout`
+fn run_worker_process(exe: &Path, core: &Path, frames: usize, analyze: bool, timeout: Duration) -> IncodeResult<Value> {
+    let mut command = Command::new(exe);
+    command
+        .arg("--triage-worker")
+        .arg(core)
+        .arg("--triage-frames")
+        .arg(frames.to_string())
+        .stdin(Stdio::null())
+        .stdout(Stdio::piped())
+        .stderr(Stdio::null());
+    if analyze {
+        command.arg("--triage-analyze");
+    }
+    let mut child = command
+        .spawn()
+        .map_err(|e| IncodeError::process(format!("Failed to start triage worker: {}", e)))?;
+
+    // Drain stdout while waiting so a large analysis can't fill the pipe and stall the worker
+    let mut stdout = child.stdout.take().expect("worker stdout is piped");
+    let reader = std::thread::spawn(move || {
+        let mut output = String::new();
+        let _ = stdout.read_to_string(&mut output);
+        output
+    });
+
+    let deadline = Instant::now() + timeout;
+    let status = loop {
+        match child.try_wait() {
+            Ok(Some(status)) => break status,
+            Ok(None) if Instant::now() >= deadline => {
+                warn!("Triage worker for {} timed out", core.display());
+                let _ = child.kill();
+                let _ = child.wait();
+                return Err(IncodeError::Timeout);
+            }
+            Ok(None) => std::thread::sleep(Duration::from_millis(20)),
+            Err(e) => return Err(IncodeError::process(format!("Triage worker failed: {}", e))),
+        }
+    };
+    let output = reader.join().unwrap_or_default();
+    if !status.success() && output.trim().is_empty() {
+        return Err(IncodeError::process(format!("Triage worker exited with {}", status)));
+    }
+    serde_json::from_str(output.trim())
+        .map_err(|e| IncodeError::process(format!("Unreadable triage worker output: {}", e)))
+}
+
+fn signature_from_json(core: &Path, value: &Value) -> CoreSignature {
+    let frames: Vec<String> = value["frames"]
+        .as_array()
+        .map(|frames| frames.iter().filter_map(|frame| frame.as_str().map(String::from)).collect())
+        .unwrap_or_default();
+    let signal = value["signal"].as_i64().unwrap_or(0) as i32;
+    let error = value["error"].as_str().map(String::from).or_else(|| {
+        frames.is_empty().then(|| "No frames in faulting thread".to_string())
+    });
+    CoreSignature {
+        core_path: core.to_string_lossy().into_owned(),
+        hash: signature_hash(signal, &frames),
+        frames,
+        signal,
+        build: value["build"].as_str().map(String::from),
+        error,
+    }
+}
+
+/// Regular files in `directory` that are ELF core dumps
+fn find_cores(directory: &Path, options: &TriageOptions) -> IncodeResult<Vec<PathBuf>> {
+    let entries = std::fs::read_dir(directory)
+        .map_err(|e| IncodeError::invalid_parameter(format!("Cannot read {}: {}", directory.display(), e)))?;
+    let mut cores: Vec<PathBuf> = entries
+        .filter_map(|entry| entry.ok())
+        .filter(|entry| entry.file_type().map_or(false, |kind| kind.is_file()))
+        .map(|entry| entry.path())
+        .filter(|path| {
+            options.name_pattern.as_deref().map_or(true, |pattern| {
+                path.file_name().map_or(false, |name| name.to_string_lossy().contains(pattern))
+            })
+        })
+        .filter(|path| is_elf_core(path))
+        .collect();
+    cores.sort();
+    debug!("Found {} cores in {}", cores.len(), directory.display());
+    Ok(cores)
+}
+
+/// Check the ELF header only; cores are far too large to open fully here
+fn is_elf_core(path: &Path) -> bool {
+    let mut header = [0u8; 18];
+    std::fs::File::open(path)
+        .and_then(|mut file| file.read_exact(&mut header))
+        .map_or(false, |_| &header[..4] == b"\x7fELF" && u16::from_le_bytes([header[16], header[17]]) == 4)
+}
+
+fn modified(path: &Path) -> SystemTime {
+    std::fs::metadata(path).and_then(|meta| meta.modified()).unwrap_or(SystemTime::UNIX_EPOCH)
+}
+
+/// Workers allowed by both the CPU count and the memory currently available
+fn worker_count(options: &TriageOptions) -> usize {
+    let cpus = std::thread::available_parallelism().map(|n| n.get()).unwrap_or(1);
+    let by_cpu = options.max_workers.unwrap_or(cpus).clamp(1, cpus.max(1) * 2);
+    let by_memory = available_memory()
+        .map(|bytes| (bytes / options.worker_memory_bytes.max(1)) as usize)
+        .unwrap_or(by_cpu);
+    by_cpu.min(by_memory).max(1)
+}
+
+fn available_memory() -> Option<u64> {
+    let meminfo = std::fs::read_to_string("/proc/meminfo").ok()?;
+    let line = meminfo.lines().find(|line| line.starts_with("MemAvailable:"))?;
+    let kib: u64 = line.split_whitespace().nth(1)?.parse().ok()?;
+    Some(kib * 1024)
+}
+
+/// The incode binary, when that is what is running; library users get threads
+pub(crate) fn default_worker_exe() -> Option<PathBuf> {
+    let exe = std::env::current_exe().ok()?;
+    (exe.file_stem()? == "incode").then_some(exe)
+}
+
+pub fn crash_analysis_json(analysis: &CrashAnalysis) -> Value {
+    json!({
+        "crash_type": analysis.crash_type,
+        "crash_address": analysis.crash_address.map(|addr| format!("0x{:x}", addr)),
+        "faulting_thread": analysis.faulting_thread,
+        "signal_number": analysis.signal_number,
+        "signal_name": analysis.signal_name,
+        "exception_type": analysis.exception_type,
+        "exception_codes": analysis.exception_codes,
+        "crashed_thread_backtrace": analysis.crashed_thread_backtrace,
+        "register_state": analysis.register_state,
+        "memory_regions": analysis.memory_regions,
+        "loaded_modules": analysis.loaded_modules,
+        "crash_summary": analysis.crash_summary,
+        "recommendations": analysis.recommendations,
+        "signature": analysis.signature.map(|hash| format!("{:016x}", hash)),
+        "signature_frames": analysis.signature_frames,
+        "known_crash": analysis.known_crash.as_ref().map(crash_record_json),
+        "fault": analysis.fault.as_ref().map(fault_json)
+    })
+}
+
+pub fn crash_record_json(record: &CrashRecord) -> Value {
+    json!({
+        "bucket_id": record.bucket_id,
+        "signature": format!("{:016x}", record.signature),
+        "count": record.count,
+        "first_seen": record.first_seen,
+        "last_seen": record.last_seen,
+        "signal": core_file::signal_name(record.signal),
+        "first_build": record.first_build,
+        "last_build": record.last_build,
+        "representative": record.representative,
+        "last_core": record.last_core,
+        "frames": record.frames,
+        "summary": record.summary,
+        "description": record.describe()
+    })
+}
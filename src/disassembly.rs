@@ -0,0 +1,357 @@
+// Disassembly with a decoded-instruction cache
+//
+// LLDB does the decoding (SBTargetReadInstructions, Intel syntax on x86, so
+// the output reads like the rest of the tools). Branch, call and RIP-relative
+// operands get a symbolic name. Runs decoded from a module's code are cached
+// by module and file address. They are stored relative to their first
+// instruction, so a cached run stays valid across ASLR slides and relaunches,
+// and stepping through a hot function never decodes it twice.
+
+use std::collections::HashMap;
+use std::ffi::{CStr, CString};
+use std::os::raw::{c_char, c_void};
+
+use lldb_sys::*;
+use serde_json::{json, Value};
+
+use crate::session_snapshot::{build_key, module_identity};
+
+/// Largest range `decode_range` will read; no single function is this big
+const MAX_RANGE_BYTES: u64 = 4 * 1024 * 1024;
+
+/// One decoded instruction
+#[derive(Debug, Clone, PartialEq)]
+pub struct Instruction {
+    pub address: u64,
+    pub size: u32,
+    pub mnemonic: String,
+    pub operands: String,
+    /// LLDB's own annotation, e.g. a string literal or a resolved constant
+    pub comment: Option<String>,
+    /// Address a branch, call or RIP-relative operand refers to
+    pub target: Option<u64>,
+    /// `target` as symbol+offset
+    pub symbol: Option<String>,
+}
+
+impl Instruction {
+    /// Same instruction at `base` + its current address
+    fn relocated(&self, base: u64) -> Self {
+        Self {
+            address: self.address.wrapping_add(base),
+            target: self.target.map(|target| target.wrapping_add(base)),
+            ..self.clone()
+        }
+    }
+
+    /// "0x...: mnemonic operands ; symbol", the format `disassemble` has always returned
+    pub fn text(&self) -> String {
+        let mut text = format!("0x{:016x}: {}", self.address, self.mnemonic);
+        if !self.operands.is_empty() {
+            text.push(' ');
+            text.push_str(&self.operands);
+        }
+        if let Some(note) = self.symbol.as_ref().or(self.comment.as_ref()) {
+            text.push_str(" ; ");
+            text.push_str(note);
+        }
+        text
+    }
+
+    pub fn to_json(&self) -> Value {
+        json!({
+            "address": format!("0x{:x}", self.address),
+            "size": self.size,
+            "mnemonic": self.mnemonic,
+            "operands": self.operands,
+            "comment": self.comment,
+            "target": self.target.map(|target| format!("0x{:x}", target)),
+            "symbol": self.symbol
+        })
+    }
+
+    fn approx_bytes(&self) -> usize {
+        std::mem::size_of::<Self>()
+            + self.mnemonic.len()
+            + self.operands.len()
+            + self.comment.as_ref().map_or(0, String::len)
+            + self.symbol.as_ref().map_or(0, String::len)
+    }
+}
+
+/// Result of one disassembly request
+#[derive(Debug, Clone)]
+pub struct Disassembly {
+    pub address: u64,
+    /// Symbol containing `address`
+    pub function: Option<String>,
+    pub instructions: Vec<Instruction>,
+    /// True when served from the cache without decoding
+    pub cached: bool,
+}
+
+/// A decoded run, addresses relative to its first instruction
+#[derive(Debug)]
+pub struct DecodedRun {
+    pub function: Option<String>,
+    pub instructions: Vec<Instruction>,
+}
+
+impl DecodedRun {
+    pub fn approx_bytes(&self) -> usize {
+        std::mem::size_of::<Self>()
+            + self.function.as_ref().map_or(0, String::len)
+            + self.instructions.iter().map(Instruction::approx_bytes).sum::<usize>()
+    }
+
+    /// Bytes the run covers from its first instruction
+    pub fn byte_len(&self) -> u64 {
+        self.instructions.last().map_or(0, |last| last.address + last.size as u64)
+    }
+
+    /// The first `count` instructions placed at load address `base`
+    pub fn at(&self, base: u64, count: usize) -> Vec<Instruction> {
+        self.instructions.iter().take(count).map(|instruction| instruction.relocated(base)).collect()
+    }
+}
+
+fn is_branch(mnemonic: &str) -> bool {
+    let mnemonic = mnemonic.to_ascii_lowercase();
+    let mnemonic = mnemonic.trim_start_matches("notrack ").trim_start_matches("bnd ");
+    mnemonic.starts_with('j')
+        || mnemonic.starts_with("call")
+        || mnemonic.starts_with("loop")
+        || matches!(mnemonic, "b" | "bl" | "cbz" | "cbnz" | "tbz" | "tbnz" | "adr")
+        || mnemonic.starts_with("b.")
+}
+
+fn parse_hex(text: &str) -> Option<u64> {
+    let text = text.trim().trim_start_matches('#');
+    let digits = text.strip_prefix("0x").or_else(|| text.strip_prefix("0X"))?;
+    u64::from_str_radix(digits, 16).ok()
+}
+
+/// Address a direct branch or RIP-relative operand refers to. Indirect
+/// branches through registers have no static target.
+pub fn operand_target(mnemonic: &str, operands: &str, address: u64, size: u32) -> Option<u64> {
+    if let Some(start) = operands.find("[rip") {
+        let inner = &operands[start + 4..];
+        let inner = &inner[..inner.find(']')?];
+        let next = address.wrapping_add(size as u64);
+        let inner = inner.trim();
+        return match inner.chars().next() {
+            None => Some(next),
+            Some('+') => parse_hex(&inner[1..]).map(|disp| next.wrapping_add(disp)),
+            Some('-') => parse_hex(&inner[1..]).map(|disp| next.wrapping_sub(disp)),
+            _ => None,
+        };
+    }
+    if is_branch(mnemonic) {
+        // The target is the last operand: "0x401136", "x0, 0x1000", "w0, #0x3, 0x1000"
+        return operands.rsplit(',').next().and_then(parse_hex);
+    }
+    None
+}
+
+fn c_text(ptr: *const c_char) -> Option<String> {
+    if ptr.is_null() {
+        return None;
+    }
+    let text = unsafe { CStr::from_ptr(ptr) }.to_string_lossy().trim().to_string();
+    (!text.is_empty()).then_some(text)
+}
+
+/// Name of the symbol containing `address`, as name or name+0xoffset
+pub(crate) fn symbolize(target: SBTargetRef, address: u64) -> Option<String> {
+    let resolved = unsafe { SBTargetResolveLoadAddress(target, address) };
+    if resolved.is_null() {
+        return None;
+    }
+    let symbol = unsafe { SBAddressGetSymbol(resolved) };
+    let name = if symbol.is_null() { None } else { c_text(unsafe { SBSymbolGetName(symbol) }) };
+    let start = name.as_ref().map(|_| unsafe { SBSymbolGetStartAddress(symbol) });
+    let text = match (name, start) {
+        (Some(name), Some(start)) if !start.is_null() => {
+            let start = unsafe { SBAddressGetLoadAddress(start, target) };
+            match address.checked_sub(start) {
+                Some(0) | None => Some(name),
+                Some(offset) => Some(format!("{}+0x{:x}", name, offset)),
+            }
+        }
+        (name, _) => name,
+    };
+    unsafe { DisposeSBAddress(resolved) };
+    text
+}
+
+/// Module path, UUID (build ID) and file address of code at `address`. None
+/// for code outside any module's sections (JIT code, the stack), which may
+/// change under us and is never cached.
+pub(crate) fn code_identity(target: SBTargetRef, address: u64) -> Option<(String, Option<String>, u64)> {
+    let resolved = unsafe { SBTargetResolveLoadAddress(target, address) };
+    if resolved.is_null() {
+        return None;
+    }
+    let identity = if unsafe { SBAddressGetSection(resolved) }.is_null() {
+        None
+    } else {
+        module_identity(unsafe { SBAddressGetModule(resolved) })
+            .map(|(path, uuid)| (path, uuid, unsafe { SBAddressGetFileAddress(resolved) }))
+    };
+    unsafe { DisposeSBAddress(resolved) };
+    identity
+}
+
+/// Cache key for code at `address`: module build and file address
+pub(crate) fn cache_key(target: SBTargetRef, address: u64) -> Option<String> {
+    code_identity(target, address)
+        .map(|(path, uuid, file_address)| code_key(&path, uuid.as_deref(), file_address))
+}
+
+pub(crate) fn code_key(path: &str, uuid: Option<&str>, file_address: u64) -> String {
+    format!("{}@0x{:x}", build_key(path, uuid), file_address)
+}
+
+/// File address a code key was made for
+pub(crate) fn key_file_address(key: &str) -> Option<u64> {
+    let (_, address) = key.rsplit_once("@0x")?;
+    u64::from_str_radix(address, 16).ok()
+}
+
+/// Decode `count` instructions at `address`, resolving operand targets to
+/// symbols. Addresses in the result are relative to `address`.
+pub(crate) fn decode(target: SBTargetRef, address: u64, count: u32) -> Option<DecodedRun> {
+    let flavor = CString::new("intel").ok()?;
+    let start = unsafe { SBTargetResolveLoadAddress(target, address) };
+    if start.is_null() {
+        return None;
+    }
+    let list = unsafe { SBTargetReadInstructions2(target, start, count, flavor.as_ptr()) };
+    unsafe { DisposeSBAddress(start) };
+    collect_run(target, list, address, u64::MAX, true)
+}
+
+/// Decode exactly the bytes in [start, end), e.g. one whole function, with
+/// no guess at the instruction count. Addresses are relative to `start`.
+/// Operand targets are left unnamed; this feeds the CFG builder.
+pub(crate) fn decode_range(target: SBTargetRef, start: u64, end: u64) -> Option<DecodedRun> {
+    let size = end.checked_sub(start).filter(|size| *size > 0 && *size <= MAX_RANGE_BYTES)? as usize;
+    let flavor = CString::new("intel").ok()?;
+    let base = unsafe { SBTargetResolveLoadAddress(target, start) };
+    if base.is_null() {
+        return None;
+    }
+    let mut bytes = vec![0u8; size];
+    let error = unsafe { CreateSBError() };
+    let read = unsafe { SBTargetReadMemory(target, base, bytes.as_mut_ptr() as *mut c_void, size, error) };
+    unsafe { DisposeSBError(error) };
+    let list = if read > 0 {
+        unsafe { SBTargetGetInstructionsWithFlavor(target, base, flavor.as_ptr(), bytes.as_mut_ptr() as *mut c_void, read) }
+    } else {
+        std::ptr::null_mut()
+    };
+    unsafe { DisposeSBAddress(base) };
+    collect_run(target, list, start, size as u64, false)
+}
+
+/// Walk an instruction list decoded at `address`, stopping `limit` bytes in.
+/// Operand targets are named only when `symbolize_targets` is set: each one
+/// costs an address lookup, and graph building only needs the addresses.
+fn collect_run(target: SBTargetRef, list: SBInstructionListRef, address: u64, limit: u64, symbolize_targets: bool) -> Option<DecodedRun> {
+    if list.is_null() {
+        return None;
+    }
+
+    let mut symbols: HashMap<u64, Option<String>> = HashMap::new();
+    let mut instructions = Vec::new();
+    let mut offset = 0u64;
+    for i in 0..unsafe { SBInstructionListGetSize(list) } {
+        if offset >= limit {
+            break;
+        }
+        let instruction = unsafe { SBInstructionListGetInstructionAtIndex(list, i as u32) };
+        if instruction.is_null() {
+            break;
+        }
+        let size = unsafe { SBInstructionGetByteSize(instruction) } as u32;
+        let mnemonic = c_text(unsafe { SBInstructionGetMnemonic(instruction, target) }).unwrap_or_default();
+        let operands = c_text(unsafe { SBInstructionGetOperands(instruction, target) }).unwrap_or_default();
+        let comment = c_text(unsafe { SBInstructionGetComment(instruction, target) });
+        unsafe { DisposeSBInstruction(instruction) };
+        if size == 0 || mnemonic.is_empty() {
+            break;
+        }
+
+        let here = address.wrapping_add(offset);
+        let target_address = operand_target(&mnemonic, &operands, here, size);
+        let symbol = target_address.filter(|_| symbolize_targets).and_then(|target_address| {
+            symbols.entry(target_address).or_insert_with(|| symbolize(target, target_address)).clone()
+        });
+        instructions.push(Instruction {
+            address: offset,
+            size,
+            mnemonic,
+            operands,
+            comment,
+            target: target_address.map(|target_address| target_address.wrapping_sub(address)),
+            symbol,
+        });
+        offset += size as u64;
+    }
+    unsafe { DisposeSBInstructionList(list) };
+
+    let function = if symbolize_targets { symbolize(target, address) } else { None };
+    (!instructions.is_empty()).then(|| DecodedRun { function, instructions })
+}
+
+/// Load address range [start, end) of the symbol containing `address`, and its name
+pub(crate) fn symbol_bounds(target: SBTargetRef, address: u64) -> Option<(u64, u64, Option<String>)> {
+    let resolved = unsafe { SBTargetResolveLoadAddress(target, address) };
+    if resolved.is_null() {
+        return None;
+    }
+    let symbol = unsafe { SBAddressGetSymbol(resolved) };
+    unsafe { DisposeSBAddress(resolved) };
+    if symbol.is_null() {
+        return None;
+    }
+    let start = unsafe { SBSymbolGetStartAddress(symbol) };
+    let end = unsafe { SBSymbolGetEndAddress(symbol) };
+    if start.is_null() || end.is_null() {
+        return None;
+    }
+    let start = unsafe { SBAddressGetLoadAddress(start, target) };
+    let end = unsafe { SBAddressGetLoadAddress(end, target) };
+    (start != u64::MAX && end > start).then(|| (start, end, c_text(unsafe { SBSymbolGetName(symbol) })))
+}
+
+/// Start address of a function by name, for disassembling "main" rather than an address
+pub(crate) fn function_address(target: SBTargetRef, name: &str) -> Option<u64> {
+    let name = CString::new(name).ok()?;
+    let contexts = unsafe { SBTargetFindFunctions(target, name.as_ptr(), FunctionNameType::AUTO.bits()) };
+    if contexts.is_null() {
+        return None;
+    }
+    let mut address = None;
+    for i in 0..unsafe { SBSymbolContextListGetSize(contexts) } {
+        let context = unsafe { SBSymbolContextListGetContextAtIndex(contexts, i) };
+        if context.is_null() {
+            continue;
+        }
+        let function = unsafe { SBSymbolContextGetFunction(context) };
+        let start = if function.is_null() {
+            let symbol = unsafe { SBSymbolContextGetSymbol(context) };
+            if symbol.is_null() { std::ptr::null_mut() } else { unsafe { SBSymbolGetStartAddress(symbol) } }
+        } else {
+            unsafe { SBFunctionGetStartAddress(function) }
+        };
+        if !start.is_null() {
+            let load = unsafe { SBAddressGetLoadAddress(start, target) };
+            address = (load != u64::MAX).then_some(load).or_else(|| Some(unsafe { SBAddressGetFileAddress(start) }));
+        }
+        if address.is_some() {
+            break;
+        }
+    }
+    address
+}
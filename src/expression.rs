@@ -0,0 +1,655 @@
+// Expression evaluation
+//
+// Most expressions agents send are plain lvalue paths: `a.b[3]->c`, `*ptr`,
+// `global_struct.value`. Those are resolved straight from the variable's
+// debug-info location and the type layout, walking SBValue children and
+// reading only the bytes the final value needs. Anything else goes to LLDB's
+// expression evaluator, which compiles and JITs the expression and costs
+// tens of milliseconds per call.
+
+use std::collections::HashMap;
+use std::ffi::{CStr, CString};
+use std::time::{Duration, Instant};
+
+use lldb_sys::*;
+use serde_json::{json, Value};
+
+use crate::error::{IncodeError, IncodeResult};
+use crate::lldb_manager::sb_error_message;
+use crate::session_snapshot::{file_spec_path, module_identity};
+use crate::stl_decode;
+
+/// Evaluator timeout when the caller does not give one
+pub const DEFAULT_TIMEOUT: Duration = Duration::from_secs(5);
+
+/// One step from a value to a part of it
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum PathStep {
+    /// `.name`
+    Member(String),
+    /// `->name`
+    Arrow(String),
+    /// `[n]` on an array or pointer
+    Index(u64),
+}
+
+/// `&`? `*`* root (`.m` | `->m` | `[n]`)*
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct LvaluePath {
+    pub address_of: bool,
+    /// Leading `*`s, applied after the steps
+    pub derefs: u32,
+    /// Variable name, possibly namespace-qualified
+    pub root: String,
+    pub steps: Vec<PathStep>,
+}
+
+fn identifier(text: &str) -> Option<(&str, &str)> {
+    let end = text.find(|c: char| !(c.is_ascii_alphanumeric() || c == '_')).unwrap_or(text.len());
+    let first = text.chars().next()?;
+    (end > 0 && !first.is_ascii_digit()).then(|| (&text[..end], &text[end..]))
+}
+
+fn index(text: &str) -> Option<(u64, &str)> {
+    let close = text.find(']')?;
+    let digits = text[..close].trim();
+    let value = match digits.strip_prefix("0x").or_else(|| digits.strip_prefix("0X")) {
+        Some(hex) => u64::from_str_radix(hex, 16).ok()?,
+        None => digits.parse().ok()?,
+    };
+    Some((value, &text[close + 1..]))
+}
+
+/// Parse `expression` as an lvalue path, or None when it needs the evaluator
+pub fn parse_lvalue(expression: &str) -> Option<LvaluePath> {
+    let mut rest = expression.trim();
+    let address_of = rest.starts_with('&');
+    if address_of {
+        rest = rest[1..].trim_start();
+    }
+    let mut derefs = 0;
+    while let Some(after) = rest.strip_prefix('*') {
+        derefs += 1;
+        rest = after.trim_start();
+    }
+
+    let mut root = String::new();
+    loop {
+        let (name, after) = identifier(rest)?;
+        root.push_str(name);
+        match after.strip_prefix("::") {
+            Some(after) => {
+                root.push_str("::");
+                rest = after;
+            }
+            None => {
+                rest = after;
+                break;
+            }
+        }
+    }
+    // Keywords and literals are not variables
+    if matches!(root.as_str(), "sizeof" | "true" | "false" | "nullptr" | "this" | "alignof") {
+        return None;
+    }
+
+    let mut steps = Vec::new();
+    loop {
+        rest = rest.trim_start();
+        if rest.is_empty() {
+            break;
+        }
+        if let Some(after) = rest.strip_prefix("->") {
+            let (name, after) = identifier(after.trim_start())?;
+            steps.push(PathStep::Arrow(name.to_string()));
+            rest = after;
+        } else if let Some(after) = rest.strip_prefix('.') {
+            let (name, after) = identifier(after.trim_start())?;
+            steps.push(PathStep::Member(name.to_string()));
+            rest = after;
+        } else if let Some(after) = rest.strip_prefix('[') {
+            let (value, after) = index(after)?;
+            steps.push(PathStep::Index(value));
+            rest = after;
+        } else {
+            return None;
+        }
+    }
+    Some(LvaluePath { address_of, derefs, root, steps })
+}
+
+/// A value produced by either path
+#[derive(Debug, Clone, PartialEq)]
+pub struct ExpressionValue {
+    pub expression: String,
+    pub value: Option<String>,
+    pub summary: Option<String>,
+    pub type_name: Option<String>,
+    /// Where the value lives, when it is in memory
+    pub address: Option<u64>,
+    /// Resolved as an lvalue path without the expression evaluator
+    pub fast_path: bool,
+    pub elapsed_us: u64,
+}
+
+impl ExpressionValue {
+    /// Value as LLDB would print it: scalar, then summary, then a placeholder
+    pub fn display(&self) -> String {
+        match (&self.value, &self.summary) {
+            (Some(value), Some(summary)) => format!("{} {}", value, summary),
+            (Some(value), None) => value.clone(),
+            (None, Some(summary)) => summary.clone(),
+            (None, None) => format!("({})", self.type_name.as_deref().unwrap_or("no value")),
+        }
+    }
+
+    pub fn to_json(&self) -> Value {
+        json!({
+            "expression": self.expression,
+            "value": self.value,
+            "summary": self.summary,
+            "type": self.type_name,
+            "address": self.address.map(|address| format!("0x{:x}", address)),
+            "fast_path": self.fast_path,
+            "elapsed_us": self.elapsed_us
+        })
+    }
+}
+
+fn c_text(ptr: *const std::os::raw::c_char) -> Option<String> {
+    if ptr.is_null() {
+        return None;
+    }
+    let text = unsafe { CStr::from_ptr(ptr) }.to_string_lossy().into_owned();
+    (!text.is_empty()).then_some(text)
+}
+
+/// Error carried by `value`, if any
+fn value_error(value: SBValueRef) -> Option<String> {
+    if value.is_null() || !unsafe { SBValueIsValid(value) } {
+        return Some("invalid value".to_string());
+    }
+    let error = unsafe { SBValueGetError(value) };
+    (!error.is_null() && unsafe { SBErrorFail(error) }).then(|| sb_error_message(error))
+}
+
+fn describe(value: SBValueRef, expression: &str, fast_path: bool, started: Instant) -> ExpressionValue {
+    let address = unsafe { SBValueGetLoadAddress(value) };
+    ExpressionValue {
+        expression: expression.to_string(),
+        value: c_text(unsafe { SBValueGetValue(value) }),
+        summary: c_text(unsafe { SBValueGetSummary(value) }),
+        type_name: c_text(unsafe { SBValueGetTypeName(value) }),
+        address: (address != u64::MAX).then_some(address),
+        fast_path,
+        elapsed_us: started.elapsed().as_micros() as u64,
+    }
+}
+
+/// A path step bound to the type layout of one frame context: members are
+/// child indices, so replaying the path does no name lookups
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum Step {
+    Child(u32),
+    /// Member reached through a base class, looked up by name
+    Member(String),
+    /// Element `n` of an array, or at offset `n` from a pointer
+    Element(u32),
+    Deref,
+    AddressOf,
+}
+
+fn find_root(frame: SBFrameRef, root: &str) -> Option<SBValueRef> {
+    let root = CString::new(root).ok()?;
+    let mut value = unsafe { SBFrameFindVariable(frame, root.as_ptr()) };
+    for kind in [ValueType::VariableGlobal, ValueType::VariableStatic] {
+        if value_error(value).is_none() {
+            break;
+        }
+        value = unsafe { SBFrameFindValue(frame, root.as_ptr(), kind) };
+    }
+    value_error(value).is_none().then_some(value)
+}
+
+fn apply_step(value: SBValueRef, step: &Step) -> Option<SBValueRef> {
+    let next = match step {
+        Step::Child(index) => unsafe { SBValueGetChildAtIndex(value, *index) },
+        Step::Member(name) => {
+            let name = CString::new(name.as_str()).ok()?;
+            unsafe { SBValueGetChildMemberWithName(value, name.as_ptr()) }
+        }
+        Step::Element(n) => element(value, *n)?,
+        Step::Deref => {
+            if !unsafe { SBValueTypeIsPointerType(value) } {
+                return None;
+            }
+            unsafe { SBValueDereference(value) }
+        }
+        Step::AddressOf => unsafe { SBValueAddressOf(value) },
+    };
+    value_error(next).is_none().then_some(next)
+}
+
+/// `value[n]` as C reads it: an array's element, or the object `n` pointees
+/// past a pointer. None for anything else, since on a class `[n]` is its
+/// `operator[]`, which only the evaluator can run.
+fn element(value: SBValueRef, n: u32) -> Option<SBValueRef> {
+    let sb_type = unsafe { SBTypeGetCanonicalType(SBValueGetType(value)) };
+    if unsafe { SBTypeIsArrayType(sb_type) } {
+        // The raw array, so a synthetic provider cannot stand in for its elements
+        let raw = unsafe { SBValueGetNonSyntheticValue(value) };
+        return Some(unsafe { SBValueGetChildAtIndex2(raw, n, DynamicValueType::NoDynamicValues, true) });
+    }
+    if !unsafe { SBTypeIsPointerType(sb_type) } {
+        return None;
+    }
+    let pointee = unsafe { SBTypeGetPointeeType(sb_type) };
+    let size = unsafe { SBTypeGetByteSize(pointee) };
+    if size == 0 {
+        return None;
+    }
+    let error = unsafe { CreateSBError() };
+    let pointer = unsafe { SBValueGetValueAsUnsigned(value, error, 0) };
+    let failed = unsafe { SBErrorFail(error) };
+    unsafe { DisposeSBError(error) };
+    let address = pointer.checked_add(u64::from(n).checked_mul(size)?).filter(|_| !failed)?;
+    let name = CString::new(format!("[{}]", n)).ok()?;
+    Some(unsafe { SBValueCreateValueFromAddress(value, name.as_ptr(), address, pointee) })
+}
+
+/// Member `name` of `value` as a bound step
+fn member_step(value: SBValueRef, name: &str) -> Option<Step> {
+    let name_cstr = CString::new(name).ok()?;
+    let index = unsafe { SBValueGetIndexOfChildWithName(value, name_cstr.as_ptr()) };
+    Some(if index == u32::MAX { Step::Member(name.to_string()) } else { Step::Child(index) })
+}
+
+/// Resolve `path` from the frame's variables and globals, recording the
+/// bound steps taken. None when any step does not apply and the evaluator
+/// should decide.
+fn resolve_path(frame: SBFrameRef, path: &LvaluePath) -> Option<(SBValueRef, Vec<Step>)> {
+    let mut value = find_root(frame, &path.root)?;
+    let mut steps = Vec::with_capacity(path.steps.len() + path.derefs as usize + 1);
+    let take = |value: SBValueRef, step: Step, steps: &mut Vec<Step>| {
+        let next = apply_step(value, &step)?;
+        steps.push(step);
+        Some(next)
+    };
+
+    for step in &path.steps {
+        value = match step {
+            PathStep::Member(name) => take(value, member_step(value, name)?, &mut steps)?,
+            PathStep::Arrow(name) => {
+                let pointee = take(value, Step::Deref, &mut steps)?;
+                take(pointee, member_step(pointee, name)?, &mut steps)?
+            }
+            PathStep::Index(n) => take(value, Step::Element(u32::try_from(*n).ok()?), &mut steps)?,
+        };
+    }
+    for _ in 0..path.derefs {
+        value = take(value, Step::Deref, &mut steps)?;
+    }
+    if path.address_of {
+        value = take(value, Step::AddressOf, &mut steps)?;
+    }
+    Some((value, steps))
+}
+
+/// Resolve `expression` as an lvalue path without running code, or None
+/// when it is not a path this can handle
+pub fn evaluate_path(frame: SBFrameRef, expression: &str) -> Option<ExpressionValue> {
+    let started = Instant::now();
+    let path = parse_lvalue(expression)?;
+    let (value, _) = resolve_path(frame, &path)?;
+    Some(describe(value, expression, true, started))
+}
+
+/// Evaluate `expression` with LLDB's expression evaluator
+pub fn evaluate_with_lldb(frame: SBFrameRef, expression: &str, timeout: Duration) -> IncodeResult<ExpressionValue> {
+    let started = Instant::now();
+    let value = evaluator_value(frame, expression, timeout)?;
+    Ok(describe(value, expression, false, started))
+}
+
+fn evaluator_value(frame: SBFrameRef, expression: &str, timeout: Duration) -> IncodeResult<SBValueRef> {
+    let expression_cstr = CString::new(expression)
+        .map_err(|_| IncodeError::expression("Expression contains a NUL byte"))?;
+
+    let options = unsafe { CreateSBExpressionOptions() };
+    unsafe {
+        SBExpressionOptionsSetTimeoutInMicroSeconds(options, timeout.as_micros().min(u32::MAX as u128) as u32);
+        SBExpressionOptionsSetUnwindOnError(options, true);
+        SBExpressionOptionsSetIgnoreBreakpoints(options, true);
+    }
+    let value = unsafe { SBFrameEvaluateExpression4(frame, expression_cstr.as_ptr(), options) };
+    unsafe { DisposeSBExpressionOptions(options) };
+
+    if let Some(error) = value_error(value) {
+        return Err(IncodeError::expression(format!("Failed to evaluate '{}': {}", expression, error)));
+    }
+    Ok(value)
+}
+
+/// The SBValue `expression` denotes, by path when possible
+pub(crate) fn value_of(frame: SBFrameRef, expression: &str, timeout: Duration) -> IncodeResult<SBValueRef> {
+    match parse_lvalue(expression).and_then(|path| resolve_path(frame, &path)) {
+        Some((value, _)) => Ok(value),
+        None => evaluator_value(frame, expression, timeout),
+    }
+}
+
+/// Lvalue paths directly, everything else through the evaluator
+pub fn evaluate(frame: SBFrameRef, expression: &str, timeout: Duration) -> IncodeResult<ExpressionValue> {
+    match evaluate_path(frame, expression) {
+        Some(value) => Ok(value),
+        None => evaluate_with_lldb(frame, expression, timeout),
+    }
+}
+
+/// `path.size()`, `path->size()` or the same with `empty()`: the container's
+/// path and whether emptiness was asked for
+pub fn parse_container_query(expression: &str) -> Option<(LvaluePath, bool)> {
+    let trimmed = expression.trim();
+    let (call, empty) = [("size", false), ("empty", true)].into_iter()
+        .find_map(|(name, empty)| {
+            let call = trimmed.strip_suffix(')')?.trim_end().strip_suffix('(')?.trim_end().strip_suffix(name)?;
+            Some((call.trim_end(), empty))
+        })?;
+    let (container, arrow) = match call.strip_suffix("->") {
+        Some(container) => (container, true),
+        None => (call.strip_suffix('.')?, false),
+    };
+    let mut path = parse_lvalue(container)?;
+    // `p->size()` is `(*p).size()`; only plain paths qualify
+    if path.address_of || (arrow && path.derefs > 0) {
+        return None;
+    }
+    if arrow {
+        path.derefs = 1;
+    }
+    Some((path, empty))
+}
+
+/// Calls that have no business in an inspection expression: they allocate,
+/// free, overwrite, or end or spawn processes
+const UNSAFE_PATTERNS: [&str; 17] = [
+    "system(", "exec(", "fork(", "kill(",
+    "delete ", "free(", "malloc(", "realloc(",
+    "memcpy(", "memset(", "strcpy(",
+    "exit(", "abort(", "_exit(",
+    "remove(", "unlink(", "rmdir(",
+];
+
+/// True for expressions the tools refuse to run in the debuggee
+pub fn is_unsafe(expression: &str) -> bool {
+    UNSAFE_PATTERNS.iter().any(|pattern| expression.contains(pattern))
+}
+
+/// Standard containers whose synthetic children are exactly their elements,
+/// so the child count is what `size()` returns
+pub fn counts_elements(type_name: &str) -> bool {
+    let base = type_name.trim_start_matches("const ");
+    let Some(base) = base.strip_prefix("std::") else {
+        return false;
+    };
+    let base = ["__1::", "__2::", "__cxx11::", "__debug::"].iter()
+        .find_map(|ns| base.strip_prefix(ns))
+        .unwrap_or(base);
+    base.find('<').map_or(false, |end| matches!(&base[..end],
+        "vector" | "deque" | "list" | "forward_list"
+        | "map" | "multimap" | "set" | "multiset"
+        | "unordered_map" | "unordered_multimap" | "unordered_set" | "unordered_multiset"))
+}
+
+/// How a prepared expression is evaluated in one frame context
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum Plan {
+    /// Lvalue path replayed from bound steps
+    Path { root: String, steps: Vec<Step> },
+    /// `size()` or `empty()` of a standard container LLDB has a synthetic
+    /// provider for, answered from its child count without calling into the process
+    ContainerSize { root: String, steps: Vec<Step>, empty: bool },
+    /// Needs LLDB's expression evaluator
+    Evaluator,
+}
+
+impl Plan {
+    pub fn kind(&self) -> &'static str {
+        match self {
+            Plan::Path { .. } => "lvalue_path",
+            Plan::ContainerSize { .. } => "container_size",
+            Plan::Evaluator => "evaluator",
+        }
+    }
+}
+
+/// Work out once how `expression` is evaluated in `frame`'s context
+pub fn plan(frame: SBFrameRef, expression: &str) -> Plan {
+    if let Some(path) = parse_lvalue(expression) {
+        if let Some((_, steps)) = resolve_path(frame, &path) {
+            return Plan::Path { root: path.root, steps };
+        }
+    }
+    if let Some((path, empty)) = parse_container_query(expression) {
+        if let Some((value, steps)) = resolve_path(frame, &path) {
+            let type_name = stl_decode::type_info(unsafe { SBValueGetType(value) }).map(|info| info.name);
+            if unsafe { SBValueIsSynthetic(value) } && type_name.as_deref().map_or(false, counts_elements) {
+                return Plan::ContainerSize { root: path.root, steps, empty };
+            }
+        }
+    }
+    Plan::Evaluator
+}
+
+fn replay(frame: SBFrameRef, root: &str, steps: &[Step]) -> Option<SBValueRef> {
+    steps.iter().try_fold(find_root(frame, root)?, |value, step| apply_step(value, step))
+}
+
+/// Evaluate `expression` in `frame` following `plan`. A plan that no longer
+/// applies, such as a path through a now-null pointer, falls back to the
+/// evaluator, which reports the error properly.
+pub fn evaluate_plan(frame: SBFrameRef, expression: &str, plan: &Plan, timeout: Duration) -> IncodeResult<ExpressionValue> {
+    let started = Instant::now();
+    match plan {
+        Plan::Path { root, steps } => {
+            if let Some(value) = replay(frame, root, steps) {
+                return Ok(describe(value, expression, true, started));
+            }
+        }
+        Plan::ContainerSize { root, steps, empty } => {
+            if let Some(value) = replay(frame, root, steps) {
+                let count = unsafe { SBValueGetNumChildren(value) };
+                return Ok(ExpressionValue {
+                    expression: expression.to_string(),
+                    value: Some(if *empty { (count == 0).to_string() } else { count.to_string() }),
+                    summary: None,
+                    type_name: Some(if *empty { "bool" } else { "size_t" }.to_string()),
+                    address: None,
+                    fast_path: true,
+                    elapsed_us: started.elapsed().as_micros() as u64,
+                });
+            }
+        }
+        Plan::Evaluator => {}
+    }
+    evaluate_with_lldb(frame, expression, timeout)
+}
+
+/// Frame context shape a plan is valid for: module build, function and
+/// compile unit. Frames sharing it see the same variables and type layouts.
+pub(crate) fn frame_context(frame: SBFrameRef) -> String {
+    let (module, uuid) = module_identity(unsafe { SBFrameGetModule(frame) }).unwrap_or_default();
+    let function = c_text(unsafe { SBFrameGetDisplayFunctionName(frame) }).unwrap_or_default();
+    let compile_unit = unsafe { SBFrameGetCompileUnit(frame) };
+    let compile_unit = if compile_unit.is_null() {
+        None
+    } else {
+        file_spec_path(unsafe { SBCompileUnitGetFileSpec(compile_unit) })
+    };
+    format!("{}#{}:{}:{}", module, uuid.unwrap_or_default(), function, compile_unit.unwrap_or_default())
+}
+
+/// A prepared expression and its plan for each frame context it has run in
+#[derive(Debug, Clone)]
+pub struct PreparedExpression {
+    pub id: u32,
+    pub expression: String,
+    /// Frame context key -> plan
+    plans: HashMap<String, Plan>,
+    pub hits: u64,
+    pub misses: u64,
+}
+
+impl PreparedExpression {
+    pub fn plan(&self, context: &str) -> Option<&Plan> {
+        self.plans.get(context)
+    }
+
+    pub fn contexts(&self) -> usize {
+        self.plans.len()
+    }
+}
+
+/// Prepared expressions by handle
+#[derive(Debug, Default)]
+pub struct PreparedExpressions {
+    next_id: u32,
+    entries: HashMap<u32, PreparedExpression>,
+}
+
+impl PreparedExpressions {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Register `expression` with its plan for `context`; returns the handle
+    pub fn prepare(&mut self, expression: &str, context: String, plan: Plan) -> u32 {
+        // The same expression keeps its handle and counters
+        if let Some(prepared) = self.entries.values_mut().find(|prepared| prepared.expression == expression) {
+            if !prepared.plans.contains_key(&context) {
+                prepared.misses += 1;
+                prepared.plans.insert(context, plan);
+            }
+            return prepared.id;
+        }
+        self.next_id += 1;
+        let id = self.next_id;
+        self.entries.insert(id, PreparedExpression {
+            id,
+            expression: expression.to_string(),
+            plans: HashMap::from([(context, plan)]),
+            hits: 0,
+            misses: 1,
+        });
+        id
+    }
+
+    pub fn get(&self, id: u32) -> Option<&PreparedExpression> {
+        self.entries.get(&id)
+    }
+
+    /// Plan for `context`, counting a hit, or None after counting a miss
+    pub fn lookup(&mut self, id: u32, context: &str) -> Option<Plan> {
+        let prepared = self.entries.get_mut(&id)?;
+        match prepared.plans.get(context) {
+            Some(plan) => {
+                prepared.hits += 1;
+                Some(plan.clone())
+            }
+            None => {
+                prepared.misses += 1;
+                None
+            }
+        }
+    }
+
+    /// Add a plan compiled after a miss
+    pub fn add_plan(&mut self, id: u32, context: String, plan: Plan) {
+        if let Some(prepared) = self.entries.get_mut(&id) {
+            prepared.plans.insert(context, plan);
+        }
+    }
+
+    pub fn release(&mut self, id: u32) -> bool {
+        self.entries.remove(&id).is_some()
+    }
+
+    pub fn iter(&self) -> impl Iterator<Item = &PreparedExpression> {
+        self.entries.values()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_lvalue_path_parsing() {
+        let path = parse_lvalue("a.b[3]->c").expect("member, index and arrow steps");
+        assert_eq!(path.root, "a");
+        assert_eq!(path.steps, vec![
+            PathStep::Member("b".to_string()),
+            PathStep::Index(3),
+            PathStep::Arrow("c".to_string()),
+        ]);
+        assert!(!path.address_of);
+
+        let path = parse_lvalue("**ptr").unwrap();
+        assert_eq!((path.derefs, path.root.as_str()), (2, "ptr"));
+        let path = parse_lvalue("&ns::global_struct . value [0x10]").unwrap();
+        assert!(path.address_of);
+        assert_eq!(path.root, "ns::global_struct");
+        assert_eq!(path.steps, vec![PathStep::Member("value".to_string()), PathStep::Index(16)]);
+
+        // Anything beyond a path goes to the expression evaluator
+        for expression in ["1 + 2", "sizeof(int)", "local_int * 2", "f(x)", "a[i]", "x = 5", "(char)c", "3", ""] {
+            assert!(parse_lvalue(expression).is_none(), "{} should not parse as a path", expression);
+        }
+    }
+
+    #[test]
+    fn test_prepared_expression_plans_and_counters() {
+        let (path, empty) = parse_container_query("shared_work_queue.size()").unwrap();
+        assert_eq!((path.root.as_str(), path.derefs, empty), ("shared_work_queue", 0, false));
+        let (path, empty) = parse_container_query("state->items . empty ( )").unwrap();
+        assert_eq!((path.root.as_str(), path.derefs, empty), ("state", 0, true));
+        assert_eq!(path.steps, vec![crate::expression::PathStep::Arrow("items".to_string())]);
+        // `q->size()` is the size of `*q`
+        let (path, _) = parse_container_query("q->size()").unwrap();
+        assert_eq!((path.root.as_str(), path.derefs), ("q", 1));
+        assert!(parse_container_query("queue.size(1)").is_none());
+        assert!(parse_container_query("resize()").is_none());
+
+        let mut prepared = PreparedExpressions::new();
+        let handle = prepared.prepare("queue.size()", "exe#:worker:worker.cpp".to_string(), Plan::Evaluator);
+        // Preparing again in the same context keeps the handle and does not recompile
+        assert_eq!(prepared.prepare("queue.size()", "exe#:worker:worker.cpp".to_string(), Plan::Evaluator), handle);
+
+        assert_eq!(prepared.lookup(handle, "exe#:worker:worker.cpp"), Some(Plan::Evaluator));
+        assert_eq!(prepared.lookup(handle, "exe#:worker:worker.cpp"), Some(Plan::Evaluator));
+        // A frame from another function needs its own plan
+        assert_eq!(prepared.lookup(handle, "exe#:main:main.cpp"), None);
+        prepared.add_plan(handle, "exe#:main:main.cpp".to_string(), Plan::Evaluator);
+
+        let entry = prepared.get(handle).unwrap();
+        assert_eq!((entry.hits, entry.misses, entry.contexts()), (2, 2, 2));
+        assert!(prepared.release(handle));
+        assert!(prepared.get(handle).is_none());
+    }
+
+    #[test]
+    fn test_container_size_and_unsafe_filters() {
+        assert!(counts_elements("std::vector<int, std::allocator<int> >"));
+        assert!(counts_elements("std::__1::unordered_map<int, int, std::__1::hash<int>, std::__1::equal_to<int>, std::__1::allocator<std::__1::pair<const int, int> > >"));
+        assert!(counts_elements("std::__cxx11::list<int, std::allocator<int> >"));
+        // Synthetic children that are not elements
+        assert!(!counts_elements("std::__cxx11::basic_string<char, std::char_traits<char>, std::allocator<char> >"));
+        assert!(!counts_elements("std::shared_ptr<int>"));
+        assert!(!counts_elements("std::optional<int>"));
+        assert!(!counts_elements("QList<int>"));
+
+        assert!(is_unsafe("free(ptr)"));
+        assert!(is_unsafe("items.size() + system(\"id\")"));
+        assert!(!is_unsafe("items.size()"));
+    }
+}
@@ -0,0 +1,680 @@
+// Fault decoding
+//
+// Turns a crash into an explanation: the si_code from the stop info or core
+// notes, the faulting instruction and the memory operand it dereferenced
+// (computed from the thread's registers), and what the fault address was
+// according to the region table: a NULL dereference, a stack guard page,
+// unmapped memory, a write to read-only data, and so on. Everything comes
+// from one register read, one instruction read and one region table.
+
+use std::collections::BTreeMap;
+
+use lldb_sys::*;
+use serde_json::{json, Value};
+
+use crate::lldb_manager::MemoryRegion;
+
+/// Addresses below this are NULL plus an offset (Linux vm.mmap_min_addr)
+const NULL_PAGE_LIMIT: u64 = 0x10000;
+/// Faults this far below the stack mapping are still stack overflows
+const STACK_GUARD_GAP: u64 = 1024 * 1024;
+const SI_KERNEL: i32 = 0x80;
+const BUS_ADRALN: i32 = 1;
+
+/// Instruction at the faulting PC
+#[derive(Debug, Clone)]
+pub struct FaultingInstruction {
+    pub address: u64,
+    pub size: u64,
+    pub mnemonic: String,
+    pub operands: String,
+}
+
+impl FaultingInstruction {
+    pub fn text(&self) -> String {
+        if self.operands.is_empty() {
+            self.mnemonic.clone()
+        } else {
+            format!("{} {}", self.mnemonic, self.operands)
+        }
+    }
+}
+
+/// Memory operand of an instruction, e.g. `[rbx + 8*rcx + 0x10]`
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct MemoryOperand {
+    pub text: String,
+    pub base: Option<String>,
+    pub index: Option<String>,
+    pub scale: u64,
+    pub displacement: i64,
+    /// fs or gs override; the segment base register is added
+    pub segment: Option<String>,
+    /// Whether the instruction writes through the operand
+    pub is_write: bool,
+}
+
+impl MemoryOperand {
+    /// Effective address, if every register it uses is known
+    pub fn effective_address(&self, registers: &BTreeMap<String, u64>, next_pc: u64) -> Option<u64> {
+        let read = |name: &str| register_value(registers, name, next_pc);
+        let mut address = self.displacement as u64;
+        if let Some(segment) = self.segment.as_deref() {
+            address = address.wrapping_add(read(&format!("{}_base", segment))?);
+        }
+        if let Some(base) = self.base.as_deref() {
+            address = address.wrapping_add(read(base)?);
+        }
+        if let Some(index) = self.index.as_deref() {
+            address = address.wrapping_add(read(index)?.wrapping_mul(self.scale));
+        }
+        Some(address)
+    }
+}
+
+/// Everything known about a fault
+#[derive(Debug, Clone, Default)]
+pub struct FaultInfo {
+    pub signal: i32,
+    pub si_code: Option<i32>,
+    pub si_code_name: Option<&'static str>,
+    /// Address the kernel reported, if any
+    pub fault_address: Option<u64>,
+    pub pc: Option<u64>,
+    pub sp: Option<u64>,
+    pub instruction: Option<FaultingInstruction>,
+    pub memory_operand: Option<MemoryOperand>,
+    /// Base register of the memory operand and its value
+    pub base_register: Option<(String, u64)>,
+    /// Address the memory operand resolves to
+    pub computed_address: Option<u64>,
+    /// "read", "write", "execute" or "unknown"
+    pub access: &'static str,
+    /// e.g. "null_dereference", "stack_overflow", "wild_write"
+    pub classification: &'static str,
+    pub description: String,
+    /// Region containing the address, as "start-end perms name"
+    pub region: Option<String>,
+}
+
+impl FaultInfo {
+    /// The address that best explains the fault
+    pub fn address(&self) -> Option<u64> {
+        // A general protection fault (SI_KERNEL) reports 0; only the operand has the real address
+        match self.fault_address {
+            Some(0) if self.si_code == Some(SI_KERNEL) => self.computed_address,
+            Some(reported) => Some(reported),
+            None => self.computed_address,
+        }
+    }
+}
+
+/// Decode a fault from the signal, si_code and fault address plus the
+/// faulting thread's registers, its instruction and the region table
+pub fn decode_fault(
+    signal: i32,
+    si_code: Option<i32>,
+    fault_address: Option<u64>,
+    registers: &BTreeMap<String, u64>,
+    instruction: Option<FaultingInstruction>,
+    regions: &[MemoryRegion],
+) -> FaultInfo {
+    let pc = ["rip", "pc", "eip"].iter().find_map(|name| registers.get(*name).copied());
+    let sp = ["rsp", "sp", "esp"].iter().find_map(|name| registers.get(*name).copied());
+    let x86 = registers.contains_key("rip") || registers.contains_key("eip");
+
+    let mut fault = FaultInfo {
+        signal,
+        si_code,
+        si_code_name: si_code.and_then(|code| si_code_name(signal, code)),
+        fault_address,
+        pc,
+        sp,
+        access: "unknown",
+        ..FaultInfo::default()
+    };
+
+    if let Some(instruction) = instruction.as_ref() {
+        let operand = parse_memory_operand(&instruction.mnemonic, &instruction.operands);
+        if let Some(operand) = operand {
+            let next_pc = instruction.address + instruction.size;
+            fault.base_register = operand.base.as_ref().and_then(|base| {
+                register_value(registers, base, next_pc).map(|value| (base.clone(), value))
+            });
+            fault.computed_address = operand.effective_address(registers, next_pc);
+            fault.access = if operand.is_write { "write" } else { "read" };
+            fault.memory_operand = Some(operand);
+        }
+    }
+    fault.instruction = instruction;
+
+    // Jumping to a bad address faults on the fetch itself
+    if pc.is_some() && pc == fault_address {
+        fault.access = "execute";
+    }
+
+    let (classification, description, region) = classify(&fault, x86, regions);
+    fault.classification = classification;
+    fault.description = description;
+    fault.region = region;
+    fault
+}
+
+fn classify(fault: &FaultInfo, x86: bool, regions: &[MemoryRegion]) -> (&'static str, String, Option<String>) {
+    let signal = fault.signal;
+    if signal != libc::SIGSEGV && signal != libc::SIGBUS {
+        let what = match (signal, fault.si_code_name) {
+            (_, Some(code)) => format!("{} ({})", crate::core_file::signal_name(signal), code),
+            _ => crate::core_file::signal_name(signal).to_string(),
+        };
+        let at = fault.instruction.as_ref().map(|i| format!(" at `{}`", i.text())).unwrap_or_default();
+        return ("not_memory_fault", format!("{}{}", what, at), None);
+    }
+    if signal == libc::SIGBUS && fault.si_code == Some(BUS_ADRALN) {
+        return ("misaligned_access", describe_access(fault, "Misaligned"), None);
+    }
+
+    let Some(address) = fault.address() else {
+        if fault.si_code == Some(SI_KERNEL) {
+            let at = fault.instruction.as_ref().map(|i| format!(" at `{}`", i.text())).unwrap_or_default();
+            return ("general_protection", format!("General protection fault{}: non-canonical address or privileged instruction", at), None);
+        }
+        return ("unknown", "Fault address unavailable".to_string(), None);
+    };
+
+    if address < NULL_PAGE_LIMIT {
+        let description = match address {
+            0 => format!("NULL pointer {}", access_noun(fault.access)),
+            offset => format!("NULL pointer {} at offset {:#x} (field or element of a NULL object)", access_noun(fault.access), offset),
+        };
+        return ("null_dereference", with_operand(fault, description), None);
+    }
+    if x86 && (0x0000_8000_0000_0000..0xffff_8000_0000_0000).contains(&address) {
+        return (
+            "non_canonical",
+            with_operand(fault, format!("Non-canonical address {:#x}: a garbage or poisoned pointer", address)),
+            None,
+        );
+    }
+
+    let region = regions.iter().find(|region| region.start_address <= address && address < region.end_address);
+    let region_text = region.map(describe_region);
+    let near_stack = is_near_stack(address, fault.sp, regions);
+
+    if fault.access == "execute" {
+        return match region {
+            Some(region) if !region.permissions.contains('x') => (
+                "execute_non_executable",
+                format!("Jumped to non-executable memory at {:#x}", address),
+                region_text,
+            ),
+            _ => ("wild_jump", format!("Jumped to unmapped address {:#x}: corrupted function pointer or return address", address), region_text),
+        };
+    }
+
+    match region {
+        Some(region) if region.permissions.trim_matches('p').chars().all(|c| c == '-') => {
+            if near_stack {
+                ("stack_overflow", format!("Stack overflow: {:#x} is in the stack guard page", address), region_text)
+            } else {
+                ("guard_page", with_operand(fault, format!("Access to guard page at {:#x}", address)), region_text)
+            }
+        }
+        Some(region) if fault.access == "write" && !region.permissions.contains('w') => (
+            "write_to_readonly",
+            with_operand(fault, format!("Write to read-only memory at {:#x}", address)),
+            region_text,
+        ),
+        Some(_) if signal == libc::SIGBUS => (
+            "bus_error",
+            format!("Bus error at {:#x}: mapped file truncated or hardware error", address),
+            region_text,
+        ),
+        Some(_) => ("access_violation", with_operand(fault, describe_access(fault, "Faulting")), region_text),
+        None if near_stack => (
+            "stack_overflow",
+            format!("Stack overflow: {:#x} is below the stack mapping", address),
+            None,
+        ),
+        None => {
+            let kind = match fault.access {
+                "write" => "wild_write",
+                "read" => "wild_read",
+                _ => "unmapped",
+            };
+            (kind, with_operand(fault, format!("{} unmapped address {:#x}", capitalize(access_noun(fault.access)), address)), None)
+        }
+    }
+}
+
+/// Just below the `[stack]` mapping, or within a guard gap of the stack pointer
+fn is_near_stack(address: u64, sp: Option<u64>, regions: &[MemoryRegion]) -> bool {
+    let below_stack = regions.iter().any(|region| {
+        region.name.as_deref().map_or(false, |name| name.starts_with("[stack"))
+            && address < region.start_address
+            && region.start_address - address <= STACK_GUARD_GAP
+    });
+    let near_sp = sp.map_or(false, |sp| address <= sp && sp - address <= STACK_GUARD_GAP / 16);
+    below_stack || near_sp
+}
+
+fn describe_access(fault: &FaultInfo, what: &str) -> String {
+    match fault.address() {
+        Some(address) => format!("{} {} at {:#x}", what, access_noun(fault.access), address),
+        None => format!("{} {}", what, access_noun(fault.access)),
+    }
+}
+
+fn with_operand(fault: &FaultInfo, description: String) -> String {
+    match (fault.memory_operand.as_ref(), fault.base_register.as_ref()) {
+        (Some(operand), Some((base, value))) => format!("{} via {} ({}={:#x})", description, operand.text, base, value),
+        (Some(operand), None) => format!("{} via {}", description, operand.text),
+        _ => description,
+    }
+}
+
+fn access_noun(access: &str) -> &'static str {
+    match access {
+        "write" => "write",
+        "read" => "read",
+        "execute" => "execution",
+        _ => "access",
+    }
+}
+
+fn capitalize(word: &str) -> String {
+    let mut chars = word.chars();
+    chars.next().map_or_else(String::new, |first| first.to_uppercase().chain(chars).collect())
+}
+
+fn describe_region(region: &MemoryRegion) -> String {
+    format!(
+        "{:#x}-{:#x} {} {}",
+        region.start_address,
+        region.end_address,
+        region.permissions,
+        region.name.as_deref().unwrap_or("[anonymous]")
+    )
+}
+
+/// Register value by operand name, accepting 32-bit aliases (eax, w1)
+fn register_value(registers: &BTreeMap<String, u64>, name: &str, next_pc: u64) -> Option<u64> {
+    match name {
+        "rip" | "eip" => return Some(next_pc),
+        "xzr" | "wzr" => return Some(0),
+        _ => {}
+    }
+    if let Some(&value) = registers.get(name) {
+        return Some(value);
+    }
+    let wide = if let Some(rest) = name.strip_prefix('e') {
+        format!("r{}", rest)
+    } else if let Some(rest) = name.strip_prefix('w') {
+        format!("x{}", rest)
+    } else if let Some(rest) = name.strip_suffix('d') {
+        rest.to_string() // r8d -> r8
+    } else {
+        return None;
+    };
+    registers.get(&wide).map(|value| value & 0xffff_ffff)
+}
+
+/// Memory operand of an Intel-syntax x86 or AArch64 instruction; AT&T syntax
+/// is accepted too. Implicit stack accesses (push, call, ret) go through rsp.
+pub fn parse_memory_operand(mnemonic: &str, operands: &str) -> Option<MemoryOperand> {
+    let mnemonic = mnemonic.trim().to_ascii_lowercase();
+    let mnemonic = mnemonic.rsplit(' ').next().unwrap_or(&mnemonic).to_string(); // drop rep/lock prefixes
+    // Address arithmetic and hints, not accesses
+    if ["lea", "nop", "prefetch", "prfm"].iter().any(|prefix| mnemonic.starts_with(prefix)) {
+        return None;
+    }
+    let parts = split_operands(operands);
+
+    if let Some(index) = parts.iter().position(|part| part.contains('[')) {
+        let part = parts[index];
+        let open = part.find('[')?;
+        let close = part.rfind(']')?;
+        let inner = &part[open + 1..close];
+        let mut operand = if inner.contains(',') {
+            parse_aarch64_address(inner)?
+        } else {
+            parse_intel_address(inner)?
+        };
+        operand.text = part[open..=close].to_string();
+        let prefix = part[..open].trim_end();
+        operand.segment = ["fs:", "gs:"].iter().find(|segment| prefix.ends_with(*segment)).map(|segment| segment[..2].to_string());
+        operand.is_write = if inner.contains(',') || !part.contains("ptr") && is_aarch64_mnemonic(&mnemonic) {
+            mnemonic.starts_with("st")
+        } else {
+            index == 0 && intel_writes_destination(&mnemonic, parts.len())
+        };
+        return Some(operand);
+    }
+
+    if let Some(index) = parts.iter().position(|part| part.contains('(') && part.contains('%')) {
+        let part = parts[index];
+        let mut operand = parse_att_address(part)?;
+        operand.text = part.to_string();
+        // AT&T puts the destination last
+        operand.is_write = index == parts.len() - 1 && parts.len() > 1 && intel_writes_destination(&mnemonic, parts.len());
+        return Some(operand);
+    }
+
+    // String instructions address through rdi/rsi
+    if mnemonic.starts_with("stos") || mnemonic.starts_with("movs") && parts.is_empty() {
+        return Some(MemoryOperand { text: "[rdi]".into(), base: Some("rdi".into()), scale: 1, is_write: true, ..Default::default() });
+    }
+    if mnemonic.starts_with("lods") || mnemonic.starts_with("scas") {
+        let register = if mnemonic.starts_with("lods") { "rsi" } else { "rdi" };
+        return Some(MemoryOperand { text: format!("[{}]", register), base: Some(register.into()), scale: 1, ..Default::default() });
+    }
+
+    // Implicit stack accesses
+    match mnemonic.as_str() {
+        "push" | "pushq" | "call" | "callq" => Some(MemoryOperand {
+            text: "[rsp - 0x8]".into(),
+            base: Some("rsp".into()),
+            scale: 1,
+            displacement: -8,
+            is_write: true,
+            ..Default::default()
+        }),
+        "pop" | "popq" | "ret" | "retq" => Some(MemoryOperand {
+            text: "[rsp]".into(),
+            base: Some("rsp".into()),
+            scale: 1,
+            ..Default::default()
+        }),
+        _ => None,
+    }
+}
+
+fn is_aarch64_mnemonic(mnemonic: &str) -> bool {
+    mnemonic.starts_with("ld") || mnemonic.starts_with("st") || mnemonic.starts_with("prfm")
+}
+
+/// Whether an Intel-syntax instruction writes its first operand
+fn intel_writes_destination(mnemonic: &str, operand_count: usize) -> bool {
+    const READ_ONLY: &[&str] = &["cmp", "test", "call", "jmp", "push", "bt", "ptest", "clflush"];
+    if READ_ONLY.iter().any(|prefix| mnemonic.starts_with(prefix))
+        || mnemonic.starts_with("ucomis")
+        || mnemonic.starts_with("comis")
+        || mnemonic.starts_with('j')
+    {
+        return false;
+    }
+    if operand_count == 1 {
+        // mul/div/imul read their operand; inc/dec/neg/not/pop/set* write it
+        return ["inc", "dec", "neg", "not", "pop", "set"].iter().any(|prefix| mnemonic.starts_with(prefix));
+    }
+    true
+}
+
+/// Split on top-level commas, leaving `[x1, #8]` intact
+fn split_operands(operands: &str) -> Vec<&str> {
+    let mut parts = Vec::new();
+    let mut depth = 0;
+    let mut start = 0;
+    for (i, c) in operands.char_indices() {
+        match c {
+            '[' | '(' | '{' => depth += 1,
+            ']' | ')' | '}' => depth -= 1,
+            ',' if depth == 0 => {
+                parts.push(operands[start..i].trim());
+                start = i + 1;
+            }
+            _ => {}
+        }
+    }
+    let last = operands[start..].trim();
+    if !last.is_empty() {
+        parts.push(last);
+    }
+    parts
+}
+
+/// `rbx + 8*rcx - 0x10`
+fn parse_intel_address(inner: &str) -> Option<MemoryOperand> {
+    let mut operand = MemoryOperand { scale: 1, ..Default::default() };
+    let normalized = inner.replace('-', "+-");
+    for term in normalized.split('+').map(str::trim).filter(|term| !term.is_empty()) {
+        let (negative, term) = match term.strip_prefix('-') {
+            Some(rest) => (true, rest.trim()),
+            None => (false, term),
+        };
+        if let Some((a, b)) = term.split_once('*') {
+            let (register, scale) = if parse_number(a).is_some() { (b, a) } else { (a, b) };
+            operand.index = Some(register.trim().to_string());
+            operand.scale = parse_number(scale)?;
+        } else if let Some(value) = parse_number(term) {
+            let value = value as i64;
+            operand.displacement = operand.displacement.wrapping_add(if negative { -value } else { value });
+        } else if operand.base.is_none() {
+            operand.base = Some(term.to_string());
+        } else {
+            operand.index = Some(term.to_string());
+        }
+    }
+    Some(operand)
+}
+
+/// `x1, #0x8` or `x1, x2, lsl #3`
+fn parse_aarch64_address(inner: &str) -> Option<MemoryOperand> {
+    let mut operand = MemoryOperand { scale: 1, ..Default::default() };
+    let mut fields = inner.split(',').map(str::trim);
+    operand.base = Some(fields.next()?.to_string());
+    for field in fields {
+        if let Some(immediate) = field.strip_prefix('#') {
+            operand.displacement = parse_signed(immediate)?;
+        } else if let Some(shift) = field.strip_prefix("lsl").or_else(|| field.strip_prefix("sxtw")).or_else(|| field.strip_prefix("uxtw")) {
+            let amount = shift.trim().trim_start_matches('#');
+            operand.scale = 1 << if amount.is_empty() { 0 } else { parse_number(amount)? };
+        } else {
+            operand.index = Some(field.to_string());
+        }
+    }
+    Some(operand)
+}
+
+/// `-0x10(%rbx,%rcx,8)`
+fn parse_att_address(part: &str) -> Option<MemoryOperand> {
+    let mut operand = MemoryOperand { scale: 1, ..Default::default() };
+    let open = part.find('(')?;
+    let close = part.rfind(')')?;
+    let prefix = part[..open].trim();
+    if let Some(segment) = ["%fs:", "%gs:"].iter().find(|segment| prefix.starts_with(*segment)) {
+        operand.segment = Some(segment[1..3].to_string());
+    }
+    let displacement = prefix.rsplit(':').next().unwrap_or("").trim();
+    if !displacement.is_empty() {
+        operand.displacement = parse_signed(displacement)?;
+    }
+    let mut fields = part[open + 1..close].split(',').map(|field| field.trim().trim_start_matches('%'));
+    operand.base = fields.next().filter(|base| !base.is_empty()).map(String::from);
+    operand.index = fields.next().filter(|index| !index.is_empty()).map(String::from);
+    if let Some(scale) = fields.next() {
+        operand.scale = parse_number(scale)?;
+    }
+    Some(operand)
+}
+
+fn parse_number(text: &str) -> Option<u64> {
+    let text = text.trim();
+    match text.strip_prefix("0x") {
+        Some(hex) => u64::from_str_radix(hex, 16).ok(),
+        None => text.parse().ok(),
+    }
+}
+
+fn parse_signed(text: &str) -> Option<i64> {
+    let text = text.trim();
+    match text.strip_prefix('-') {
+        Some(rest) => parse_number(rest).map(|value| -(value as i64)),
+        None => parse_number(text).map(|value| value as i64),
+    }
+}
+
+/// Symbolic si_code for the signals that carry one
+pub fn si_code_name(signal: i32, code: i32) -> Option<&'static str> {
+    let generic = match code {
+        0 => Some("SI_USER"),
+        0x80 => Some("SI_KERNEL"),
+        -1 => Some("SI_QUEUE"),
+        -2 => Some("SI_TIMER"),
+        -6 => Some("SI_TKILL"),
+        _ => None,
+    };
+    if generic.is_some() {
+        return generic;
+    }
+    let names: &[&str] = match signal {
+        libc::SIGSEGV => &["SEGV_MAPERR", "SEGV_ACCERR", "SEGV_BNDERR", "SEGV_PKUERR", "SEGV_ACCADI", "SEGV_ADIDERR", "SEGV_ADIPERR", "SEGV_MTEAERR", "SEGV_MTESERR"],
+        libc::SIGBUS => &["BUS_ADRALN", "BUS_ADRERR", "BUS_OBJERR", "BUS_MCEERR_AR", "BUS_MCEERR_AO"],
+        libc::SIGFPE => &["FPE_INTDIV", "FPE_INTOVF", "FPE_FLTDIV", "FPE_FLTOVF", "FPE_FLTUND", "FPE_FLTRES", "FPE_FLTINV", "FPE_FLTSUB"],
+        libc::SIGILL => &["ILL_ILLOPC", "ILL_ILLOPN", "ILL_ILLADR", "ILL_ILLTRP", "ILL_PRVOPC", "ILL_PRVREG", "ILL_COPROC", "ILL_BADSTK"],
+        libc::SIGTRAP => &["TRAP_BRKPT", "TRAP_TRACE", "TRAP_BRANCH", "TRAP_HWBKPT"],
+        _ => &[],
+    };
+    usize::try_from(code).ok().and_then(|code| code.checked_sub(1)).and_then(|index| names.get(index).copied())
+}
+
+/// si_code and fault address from an LLDB stop description such as
+/// "signal SIGSEGV: address not mapped to object (fault address: 0x8)".
+/// The same words mean different codes under different signals, so the
+/// description is only matched against the texts of `signal`.
+pub fn parse_stop_description(signal: i32, description: &str) -> (Option<i32>, Option<u64>) {
+    const CODES: &[(i32, &str, i32)] = &[
+        (libc::SIGSEGV, "address not mapped to object", 1),
+        (libc::SIGSEGV, "invalid address (", 1),
+        (libc::SIGSEGV, "invalid permissions for mapped object", 2),
+        (libc::SIGSEGV, "address access protected", 2),
+        (libc::SIGSEGV, "failed address bounds checks", 3),
+        (libc::SIGSEGV, "failed protection key checks", 4),
+        (libc::SIGSEGV, "async tag check fault", 8),
+        (libc::SIGSEGV, "sync tag check fault", 9),
+        (libc::SIGBUS, "illegal alignment", 1),
+        (libc::SIGBUS, "invalid address alignment", 1),
+        (libc::SIGBUS, "illegal address", 2),
+        (libc::SIGBUS, "nonexistent physical address", 2),
+        (libc::SIGBUS, "hardware error", 3),
+        (libc::SIGFPE, "integer divide by zero", 1),
+        (libc::SIGFPE, "integer overflow", 2),
+        (libc::SIGFPE, "floating point divide by zero", 3),
+        (libc::SIGFPE, "floating point overflow", 4),
+        (libc::SIGFPE, "floating point underflow", 5),
+        (libc::SIGFPE, "floating point inexact result", 6),
+        (libc::SIGFPE, "floating point invalid operation", 7),
+        (libc::SIGFPE, "subscript out of range", 8),
+        (libc::SIGILL, "illegal opcode", 1),
+        (libc::SIGILL, "illegal operand", 2),
+        (libc::SIGILL, "illegal addressing mode", 3),
+        (libc::SIGILL, "illegal trap", 4),
+        (libc::SIGILL, "privileged opcode", 5),
+        (libc::SIGILL, "privileged register", 6),
+        (libc::SIGILL, "coprocessor error", 7),
+        (libc::SIGILL, "internal stack error", 8),
+    ];
+    // Sender codes are the same for every signal
+    const SENDERS: &[(&str, i32)] = &[("sent by kill", 0), ("sent by tkill", -6)];
+
+    let si_code = CODES.iter()
+        .filter(|(signo, _, _)| *signo == signal)
+        .map(|&(_, text, code)| (text, code))
+        .chain(SENDERS.iter().copied())
+        .find(|(text, _)| description.contains(text))
+        .map(|(_, code)| code);
+    let fault_address = description
+        .split_once("fault address: ")
+        .and_then(|(_, rest)| rest.split(|c: char| c == ')' || c.is_whitespace()).next())
+        .and_then(parse_number);
+    (si_code, fault_address)
+}
+
+/// Stop description of `thread`, e.g. "signal SIGSEGV: ..."
+pub(crate) fn stop_description(thread: SBThreadRef) -> String {
+    let mut buffer = vec![0u8; 512];
+    let written = unsafe { SBThreadGetStopDescription(thread, buffer.as_mut_ptr() as *mut std::os::raw::c_char, buffer.len()) };
+    buffer.truncate(written.min(buffer.len()));
+    String::from_utf8_lossy(&buffer).trim_end_matches('\0').to_string()
+}
+
+/// Decode the instruction at `pc`, in Intel syntax on x86
+pub(crate) fn read_instruction(target: SBTargetRef, pc: u64) -> Option<FaultingInstruction> {
+    let flavor = std::ffi::CString::new("intel").ok()?;
+    let address = unsafe { SBTargetResolveLoadAddress(target, pc) };
+    if address.is_null() {
+        return None;
+    }
+    let list = unsafe { SBTargetReadInstructions2(target, address, 1, flavor.as_ptr()) };
+    unsafe { DisposeSBAddress(address) };
+    if list.is_null() {
+        return None;
+    }
+    let instruction = if unsafe { SBInstructionListGetSize(list) } > 0 {
+        let instruction = unsafe { SBInstructionListGetInstructionAtIndex(list, 0) };
+        let text = |ptr: *const std::os::raw::c_char| {
+            if ptr.is_null() {
+                String::new()
+            } else {
+                unsafe { std::ffi::CStr::from_ptr(ptr) }.to_string_lossy().trim().to_string()
+            }
+        };
+        let decoded = (!instruction.is_null()).then(|| FaultingInstruction {
+            address: pc,
+            size: unsafe { SBInstructionGetByteSize(instruction) } as u64,
+            mnemonic: text(unsafe { SBInstructionGetMnemonic(instruction, target) }),
+            operands: text(unsafe { SBInstructionGetOperands(instruction, target) }),
+        });
+        if !instruction.is_null() {
+            unsafe { DisposeSBInstruction(instruction) };
+        }
+        decoded.filter(|decoded| !decoded.mnemonic.is_empty())
+    } else {
+        None
+    };
+    unsafe { DisposeSBInstructionList(list) };
+    instruction
+}
+
+/// Next steps specific to the kind of fault
+pub fn recommendations(fault: &FaultInfo) -> Vec<String> {
+    let base = fault.base_register.as_ref().map(|(name, _)| name.as_str());
+    match fault.classification {
+        "null_dereference" => vec![match base {
+            Some(base) => format!("Find where {} was loaded and why it was NULL; the offset names the field accessed", base),
+            None => "Check the pointer being dereferenced for NULL".to_string(),
+        }],
+        "stack_overflow" => vec!["Look for unbounded recursion or large stack arrays in the backtrace".to_string()],
+        "guard_page" => vec!["An access ran off the end of a buffer into a guard page; check loop bounds and lengths".to_string()],
+        "write_to_readonly" => vec!["A write hit read-only memory: a string literal, const data or code; check the pointer's origin".to_string()],
+        "non_canonical" | "general_protection" => vec!["The pointer is garbage: look for use-after-free or uninitialized memory".to_string()],
+        "wild_write" | "wild_read" | "unmapped" => vec![match base {
+            Some(base) => format!("{} holds a dangling or corrupted pointer; watch where it is written", base),
+            None => "The address is unmapped: look for use-after-free or pointer corruption".to_string(),
+        }],
+        "wild_jump" | "execute_non_executable" => vec!["Control flow went to a bad address: check function pointers, vtables and return addresses for corruption".to_string()],
+        "misaligned_access" => vec!["Check pointer casts and packed structures for misaligned access".to_string()],
+        "bus_error" => vec!["Check whether a memory-mapped file was truncated while mapped".to_string()],
+        _ => Vec::new(),
+    }
+}
+
+pub fn fault_json(fault: &FaultInfo) -> Value {
+    json!({
+        "signal": crate::core_file::signal_name(fault.signal),
+        "si_code": fault.si_code,
+        "si_code_name": fault.si_code_name,
+        "fault_address": fault.fault_address.map(|addr| format!("0x{:x}", addr)),
+        "address": fault.address().map(|addr| format!("0x{:x}", addr)),
+        "pc": fault.pc.map(|pc| format!("0x{:x}", pc)),
+        "sp": fault.sp.map(|sp| format!("0x{:x}", sp)),
+        "instruction": fault.instruction.as_ref().map(FaultingInstruction::text),
+        "memory_operand": fault.memory_operand.as_ref().map(|operand| operand.text.clone()),
+        "base_register": fault.base_register.as_ref().map(|(name, value)| json!({ "name": name, "value": format!("0x{:x}", value) })),
+        "computed_address": fault.computed_address.map(|addr| format!("0x{:x}", addr)),
+        "access": fault.access,
+        "classification": fault.classification,
+        "description": fault.description,
+        "region": fault.region
+    })
+}
@@ -0,0 +1,395 @@
+// Point-in-time snapshot of many processes at once
+//
+// Each matching process is attached by a worker with its own SBDebugger, held
+// stopped only long enough to walk every thread's stack and read one thread's
+// registers, then detached. Identical stacks across the whole fleet are folded
+// together so a pool of 64 idle workers reads as one entry, not 64.
+
+use std::collections::{BTreeMap, HashMap};
+use std::sync::Mutex;
+use std::time::Instant;
+
+use lldb_sys::*;
+use tracing::{debug, info, warn};
+
+use crate::error::{IncodeError, IncodeResult};
+use crate::lldb_manager::{process_regions, sb_error_message, ProcessInfo};
+use crate::process_table::{thread_cpu_ticks, ProcessFilter, RegionStats};
+
+/// What to snapshot and how hard to work at it
+#[derive(Debug, Clone)]
+pub struct SnapshotOptions {
+    pub filter: ProcessFilter,
+    /// Processes attached at the same time
+    pub max_concurrency: usize,
+    /// Refuse filters that match more processes than this
+    pub max_processes: usize,
+    /// Frames captured per thread
+    pub max_frames: u32,
+}
+
+impl Default for SnapshotOptions {
+    fn default() -> Self {
+        Self {
+            filter: ProcessFilter::default(),
+            max_concurrency: 8,
+            max_processes: 256,
+            max_frames: 64,
+        }
+    }
+}
+
+/// The one thread per process whose registers are captured
+#[derive(Debug, Clone)]
+pub struct FocusThread {
+    pub tid: u32,
+    /// Why this thread was picked: "crashed", "hot" or "selected"
+    pub reason: String,
+    pub stop_reason: String,
+    pub cpu_ticks: Option<u64>,
+    pub registers: BTreeMap<String, u64>,
+}
+
+#[derive(Debug, Clone)]
+pub struct ProcessSnapshot {
+    pub pid: u32,
+    pub name: Option<String>,
+    pub thread_count: usize,
+    pub focus_thread: Option<FocusThread>,
+    pub regions: Option<RegionStats>,
+    /// Index into `FleetSnapshot::unique_stacks` (equal to `UniqueStack::id`)
+    /// for each thread, in thread order
+    pub stack_ids: Vec<usize>,
+    /// Time the process was held stopped
+    pub stopped_ms: u64,
+    pub error: Option<String>,
+}
+
+/// A call stack shared by one or more threads across the fleet
+#[derive(Debug, Clone)]
+pub struct UniqueStack {
+    pub id: usize,
+    pub frames: Vec<String>,
+    pub thread_count: usize,
+    pub pids: Vec<u32>,
+}
+
+#[derive(Debug, Clone)]
+pub struct FleetSnapshot {
+    pub processes: Vec<ProcessSnapshot>,
+    pub unique_stacks: Vec<UniqueStack>,
+    pub thread_count: usize,
+    pub elapsed_ms: u64,
+}
+
+/// Raw per-process capture before stacks are deduplicated
+struct Capture {
+    snapshot: ProcessSnapshot,
+    stacks: Vec<Vec<String>>,
+}
+
+/// Attach to each of `targets` (except `exclude`) and aggregate their stacks
+/// into one report
+pub fn snapshot_processes(
+    mut targets: Vec<ProcessInfo>,
+    options: &SnapshotOptions,
+    exclude: &[u32],
+) -> IncodeResult<FleetSnapshot> {
+    let started = Instant::now();
+
+    let own_pid = std::process::id();
+    targets.retain(|p| p.pid != own_pid && !exclude.contains(&p.pid));
+
+    if targets.is_empty() {
+        return Err(IncodeError::process_not_found("No processes match the snapshot filter"));
+    }
+    if targets.len() > options.max_processes {
+        return Err(IncodeError::invalid_parameter(format!(
+            "Filter matches {} processes, more than the limit of {}", targets.len(), options.max_processes
+        )));
+    }
+
+    info!("Snapshotting {} processes with up to {} workers", targets.len(), options.max_concurrency);
+
+    // Workers pull from a shared queue so one slow attach doesn't stall a whole batch
+    let queue = Mutex::new(targets.into_iter().map(|p| (p.pid, p.name)).collect::<Vec<_>>());
+    let results = Mutex::new(Vec::new());
+    let workers = options.max_concurrency.clamp(1, 64);
+
+    std::thread::scope(|scope| {
+        for _ in 0..workers {
+            scope.spawn(|| loop {
+                let Some((pid, name)) = queue.lock().unwrap().pop() else {
+                    break;
+                };
+                let capture = capture_process(pid, name, options.max_frames);
+                results.lock().unwrap().push(capture);
+            });
+        }
+    });
+
+    let mut captures = results.into_inner().unwrap();
+    captures.sort_by_key(|capture| capture.snapshot.pid);
+
+    // Fold identical stacks across all processes
+    let mut index: HashMap<Vec<String>, usize> = HashMap::new();
+    let mut unique_stacks: Vec<UniqueStack> = Vec::new();
+    let mut thread_count = 0;
+    let mut processes = Vec::with_capacity(captures.len());
+
+    for Capture { mut snapshot, stacks } in captures {
+        thread_count += stacks.len();
+        for frames in stacks {
+            let id = *index.entry(frames.clone()).or_insert_with(|| {
+                unique_stacks.push(UniqueStack {
+                    id: unique_stacks.len(),
+                    frames,
+                    thread_count: 0,
+                    pids: Vec::new(),
+                });
+                unique_stacks.len() - 1
+            });
+            let stack = &mut unique_stacks[id];
+            stack.thread_count += 1;
+            if stack.pids.last() != Some(&snapshot.pid) {
+                stack.pids.push(snapshot.pid);
+            }
+            snapshot.stack_ids.push(id);
+        }
+        processes.push(snapshot);
+    }
+
+    // Most common stacks first, then renumbered so an id is its position again
+    unique_stacks.sort_by(|a, b| b.thread_count.cmp(&a.thread_count).then(a.id.cmp(&b.id)));
+    let mut position = vec![0; unique_stacks.len()];
+    for (index, stack) in unique_stacks.iter_mut().enumerate() {
+        position[stack.id] = index;
+        stack.id = index;
+    }
+    for snapshot in &mut processes {
+        for id in &mut snapshot.stack_ids {
+            *id = position[*id];
+        }
+    }
+
+    let elapsed_ms = started.elapsed().as_millis() as u64;
+    info!("Fleet snapshot: {} processes, {} threads, {} unique stacks in {}ms",
+        processes.len(), thread_count, unique_stacks.len(), elapsed_ms);
+
+    Ok(FleetSnapshot {
+        processes,
+        unique_stacks,
+        thread_count,
+        elapsed_ms,
+    })
+}
+
+fn capture_process(pid: u32, name: Option<String>, max_frames: u32) -> Capture {
+    let mut snapshot = ProcessSnapshot {
+        pid,
+        name,
+        thread_count: 0,
+        focus_thread: None,
+        regions: None,
+        stack_ids: Vec::new(),
+        stopped_ms: 0,
+        error: None,
+    };
+
+    let debugger = unsafe { SBDebuggerCreate() };
+    if debugger.is_null() {
+        snapshot.error = Some("Failed to create debugger".to_string());
+        return Capture { snapshot, stacks: Vec::new() };
+    }
+    unsafe { SBDebuggerSetAsync(debugger, false) };
+
+    let stacks = match capture_stopped(debugger, pid, max_frames, &mut snapshot) {
+        Ok(stacks) => stacks,
+        Err(e) => {
+            debug!("Snapshot of PID {} failed: {}", pid, e);
+            snapshot.error = Some(e.to_string());
+            Vec::new()
+        }
+    };
+
+    unsafe { SBDebuggerDestroy(debugger) };
+    Capture { snapshot, stacks }
+}
+
+/// Attach, walk all threads, detach; the process is stopped only in here
+fn capture_stopped(
+    debugger: SBDebuggerRef,
+    pid: u32,
+    max_frames: u32,
+    snapshot: &mut ProcessSnapshot,
+) -> IncodeResult<Vec<Vec<String>>> {
+    let target = unsafe { SBDebuggerCreateTarget2(debugger, std::ptr::null()) };
+    if target.is_null() {
+        return Err(IncodeError::lldb_op("Failed to create target"));
+    }
+
+    let attach_info = unsafe { CreateSBAttachInfo() };
+    unsafe { SBAttachInfoSetProcessID(attach_info, pid as lldb_pid_t) };
+    let error = unsafe { CreateSBError() };
+    let stopped_at = Instant::now();
+    let process = unsafe { SBTargetAttach(target, attach_info, error) };
+    let attach_error = if process.is_null() || unsafe { SBErrorFail(error) } {
+        Some(sb_error_message(error))
+    } else {
+        None
+    };
+    unsafe {
+        DisposeSBError(error);
+        DisposeSBAttachInfo(attach_info);
+    }
+    if let Some(message) = attach_error {
+        return Err(IncodeError::process_not_found(format!("Failed to attach: {}", message)));
+    }
+
+    let num_threads = unsafe { SBProcessGetNumThreads(process) };
+    let mut stacks = Vec::with_capacity(num_threads as usize);
+    let mut crashed: Option<SBThreadRef> = None;
+    let mut hottest: Option<(SBThreadRef, u64)> = None;
+
+    for i in 0..num_threads {
+        let thread = unsafe { SBProcessGetThreadAtIndex(process, i as usize) };
+        if thread.is_null() {
+            continue;
+        }
+        stacks.push(thread_stack(thread, max_frames));
+
+        if crashed.is_none() && is_fault_stop(thread) {
+            crashed = Some(thread);
+        }
+        let tid = unsafe { SBThreadGetThreadID(thread) } as u32;
+        if let Some(ticks) = thread_cpu_ticks(pid, tid) {
+            if hottest.map_or(true, |(_, best)| ticks > best) {
+                hottest = Some((thread, ticks));
+            }
+        }
+    }
+
+    let focus = match (crashed, hottest) {
+        (Some(thread), _) => Some((thread, "crashed")),
+        (None, Some((thread, _))) => Some((thread, "hot")),
+        (None, None) => {
+            let thread = unsafe { SBProcessGetSelectedThread(process) };
+            (!thread.is_null()).then_some((thread, "selected"))
+        }
+    };
+    snapshot.focus_thread = focus.map(|(thread, reason)| {
+        let tid = unsafe { SBThreadGetThreadID(thread) } as u32;
+        FocusThread {
+            tid,
+            reason: reason.to_string(),
+            stop_reason: format!("{:?}", unsafe { SBThreadGetStopReason(thread) }),
+            cpu_ticks: thread_cpu_ticks(pid, tid),
+            registers: general_registers(thread),
+        }
+    });
+    snapshot.thread_count = stacks.len();
+    snapshot.regions = process_regions(process).map(|regions| RegionStats::from_regions(&regions));
+
+    let error = unsafe { SBProcessDetach(process) };
+    if !error.is_null() {
+        if unsafe { SBErrorFail(error) } {
+            warn!("Detaching from PID {} failed: {}", pid, sb_error_message(error));
+        }
+        unsafe { DisposeSBError(error) };
+    }
+    snapshot.stopped_ms = stopped_at.elapsed().as_millis() as u64;
+
+    unsafe {
+        DisposeSBProcess(process);
+        DisposeSBTarget(target);
+    }
+    Ok(stacks)
+}
+
+/// Symbolic frames of one thread, e.g. `epoll_wait (libc.so.6)`
+pub(crate) fn thread_stack(thread: SBThreadRef, max_frames: u32) -> Vec<String> {
+    let num_frames = unsafe { SBThreadGetNumFrames(thread) }.min(max_frames);
+    (0..num_frames)
+        .filter_map(|i| {
+            let frame = unsafe { SBThreadGetFrameAtIndex(thread, i) };
+            if frame.is_null() {
+                return None;
+            }
+            let name_ptr = unsafe { SBFrameGetDisplayFunctionName(frame) };
+            let module = frame_module(frame);
+            Some(if name_ptr.is_null() {
+                // Unsymbolized frames differ per process under ASLR; keep module only
+                format!("?? ({})", module.unwrap_or_else(|| "unknown".to_string()))
+            } else {
+                let name = unsafe { std::ffi::CStr::from_ptr(name_ptr) }.to_string_lossy();
+                match module {
+                    Some(module) => format!("{} ({})", name, module),
+                    None => name.into_owned(),
+                }
+            })
+        })
+        .collect()
+}
+
+fn frame_module(frame: SBFrameRef) -> Option<String> {
+    let module = unsafe { SBFrameGetModule(frame) };
+    if module.is_null() {
+        return None;
+    }
+    let file_spec = unsafe { SBModuleGetFileSpec(module) };
+    if file_spec.is_null() {
+        return None;
+    }
+    let name_ptr = unsafe { SBFileSpecGetFilename(file_spec) };
+    if name_ptr.is_null() {
+        None
+    } else {
+        Some(unsafe { std::ffi::CStr::from_ptr(name_ptr) }.to_string_lossy().into_owned())
+    }
+}
+
+/// Stopped for a fault rather than for the SIGSTOP sent by the attach itself
+fn is_fault_stop(thread: SBThreadRef) -> bool {
+    match unsafe { SBThreadGetStopReason(thread) } {
+        StopReason::Exception => true,
+        StopReason::Signal => {
+            let signo = unsafe { SBThreadGetStopReasonDataAtIndex(thread, 0) };
+            signo != libc::SIGSTOP as u64
+        }
+        _ => false,
+    }
+}
+
+/// First register set (general purpose registers) of the thread's top frame
+pub(crate) fn general_registers(thread: SBThreadRef) -> BTreeMap<String, u64> {
+    let mut registers = BTreeMap::new();
+    let frame = unsafe { SBThreadGetFrameAtIndex(thread, 0) };
+    if frame.is_null() {
+        return registers;
+    }
+    let register_list = unsafe { SBFrameGetRegisters(frame) };
+    if register_list.is_null() || unsafe { SBValueListGetSize(register_list) } == 0 {
+        return registers;
+    }
+
+    let register_set = unsafe { SBValueListGetValueAtIndex(register_list, 0) };
+    if register_set.is_null() {
+        return registers;
+    }
+    let error = unsafe { CreateSBError() };
+    for i in 0..unsafe { SBValueGetNumChildren(register_set) } {
+        let register = unsafe { SBValueGetChildAtIndex(register_set, i) };
+        if register.is_null() {
+            continue;
+        }
+        let name_ptr = unsafe { SBValueGetName(register) };
+        if name_ptr.is_null() {
+            continue;
+        }
+        let name = unsafe { std::ffi::CStr::from_ptr(name_ptr) }.to_string_lossy().into_owned();
+        let value = unsafe { SBValueGetValueAsUnsigned(register, error, 0) };
+        registers.insert(name, value);
+    }
+    unsafe { DisposeSBError(error) };
+    registers
+}
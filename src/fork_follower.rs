@@ -0,0 +1,537 @@
+// Multi-process debugging for forking debuggees
+//
+// LLDB follows either the parent or the child across fork() and detaches the
+// other side. To debug both, the follower watches the debuggee's process tree
+// and attaches every new descendant with its own SBDebugger on its own worker
+// thread, so children run and stop independently of the primary process.
+
+use std::collections::{HashMap, HashSet};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::mpsc::{self, Receiver, RecvTimeoutError, Sender};
+use std::sync::{Arc, Mutex, MutexGuard};
+use std::thread::JoinHandle;
+use std::time::{Duration, Instant, SystemTime};
+
+use lldb_sys::*;
+use tracing::{debug, info, warn};
+use uuid::Uuid;
+
+use crate::error::{IncodeError, IncodeResult};
+use crate::lldb_manager::{sb_error_message, state_name, DebuggingSession, SessionState};
+use crate::process_table::{ProcessFilter, ProcessTable};
+
+/// Which side of a fork() stays under the debugger
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ForkPolicy {
+    /// Keep debugging the parent; children run free (LLDB default)
+    Parent,
+    /// Switch the primary process over to the child
+    Child,
+    /// Keep the parent and attach every child in its own session
+    Both,
+}
+
+impl ForkPolicy {
+    pub fn parse(policy: &str) -> IncodeResult<Self> {
+        match policy {
+            "parent" => Ok(ForkPolicy::Parent),
+            "child" => Ok(ForkPolicy::Child),
+            "both" => Ok(ForkPolicy::Both),
+            _ => Err(IncodeError::invalid_parameter(format!(
+                "Unknown fork policy '{}': expected parent, child or both", policy
+            ))),
+        }
+    }
+
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            ForkPolicy::Parent => "parent",
+            ForkPolicy::Child => "child",
+            ForkPolicy::Both => "both",
+        }
+    }
+
+    /// Value for LLDB's target.process.follow-fork-mode setting
+    pub fn follow_fork_mode(&self) -> &'static str {
+        match self {
+            ForkPolicy::Child => "child",
+            ForkPolicy::Parent | ForkPolicy::Both => "parent",
+        }
+    }
+}
+
+/// Request sent to a child worker
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ChildCommand {
+    Continue,
+    Interrupt,
+    Kill,
+    Detach,
+}
+
+impl ChildCommand {
+    pub fn parse(action: &str) -> IncodeResult<Self> {
+        match action {
+            "continue" => Ok(ChildCommand::Continue),
+            "interrupt" => Ok(ChildCommand::Interrupt),
+            "kill" => Ok(ChildCommand::Kill),
+            "detach" => Ok(ChildCommand::Detach),
+            _ => Err(IncodeError::invalid_parameter(format!(
+                "Unknown child action '{}': expected continue, interrupt, kill or detach", action
+            ))),
+        }
+    }
+}
+
+/// Snapshot of one followed child process
+#[derive(Debug, Clone)]
+pub struct ChildSessionInfo {
+    pub session_id: Uuid,
+    pub pid: u32,
+    pub parent_pid: u32,
+    pub state: String,
+    pub stop_reason: Option<String>,
+    pub breakpoints: u32,
+    /// Time from noticing the child to having it attached
+    pub attach_ms: u64,
+    pub error: Option<String>,
+}
+
+type CommandReply = Sender<IncodeResult<()>>;
+
+struct ChildWorker {
+    info: Arc<Mutex<ChildSessionInfo>>,
+    commands: Sender<(ChildCommand, CommandReply)>,
+    handle: Option<JoinHandle<()>>,
+}
+
+/// State shared between the follower, its watcher and the child workers
+struct Shared {
+    children: Mutex<HashMap<u32, ChildWorker>>,
+    sessions: Arc<Mutex<HashMap<Uuid, DebuggingSession>>>,
+    breakpoints_file: PathBuf,
+    /// PIDs never to follow; also held for the whole of each discovery pass
+    ignored: Mutex<HashSet<u32>>,
+    stop: AtomicBool,
+}
+
+/// Watches a debuggee's descendants and debugs each one on a worker thread
+pub struct ForkFollower {
+    shared: Arc<Shared>,
+    watcher: Option<JoinHandle<()>>,
+}
+
+impl ForkFollower {
+    /// How often the process tree is checked for new children
+    const POLL_INTERVAL: Duration = Duration::from_millis(25);
+    /// How long a worker waits for commands before checking process events
+    const WORKER_TICK: Duration = Duration::from_millis(20);
+    const COMMAND_TIMEOUT: Duration = Duration::from_secs(10);
+
+    /// Start following children of `root_pid`. Breakpoints serialized into
+    /// `breakpoints_dir` (see `save_breakpoints`) are re-created in every child;
+    /// the directory must be private to this user and is removed by `stop`.
+    pub fn start(
+        root_pid: u32,
+        sessions: Arc<Mutex<HashMap<Uuid, DebuggingSession>>>,
+        breakpoints_dir: PathBuf,
+        ignored: impl IntoIterator<Item = u32>,
+    ) -> Self {
+        let shared = Arc::new(Shared {
+            children: Mutex::new(HashMap::new()),
+            sessions,
+            breakpoints_file: breakpoints_dir.join("breakpoints.json"),
+            ignored: Mutex::new(ignored.into_iter().collect()),
+            stop: AtomicBool::new(false),
+        });
+
+        let watcher_shared = shared.clone();
+        let watcher = std::thread::Builder::new()
+            .name(format!("fork-watch-{}", root_pid))
+            .spawn(move || Self::watch(root_pid, &watcher_shared))
+            .ok();
+
+        info!("Following forks of process {}", root_pid);
+        Self { shared, watcher }
+    }
+
+    /// Hold off discovery of new children while the guard lives. PIDs added
+    /// to the guard are never followed, e.g. processes forked by the server itself.
+    pub fn pause_discovery(&self) -> MutexGuard<'_, HashSet<u32>> {
+        self.shared.ignored.lock().unwrap()
+    }
+
+    /// Where the breakpoints inherited by new children are kept
+    pub fn breakpoints_file(&self) -> &Path {
+        &self.shared.breakpoints_file
+    }
+
+    pub fn children(&self) -> Vec<ChildSessionInfo> {
+        let children = self.shared.children.lock().unwrap();
+        let mut infos: Vec<ChildSessionInfo> = children.values()
+            .map(|worker| worker.info.lock().unwrap().clone())
+            .collect();
+        infos.sort_by_key(|info| info.pid);
+        infos
+    }
+
+    /// Send `command` to the worker debugging `pid` and wait for it to be applied
+    pub fn control(&self, pid: u32, command: ChildCommand) -> IncodeResult<ChildSessionInfo> {
+        let (reply_tx, reply_rx) = mpsc::channel();
+        let info = {
+            let children = self.shared.children.lock().unwrap();
+            let worker = children.get(&pid)
+                .ok_or_else(|| IncodeError::process_not_found(format!("No child session for PID {}", pid)))?;
+            worker.commands.send((command, reply_tx))
+                .map_err(|_| IncodeError::process(format!("Child session for PID {} has ended", pid)))?;
+            worker.info.clone()
+        };
+
+        match reply_rx.recv_timeout(Self::COMMAND_TIMEOUT) {
+            Ok(result) => result?,
+            Err(RecvTimeoutError::Timeout) => return Err(IncodeError::Timeout),
+            Err(RecvTimeoutError::Disconnected) => {
+                return Err(IncodeError::process(format!("Child session for PID {} has ended", pid)))
+            }
+        }
+
+        let snapshot = info.lock().unwrap().clone();
+        Ok(snapshot)
+    }
+
+    /// Detach from every child that is still attached and stop watching
+    pub fn stop(&mut self) {
+        self.shared.stop.store(true, Ordering::SeqCst);
+        if let Some(watcher) = self.watcher.take() {
+            let _ = watcher.join();
+        }
+
+        let workers: Vec<ChildWorker> = self.shared.children.lock().unwrap().drain().map(|(_, w)| w).collect();
+        for mut worker in workers {
+            if let Some(handle) = worker.handle.take() {
+                let _ = handle.join();
+            }
+        }
+
+        let _ = std::fs::remove_file(&self.shared.breakpoints_file);
+        if let Some(dir) = self.shared.breakpoints_file.parent() {
+            let _ = std::fs::remove_dir(dir);
+        }
+    }
+
+    fn watch(root_pid: u32, shared: &Arc<Shared>) {
+        let table = ProcessTable::new();
+        while !shared.stop.load(Ordering::SeqCst) {
+            if !Path::new(&format!("/proc/{}", root_pid)).exists() {
+                debug!("Root process {} is gone; fork watcher exiting", root_pid);
+                break;
+            }
+
+            {
+                let ignored = shared.ignored.lock().unwrap();
+                let mut tracked: Vec<u32> = shared.children.lock().unwrap().keys().copied().collect();
+                tracked.push(root_pid);
+
+                for (pid, parent_pid) in Self::new_children(&tracked, &table) {
+                    if ignored.contains(&pid) {
+                        continue;
+                    }
+                    let worker = ChildWorker::spawn(pid, parent_pid, shared.clone());
+                    shared.children.lock().unwrap().insert(pid, worker);
+                }
+            }
+
+            std::thread::sleep(Self::POLL_INTERVAL);
+        }
+    }
+
+    /// Children of any tracked process that are not tracked themselves
+    fn new_children(tracked: &[u32], table: &ProcessTable) -> Vec<(u32, u32)> {
+        let mut found = Vec::new();
+        let mut complete = true;
+        for &parent in tracked {
+            match read_children(parent) {
+                Some(children) => found.extend(children.into_iter().map(|child| (child, parent))),
+                None => complete = false,
+            }
+        }
+
+        // Kernels without /proc/<pid>/task/<tid>/children need a full scan
+        if !complete {
+            let filter = ProcessFilter { include_system: true, ..Default::default() };
+            if let Ok(processes) = table.scan(&filter) {
+                found = processes.into_iter()
+                    .filter_map(|p| p.ppid.filter(|ppid| tracked.contains(ppid)).map(|ppid| (p.pid, ppid)))
+                    .collect();
+            }
+        }
+
+        found.retain(|(pid, _)| !tracked.contains(pid));
+        found.sort_unstable();
+        found.dedup();
+        found
+    }
+}
+
+impl Drop for ForkFollower {
+    fn drop(&mut self) {
+        self.stop();
+    }
+}
+
+/// Direct children of `pid` from /proc/<pid>/task/*/children
+fn read_children(pid: u32) -> Option<Vec<u32>> {
+    // A process that has already exited has no children to report
+    let Ok(tasks) = std::fs::read_dir(format!("/proc/{}/task", pid)) else {
+        return Some(Vec::new());
+    };
+    let mut children = Vec::new();
+    for task in tasks.filter_map(|entry| entry.ok()) {
+        match std::fs::read_to_string(task.path().join("children")) {
+            Ok(list) => children.extend(list.split_whitespace().filter_map(|child| child.parse::<u32>().ok())),
+            Err(_) if !task.path().exists() => continue,
+            Err(_) => return None,
+        }
+    }
+    Some(children)
+}
+
+impl ChildWorker {
+    fn spawn(pid: u32, parent_pid: u32, shared: Arc<Shared>) -> Self {
+        let session_id = Uuid::new_v4();
+        let info = Arc::new(Mutex::new(ChildSessionInfo {
+            session_id,
+            pid,
+            parent_pid,
+            state: "Attaching".to_string(),
+            stop_reason: None,
+            breakpoints: 0,
+            attach_ms: 0,
+            error: None,
+        }));
+
+        shared.sessions.lock().unwrap().insert(session_id, DebuggingSession {
+            id: session_id,
+            target_path: std::fs::read_link(format!("/proc/{}/exe", pid))
+                .ok()
+                .map(|path| path.to_string_lossy().into_owned()),
+            process_id: Some(pid),
+            state: SessionState::Created,
+            created_at: SystemTime::now(),
+        });
+
+        let (commands, command_rx) = mpsc::channel();
+        let worker_info = info.clone();
+        let handle = std::thread::Builder::new()
+            .name(format!("fork-child-{}", pid))
+            .spawn(move || {
+                let final_state = match Self::run(pid, &worker_info, &shared, command_rx) {
+                    Ok(state) => state,
+                    Err(e) => {
+                        warn!("Child session for PID {} failed: {}", pid, e);
+                        let mut info = worker_info.lock().unwrap();
+                        info.state = "Failed".to_string();
+                        info.error = Some(e.to_string());
+                        SessionState::Terminated
+                    }
+                };
+                if let Some(session) = shared.sessions.lock().unwrap().get_mut(&session_id) {
+                    session.state = final_state;
+                }
+            })
+            .ok();
+
+        Self { info, commands, handle }
+    }
+
+    /// Attach to the child and service commands until it exits or is released
+    fn run(
+        pid: u32,
+        info: &Mutex<ChildSessionInfo>,
+        shared: &Shared,
+        commands: Receiver<(ChildCommand, CommandReply)>,
+    ) -> IncodeResult<SessionState> {
+        let started = Instant::now();
+        let debugger = unsafe { SBDebuggerCreate() };
+        if debugger.is_null() {
+            return Err(IncodeError::lldb_init("Failed to create debugger for child"));
+        }
+        let result = Self::debug_child(debugger, pid, started, info, shared, &commands);
+        unsafe { SBDebuggerDestroy(debugger) };
+        result
+    }
+
+    fn debug_child(
+        debugger: SBDebuggerRef,
+        pid: u32,
+        started: Instant,
+        info: &Mutex<ChildSessionInfo>,
+        shared: &Shared,
+        commands: &Receiver<(ChildCommand, CommandReply)>,
+    ) -> IncodeResult<SessionState> {
+        unsafe { SBDebuggerSetAsync(debugger, false) };
+
+        let target = unsafe { SBDebuggerCreateTarget2(debugger, std::ptr::null()) };
+        if target.is_null() {
+            return Err(IncodeError::lldb_op("Failed to create target for child"));
+        }
+
+        let attach_info = unsafe { CreateSBAttachInfo() };
+        unsafe { SBAttachInfoSetProcessID(attach_info, pid as lldb_pid_t) };
+        let error = unsafe { CreateSBError() };
+        let process = unsafe { SBTargetAttach(target, attach_info, error) };
+        let attach_error = if process.is_null() || unsafe { SBErrorFail(error) } {
+            Some(sb_error_message(error))
+        } else {
+            None
+        };
+        unsafe {
+            DisposeSBError(error);
+            DisposeSBAttachInfo(attach_info);
+        }
+        if let Some(message) = attach_error {
+            unsafe { SBDebuggerDeleteTarget(debugger, target) };
+            return Err(IncodeError::process_not_found(format!("Failed to attach to child {}: {}", pid, message)));
+        }
+
+        // Breakpoints are resolved against the child's own modules once attached
+        let breakpoints = if shared.breakpoints_file.exists() {
+            load_breakpoints(target, &shared.breakpoints_file)
+        } else {
+            0
+        };
+
+        {
+            let mut info = info.lock().unwrap();
+            info.state = state_name(unsafe { SBProcessGetState(process) }).to_string();
+            info.breakpoints = breakpoints;
+            info.attach_ms = started.elapsed().as_millis() as u64;
+        }
+        info!("Attached to child {} with {} breakpoints", pid, breakpoints);
+
+        // From here the child runs on its own; events are collected below
+        unsafe { SBDebuggerSetAsync(debugger, true) };
+        let listener = unsafe { SBDebuggerGetListener(debugger) };
+        let event = unsafe { CreateSBEvent() };
+        unsafe { SBProcessContinue(process) };
+
+        let outcome = loop {
+            if shared.stop.load(Ordering::SeqCst) {
+                unsafe { SBProcessDetach(process) };
+                break SessionState::Created;
+            }
+
+            match commands.recv_timeout(ForkFollower::WORKER_TICK) {
+                Ok((command, reply)) => {
+                    let error = unsafe {
+                        match command {
+                            ChildCommand::Continue => SBProcessContinue(process),
+                            ChildCommand::Interrupt => SBProcessStop(process),
+                            ChildCommand::Kill => SBProcessKill(process),
+                            ChildCommand::Detach => SBProcessDetach(process),
+                        }
+                    };
+                    let result = if !error.is_null() && unsafe { SBErrorFail(error) } {
+                        Err(IncodeError::lldb_op(sb_error_message(error)))
+                    } else {
+                        Ok(())
+                    };
+                    if !error.is_null() {
+                        unsafe { DisposeSBError(error) };
+                    }
+                    let _ = reply.send(result);
+
+                    match command {
+                        ChildCommand::Kill => break SessionState::Terminated,
+                        ChildCommand::Detach => break SessionState::Created,
+                        _ => {}
+                    }
+                }
+                Err(RecvTimeoutError::Disconnected) => {
+                    unsafe { SBProcessDetach(process) };
+                    break SessionState::Created;
+                }
+                Err(RecvTimeoutError::Timeout) => {}
+            }
+
+            while !listener.is_null() && unsafe { SBListenerWaitForEvent(listener, 0, event) } {
+                if unsafe { SBProcessEventIsProcessEvent(event) } {
+                    Self::record_state(process, unsafe { SBProcessGetStateFromEvent(event) }, info);
+                }
+            }
+
+            let state = unsafe { SBProcessGetState(process) };
+            if matches!(state, StateType::Exited | StateType::Detached | StateType::Invalid) {
+                Self::record_state(process, state, info);
+                break SessionState::Terminated;
+            }
+        };
+
+        unsafe {
+            DisposeSBEvent(event);
+            DisposeSBProcess(process);
+            DisposeSBTarget(target);
+        }
+        Ok(outcome)
+    }
+
+    fn record_state(process: SBProcessRef, state: StateType, info: &Mutex<ChildSessionInfo>) {
+        let stop_reason = if state == StateType::Stopped || state == StateType::Crashed {
+            let thread = unsafe { SBProcessGetSelectedThread(process) };
+            if thread.is_null() {
+                None
+            } else {
+                Some(format!("{:?}", unsafe { SBThreadGetStopReason(thread) }))
+            }
+        } else {
+            None
+        };
+
+        let mut info = info.lock().unwrap();
+        info.state = state_name(state).to_string();
+        info.stop_reason = stop_reason;
+    }
+}
+
+/// Serialize all breakpoints of `target` so children can re-create them
+pub fn save_breakpoints(target: SBTargetRef, path: &Path) -> IncodeResult<()> {
+    let path_cstr = std::ffi::CString::new(path.to_string_lossy().as_bytes())
+        .map_err(|_| IncodeError::lldb_op("Invalid breakpoint file path"))?;
+    let file_spec = unsafe { CreateSBFileSpec2(path_cstr.as_ptr()) };
+    let error = unsafe { SBTargetBreakpointsWriteToFile(target, file_spec) };
+    let result = if !error.is_null() && unsafe { SBErrorFail(error) } {
+        Err(IncodeError::breakpoint(format!("Failed to save breakpoints: {}", sb_error_message(error))))
+    } else {
+        Ok(())
+    };
+    unsafe {
+        if !error.is_null() {
+            DisposeSBError(error);
+        }
+        DisposeSBFileSpec(file_spec);
+    }
+    result
+}
+
+/// Re-create serialized breakpoints in `target`, returning how many were added
+fn load_breakpoints(target: SBTargetRef, path: &Path) -> u32 {
+    let Ok(path_cstr) = std::ffi::CString::new(path.to_string_lossy().as_bytes()) else {
+        return 0;
+    };
+    unsafe {
+        let file_spec = CreateSBFileSpec2(path_cstr.as_ptr());
+        let new_breakpoints = CreateSBBreakpointList(target);
+        let error = SBTargetBreakpointsCreateFromFile(target, file_spec, new_breakpoints);
+        if !error.is_null() && SBErrorFail(error) {
+            warn!("Failed to load inherited breakpoints: {}", sb_error_message(error));
+        }
+        let count = SBBreakpointListGetSize(new_breakpoints) as u32;
+        if !error.is_null() {
+            DisposeSBError(error);
+        }
+        DisposeSBBreakpointList(new_breakpoints);
+        DisposeSBFileSpec(file_spec);
+        count
+    }
+}
@@ -0,0 +1,470 @@
+// Per-function control-flow graphs
+//
+// A function is decoded whole (bounds from its symbol), cut into basic blocks
+// at branch targets and after every branch, and annotated with immediate
+// dominators and natural loops. Graphs are position independent: block
+// offsets are relative to the function start, so one graph serves every run
+// of the same build and is cached by build ID.
+
+use std::collections::BTreeSet;
+use std::sync::Mutex;
+
+use serde_json::{json, Value};
+
+use crate::disassembly::Instruction;
+
+/// How control leaves an instruction
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Flow {
+    Normal,
+    Call,
+    Return,
+    Jump,
+    ConditionalJump,
+    IndirectJump,
+    Halt,
+}
+
+/// Classify by mnemonic; x86 and AArch64 spellings
+pub fn flow(mnemonic: &str, has_target: bool) -> Flow {
+    let mnemonic = mnemonic.to_ascii_lowercase();
+    let mnemonic = mnemonic
+        .trim_start_matches("notrack ")
+        .trim_start_matches("bnd ")
+        .trim_start_matches("rep ");
+    match mnemonic {
+        "ret" | "retq" | "retn" | "retf" | "iret" | "iretq" | "retaa" | "retab" | "eret" => Flow::Return,
+        "hlt" | "ud2" | "ud1" | "int3" | "brk" | "udf" => Flow::Halt,
+        "jmp" | "jmpq" | "b" => if has_target { Flow::Jump } else { Flow::IndirectJump },
+        "br" | "braa" | "brab" | "braaz" | "brabz" => Flow::IndirectJump,
+        "bl" | "blr" | "blraa" | "blrab" | "blraaz" | "blrabz" => Flow::Call,
+        "cbz" | "cbnz" | "tbz" | "tbnz" => Flow::ConditionalJump,
+        _ if mnemonic.starts_with("call") => Flow::Call,
+        _ if mnemonic.starts_with('j') || mnemonic.starts_with("loop") => Flow::ConditionalJump,
+        _ if mnemonic.starts_with("b.") || mnemonic.starts_with("bc.") => Flow::ConditionalJump,
+        _ => Flow::Normal,
+    }
+}
+
+/// How a block ends
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum BlockEnd {
+    /// Runs into the next block
+    Fallthrough,
+    Jump,
+    /// Successors are [taken, fallthrough]
+    Conditional,
+    Return,
+    /// Jump through a register or memory, e.g. a switch table
+    Indirect,
+    /// Jump out of the function
+    TailCall,
+    Halt,
+}
+
+impl BlockEnd {
+    pub fn name(self) -> &'static str {
+        match self {
+            BlockEnd::Fallthrough => "fallthrough",
+            BlockEnd::Jump => "jump",
+            BlockEnd::Conditional => "cond",
+            BlockEnd::Return => "return",
+            BlockEnd::Indirect => "indirect",
+            BlockEnd::TailCall => "tail_call",
+            BlockEnd::Halt => "halt",
+        }
+    }
+}
+
+#[derive(Debug, Clone, PartialEq)]
+pub struct BasicBlock {
+    /// Offset from the function start
+    pub start: u64,
+    pub end: u64,
+    pub instructions: usize,
+    pub end_kind: BlockEnd,
+    pub successors: Vec<usize>,
+    pub calls: usize,
+}
+
+/// A natural loop
+#[derive(Debug, Clone, PartialEq)]
+pub struct Loop {
+    pub header: usize,
+    /// Blocks with a back edge to the header
+    pub latches: Vec<usize>,
+    pub blocks: Vec<usize>,
+    /// 1 for outermost loops
+    pub depth: usize,
+}
+
+#[derive(Debug, Clone)]
+pub struct FunctionCfg {
+    pub name: Option<String>,
+    /// GNU build ID or UUID of the containing module
+    pub build_id: Option<String>,
+    pub size: u64,
+    pub blocks: Vec<BasicBlock>,
+    /// Immediate dominator per block; None for the entry and unreachable blocks
+    pub idom: Vec<Option<usize>>,
+    pub loops: Vec<Loop>,
+}
+
+impl FunctionCfg {
+    /// Split decoded instructions (addresses relative to the function start)
+    /// into blocks and analyse them
+    pub fn build(name: Option<String>, build_id: Option<String>, size: u64, instructions: &[Instruction]) -> Self {
+        let in_function = |target: u64| target < size;
+        // Jumps through memory ("jmp [rip + x]") carry the slot's address, not a destination
+        let direct = |instruction: &Instruction| instruction.target.filter(|_| !instruction.operands.contains('['));
+
+        // Leaders: the entry, every in-function branch target, and whatever follows a block end
+        let mut leaders = BTreeSet::new();
+        leaders.insert(0);
+        for instruction in instructions {
+            let kind = flow(&instruction.mnemonic, direct(instruction).is_some());
+            let next = instruction.address + instruction.size as u64;
+            match kind {
+                Flow::Jump | Flow::ConditionalJump => {
+                    if let Some(target) = direct(instruction).filter(|target| in_function(*target)) {
+                        leaders.insert(target);
+                    }
+                    leaders.insert(next);
+                }
+                Flow::Return | Flow::IndirectJump | Flow::Halt => {
+                    leaders.insert(next);
+                }
+                Flow::Normal | Flow::Call => {}
+            }
+        }
+        // A target inside an instruction (overlapping code) cannot start a block
+        let starts: BTreeSet<u64> = instructions.iter().map(|instruction| instruction.address).collect();
+        leaders.retain(|leader| starts.contains(leader));
+
+        let mut blocks: Vec<BasicBlock> = Vec::new();
+        let mut targets: Vec<Option<u64>> = Vec::new();
+        for instruction in instructions {
+            if leaders.contains(&instruction.address) || blocks.is_empty() {
+                blocks.push(BasicBlock {
+                    start: instruction.address,
+                    end: instruction.address,
+                    instructions: 0,
+                    end_kind: BlockEnd::Fallthrough,
+                    successors: Vec::new(),
+                    calls: 0,
+                });
+                targets.push(None);
+            }
+            let block = blocks.last_mut().unwrap();
+            block.end = instruction.address + instruction.size as u64;
+            block.instructions += 1;
+            let target = direct(instruction);
+            block.end_kind = match flow(&instruction.mnemonic, target.is_some()) {
+                Flow::Jump if target.map_or(false, in_function) => BlockEnd::Jump,
+                Flow::Jump => BlockEnd::TailCall,
+                Flow::ConditionalJump => BlockEnd::Conditional,
+                Flow::Return => BlockEnd::Return,
+                Flow::IndirectJump => BlockEnd::Indirect,
+                Flow::Halt => BlockEnd::Halt,
+                Flow::Call => {
+                    block.calls += 1;
+                    BlockEnd::Fallthrough
+                }
+                Flow::Normal => BlockEnd::Fallthrough,
+            };
+            *targets.last_mut().unwrap() = target;
+        }
+
+        let index_of = |offset: u64| blocks.binary_search_by_key(&offset, |block| block.start).ok();
+        let successors: Vec<Vec<usize>> = blocks.iter().zip(&targets).enumerate().map(|(index, (block, target))| {
+            let taken = target.filter(|target| in_function(*target)).and_then(index_of);
+            let next = (index + 1 < blocks.len() && blocks[index + 1].start == block.end).then_some(index + 1);
+            match block.end_kind {
+                BlockEnd::Fallthrough => next.into_iter().collect(),
+                BlockEnd::Jump => taken.into_iter().collect(),
+                BlockEnd::Conditional => taken.into_iter().chain(next).collect(),
+                _ => Vec::new(),
+            }
+        }).collect();
+        for (block, successors) in blocks.iter_mut().zip(successors) {
+            block.successors = successors;
+        }
+
+        let idom = dominators(&blocks);
+        let loops = natural_loops(&blocks, &idom);
+        Self { name, build_id, size, blocks, idom, loops }
+    }
+
+    pub fn edge_count(&self) -> usize {
+        self.blocks.iter().map(|block| block.successors.len()).sum()
+    }
+
+    pub fn max_loop_depth(&self) -> usize {
+        self.loops.iter().map(|l| l.depth).max().unwrap_or(0)
+    }
+
+    pub fn approx_bytes(&self) -> usize {
+        std::mem::size_of::<Self>()
+            + self.name.as_ref().map_or(0, String::len)
+            + self.build_id.as_ref().map_or(0, String::len)
+            + self.blocks.iter().map(|block| std::mem::size_of::<BasicBlock>() + block.successors.len() * 8).sum::<usize>()
+            + self.idom.len() * 16
+            + self.loops.iter().map(|l| std::mem::size_of::<Loop>() + (l.blocks.len() + l.latches.len()) * 8).sum::<usize>()
+    }
+
+    /// One-line summary, for bulk module requests
+    pub fn summary_json(&self, base: u64) -> Value {
+        json!({
+            "function": self.name,
+            "start": format!("0x{:x}", base),
+            "size": self.size,
+            "blocks": self.blocks.len(),
+            "edges": self.edge_count(),
+            "loops": self.loops.len(),
+            "max_loop_depth": self.max_loop_depth()
+        })
+    }
+
+    /// Compact graph placed at load address `base`: blocks as
+    /// [start, size, instructions, end kind, successors]
+    pub fn to_json(&self, base: u64) -> Value {
+        let blocks: Vec<Value> = self.blocks.iter()
+            .map(|block| json!([
+                format!("0x{:x}", base + block.start),
+                block.end - block.start,
+                block.instructions,
+                block.end_kind.name(),
+                block.successors
+            ]))
+            .collect();
+        let loops: Vec<Value> = self.loops.iter()
+            .map(|l| json!({ "header": l.header, "latches": l.latches, "blocks": l.blocks, "depth": l.depth }))
+            .collect();
+        json!({
+            "function": self.name,
+            "build_id": self.build_id,
+            "start": format!("0x{:x}", base),
+            "end": format!("0x{:x}", base + self.size),
+            "block_format": ["start", "size", "instructions", "end", "successors"],
+            "blocks": blocks,
+            "edges": self.edge_count(),
+            "idom": self.idom,
+            "loops": loops,
+            "exits": self.blocks.iter().enumerate()
+                .filter(|(_, block)| matches!(block.end_kind, BlockEnd::Return | BlockEnd::TailCall))
+                .map(|(index, _)| index)
+                .collect::<Vec<_>>()
+        })
+    }
+}
+
+/// Blocks reachable from the entry in reverse postorder
+fn reverse_postorder(blocks: &[BasicBlock]) -> Vec<usize> {
+    let mut order = Vec::with_capacity(blocks.len());
+    if blocks.is_empty() {
+        return order;
+    }
+    let mut visited = vec![false; blocks.len()];
+    let mut stack = vec![(0usize, 0usize)];
+    visited[0] = true;
+    while let Some((block, next)) = stack.last_mut() {
+        if let Some(&successor) = blocks[*block].successors.get(*next) {
+            *next += 1;
+            if !visited[successor] {
+                visited[successor] = true;
+                stack.push((successor, 0));
+            }
+        } else {
+            order.push(*block);
+            stack.pop();
+        }
+    }
+    order.reverse();
+    order
+}
+
+/// Immediate dominators (Cooper, Harvey and Kennedy's iterative algorithm)
+pub fn dominators(blocks: &[BasicBlock]) -> Vec<Option<usize>> {
+    let order = reverse_postorder(blocks);
+    let mut rank = vec![usize::MAX; blocks.len()];
+    for (position, &block) in order.iter().enumerate() {
+        rank[block] = position;
+    }
+    let mut predecessors = vec![Vec::new(); blocks.len()];
+    for (index, block) in blocks.iter().enumerate() {
+        for &successor in &block.successors {
+            predecessors[successor].push(index);
+        }
+    }
+
+    let mut idom: Vec<Option<usize>> = vec![None; blocks.len()];
+    if order.is_empty() {
+        return idom;
+    }
+    idom[0] = Some(0);
+    let intersect = |idom: &[Option<usize>], mut a: usize, mut b: usize| {
+        while a != b {
+            while rank[a] > rank[b] {
+                a = idom[a].unwrap();
+            }
+            while rank[b] > rank[a] {
+                b = idom[b].unwrap();
+            }
+        }
+        a
+    };
+    let mut changed = true;
+    while changed {
+        changed = false;
+        for &block in order.iter().skip(1) {
+            let mut new_idom = None;
+            for &predecessor in &predecessors[block] {
+                if idom[predecessor].is_none() {
+                    continue;
+                }
+                new_idom = Some(match new_idom {
+                    None => predecessor,
+                    Some(current) => intersect(&idom, predecessor, current),
+                });
+            }
+            if new_idom.is_some() && idom[block] != new_idom {
+                idom[block] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    idom[0] = None;
+    idom
+}
+
+fn dominates(idom: &[Option<usize>], a: usize, mut b: usize) -> bool {
+    loop {
+        if a == b {
+            return true;
+        }
+        match idom[b] {
+            Some(parent) => b = parent,
+            None => return false,
+        }
+    }
+}
+
+/// Natural loops from back edges (edges to a dominator), one per header
+pub fn natural_loops(blocks: &[BasicBlock], idom: &[Option<usize>]) -> Vec<Loop> {
+    let reachable = |block: usize| block == 0 || idom[block].is_some();
+    let mut predecessors = vec![Vec::new(); blocks.len()];
+    for (index, block) in blocks.iter().enumerate() {
+        for &successor in &block.successors {
+            predecessors[successor].push(index);
+        }
+    }
+
+    let mut loops: Vec<Loop> = Vec::new();
+    for (latch, block) in blocks.iter().enumerate() {
+        if !reachable(latch) {
+            continue;
+        }
+        for &header in &block.successors {
+            if !dominates(idom, header, latch) {
+                continue;
+            }
+            let position = match loops.iter().position(|l| l.header == header) {
+                Some(position) => position,
+                None => {
+                    loops.push(Loop { header, latches: Vec::new(), blocks: vec![header], depth: 0 });
+                    loops.len() - 1
+                }
+            };
+            let found = &mut loops[position];
+            found.latches.push(latch);
+            let mut stack = vec![latch];
+            while let Some(member) = stack.pop() {
+                if found.blocks.contains(&member) {
+                    continue;
+                }
+                found.blocks.push(member);
+                stack.extend(predecessors[member].iter().copied().filter(|p| reachable(*p)));
+            }
+        }
+    }
+    for l in &mut loops {
+        l.blocks.sort_unstable();
+    }
+    let depths: Vec<usize> = loops.iter()
+        .map(|inner| loops.iter().filter(|outer| outer.blocks.binary_search(&inner.header).is_ok()).count())
+        .collect();
+    for (l, depth) in loops.iter_mut().zip(depths) {
+        l.depth = depth;
+    }
+    loops.sort_by_key(|l| l.header);
+    loops
+}
+
+/// Build many graphs on all cores; LLDB decoding has already happened on the
+/// caller's thread, this is the pure analysis
+pub fn build_parallel(functions: Vec<(Option<String>, Option<String>, u64, Vec<Instruction>)>) -> Vec<FunctionCfg> {
+    let workers = std::thread::available_parallelism().map(|n| n.get()).unwrap_or(1).min(functions.len().max(1));
+    let queue = Mutex::new(functions.into_iter().enumerate().collect::<Vec<_>>());
+    let results = Mutex::new(Vec::new());
+    std::thread::scope(|scope| {
+        for _ in 0..workers {
+            scope.spawn(|| loop {
+                let Some((index, (name, build_id, size, instructions))) = queue.lock().unwrap().pop() else {
+                    break;
+                };
+                let cfg = FunctionCfg::build(name, build_id, size, &instructions);
+                results.lock().unwrap().push((index, cfg));
+            });
+        }
+    });
+    let mut results = results.into_inner().unwrap();
+    results.sort_by_key(|(index, _)| *index);
+    results.into_iter().map(|(_, cfg)| cfg).collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_function_cfg_blocks_dominators_and_loops() {
+        let instruction = |address: u64, size: u32, mnemonic: &str, operands: &str, target: Option<u64>| Instruction {
+            address,
+            size,
+            mnemonic: mnemonic.to_string(),
+            operands: operands.to_string(),
+            comment: None,
+            target,
+            symbol: None,
+        };
+        // while (i < n) { i += f(i); } return i;
+        let instructions = vec![
+            instruction(0, 2, "xor", "eax, eax", None),
+            instruction(2, 2, "cmp", "eax, edi", None),
+            instruction(4, 2, "jge", "0x10", Some(0x10)),
+            instruction(6, 2, "mov", "edi, eax", None),
+            instruction(8, 5, "call", "0x999", Some(0x999)),
+            instruction(13, 3, "jmp", "0x2", Some(0x2)),
+            instruction(16, 1, "ret", "", None),
+        ];
+        let cfg = FunctionCfg::build(Some("loop".to_string()), None, 17, &instructions);
+
+        let starts: Vec<u64> = cfg.blocks.iter().map(|block| block.start).collect();
+        assert_eq!(starts, vec![0, 2, 6, 16]);
+        assert_eq!(cfg.blocks[1].end_kind, BlockEnd::Conditional);
+        assert_eq!(cfg.blocks[1].successors, vec![3, 2], "Conditional successors are [taken, fallthrough]");
+        assert_eq!(cfg.blocks[2].successors, vec![1]);
+        assert_eq!(cfg.blocks[2].calls, 1);
+        assert_eq!(cfg.blocks[3].end_kind, BlockEnd::Return);
+        assert_eq!(cfg.idom, vec![None, Some(0), Some(1), Some(1)]);
+
+        assert_eq!(cfg.loops.len(), 1);
+        assert_eq!(cfg.loops[0].header, 1);
+        assert_eq!(cfg.loops[0].latches, vec![2]);
+        assert_eq!(cfg.loops[0].blocks, vec![1, 2]);
+        assert_eq!(cfg.loops[0].depth, 1);
+
+        let graph = cfg.to_json(0x401000);
+        assert_eq!(graph["blocks"][1][0], "0x401002");
+    }
+}
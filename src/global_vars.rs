@@ -0,0 +1,514 @@
+// Global and static variable enumeration
+//
+// Globals are enumerated once per module build from the debug info and kept
+// as a data layout: each variable's name, canonical type, size and file
+// address, plus the data sections (.data, .bss and friends) they live in.
+// Values are never fetched one SBValue at a time. A page of globals is
+// sorted by address and read as one bulk read per data section it touches,
+// so a module with 50k globals costs a handful of reads however many of
+// them are shown. Without a live process, initialised data comes from the
+// object file and zero-fill sections decode as zeros without a read.
+
+use std::collections::{HashMap, HashSet};
+use std::ffi::CStr;
+
+use lldb_sys::*;
+use serde_json::{json, Value};
+
+use crate::session_snapshot;
+use crate::stl_decode::{self, CountingReader, MemoryReader, TypeInfo};
+
+/// Globals decoded per request by default
+pub const DEFAULT_PAGE: usize = 200;
+/// Globals decoded per request at most
+pub const MAX_PAGE: usize = 5_000;
+/// Largest single bulk read; a bigger section span is split
+const MAX_RUN_BYTES: u64 = 8 * 1024 * 1024;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Storage {
+    Global,
+    Static,
+}
+
+impl Storage {
+    pub fn name(self) -> &'static str {
+        match self {
+            Storage::Global => "global",
+            Storage::Static => "static",
+        }
+    }
+}
+
+/// A section holding global data, in file addresses
+#[derive(Debug, Clone)]
+pub struct DataSection {
+    pub name: String,
+    pub file_address: u64,
+    pub size: u64,
+    /// .bss and the like: no file contents, zero at load
+    pub zero_fill: bool,
+}
+
+impl DataSection {
+    fn contains(&self, address: u64, size: u64) -> bool {
+        address >= self.file_address && address + size <= self.file_address + self.size
+    }
+}
+
+/// Where one global lives and how to decode it
+#[derive(Debug, Clone)]
+pub struct GlobalSlot {
+    pub name: String,
+    pub type_info: TypeInfo,
+    pub file_address: u64,
+    pub storage: Storage,
+    /// Index into the module's data sections, None when outside all of them
+    pub section: Option<usize>,
+}
+
+/// The globals of one module build, sorted by file address
+#[derive(Debug, Clone)]
+pub struct ModuleGlobals {
+    pub path: String,
+    pub uuid: Option<String>,
+    pub sections: Vec<DataSection>,
+    pub slots: Vec<GlobalSlot>,
+}
+
+impl ModuleGlobals {
+    pub fn new(path: String, uuid: Option<String>, sections: Vec<DataSection>, mut slots: Vec<GlobalSlot>) -> Self {
+        for slot in &mut slots {
+            let size = slot.type_info.size.max(1) as u64;
+            slot.section = sections.iter().position(|section| section.contains(slot.file_address, size));
+        }
+        slots.sort_by(|a, b| a.file_address.cmp(&b.file_address).then_with(|| a.name.cmp(&b.name)));
+        // A variable declared in several compile units is found once per unit
+        slots.dedup_by(|a, b| a.file_address == b.file_address && a.name == b.name);
+        Self { path, uuid, sections, slots }
+    }
+
+    pub fn file_name(&self) -> &str {
+        self.path.rsplit('/').next().unwrap_or(&self.path)
+    }
+
+    /// A module filter matches the file name or any part of the path
+    pub fn matches(&self, module_filter: &str) -> bool {
+        self.file_name() == module_filter || self.path.contains(module_filter)
+    }
+
+    pub fn approx_bytes(&self) -> usize {
+        self.path.len()
+            + self.uuid.as_ref().map_or(0, String::len)
+            + self.sections.iter().map(|section| section.name.len() + 40).sum::<usize>()
+            + self.slots.iter().map(|slot| slot.name.len() + slot.type_info.name.len() + 80).sum::<usize>()
+    }
+}
+
+/// Which globals a query wants
+#[derive(Debug, Clone, Default)]
+pub struct GlobalFilter {
+    pub module: Option<String>,
+    pub name: Option<String>,
+    pub include_static: bool,
+}
+
+impl GlobalFilter {
+    fn accepts(&self, slot: &GlobalSlot) -> bool {
+        (self.include_static || slot.storage == Storage::Global)
+            && self.name.as_deref().map_or(true, |pattern| slot.name.contains(pattern))
+    }
+}
+
+/// One module's layout as mapped in the target
+pub struct ModuleImage<'a> {
+    pub globals: &'a ModuleGlobals,
+    /// Load address minus file address; 0 when reading from the object file
+    pub slide: u64,
+    pub memory: &'a dyn MemoryReader,
+    /// Reading a live process rather than the object file
+    pub live: bool,
+}
+
+#[derive(Debug, Clone)]
+pub struct GlobalValue {
+    pub module: String,
+    pub name: String,
+    pub type_name: String,
+    pub storage: Storage,
+    pub address: u64,
+    pub size: usize,
+    pub section: Option<String>,
+    pub value: Value,
+}
+
+impl GlobalValue {
+    /// The value as text, strings quoted the way LLDB prints them
+    pub fn display(&self) -> String {
+        match &self.value {
+            Value::String(text) => format!("{:?}", text),
+            Value::Object(object) if object.contains_key("error") => {
+                format!("<{}>", object["error"].as_str().unwrap_or("unreadable"))
+            }
+            Value::Object(_) => format!("{{...}} @ 0x{:x}", self.address),
+            other => other.to_string(),
+        }
+    }
+
+    pub fn to_json(&self) -> Value {
+        json!({
+            "name": self.name,
+            "type": self.type_name,
+            "value": self.value,
+            "scope": self.storage.name(),
+            "module": self.module,
+            "section": self.section,
+            "address": format!("0x{:x}", self.address),
+            "size": self.size,
+        })
+    }
+}
+
+/// A page of globals across the matched modules
+#[derive(Debug, Clone)]
+pub struct GlobalsPage {
+    /// Matching globals across all modules, before paging
+    pub total: usize,
+    pub offset: usize,
+    pub globals: Vec<GlobalValue>,
+    pub modules: Vec<String>,
+    pub reads: usize,
+    pub bytes_read: usize,
+}
+
+impl GlobalsPage {
+    pub fn has_more(&self) -> bool {
+        self.offset + self.globals.len() < self.total
+    }
+}
+
+/// Consecutive slots of one section read together
+struct Run {
+    section: usize,
+    start: u64,
+    end: u64,
+    slots: Vec<usize>,
+}
+
+/// Group `slots` (indexes into `globals.slots`, ascending by address) into
+/// one run per section, split where a span would exceed MAX_RUN_BYTES
+fn plan_runs(globals: &ModuleGlobals, slots: &[usize]) -> Vec<Run> {
+    let mut runs: Vec<Run> = Vec::new();
+    for &index in slots {
+        let slot = &globals.slots[index];
+        let Some(section) = slot.section else {
+            continue;
+        };
+        let end = slot.file_address + slot.type_info.size.max(1) as u64;
+        match runs.last_mut() {
+            Some(run) if run.section == section && end - run.start <= MAX_RUN_BYTES => {
+                run.end = run.end.max(end);
+                run.slots.push(index);
+            }
+            _ => runs.push(Run { section, start: slot.file_address, end, slots: vec![index] }),
+        }
+    }
+    runs
+}
+
+/// Decode the globals matching `filter`, skipping `offset` of them and
+/// returning at most `limit`, with one bulk read per section run
+pub fn read_page(images: &[ModuleImage], filter: &GlobalFilter, offset: usize, limit: usize) -> GlobalsPage {
+    let limit = limit.clamp(1, MAX_PAGE);
+    let mut page = GlobalsPage { total: 0, offset, globals: Vec::new(), modules: Vec::new(), reads: 0, bytes_read: 0 };
+
+    for image in images {
+        let globals = image.globals;
+        if filter.module.as_deref().map_or(false, |module| !globals.matches(module)) {
+            continue;
+        }
+        page.modules.push(globals.path.clone());
+        let matching: Vec<usize> = (0..globals.slots.len()).filter(|&i| filter.accepts(&globals.slots[i])).collect();
+        let skip = offset.saturating_sub(page.total).min(matching.len());
+        page.total += matching.len();
+        let room = limit - page.globals.len();
+        if room == 0 || skip == matching.len() {
+            continue;
+        }
+        let wanted = &matching[skip..(skip + room).min(matching.len())];
+
+        let memory = CountingReader::new(image.memory);
+        let mut values: HashMap<usize, Value> = HashMap::new();
+        for run in plan_runs(globals, wanted) {
+            let size = (run.end - run.start) as usize;
+            let bytes = if globals.sections[run.section].zero_fill && !image.live {
+                Some(vec![0u8; size])
+            } else {
+                memory.read(run.start.wrapping_add(image.slide), size)
+            };
+            for index in run.slots {
+                let slot = &globals.slots[index];
+                let address = slot.file_address.wrapping_add(image.slide);
+                let value = match &bytes {
+                    Some(bytes) => {
+                        let start = (slot.file_address - run.start) as usize;
+                        stl_decode::decode_element(&memory, &slot.type_info, &bytes[start..start + slot.type_info.size], address)
+                    }
+                    None => json!({ "address": format!("0x{:x}", address), "error": "memory not readable" }),
+                };
+                values.insert(index, value);
+            }
+        }
+        page.reads += memory.reads.get();
+        page.bytes_read += memory.bytes.get();
+
+        for &index in wanted {
+            let slot = &globals.slots[index];
+            let address = slot.file_address.wrapping_add(image.slide);
+            let value = values.remove(&index)
+                .unwrap_or_else(|| json!({ "address": format!("0x{:x}", address), "error": "not in a data section" }));
+            page.globals.push(GlobalValue {
+                module: globals.file_name().to_string(),
+                name: slot.name.clone(),
+                type_name: slot.type_info.name.clone(),
+                storage: slot.storage,
+                address,
+                size: slot.type_info.size,
+                section: slot.section.map(|section| globals.sections[section].name.clone()),
+                value,
+            });
+        }
+    }
+    page
+}
+
+// LLDB side
+
+/// Reads a module's object file contents by file address
+pub(crate) struct FileMemory {
+    pub target: SBTargetRef,
+    pub module: SBModuleRef,
+}
+
+impl MemoryReader for FileMemory {
+    fn read(&self, address: u64, size: usize) -> Option<Vec<u8>> {
+        let resolved = unsafe { SBModuleResolveFileAddress(self.module, address) };
+        if resolved.is_null() {
+            return None;
+        }
+        let mut buffer = vec![0u8; size];
+        let error = unsafe { CreateSBError() };
+        let read = unsafe { SBTargetReadMemory(self.target, resolved, buffer.as_mut_ptr() as *mut std::ffi::c_void, size, error) };
+        unsafe {
+            DisposeSBError(error);
+            DisposeSBAddress(resolved);
+        }
+        buffer.truncate(read);
+        (read > 0).then_some(buffer)
+    }
+}
+
+fn c_text(ptr: *const std::os::raw::c_char) -> Option<String> {
+    if ptr.is_null() {
+        return None;
+    }
+    let text = unsafe { CStr::from_ptr(ptr) }.to_string_lossy().into_owned();
+    (!text.is_empty()).then_some(text)
+}
+
+fn collect_data_sections(section: SBSectionRef, out: &mut Vec<DataSection>) {
+    let children = unsafe { SBSectionGetNumSubSections(section) };
+    if children > 0 {
+        for i in 0..children {
+            let child = unsafe { SBSectionGetSubSectionAtIndex(section, i) };
+            if !child.is_null() {
+                collect_data_sections(child, out);
+            }
+        }
+        return;
+    }
+    let zero_fill = match unsafe { SBSectionGetSectionType(section) } {
+        SectionType::ZeroFill => true,
+        SectionType::Data | SectionType::Data4 | SectionType::Data8 | SectionType::Data16
+            | SectionType::DataPointers | SectionType::DataCString | SectionType::DataCStringPointers
+            | SectionType::DataSymbolAddress | SectionType::Other => false,
+        _ => return,
+    };
+    let file_address = unsafe { SBSectionGetFileAddress(section) };
+    let size = unsafe { SBSectionGetByteSize(section) };
+    if file_address != u64::MAX && size > 0 {
+        let name = c_text(unsafe { SBSectionGetName(section) }).unwrap_or_default();
+        out.push(DataSection { name, file_address, size, zero_fill });
+    }
+}
+
+/// Data sections of a module, in file addresses
+pub(crate) fn data_sections(module: SBModuleRef) -> Vec<DataSection> {
+    let mut sections = Vec::new();
+    for i in 0..unsafe { SBModuleGetNumSections(module) } {
+        let section = unsafe { SBModuleGetSectionAtIndex(module, i) };
+        if !section.is_null() {
+            collect_data_sections(section, &mut sections);
+        }
+    }
+    sections.sort_by_key(|section| section.file_address);
+    sections
+}
+
+/// Cache key of a module build
+pub(crate) fn module_key(path: &str, uuid: Option<&str>) -> String {
+    session_snapshot::build_key(path, uuid)
+}
+
+/// The slot a looked-up global occupies, with the identity of its module
+fn slot_of(value: SBValueRef) -> Option<((String, Option<String>), GlobalSlot)> {
+    if value.is_null() {
+        return None;
+    }
+    let storage = match unsafe { SBValueGetValueType(value) } {
+        ValueType::VariableGlobal => Storage::Global,
+        ValueType::VariableStatic => Storage::Static,
+        // Thread-locals have no single address
+        _ => return None,
+    };
+    let name = c_text(unsafe { SBValueGetName(value) })?;
+    let type_info = stl_decode::type_info(unsafe { SBValueGetType(value) })?;
+    let address = unsafe { SBValueGetAddress(value) };
+    if address.is_null() {
+        return None;
+    }
+    let file_address = unsafe { SBAddressGetFileAddress(address) };
+    let identity = session_snapshot::module_identity(unsafe { SBAddressGetModule(address) });
+    unsafe { DisposeSBAddress(address) };
+    let identity = identity.filter(|_| file_address != u64::MAX)?;
+    Some((identity, GlobalSlot { name, type_info, file_address, storage, section: None }))
+}
+
+/// Globals and statics of the modules in `target` whose keys are in
+/// `wanted`, by module key. One regex lookup over the whole target whatever
+/// is wanted: LLDB has no per-module enumeration, and the lookup only builds
+/// values, it does not read them.
+pub(crate) fn enumerate(target: SBTargetRef, wanted: &HashSet<String>) -> HashMap<String, ModuleGlobals> {
+    let mut modules: HashMap<String, (String, Option<String>, Vec<GlobalSlot>, SBModuleRef)> = HashMap::new();
+    for i in 0..unsafe { SBTargetGetNumModules(target) } {
+        let module = unsafe { SBTargetGetModuleAtIndex(target, i) };
+        if let Some((path, uuid)) = session_snapshot::module_identity(module) {
+            let key = module_key(&path, uuid.as_deref());
+            if wanted.contains(&key) {
+                modules.insert(key, (path, uuid, Vec::new(), module));
+            }
+        }
+    }
+
+    let pattern = std::ffi::CString::new(".").unwrap();
+    let list = unsafe { SBTargetFindGlobalVariables2(target, pattern.as_ptr(), u32::MAX, MatchType::Regex) };
+    if !list.is_null() {
+        for i in 0..unsafe { SBValueListGetSize(list) } {
+            let Some(((path, uuid), slot)) = slot_of(unsafe { SBValueListGetValueAtIndex(list, i) }) else {
+                continue;
+            };
+            if let Some((_, _, slots, _)) = modules.get_mut(&module_key(&path, uuid.as_deref())) {
+                slots.push(slot);
+            }
+        }
+    }
+
+    modules.into_iter()
+        .map(|(key, (path, uuid, slots, module))| (key, ModuleGlobals::new(path, uuid, data_sections(module), slots)))
+        .collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::stl_decode::FakeMemory;
+
+    #[test]
+    fn test_global_layout_bulk_reads() {
+        let int = TypeInfo::new("int", 4);
+        let sections = vec![
+            DataSection { name: ".data".to_string(), file_address: 0x4000, size: 0x40000, zero_fill: false },
+            DataSection { name: ".bss".to_string(), file_address: 0x50000, size: 0x40000, zero_fill: true },
+        ];
+        // 50k globals, half initialised data and half bss, given out of order
+        let mut slots: Vec<GlobalSlot> = (0..50_000u64).rev().map(|i| {
+            let file_address = if i < 25_000 { 0x4000 + i * 4 } else { 0x50000 + (i - 25_000) * 4 };
+            let storage = if i % 10 == 0 { Storage::Static } else { Storage::Global };
+            GlobalSlot { name: format!("g_{}", i), type_info: int.clone(), file_address, storage, section: None }
+        }).collect();
+        slots.push(GlobalSlot { name: "g_ratio".to_string(), type_info: TypeInfo::new("double", 8), file_address: 0x3ff8, storage: Storage::Global, section: None });
+        slots.push(GlobalSlot { name: "g_1".to_string(), type_info: int.clone(), file_address: 0x4004, storage: Storage::Global, section: None });
+        let globals = ModuleGlobals::new("/usr/bin/app".to_string(), None, sections, slots);
+        assert_eq!(globals.slots.len(), 50_001, "duplicate declaration folded");
+        assert_eq!(globals.slots[0].section, None, "g_ratio lies before .data");
+
+        let mut bytes = vec![0u8; 0x90000];
+        for i in 0..25_000u32 {
+            let at = (i * 4) as usize;
+            bytes[at..at + 4].copy_from_slice(&(i as i32 * 3).to_le_bytes());
+        }
+        bytes[0x4c000..0x4c004].copy_from_slice(&7i32.to_le_bytes());
+        let slide = 0x7f00_0000_0000u64;
+        let mut memory = FakeMemory::default();
+        memory.put(0x4000 + slide, bytes.clone());
+        let live = [ModuleImage { globals: &globals, slide, memory: &memory, live: true }];
+        let all = GlobalFilter { include_static: true, ..Default::default() };
+
+        // A page spanning .data and .bss costs one read per section
+        let page = read_page(&live, &all, 24_990, 20);
+        assert_eq!(page.total, 50_001);
+        assert_eq!(page.globals.len(), 20);
+        assert!(page.has_more());
+        assert_eq!(page.reads, 2);
+        assert_eq!(page.globals[0].name, "g_24989");
+        assert_eq!(page.globals[0].value, json!(24_989 * 3));
+        assert_eq!(page.globals[0].section.as_deref(), Some(".data"));
+        assert_eq!(page.globals[0].address, 0x4000 + 24_989 * 4 + slide);
+        assert_eq!(page.globals[11].name, "g_25000");
+        assert_eq!(page.globals[11].section.as_deref(), Some(".bss"));
+        assert_eq!(page.globals[11].value, json!(7));
+
+        // Every global at once is still a read per section
+        memory.reads.set(0);
+        let page = read_page(&live, &all, 0, 50_001);
+        assert_eq!(page.globals.len(), MAX_PAGE);
+        assert_eq!(memory.reads.get(), 1);
+        assert!(page.globals[0].value.get("error").is_some(), "outside any data section");
+
+        // Name and storage filters, and a module filter that matches nothing
+        let filter = GlobalFilter { name: Some("g_2500".to_string()), include_static: false, ..Default::default() };
+        let page = read_page(&live, &filter, 0, 100);
+        assert!(page.globals.iter().all(|g| g.storage == Storage::Global && g.name.contains("g_2500")));
+        assert_eq!(page.total, 9, "g_2500 and g_25000 are static");
+        let filter = GlobalFilter { module: Some("libother.so".to_string()), include_static: true, ..Default::default() };
+        assert_eq!(read_page(&live, &filter, 0, 100).total, 0);
+        let filter = GlobalFilter { module: Some("app".to_string()), include_static: true, ..Default::default() };
+        assert_eq!(read_page(&live, &filter, 0, 1).total, 50_001);
+
+        // From the object file, .bss decodes as zeros without a read
+        memory.reads.set(0);
+        let mut file = FakeMemory::default();
+        file.put(0x4000, bytes);
+        let image = [ModuleImage { globals: &globals, slide: 0, memory: &file, live: false }];
+        let page = read_page(&image, &all, 30_000, 10);
+        assert_eq!(file.reads.get(), 0);
+        assert_eq!(page.globals[0].value, json!(0));
+        assert_eq!(page.globals[0].display(), "0");
+
+        // A C string global shows the text it points to
+        let version = ModuleGlobals::new(
+            "/usr/bin/app".to_string(),
+            None,
+            vec![DataSection { name: ".data".to_string(), file_address: 0x4000, size: 0x100, zero_fill: false }],
+            vec![GlobalSlot { name: "g_app_version".to_string(), type_info: TypeInfo::new("const char *", 8), file_address: 0x4000, storage: Storage::Global, section: None }],
+        );
+        let mut bytes = vec![0u8; 0x200];
+        bytes[..8].copy_from_slice(&0x4100u64.to_le_bytes());
+        bytes[0x100..0x106].copy_from_slice(b"1.0.0\0");
+        let mut file = FakeMemory::default();
+        file.put(0x4000, bytes);
+        let page = read_page(&[ModuleImage { globals: &version, slide: 0, memory: &file, live: false }], &all, 0, 10);
+        assert_eq!(page.globals[0].value, json!("1.0.0"));
+        assert_eq!(page.globals[0].display(), "\"1.0.0\"");
+    }
+}
@@ -1,9 +1,31 @@
 // InCode Library - Export modules for testing
 
+pub mod cache_manager;
+pub mod checkpoint;
+pub mod console_buffer;
+pub mod core_file;
+pub mod crash_db;
+pub mod crash_triage;
+pub mod disassembly;
 pub mod error;
+pub mod expression;
+pub mod fault_decode;
+pub mod fleet_snapshot;
+pub mod fork_follower;
+pub mod function_cfg;
+pub mod global_vars;
 pub mod lldb_manager;
 pub mod mcp_server;
+pub mod minidump;
+pub mod process_table;
+pub mod register_schema;
+pub mod session_snapshot;
+pub mod stl_decode;
+pub mod stop_delta;
+pub mod tls;
 pub mod tools;
+pub mod watch_list;
+pub mod xref_index;
 
 // Re-export commonly used types
 pub use error::{IncodeError, IncodeResult};
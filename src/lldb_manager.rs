@@ -1,11 +1,37 @@
-use std::collections::HashMap;
+use std::collections::hash_map::DefaultHasher;
+use std::collections::{HashMap, HashSet};
+use std::hash::{Hash, Hasher};
 use std::sync::{Arc, Mutex};
-use std::path::Path;
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::path::{Path, PathBuf};
+use std::time::{Duration, Instant};
 use tracing::{debug, info, error, warn};
 use uuid::Uuid;
-use serde_json::{json, Value};
-
+use serde_json::Value;
+
+use crate::cache_manager::{self, private_dir, BudgetedCache, CacheConfig, CacheManager, EnforceReport};
+use crate::checkpoint::{self, Checkpoint, CheckpointStore};
+use crate::core_file::{self, CoreFile};
+use crate::crash_db::{self, CrashDatabase, CrashRecord};
+use crate::crash_triage::{self, TriageOptions, TriageReport};
+use crate::console_buffer::{ConsoleBuffer, ConsoleDrainer, ConsoleRead};
 use crate::error::{IncodeError, IncodeResult};
+use crate::expression::{self, ExpressionValue, Plan, PreparedExpression, PreparedExpressions};
+use crate::fault_decode::{self, FaultInfo};
+use crate::fleet_snapshot::{self, FleetSnapshot, SnapshotOptions};
+use crate::fork_follower::{save_breakpoints, ChildCommand, ChildSessionInfo, ForkFollower, ForkPolicy};
+use crate::minidump::{self, MinidumpOptions, MinidumpReport};
+use crate::process_table::{memory_map, MapEntry, ProcessFilter, ProcessTable};
+use crate::disassembly::{self, DecodedRun, Disassembly};
+use crate::function_cfg::{self, FunctionCfg};
+use crate::global_vars::{self, GlobalFilter, GlobalsPage, ModuleGlobals, ModuleImage};
+use crate::register_schema::{self, RegisterSchema, RegisterValues};
+use crate::stl_decode::{self, ContainerView, TypeInfo};
+use crate::stop_delta::{self, StateDelta, StopDeltaTracker, StopState};
+use crate::tls::{self, TlsAbi, TlsLocation, TlsView};
+use crate::watch_list::{self, Watch, WatchList, WatchResult};
+use crate::xref_index::{self, XrefIndex, XrefKind, XrefQuery};
+use crate::session_snapshot::{self, BreakpointRestore, ModuleIndex, RestoreOptions, SessionRestore, SessionSnapshot};
 
 // Use LLDB bindings from lldb-sys crate
 use lldb_sys::*;
@@ -122,11 +148,16 @@ pub struct ThreadInfo {
 #[derive(Debug, Clone)]
 pub struct RegisterInfo {
     pub name: String,
+    /// Low 64 bits; `bytes` holds the full width of vector registers
     pub value: u64,
     pub size: u32,
     pub register_type: String,
     pub format: String,
     pub is_valid: bool,
+    /// Register set the register belongs to
+    pub set: String,
+    /// Little-endian value bytes, `size` long
+    pub bytes: Vec<u8>,
 }
 
 #[derive(Debug, Clone)]
@@ -279,14 +310,126 @@ pub struct CrashAnalysis {
     pub loaded_modules: Vec<String>, // List of loaded modules/libraries
     pub crash_summary: String, // High-level crash description
     pub recommendations: Vec<String>, // Debugging recommendations
+    pub signature: Option<u64>, // Hash of the signal and normalized top frames
+    pub signature_frames: Vec<String>, // Frames the signature was computed from
+    pub known_crash: Option<CrashRecord>, // Matching bucket in the crash database
+    pub fault: Option<FaultInfo>, // Decoded faulting instruction and address classification
 }
 
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, Default)]
 pub struct ProcessInfo {
     pub pid: u32,
     pub state: String,
     pub executable_path: Option<String>,
     pub memory_usage: Option<u64>,
+    pub ppid: Option<u32>,
+    pub name: Option<String>, // Short process name (comm)
+    pub cmdline: Option<String>, // Full command line, arguments space-separated
+    pub uid: Option<u32>,
+    pub user: Option<String>,
+}
+
+/// Longest single wait for a stop. The MCP handler serves one request at a
+/// time, so longer runs are waited out by repeated calls instead.
+pub const MAX_STOP_WAIT_MS: u64 = 30_000;
+
+/// Process state observed when an asynchronous run comes to rest
+#[derive(Debug, Clone)]
+pub struct StopEvent {
+    pub pid: u32,
+    pub state: String,
+    pub thread_id: Option<u32>,
+    pub stop_reason: Option<String>,
+    pub exit_status: Option<i32>,
+    pub elapsed_ms: u64,
+}
+
+/// What was found when opening a core file
+#[derive(Debug, Clone)]
+pub struct CoreSummary {
+    pub path: String,
+    /// Executable the target was created from, if one was found
+    pub executable: Option<String>,
+    pub pid: Option<u32>,
+    pub command: Option<String>,
+    pub file_size: u64,
+    pub segments: usize,
+    /// Total size of the captured address space
+    pub mapped_bytes: u64,
+    pub threads: usize,
+    pub faulting_thread: Option<u32>,
+    /// Registers of the faulting thread as the kernel saved them
+    pub faulting_pc: Option<u64>,
+    pub faulting_sp: Option<u64>,
+    pub signal: Option<core_file::CoreSignal>,
+    pub load_ms: u64,
+}
+
+/// Outcome of switching to a checkpoint
+#[derive(Debug, Clone)]
+pub struct CheckpointRestore {
+    /// The checkpoint that was restored
+    pub checkpoint: Checkpoint,
+    /// PID now being debugged
+    pub pid: u32,
+    pub pc: u64,
+    pub pc_matches: bool,
+    pub registers_restored: usize,
+    pub registers_failed: Vec<String>,
+    /// Replacement checkpoint under the same id, when asked to keep it
+    pub kept: Option<Checkpoint>,
+}
+
+/// How a process is launched
+#[derive(Debug, Clone, PartialEq)]
+pub struct LaunchOptions {
+    pub args: Vec<String>,
+    /// Added to (or overriding) the inherited environment
+    pub env: HashMap<String, String>,
+    pub working_dir: Option<String>,
+    /// Stop at the program entry point before any user code runs
+    pub stop_at_entry: bool,
+    /// Resolve and load every dependent module when the target is created
+    pub preload_dependents: bool,
+    /// Only parse symbol tables and debug info for modules when they are needed
+    pub load_symbols_on_demand: bool,
+    /// Wait this long for the first stop (e.g. a breakpoint) after launching
+    pub wait_for_stop_ms: Option<u64>,
+}
+
+impl Default for LaunchOptions {
+    fn default() -> Self {
+        Self {
+            args: Vec::new(),
+            env: HashMap::new(),
+            working_dir: None,
+            stop_at_entry: false,
+            preload_dependents: false,
+            load_symbols_on_demand: true,
+            wait_for_stop_ms: None,
+        }
+    }
+}
+
+/// Wall-clock time spent in each launch phase
+#[derive(Debug, Clone)]
+pub struct LaunchTiming {
+    pub target_create_ms: u64,
+    pub exec_ms: u64,
+    /// Launch-to-first-stop; `None` if the process has not stopped yet
+    pub first_stop_ms: Option<u64>,
+    pub total_ms: u64,
+}
+
+#[derive(Debug, Clone)]
+pub struct LaunchReport {
+    pub pid: u32,
+    pub state: String,
+    /// Modules known to the target when the process started
+    pub modules_at_exec: u32,
+    /// Modules known to the target when the launch call returned
+    pub modules_loaded: u32,
+    pub timing: LaunchTiming,
 }
 
 #[derive(Debug, Clone)]
@@ -323,6 +466,103 @@ pub struct LldbVersionInfo {
 // LLDB functions are now imported from lldb-sys crate above
 // All mock implementations removed - using real LLDB bindings only
 
+/// Human-readable name for an LLDB process state
+pub(crate) fn state_name(state: StateType) -> &'static str {
+    match state {
+        StateType::Invalid => "Invalid",
+        StateType::Unloaded => "Unloaded",
+        StateType::Connected => "Connected",
+        StateType::Attaching => "Attaching",
+        StateType::Launching => "Launching",
+        StateType::Stopped => "Stopped",
+        StateType::Running => "Running",
+        StateType::Stepping => "Stepping",
+        StateType::Crashed => "Crashed",
+        StateType::Detached => "Detached",
+        StateType::Exited => "Exited",
+        StateType::Suspended => "Suspended",
+    }
+}
+
+/// Whether a process in this state will not make progress without a resume
+fn is_rest_state(state: StateType) -> bool {
+    matches!(state, StateType::Stopped | StateType::Crashed | StateType::Exited | StateType::Detached | StateType::Suspended)
+}
+
+/// Extract the message carried by an SBError, if any
+pub(crate) fn sb_error_message(error: SBErrorRef) -> String {
+    let msg_ptr = unsafe { SBErrorGetCString(error) };
+    if msg_ptr.is_null() {
+        "Unknown LLDB error".to_string()
+    } else {
+        unsafe { std::ffi::CStr::from_ptr(msg_ptr) }.to_string_lossy().into_owned()
+    }
+}
+
+/// Mapped regions of a live process as LLDB reports them, which works for
+/// remote and non-Linux targets alike. `None` if LLDB has no region list.
+pub(crate) fn process_regions(process: SBProcessRef) -> Option<Vec<MemoryRegion>> {
+    let list = unsafe { SBProcessGetMemoryRegions(process) };
+    if list.is_null() {
+        return None;
+    }
+    let info = unsafe { CreateSBMemoryRegionInfo() };
+    let mut regions = Vec::new();
+    for i in 0..unsafe { SBMemoryRegionInfoListGetSize(list) } {
+        if !unsafe { SBMemoryRegionInfoListGetMemoryRegionAtIndex(list, i, info) } || !unsafe { SBMemoryRegionInfoIsMapped(info) } {
+            continue;
+        }
+        let (start, end) = unsafe { (SBMemoryRegionInfoGetRegionBase(info), SBMemoryRegionInfoGetRegionEnd(info)) };
+        let flag = |set: bool, c: char| if set { c } else { '-' };
+        let permissions = unsafe {
+            [
+                flag(SBMemoryRegionInfoIsReadable(info), 'r'),
+                flag(SBMemoryRegionInfoIsWritable(info), 'w'),
+                flag(SBMemoryRegionInfoIsExecutable(info), 'x'),
+            ]
+        };
+        let name_ptr = unsafe { SBMemoryRegionInfoGetName(info) };
+        let name = (!name_ptr.is_null())
+            .then(|| unsafe { std::ffi::CStr::from_ptr(name_ptr) }.to_string_lossy().into_owned())
+            .filter(|name| !name.is_empty());
+        regions.push(MemoryRegion {
+            start_address: start,
+            end_address: end,
+            size: end.saturating_sub(start),
+            permissions: permissions.iter().collect(),
+            name,
+        });
+    }
+    unsafe {
+        DisposeSBMemoryRegionInfo(info);
+        DisposeSBMemoryRegionInfoList(list);
+    }
+    Some(regions)
+}
+
+/// Cache key for a function's CFG: module build and file address
+fn cfg_key(path: &str, uuid: &Option<String>, file_address: u64) -> String {
+    disassembly::code_key(path, uuid.as_deref(), file_address)
+}
+
+/// Fingerprint of the target's modules, in load order: changes when the
+/// process execs or loads or unloads a module
+fn module_list_fingerprint(target: SBTargetRef) -> u64 {
+    let mut hasher = DefaultHasher::new();
+    for i in 0..unsafe { SBTargetGetNumModules(target) } {
+        session_snapshot::module_identity(unsafe { SBTargetGetModuleAtIndex(target, i) }).hash(&mut hasher);
+    }
+    hasher.finish()
+}
+
+/// Charge a finished cross-reference index at its real size, unless it was evicted mid-sweep
+fn charge_xref_index(cache: &BudgetedCache<String, Arc<XrefIndex>>, key: String, index: &Arc<XrefIndex>) {
+    if cache.get(&key).map_or(false, |cached| Arc::ptr_eq(&cached, index)) {
+        let elapsed_us = index.progress().elapsed_ms * 1000;
+        cache.insert(key, index.clone(), index.approx_bytes(), elapsed_us);
+    }
+}
+
 
 /// Session information for debugging state
 #[derive(Debug, Clone)]
@@ -354,6 +594,48 @@ pub struct LldbManager {
     current_thread: Option<SBThreadRef>,
     current_thread_id: Option<u32>,
     current_frame_index: u32,
+    async_run_pending: AtomicBool,
+    process_table: Arc<ProcessTable>,
+    console: Arc<ConsoleBuffer>,
+    console_drainer: Option<ConsoleDrainer>,
+    console_cursor: AtomicU64,
+    fork_policy: ForkPolicy,
+    fork_follower: Option<ForkFollower>,
+    checkpoints: CheckpointStore,
+    /// Mapped core file backing `current_process`, when debugging a core
+    core: Option<CoreFile>,
+    /// Directory of the persistent crash signature database
+    crash_db_path: PathBuf,
+    /// Executable and options of the last launch, kept for session snapshots
+    launch_config: Option<(String, LaunchOptions)>,
+    /// Memory budget every cache is held to
+    caches: Arc<CacheManager>,
+    /// When each session without a live process was first seen idle
+    idle_sessions: HashMap<Uuid, Instant>,
+    /// Private spill directory, created on the first spill when none is configured
+    spill_dir: Option<PathBuf>,
+    /// Register layouts by architecture and register set shape
+    register_schemas: Arc<BudgetedCache<String, Arc<RegisterSchema>>>,
+    /// Schema key of the current process's register shape, by (pid, process)
+    register_schema_key: Mutex<Option<((u32, usize), String)>>,
+    /// Decoded instruction runs by module and file address
+    disassembly: Arc<BudgetedCache<String, Arc<DecodedRun>>>,
+    /// Control-flow graphs by module build and function file address
+    function_cfgs: Arc<BudgetedCache<String, Arc<FunctionCfg>>>,
+    /// Cross-reference indexes by module build, filled by background sweeps
+    xref_indexes: Arc<BudgetedCache<String, Arc<XrefIndex>>>,
+    /// Global variable layouts by module build
+    global_layouts: Arc<BudgetedCache<String, Arc<ModuleGlobals>>>,
+    /// Each thread's state at its last two stops, for delta reporting
+    stop_deltas: StopDeltaTracker,
+    /// Expressions prepared for repeated evaluation, by handle
+    prepared_expressions: PreparedExpressions,
+    /// Expressions evaluated at every stop, with their histories
+    watches: WatchList,
+    /// Thread-locals located through the DTV so far, by process and name
+    tls_locations: HashMap<(u32, String), (TlsLocation, TypeInfo)>,
+    /// Fingerprint of the module list `tls_locations` was located against
+    tls_modules: u64,
     cleaned_up: bool,
 }
 
@@ -388,6 +670,18 @@ impl LldbManager {
 
         info!("LLDB debugger instance created successfully");
 
+        let caches = CacheManager::new(CacheConfig::from_env());
+        let process_table = Arc::new(ProcessTable::new());
+        let console = Arc::new(ConsoleBuffer::default());
+        caches.register(process_table.clone());
+        caches.register(console.clone());
+        let register_schemas = BudgetedCache::new("register_schemas", &caches);
+        let disassembly = BudgetedCache::new("disassembly", &caches);
+        let function_cfgs = BudgetedCache::new("function_cfgs", &caches);
+        let xref_indexes = BudgetedCache::new("xref_indexes", &caches);
+        let global_layouts = BudgetedCache::new("global_layouts", &caches);
+        cache_manager::log_config(&caches);
+
         Ok(Self {
             lldb_path,
             sessions: Arc::new(Mutex::new(HashMap::new())),
@@ -398,6 +692,31 @@ impl LldbManager {
             current_thread: None,
             current_thread_id: None,
             current_frame_index: 0,
+            async_run_pending: AtomicBool::new(false),
+            process_table,
+            console,
+            console_drainer: None,
+            console_cursor: AtomicU64::new(0),
+            fork_policy: ForkPolicy::Parent,
+            fork_follower: None,
+            checkpoints: CheckpointStore::new(),
+            core: None,
+            crash_db_path: crash_db::default_location(),
+            launch_config: None,
+            caches,
+            idle_sessions: HashMap::new(),
+            spill_dir: None,
+            register_schemas,
+            register_schema_key: Mutex::new(None),
+            disassembly,
+            function_cfgs,
+            xref_indexes,
+            global_layouts,
+            stop_deltas: StopDeltaTracker::new(),
+            prepared_expressions: PreparedExpressions::new(),
+            watches: WatchList::new(),
+            tls_locations: HashMap::new(),
+            tls_modules: 0,
             cleaned_up: false,
         })
     }
@@ -426,17 +745,154 @@ impl LldbManager {
         self.current_session
     }
 
-    /// Get session information
+    /// Get session information, reading it back in if it was spilled to disk
     pub fn get_session(&self, session_id: &Uuid) -> IncodeResult<DebuggingSession> {
-        let sessions = self.sessions.lock().unwrap();
-        sessions.get(session_id)
-            .cloned()
-            .ok_or_else(|| IncodeError::session(format!("Session not found: {}", session_id)))
+        let mut sessions = self.sessions.lock().unwrap();
+        if let Some(session) = sessions.get(session_id) {
+            return Ok(session.clone());
+        }
+        let session = self.unspill_session(session_id)
+            .ok_or_else(|| IncodeError::session(format!("Session not found: {}", session_id)))?;
+        sessions.insert(*session_id, session.clone());
+        Ok(session)
+    }
+
+    /// Caches register here to be held to the shared memory budget
+    pub fn cache_manager(&self) -> &Arc<CacheManager> {
+        &self.caches
+    }
+
+    /// Per-cache memory use against the budget and RSS ceiling
+    pub fn cache_report(&self) -> Value {
+        let mut report = self.caches.report();
+        report["sessions_in_memory"] = Value::from(self.sessions.lock().unwrap().len());
+        report["sessions_spilled"] = Value::from(self.spilled_session_count());
+        report
+    }
+
+    /// Spill idle sessions, then evict cache entries until the budget and RSS
+    /// ceiling are met. When the ceiling is still exceeded with the caches
+    /// empty, LLDB is asked to drop the modules no target references anymore.
+    pub fn enforce_cache_budget(&mut self) -> EnforceReport {
+        let spilled = self.spill_idle_sessions();
+        let mut report = self.caches.enforce();
+        report.spilled_sessions = spilled;
+
+        let rss_limit = self.caches.config().rss_limit_bytes;
+        if let (Some(limit), Some(rss)) = (rss_limit, report.rss_bytes) {
+            if rss > limit && self.caches.used_bytes() == 0 {
+                unsafe { SBDebuggerMemoryPressureDetected() };
+                report.rss_bytes = cache_manager::current_rss();
+                warn!("RSS {} bytes over the {} byte ceiling with caches empty", rss, limit);
+            }
+        }
+        report
+    }
+
+    /// Write sessions that have had no live process for the idle period to the
+    /// spill directory as session snapshots and drop them from memory
+    fn spill_idle_sessions(&mut self) -> usize {
+        let config = self.caches.config();
+        let idle_after = Duration::from_secs(config.idle_session_secs);
+        let now = Instant::now();
+
+        let mut sessions = self.sessions.lock().unwrap();
+        // Sessions with a process behind them (the current one, forked children) are never idle
+        let idle: Vec<Uuid> = sessions.values()
+            .filter(|session| Some(session.id) != self.current_session)
+            .filter(|session| matches!(session.state, SessionState::Created | SessionState::Terminated))
+            .map(|session| session.id)
+            .collect();
+        self.idle_sessions.retain(|id, _| idle.contains(id));
+
+        let mut spilled = 0;
+        for id in idle {
+            let since = *self.idle_sessions.entry(id).or_insert(now);
+            if now.duration_since(since) < idle_after {
+                continue;
+            }
+            let Some(session) = sessions.get(&id) else { continue };
+            let mut snapshot = SessionSnapshot::new(id);
+            snapshot.state = session.state.clone();
+            snapshot.created_at = session.created_at.duration_since(std::time::UNIX_EPOCH).unwrap_or_default().as_secs();
+            snapshot.target_path = session.target_path.clone();
+            snapshot.process_id = session.process_id;
+
+            let dir = match Self::spill_dir(&config, &mut self.spill_dir) {
+                Ok(dir) => dir,
+                Err(e) => {
+                    warn!("Could not spill idle sessions: {}", e);
+                    break;
+                }
+            };
+            let written = std::fs::write(dir.join(format!("{}.session", id)), snapshot.encode());
+            match written {
+                Ok(()) => {
+                    sessions.remove(&id);
+                    self.idle_sessions.remove(&id);
+                    spilled += 1;
+                }
+                Err(e) => warn!("Could not spill idle session {}: {}", id, e),
+            }
+        }
+        if spilled > 0 {
+            debug!("Spilled {} idle sessions", spilled);
+        }
+        spilled
+    }
+
+    /// Where idle sessions go: the configured directory once it is checked to
+    /// be ours, otherwise a fresh private one made on first use
+    fn spill_dir(config: &CacheConfig, private: &mut Option<PathBuf>) -> std::io::Result<PathBuf> {
+        if let Some(dir) = &config.spill_dir {
+            cache_manager::ensure_private_dir(dir)?;
+            return Ok(dir.clone());
+        }
+        match private {
+            Some(dir) => Ok(dir.clone()),
+            None => {
+                let dir = private_dir("incode-spill")?;
+                *private = Some(dir.clone());
+                Ok(dir)
+            }
+        }
+    }
+
+    /// Spill directory in use, if sessions can have been spilled yet
+    fn spill_location(&self) -> Option<PathBuf> {
+        self.caches.config().spill_dir.or_else(|| self.spill_dir.clone())
+    }
+
+    fn unspill_session(&self, session_id: &Uuid) -> Option<DebuggingSession> {
+        let path = self.spill_location()?.join(format!("{}.session", session_id));
+        let snapshot = SessionSnapshot::decode(&std::fs::read(&path).ok()?).ok()?;
+        let _ = std::fs::remove_file(&path);
+        Some(DebuggingSession {
+            id: snapshot.session_id,
+            target_path: snapshot.target_path,
+            process_id: snapshot.process_id,
+            state: snapshot.state,
+            created_at: std::time::UNIX_EPOCH + std::time::Duration::from_secs(snapshot.created_at),
+        })
+    }
+
+    fn spilled_session_count(&self) -> usize {
+        let Some(dir) = self.spill_location() else {
+            return 0;
+        };
+        std::fs::read_dir(dir)
+            .map(|entries| entries.filter_map(Result::ok).filter(|entry| entry.path().extension().map_or(false, |ext| ext == "session")).count())
+            .unwrap_or(0)
     }
 
     /// Update session state
     pub fn update_session_state(&self, session_id: &Uuid, state: SessionState) -> IncodeResult<()> {
         let mut sessions = self.sessions.lock().unwrap();
+        if !sessions.contains_key(session_id) {
+            if let Some(session) = self.unspill_session(session_id) {
+                sessions.insert(*session_id, session);
+            }
+        }
         if let Some(session) = sessions.get_mut(session_id) {
             session.state = state;
             debug!("Updated session {} state to {:?}", session_id, session.state);
@@ -446,114 +902,231 @@ impl LldbManager {
         }
     }
 
+    /// Capture everything needed to put the session back: target and launch
+    /// configuration, breakpoints and watchpoints with module-relative
+    /// addresses, selection, console output and loaded modules
+    pub fn snapshot_session(&self, session_id: &Uuid) -> IncodeResult<SessionSnapshot> {
+        let session = self.get_session(session_id)?;
+        let mut snapshot = SessionSnapshot::new(*session_id);
+        snapshot.state = session.state;
+        snapshot.created_at = session.created_at.duration_since(std::time::UNIX_EPOCH)
+            .unwrap_or_default().as_secs();
+        snapshot.saved_at = std::time::SystemTime::now()
+            .duration_since(std::time::UNIX_EPOCH)
+            .unwrap_or_default().as_secs();
+        snapshot.target_path = session.target_path;
+        snapshot.process_id = session.process_id;
+        snapshot.selected_thread_id = self.current_thread_id;
+        snapshot.selected_frame_index = self.current_frame_index;
+        snapshot.core_path = self.core.as_ref().map(|core| core.path().to_string_lossy().into_owned());
+        if let Some((executable, options)) = &self.launch_config {
+            snapshot.target_path.get_or_insert_with(|| executable.clone());
+            snapshot.launch = Some(options.clone());
+        }
+
+        if let Some(target) = self.current_target {
+            if snapshot.target_path.is_none() {
+                let executable = unsafe { SBTargetGetExecutable(target) };
+                if !executable.is_null() {
+                    let mut buffer = vec![0u8; 4096];
+                    let len = unsafe { SBFileSpecGetPath(executable, buffer.as_mut_ptr() as *mut i8, buffer.len()) } as usize;
+                    if len > 0 {
+                        snapshot.target_path = Some(String::from_utf8_lossy(&buffer[..len.min(buffer.len())]).into_owned());
+                    }
+                }
+            }
+            snapshot.modules = session_snapshot::capture_modules(target);
+            snapshot.breakpoints = session_snapshot::capture_breakpoints(target);
+            snapshot.watchpoints = session_snapshot::capture_watchpoints(target);
+        }
+        if let Some(process) = self.current_process {
+            let pid = unsafe { SBProcessGetProcessID(process) } as u32;
+            if pid != 0 {
+                snapshot.process_id = Some(pid);
+            }
+        }
+        snapshot.console = session_snapshot::capture_console(&self.console);
+
+        debug!("Snapshot of session {}: {} breakpoints, {} watchpoints, {} modules",
+               session_id, snapshot.breakpoints.len(), snapshot.watchpoints.len(), snapshot.modules.len());
+        Ok(snapshot)
+    }
+
     /// Save debugging session state to JSON
     pub fn save_session(&self, session_id: &Uuid) -> IncodeResult<String> {
         debug!("Saving session: {}", session_id);
-        
-        let sessions = self.sessions.lock().unwrap();
-        let session = sessions.get(session_id)
-            .ok_or_else(|| IncodeError::session(format!("Session not found: {}", session_id)))?;
-        
-        // Collect current debugging state
-        let process_info = if let Some(process_id) = session.process_id {
-            json!({
-                "process_id": process_id,
-                "state": format!("{:?}", session.state),
-                "target_path": session.target_path
-            })
-        } else {
-            json!({
-                "process_id": null,
-                "state": format!("{:?}", session.state),
-                "target_path": session.target_path
-            })
-        };
-        
-        let session_data = json!({
-            "session_id": session_id.to_string(),
-            "state": format!("{:?}", session.state),
-            "created_at": session.created_at.duration_since(std::time::UNIX_EPOCH)
-                .unwrap_or_default().as_secs(),
-            "target_path": session.target_path,
-            "process_id": session.process_id,
-            "process_info": process_info,
-            "current_thread_id": self.current_thread_id,
-            "current_frame_index": self.current_frame_index,
-            "has_target": self.current_target.is_some(),
-            "has_process": self.current_process.is_some(),
-            "has_thread": self.current_thread.is_some(),
-            "saved_at": std::time::SystemTime::now()
-                .duration_since(std::time::UNIX_EPOCH)
-                .unwrap_or_default().as_secs()
-        });
-        
-        let session_json = serde_json::to_string_pretty(&session_data)
+        let snapshot = self.snapshot_session(session_id)?;
+        let session_json = serde_json::to_string_pretty(&snapshot.to_json())
             .map_err(|e| IncodeError::lldb_op(format!("Failed to serialize session: {}", e)))?;
-        
+
         info!("Session {} saved successfully", session_id);
         Ok(session_json)
     }
 
-    /// Load debugging session state from JSON
+    /// Load debugging session state from JSON, without touching the target
     pub fn load_session(&mut self, session_data: &str) -> IncodeResult<Uuid> {
         debug!("Loading session from data");
-        
+
         let data: Value = serde_json::from_str(session_data)
             .map_err(|e| IncodeError::lldb_op(format!("Failed to parse session data: {}", e)))?;
-        
-        // Extract session information
-        let session_id_str = data["session_id"].as_str()
-            .ok_or_else(|| IncodeError::lldb_op("Missing session_id in session data"))?;
-        
-        let session_id = Uuid::parse_str(session_id_str)
-            .map_err(|e| IncodeError::lldb_op(format!("Invalid session ID: {}", e)))?;
-        
-        let state_str = data["state"].as_str()
-            .ok_or_else(|| IncodeError::lldb_op("Missing state in session data"))?;
-        
-        let state = match state_str {
-            "Created" => SessionState::Created,
-            "Attached" => SessionState::Attached,
-            "Running" => SessionState::Running,
-            "Stopped" => SessionState::Stopped,
-            "Terminated" => SessionState::Terminated,
-            _ => SessionState::Created,
-        };
-        
-        // Create new session with loaded data
-        let created_at = if let Some(timestamp) = data["created_at"].as_u64() {
-            std::time::UNIX_EPOCH + std::time::Duration::from_secs(timestamp)
-        } else {
-            std::time::SystemTime::now()
+        let snapshot = SessionSnapshot::from_json(&data)?;
+        let options = RestoreOptions { restore_target: false, restore_breakpoints: false };
+        self.restore_session(&snapshot, &options).map(|report| report.session_id)
+    }
+
+    /// Put a snapshot back in one step: register the session, then optionally
+    /// recreate the target (core, relaunch or re-attach), breakpoints and
+    /// watchpoints, selection and console output.
+    ///
+    /// A relaunched program stops at its entry point, so restored breakpoints
+    /// apply from the first instruction.
+    pub fn restore_session(&mut self, snapshot: &SessionSnapshot, options: &RestoreOptions) -> IncodeResult<SessionRestore> {
+        let restore_start = Instant::now();
+        let session_id = snapshot.session_id;
+        let mut report = SessionRestore::new(session_id);
+
+        let created_at = match snapshot.created_at {
+            0 => std::time::SystemTime::now(),
+            secs => std::time::UNIX_EPOCH + std::time::Duration::from_secs(secs),
         };
-        
-        let session = DebuggingSession {
+        self.sessions.lock().unwrap().insert(session_id, DebuggingSession {
             id: session_id,
-            target_path: data["target_path"].as_str().map(|s| s.to_string()),
-            process_id: data["process_id"].as_u64().map(|pid| pid as u32),
-            state,
+            target_path: snapshot.target_path.clone(),
+            process_id: snapshot.process_id,
+            state: snapshot.state.clone(),
             created_at,
-        };
-        
-        // Restore session state
-        let mut sessions = self.sessions.lock().unwrap();
-        sessions.insert(session_id, session);
-        drop(sessions);
-        
-        // Restore debugging context
-        if let Some(thread_id) = data["current_thread_id"].as_u64() {
-            self.current_thread_id = Some(thread_id as u32);
+        });
+        self.current_session = Some(session_id);
+        self.current_thread_id = snapshot.selected_thread_id;
+        self.current_frame_index = snapshot.selected_frame_index;
+
+        if options.restore_target {
+            self.restore_target(snapshot, &mut report)?;
         }
-        
-        if let Some(frame_index) = data["current_frame_index"].as_u64() {
-            self.current_frame_index = frame_index as u32;
+
+        if let Some(target) = self.current_target {
+            let modules = ModuleIndex::new(target);
+            let (matched, changed): (Vec<_>, Vec<_>) = snapshot.modules.iter().partition(|module| modules.contains(module));
+            report.modules_matched = matched.len();
+            report.modules_changed = changed.into_iter().map(|module| module.path.clone()).collect();
+
+            if options.restore_breakpoints {
+                for breakpoint in &snapshot.breakpoints {
+                    match session_snapshot::restore_breakpoint(target, &modules, breakpoint) {
+                        BreakpointRestore::ByOffset(id) => report.breakpoints_by_offset.push((breakpoint.id, id)),
+                        BreakpointRestore::BySpec(id) => report.breakpoints_by_spec.push((breakpoint.id, id)),
+                        BreakpointRestore::Failed => report.breakpoints_failed.push(breakpoint.spec.clone()),
+                    }
+                }
+                // Heap and stack addresses only carry over when it is still the same process
+                let same_process = self.current_process
+                    .map(|process| Some(unsafe { SBProcessGetProcessID(process) } as u32) == snapshot.process_id)
+                    .unwrap_or(false);
+                if self.current_process.is_some() {
+                    for watchpoint in &snapshot.watchpoints {
+                        match session_snapshot::restore_watchpoint(target, &modules, watchpoint, same_process) {
+                            Some(_) => report.watchpoints_restored += 1,
+                            None => report.watchpoints_skipped.push(format!("0x{:x}", watchpoint.address)),
+                        }
+                    }
+                } else {
+                    report.watchpoints_skipped = snapshot.watchpoints.iter().map(|watchpoint| format!("0x{:x}", watchpoint.address)).collect();
+                }
+            }
         }
-        
-        // Set as current session
-        self.current_session = Some(session_id);
-        
-        info!("Session {} loaded successfully", session_id);
-        Ok(session_id)
+
+        if self.current_process.is_some() {
+            if let Some(thread_id) = snapshot.selected_thread_id {
+                match self.select_thread(thread_id) {
+                    Ok(_) => {
+                        if snapshot.selected_frame_index > 0 {
+                            if let Err(e) = self.select_frame(snapshot.selected_frame_index) {
+                                debug!("Saved frame {} not restored: {}", snapshot.selected_frame_index, e);
+                            }
+                        }
+                    }
+                    Err(e) => debug!("Saved thread {} not restored: {}", thread_id, e),
+                }
+            }
+        }
+
+        // Earlier output goes back in front of anything the new process prints
+        for (stream, text) in &snapshot.console {
+            self.console.append(*stream, text.as_bytes());
+        }
+        report.console_segments = snapshot.console.len();
+        report.restore_ms = restore_start.elapsed().as_millis() as u64;
+
+        info!("Session {} restored in {}ms", session_id, report.restore_ms);
+        Ok(report)
+    }
+
+    fn restore_target(&mut self, snapshot: &SessionSnapshot, report: &mut SessionRestore) -> IncodeResult<()> {
+        fn exists(path: &Option<String>) -> Option<&str> {
+            path.as_deref().filter(|path| Path::new(path).exists())
+        }
+
+        if let Some(core_path) = exists(&snapshot.core_path) {
+            let executable = exists(&snapshot.target_path);
+            let summary = self.load_core(core_path, executable)?;
+            report.target = Some(format!("core {}", summary.path));
+        } else if let (Some(executable), Some(launch)) = (exists(&snapshot.target_path), snapshot.launch.as_ref()) {
+            let options = LaunchOptions { stop_at_entry: true, wait_for_stop_ms: None, ..launch.clone() };
+            let launched = self.launch_process_with(executable, &options)?;
+            // Keep the original launch configuration for the next snapshot
+            self.launch_config = Some((executable.to_string(), launch.clone()));
+            report.target = Some(format!("launched {}", executable));
+            report.pid = Some(launched.pid);
+        } else if let Some(pid) = snapshot.process_id.filter(|pid| Path::new(&format!("/proc/{}", pid)).exists()) {
+            self.attach_to_process(pid)?;
+            report.target = Some(format!("attached {}", pid));
+            report.pid = Some(pid);
+        } else if let Some(executable) = exists(&snapshot.target_path) {
+            let debugger = self.debugger.ok_or_else(|| IncodeError::lldb_init("No debugger instance"))?;
+            let exe_cstr = std::ffi::CString::new(executable)
+                .map_err(|_| IncodeError::invalid_parameter("Invalid executable path"))?;
+            let target = unsafe { SBDebuggerCreateTarget2(debugger, exe_cstr.as_ptr()) };
+            if target.is_null() {
+                return Err(IncodeError::lldb_op(format!("Failed to create target for {}", executable)));
+            }
+            // The process or core of the previous target does not carry over
+            self.release_process();
+            self.current_target = Some(target);
+            report.target = Some(format!("target {}", executable));
+        } else if snapshot.target_path.is_some() || snapshot.core_path.is_some() {
+            return Err(IncodeError::session(format!(
+                "Saved target {} no longer exists",
+                snapshot.core_path.as_deref().or(snapshot.target_path.as_deref()).unwrap_or_default()
+            )));
+        }
+        Ok(())
+    }
+
+    /// Let go of the current process or core without replacing it: a launched
+    /// process is killed, an attached one is detached
+    fn release_process(&mut self) {
+        self.stop_console_drainer();
+        self.stop_fork_follower();
+        self.checkpoints.discard_all();
+        self.async_run_pending.store(false, Ordering::SeqCst);
+        if let Some(process) = self.current_process.take() {
+            unsafe {
+                if self.core.is_none() {
+                    let error = if self.launch_config.is_some() { SBProcessKill(process) } else { SBProcessDetach(process) };
+                    if !error.is_null() {
+                        DisposeSBError(error);
+                    }
+                }
+                DisposeSBProcess(process);
+            }
+        }
+        if let Some(thread) = self.current_thread.take() {
+            unsafe { DisposeSBThread(thread) };
+        }
+        self.current_thread_id = None;
+        self.current_frame_index = 0;
+        self.core = None;
+        self.launch_config = None;
     }
 
     /// Clean up debugging session resources
@@ -563,6 +1136,7 @@ impl LldbManager {
         // Remove from sessions map
         let mut sessions = self.sessions.lock().unwrap();
         let session = sessions.remove(session_id)
+            .or_else(|| self.unspill_session(session_id))
             .ok_or_else(|| IncodeError::session(format!("Session not found: {}", session_id)))?;
         drop(sessions);
         
@@ -582,6 +1156,7 @@ impl LldbManager {
             // Clear current debugging context
             self.current_target = None;
             self.current_process = None;
+            self.core = None;
             self.current_thread = None;
             self.current_thread_id = None;
             self.current_frame_index = 0;
@@ -593,125 +1168,571 @@ impl LldbManager {
 
     /// Launch a process for debugging - LLDB workflow: target create + run
     pub fn launch_process(&mut self, executable: &str, args: &[String], env: &HashMap<String, String>) -> IncodeResult<u32> {
-        debug!("LLDB workflow: target create '{}' then run with args: {:?}, env: {:?}", executable, args, env);
-        
+        let options = LaunchOptions {
+            args: args.to_vec(),
+            env: env.clone(),
+            ..Default::default()
+        };
+        self.launch_process_with(executable, &options).map(|report| report.pid)
+    }
+
+    /// Launch a process from an SBLaunchInfo built out of `options`, timing each phase
+    pub fn launch_process_with(&mut self, executable: &str, options: &LaunchOptions) -> IncodeResult<LaunchReport> {
+        debug!("Launching '{}' with {:?}", executable, options);
+
         let debugger = self.debugger.ok_or_else(|| IncodeError::lldb_init("No debugger instance"))?;
-        
+
         // Validate executable exists
         if !Path::new(executable).exists() {
             return Err(IncodeError::process_not_found(format!("Executable not found: {}", executable)));
         }
+        if let Some(ref working_dir) = options.working_dir {
+            if !Path::new(working_dir).is_dir() {
+                return Err(IncodeError::invalid_parameter(format!("Working directory not found: {}", working_dir)));
+            }
+        }
+
+        let launch_start = Instant::now();
+
+        // Symbol loading policy has to be in place before the target's modules are created
+        let on_demand = if options.load_symbols_on_demand { "true" } else { "false" };
+        if let Err(e) = self.execute_command(&format!("settings set symbols.load-on-demand {}", on_demand)) {
+            warn!("Could not set symbols.load-on-demand: {}", e);
+        }
+
+        // Launch strings are checked up front so a bad one never leaves a target behind
+        let arg_cstrs = options.args.iter()
+            .map(|arg| std::ffi::CString::new(arg.as_str()))
+            .collect::<Result<Vec<_>, _>>()
+            .map_err(|_| IncodeError::lldb_op("Invalid argument"))?;
+        let mut argv_ptrs: Vec<*const i8> = arg_cstrs.iter().map(|arg| arg.as_ptr()).collect();
+        argv_ptrs.push(std::ptr::null());
+
+        let env_cstrs = options.env.iter()
+            .map(|(key, value)| std::ffi::CString::new(format!("{}={}", key, value)))
+            .collect::<Result<Vec<_>, _>>()
+            .map_err(|_| IncodeError::lldb_op("Invalid environment entry"))?;
+        let mut envp_ptrs: Vec<*const i8> = env_cstrs.iter().map(|entry| entry.as_ptr()).collect();
+        envp_ptrs.push(std::ptr::null());
 
-        // Step 1: target create (equivalent to "target create /path/to/exe")
-        debug!("Step 1: Creating target for {}", executable);
+        let working_dir_cstr = options.working_dir.as_deref()
+            .map(std::ffi::CString::new)
+            .transpose()
+            .map_err(|_| IncodeError::lldb_op("Invalid working directory"))?;
+
+        // Phase 1: target create, optionally without walking dependent modules
         let exe_cstr = std::ffi::CString::new(executable)
             .map_err(|_| IncodeError::lldb_op("Invalid executable path"))?;
-        
-        let target = unsafe { SBDebuggerCreateTarget2(debugger, exe_cstr.as_ptr()) };
-        if target.is_null() {
-            return Err(IncodeError::lldb_op(format!("Failed to create target for: {}", executable)));
+        let error = unsafe { CreateSBError() };
+        let target = unsafe {
+            SBDebuggerCreateTarget(
+                debugger,
+                exe_cstr.as_ptr(),
+                std::ptr::null(),
+                std::ptr::null(),
+                options.preload_dependents,
+                error,
+            )
+        };
+        let create_failed = target.is_null() || unsafe { SBErrorFail(error) };
+        let create_error = if create_failed { Some(sb_error_message(error)) } else { None };
+        unsafe { DisposeSBError(error) };
+        if let Some(message) = create_error {
+            return Err(IncodeError::lldb_op(format!("Failed to create target for {}: {}", executable, message)));
         }
-        
-        debug!("✓ Target created successfully for {}", executable);
+        let target_create_ms = launch_start.elapsed().as_millis() as u64;
 
-        // Step 2: Prepare arguments for run command (equivalent to "r arg1 arg2 ...")
-        debug!("Step 2: Preparing arguments for run command");
-        let mut argv_ptrs: Vec<*const i8> = Vec::new();
-        let mut arg_cstrs: Vec<std::ffi::CString> = Vec::new();
-        
-        // For LLDB run command, we only pass the arguments (not executable as argv[0])
-        for arg in args {
-            let arg_cstr = std::ffi::CString::new(arg.as_str())
-                .map_err(|_| IncodeError::lldb_op("Invalid argument"))?;
-            arg_cstrs.push(arg_cstr);
-            argv_ptrs.push(arg_cstrs.last().unwrap().as_ptr());
+        // Phase 2: build the launch info
+        let launch_info = unsafe { CreateSBLaunchInfo(argv_ptrs.as_ptr()) };
+        if launch_info.is_null() {
+            unsafe { SBDebuggerDeleteTarget(debugger, target) };
+            return Err(IncodeError::lldb_op("Failed to create launch info"));
         }
-        argv_ptrs.push(std::ptr::null()); // NULL terminate
-
-        // Log environment variables (LLDB handles environment differently)
-        if !env.is_empty() {
-            debug!("Environment variables provided: {:?}", env);
-            // TODO: Set environment via SBTarget or SBLaunchInfo if needed
+        unsafe {
+            if !env_cstrs.is_empty() {
+                // Append to the inherited environment rather than replacing it
+                SBLaunchInfoSetEnvironmentEntries(launch_info, envp_ptrs.as_ptr(), true);
+            }
+            if let Some(ref working_dir) = working_dir_cstr {
+                SBLaunchInfoSetWorkingDirectory(launch_info, working_dir.as_ptr());
+            }
+            if options.stop_at_entry {
+                let flags = SBLaunchInfoGetLaunchFlags(launch_info);
+                SBLaunchInfoSetLaunchFlags(launch_info, flags | LaunchFlags::StopAtEntry as u32);
+            }
         }
 
-        // Step 3: Run the target (equivalent to "r" command) - non-blocking
-        debug!("Step 3: Running target (equivalent to 'r' command) - non-blocking");
-        
-        // Use LLDB launch but don't wait for process completion
+        // Phase 3: exec. Waiting for the first stop needs the launch to go through
+        // the debugger listener, the same way continue_async does.
+        let wait_for_stop = options.wait_for_stop_ms.filter(|_| !options.stop_at_entry);
+        let exec_start = Instant::now();
+        let error = unsafe { CreateSBError() };
         let process = unsafe {
-            SBTargetLaunchSimple(
-                target,
-                argv_ptrs.as_ptr(),
-                std::ptr::null(), // envp - will be handled by target environment
-                std::ptr::null()  // working_dir - will use target default
-            )
+            if wait_for_stop.is_some() {
+                SBDebuggerSetAsync(debugger, true);
+            }
+            let process = SBTargetLaunch2(target, launch_info, error);
+            if wait_for_stop.is_some() {
+                SBDebuggerSetAsync(debugger, false);
+            }
+            process
         };
-
-        if process.is_null() {
-            return Err(IncodeError::lldb_op("Failed to run target - process launch failed"));
+        let launch_failed = process.is_null() || unsafe { SBErrorFail(error) };
+        let launch_error = if launch_failed { Some(sb_error_message(error)) } else { None };
+        unsafe {
+            DisposeSBError(error);
+            DisposeSBLaunchInfo(launch_info);
         }
+        if let Some(message) = launch_error {
+            // A target that never got a process would linger in the debugger's list
+            unsafe {
+                if !process.is_null() {
+                    let error = SBProcessKill(process);
+                    if !error.is_null() {
+                        DisposeSBError(error);
+                    }
+                    DisposeSBProcess(process);
+                }
+                SBDebuggerDeleteTarget(debugger, target);
+            }
+            return Err(IncodeError::lldb_op(format!("Failed to launch {}: {}", executable, message)));
+        }
+        let exec_ms = exec_start.elapsed().as_millis() as u64;
 
-        // Get PID immediately - process continues running independently
         let pid = unsafe { SBProcessGetProcessID(process) } as u32;
         if pid == 0 {
+            unsafe {
+                let error = SBProcessKill(process);
+                if !error.is_null() {
+                    DisposeSBError(error);
+                }
+                DisposeSBProcess(process);
+                SBDebuggerDeleteTarget(debugger, target);
+            }
             return Err(IncodeError::lldb_op("Failed to get valid process ID from running target"));
         }
 
-        // Get initial process state - don't wait for it to reach any specific state
-        let state = unsafe { SBProcessGetState(process) };
-        debug!("✓ LLDB workflow complete: target created, process running independently with PID: {}, state: {:?}", pid, state);
-        
+        // Checkpoints are clones of the previous process, not of this one
+        self.checkpoints.discard_all();
+
         // Update internal state
         self.current_target = Some(target);
         self.current_process = Some(process);
+        self.core = None;
+        self.async_run_pending.store(wait_for_stop.is_some(), Ordering::SeqCst);
+        self.launch_config = Some((executable.to_string(), options.clone()));
+
+        // Output accumulates from the first instruction, whether or not anyone reads it
+        self.reset_console();
+        self.console_drainer = Some(ConsoleDrainer::spawn(process, self.console.clone()));
+        self.restart_fork_follower();
 
         // Update session state if we have one
         if let Some(session_id) = self.current_session {
-            self.update_session_state(&session_id, SessionState::Running)?;
+            let session_state = if options.stop_at_entry { SessionState::Stopped } else { SessionState::Running };
+            self.update_session_state(&session_id, session_state)?;
         }
 
-        info!("Successfully completed LLDB workflow: target create + run for {} with PID {}", executable, pid);
-        Ok(pid)
+        let modules_at_exec = unsafe { SBTargetGetNumModules(target) };
+
+        // Phase 4: first stop (entry point, or the first breakpoint when waiting)
+        let first_stop_ms = if options.stop_at_entry {
+            Some(exec_ms)
+        } else if let Some(timeout_ms) = wait_for_stop {
+            match self.wait_for_stop(timeout_ms) {
+                Ok(stop) => Some(exec_ms + stop.elapsed_ms),
+                Err(IncodeError::Timeout) => None,
+                Err(e) => return Err(e),
+            }
+        } else {
+            None
+        };
+
+        let state = unsafe { SBProcessGetState(process) };
+        let report = LaunchReport {
+            pid,
+            state: state_name(state).to_string(),
+            modules_at_exec,
+            modules_loaded: unsafe { SBTargetGetNumModules(target) },
+            timing: LaunchTiming {
+                target_create_ms,
+                exec_ms,
+                first_stop_ms,
+                total_ms: launch_start.elapsed().as_millis() as u64,
+            },
+        };
+
+        info!("Launched {} with PID {} in {}ms ({:?})", executable, pid, report.timing.total_ms, report.timing);
+        Ok(report)
     }
 
-    /// Get current console output from the running process
-    pub fn get_console_output(&self) -> IncodeResult<String> {
-        let process = self.current_process.ok_or_else(|| IncodeError::lldb_op("No active process"))?;
-        
-        // Get stdout from the process
-        let mut stdout_buffer = vec![0u8; 1024];
-        let stdout_len = unsafe { 
-            SBProcessGetSTDOUT(process, stdout_buffer.as_mut_ptr() as *mut i8, stdout_buffer.len()) 
+    /// Read buffered console output (stdout/stderr) of the debuggee.
+    ///
+    /// `cursor` is the `next_cursor` of a previous read; without one, reading
+    /// continues from where the last cursor-less read stopped.
+    pub fn get_console_output(&self, cursor: Option<u64>, max_bytes: usize, pattern: Option<&str>) -> IncodeResult<ConsoleRead> {
+        if self.current_process.is_none() && self.console.end_cursor() == 0 {
+            return Err(IncodeError::lldb_op("No active process"));
+        }
+
+        let read = self.console.read(
+            cursor.unwrap_or_else(|| self.console_cursor.load(Ordering::SeqCst)),
+            max_bytes,
+            pattern,
+        );
+        if cursor.is_none() {
+            self.console_cursor.store(read.next_cursor, Ordering::SeqCst);
+        }
+
+        Ok(read)
+    }
+
+    /// Stop draining console output of the current process, keeping what was read
+    fn stop_console_drainer(&mut self) {
+        if let Some(mut drainer) = self.console_drainer.take() {
+            drainer.stop();
+        }
+    }
+
+    /// Start console capture afresh for a new process so the previous one's
+    /// output is never read as its own
+    fn reset_console(&mut self) {
+        self.stop_console_drainer();
+        self.console.clear();
+        self.console_cursor.store(self.console.end_cursor(), Ordering::SeqCst);
+    }
+
+    /// Choose which side of fork() is debugged. `Both` keeps the current process
+    /// and attaches each descendant in its own session on a worker thread.
+    pub fn set_fork_policy(&mut self, policy: ForkPolicy, stop_on_exec: Option<bool>) -> IncodeResult<()> {
+        self.execute_command(&format!("settings set target.process.follow-fork-mode {}", policy.follow_fork_mode()))?;
+        if let Some(stop_on_exec) = stop_on_exec {
+            self.execute_command(&format!("settings set target.process.stop-on-exec {}", stop_on_exec))?;
+        }
+
+        self.fork_policy = policy;
+        self.restart_fork_follower();
+        info!("Fork policy set to {}", policy.as_str());
+        Ok(())
+    }
+
+    pub fn fork_policy(&self) -> ForkPolicy {
+        self.fork_policy
+    }
+
+    /// Child processes picked up under the `Both` fork policy
+    pub fn list_child_sessions(&self) -> Vec<ChildSessionInfo> {
+        self.fork_follower.as_ref().map(|follower| follower.children()).unwrap_or_default()
+    }
+
+    /// Run, stop, kill or release a followed child process
+    pub fn control_child_session(&self, pid: u32, command: ChildCommand) -> IncodeResult<ChildSessionInfo> {
+        let follower = self.fork_follower.as_ref()
+            .ok_or_else(|| IncodeError::process("Fork following is not active (set the fork policy to 'both')"))?;
+        follower.control(pid, command)
+    }
+
+    /// (Re)start following children of the current process if the policy asks for it
+    fn restart_fork_follower(&mut self) {
+        self.stop_fork_follower();
+        if self.fork_policy != ForkPolicy::Both {
+            return;
+        }
+        let Some(process) = self.current_process else {
+            return;
         };
-        
-        let stdout_str = if stdout_len > 0 {
-            stdout_buffer.truncate(stdout_len);
-            String::from_utf8_lossy(&stdout_buffer).to_string()
+
+        let pid = unsafe { SBProcessGetProcessID(process) } as u32;
+        // LLDB reads inherited breakpoints back by path, so they live where no one else can write
+        let breakpoints_dir = match private_dir("incode-fork") {
+            Ok(dir) => dir,
+            Err(e) => {
+                warn!("Not following forks of {}: no private directory for breakpoints: {}", pid, e);
+                return;
+            }
+        };
+        // Checkpoint clones are children too, but must stay frozen
+        let checkpoint_pids = self.checkpoints.list().into_iter().map(|checkpoint| checkpoint.pid);
+        self.fork_follower = Some(ForkFollower::start(pid, self.sessions.clone(), breakpoints_dir, checkpoint_pids));
+        self.sync_fork_breakpoints();
+    }
+
+    fn stop_fork_follower(&mut self) {
+        if let Some(mut follower) = self.fork_follower.take() {
+            follower.stop();
+        }
+    }
+
+    /// Save the stopped process as a frozen copy-on-write fork that
+    /// `restore_checkpoint` can later switch to
+    pub fn checkpoint(&mut self, description: Option<&str>) -> IncodeResult<Checkpoint> {
+        let process = self.current_process.ok_or_else(IncodeError::no_process)?;
+        if unsafe { SBProcessGetState(process) } != StateType::Stopped {
+            return Err(IncodeError::process("Process must be stopped to take a checkpoint"));
+        }
+
+        let thread = self.current_thread
+            .filter(|thread| !thread.is_null())
+            .unwrap_or_else(|| unsafe { SBProcessGetSelectedThread(process) });
+        if thread.is_null() {
+            return Err(IncodeError::thread("No thread to checkpoint"));
+        }
+        let frame = unsafe { SBThreadGetFrameAtIndex(thread, 0) };
+        if frame.is_null() {
+            return Err(IncodeError::frame("No frame to checkpoint"));
+        }
+
+        // Saved before the injected call clobbers them
+        let registers = checkpoint::capture_registers(thread);
+        let pc = unsafe { SBFrameGetPC(frame) };
+
+        // LLDB must stay with the parent across the injected fork(), and the
+        // clone must not be picked up as a followed child
+        if self.fork_policy == ForkPolicy::Child {
+            self.execute_command("settings set target.process.follow-fork-mode parent")?;
+        }
+        let forked = {
+            let mut paused = self.fork_follower.as_ref().map(|follower| follower.pause_discovery());
+            let forked = checkpoint::fork_inferior(frame);
+            if let (Some(paused), Ok(pid)) = (paused.as_mut(), forked.as_ref()) {
+                paused.insert(*pid);
+            }
+            forked
+        };
+        // Put the policy back whatever happened; a clone nobody can find out
+        // about is killed rather than left stopped
+        let restored = match self.fork_policy {
+            ForkPolicy::Child => self.execute_command("settings set target.process.follow-fork-mode child").map(|_| ()),
+            _ => Ok(()),
+        };
+        let pid = forked?;
+        if let Err(e) = restored {
+            checkpoint::kill_clone(pid);
+            return Err(e);
+        }
+
+        let checkpoint = Checkpoint {
+            id: self.checkpoints.next_id(),
+            pid,
+            origin_pid: unsafe { SBProcessGetProcessID(process) } as u32,
+            thread_id: unsafe { SBThreadGetThreadID(thread) } as u32,
+            pc,
+            description: description.map(String::from),
+            created_at: std::time::SystemTime::now(),
+            registers,
+        };
+        info!("Checkpoint {} taken at 0x{:x} (clone PID {})", checkpoint.id, pc, pid);
+        self.checkpoints.insert(checkpoint.clone());
+        Ok(checkpoint)
+    }
+
+    pub fn list_checkpoints(&self) -> Vec<Checkpoint> {
+        self.checkpoints.list()
+    }
+
+    /// Discard a checkpoint and its frozen process
+    pub fn delete_checkpoint(&mut self, id: u32) -> IncodeResult<Checkpoint> {
+        let checkpoint = self.checkpoints.remove(id)
+            .ok_or_else(|| IncodeError::invalid_parameter(format!("No checkpoint {}", id)))?;
+        checkpoint::kill_clone(checkpoint.pid);
+        Ok(checkpoint)
+    }
+
+    /// Replace the current process with checkpoint `id`. The checkpoint is
+    /// consumed unless `keep` is set, in which case it is re-taken right after
+    /// restoring so the same state can be returned to again.
+    pub fn restore_checkpoint(&mut self, id: u32, keep: bool) -> IncodeResult<CheckpointRestore> {
+        let target = self.current_target.ok_or_else(|| IncodeError::lldb_op(NO_TARGET_MSG))?;
+        let checkpoint = self.checkpoints.remove(id)
+            .ok_or_else(|| IncodeError::invalid_parameter(format!("No checkpoint {}", id)))?;
+        if !checkpoint::clone_alive(checkpoint.pid) {
+            return Err(IncodeError::process_not_found(format!(
+                "Checkpoint {} process {} no longer exists", id, checkpoint.pid
+            )));
+        }
+
+        // The checkpoint takes the current process's place under the same target,
+        // so breakpoints and settings carry over. The old process is gone from
+        // here on; the new one is only published once its registers are back.
+        self.stop_console_drainer();
+        self.stop_fork_follower();
+        self.async_run_pending.store(false, Ordering::SeqCst);
+        if let Some(process) = self.current_process.take() {
+            unsafe {
+                let error = SBProcessKill(process);
+                if !error.is_null() {
+                    DisposeSBError(error);
+                }
+                DisposeSBProcess(process);
+            }
+        }
+        if let Some(thread) = self.current_thread.take() {
+            unsafe { DisposeSBThread(thread) };
+        }
+        self.current_thread_id = None;
+        self.current_frame_index = 0;
+
+        let attach_info = unsafe { CreateSBAttachInfo() };
+        unsafe { SBAttachInfoSetProcessID(attach_info, checkpoint.pid as lldb_pid_t) };
+        let error = unsafe { CreateSBError() };
+        let process = unsafe { SBTargetAttach(target, attach_info, error) };
+        let attach_error = if process.is_null() || unsafe { SBErrorFail(error) } {
+            Some(sb_error_message(error))
         } else {
-            "".to_string()
+            None
         };
-        
-        // Get stderr from the process  
-        let mut stderr_buffer = vec![0u8; 1024];
-        let stderr_len = unsafe { 
-            SBProcessGetSTDERR(process, stderr_buffer.as_mut_ptr() as *mut i8, stderr_buffer.len()) 
+        unsafe {
+            DisposeSBError(error);
+            DisposeSBAttachInfo(attach_info);
+        }
+        if let Some(message) = attach_error {
+            if !process.is_null() {
+                unsafe { DisposeSBProcess(process) };
+            }
+            checkpoint::kill_clone(checkpoint.pid);
+            return Err(IncodeError::process_not_found(format!(
+                "Failed to attach to checkpoint {}: {}", id, message
+            )));
+        }
+
+        let thread = unsafe { SBProcessGetSelectedThread(process) };
+        if thread.is_null() {
+            unsafe {
+                let error = SBProcessKill(process);
+                if !error.is_null() {
+                    DisposeSBError(error);
+                }
+                DisposeSBProcess(process);
+            }
+            return Err(IncodeError::thread("Checkpoint process has no thread"));
+        }
+        let (registers_restored, registers_failed) = checkpoint::restore_registers(thread, &checkpoint.registers);
+        let frame = unsafe { SBThreadGetFrameAtIndex(thread, 0) };
+        let pc = if frame.is_null() {
+            0
+        } else {
+            let pc = unsafe { SBFrameGetPC(frame) };
+            unsafe { DisposeSBFrame(frame) };
+            pc
         };
-        
-        let stderr_str = if stderr_len > 0 {
-            stderr_buffer.truncate(stderr_len);
-            String::from_utf8_lossy(&stderr_buffer).to_string()
+
+        self.current_process = Some(process);
+        self.current_thread = Some(thread);
+        self.current_thread_id = Some(unsafe { SBThreadGetThreadID(thread) } as u32);
+        self.restart_fork_follower();
+        if let Some(session_id) = self.current_session {
+            self.update_session_state(&session_id, SessionState::Stopped)?;
+        }
+        info!("Restored checkpoint {} (PID {}) at 0x{:x}", id, checkpoint.pid, pc);
+
+        let kept = if keep {
+            let mut fresh = self.checkpoint(checkpoint.description.as_deref())?;
+            self.checkpoints.remove(fresh.id);
+            fresh.id = checkpoint.id;
+            fresh.created_at = checkpoint.created_at;
+            self.checkpoints.insert(fresh.clone());
+            Some(fresh)
         } else {
-            "".to_string()
+            None
         };
-        
-        // Combine stdout and stderr
-        let combined_output = if !stdout_str.is_empty() || !stderr_str.is_empty() {
-            format!("STDOUT:\n{}\nSTDERR:\n{}", stdout_str, stderr_str)
+
+        Ok(CheckpointRestore {
+            pid: checkpoint.pid,
+            pc,
+            pc_matches: pc == checkpoint.pc,
+            registers_restored,
+            registers_failed,
+            checkpoint,
+            kept,
+        })
+    }
+
+    /// Children can only be forked while the parent runs, so publishing the
+    /// parent's breakpoints on every resume keeps what they inherit current
+    fn sync_fork_breakpoints(&self) {
+        if let (Some(follower), Some(target)) = (self.fork_follower.as_ref(), self.current_target) {
+            if let Err(e) = save_breakpoints(target, follower.breakpoints_file()) {
+                warn!("Children will not inherit breakpoints: {}", e);
+            }
+        }
+    }
+
+    /// Open a core file as the current process. LLDB serves threads, registers
+    /// and memory from it; the core is also mapped natively for its signal
+    /// notes and segment table. Neither reads the file up front.
+    pub fn load_core(&mut self, core_path: &str, executable: Option<&str>) -> IncodeResult<CoreSummary> {
+        debug!("Loading core {} (executable {:?})", core_path, executable);
+
+        let debugger = self.debugger.ok_or_else(|| IncodeError::lldb_init("No debugger instance"))?;
+        let load_start = Instant::now();
+        let core = CoreFile::open(core_path)?;
+
+        // Without an executable LLDB falls back to the core's own file mappings,
+        // which lack symbols when the binary has moved
+        let executable = executable
+            .map(String::from)
+            .or_else(|| core.executable_path().filter(|path| Path::new(path).exists()).map(String::from));
+        let exe_cstr = executable.as_deref()
+            .map(std::ffi::CString::new)
+            .transpose()
+            .map_err(|_| IncodeError::invalid_parameter("Invalid executable path"))?;
+        let core_cstr = std::ffi::CString::new(core_path)
+            .map_err(|_| IncodeError::invalid_parameter("Invalid core file path"))?;
+        let target = unsafe {
+            SBDebuggerCreateTarget2(debugger, exe_cstr.as_ref().map_or(std::ptr::null(), |exe| exe.as_ptr()))
+        };
+        if target.is_null() {
+            return Err(IncodeError::lldb_op(format!("Failed to create target for core {}", core_path)));
+        }
+
+        let error = unsafe { CreateSBError() };
+        let process = unsafe { SBTargetLoadCore2(target, core_cstr.as_ptr(), error) };
+        let load_error = if process.is_null() || unsafe { SBErrorFail(error) } {
+            Some(sb_error_message(error))
         } else {
-            "No console output available".to_string()
+            None
+        };
+        unsafe { DisposeSBError(error) };
+        if let Some(message) = load_error {
+            unsafe { SBDebuggerDeleteTarget(debugger, target) };
+            return Err(IncodeError::lldb_op(format!("Failed to load core {}: {}", core_path, message)));
+        }
+
+        // The core replaces whatever was being debugged; it has no live process to drain or follow
+        self.release_process();
+
+        let faulting_tid = core.faulting_thread().map(|thread| thread.tid);
+        if let Some(tid) = faulting_tid {
+            unsafe { SBProcessSetSelectedThreadByID(process, tid as lldb_tid_t) };
+        }
+        self.current_target = Some(target);
+        self.current_process = Some(process);
+        self.launch_config = None;
+        self.current_thread = None;
+        self.current_thread_id = faulting_tid;
+        self.current_frame_index = 0;
+        if let Some(session_id) = self.current_session {
+            self.update_session_state(&session_id, SessionState::Stopped)?;
+        }
+
+        let summary = CoreSummary {
+            path: core_path.to_string(),
+            executable,
+            pid: core.pid,
+            command: core.command.clone(),
+            file_size: core.file_size(),
+            segments: core.segments.len(),
+            mapped_bytes: core.segments.iter().map(|segment| segment.memsz).sum(),
+            threads: core.threads.len(),
+            faulting_thread: faulting_tid,
+            faulting_pc: core.faulting_thread().and_then(|thread| thread.pc),
+            faulting_sp: core.faulting_thread().and_then(|thread| thread.sp),
+            signal: core.signal.clone(),
+            load_ms: load_start.elapsed().as_millis() as u64,
         };
-        
-        Ok(combined_output)
+        info!("Loaded core {} ({} threads, {} segments) in {}ms", core_path, summary.threads, summary.segments, summary.load_ms);
+        self.core = Some(core);
+        Ok(summary)
     }
 
     /// Attach to an existing process
@@ -766,9 +1787,17 @@ impl LldbManager {
             return Err(IncodeError::lldb_op(format!("Process {} is not in a valid state for debugging", pid)));
         }
 
+        // Checkpoints are clones of the previous process, not of this one
+        self.checkpoints.discard_all();
+
         // Update internal state
         self.current_target = Some(target);
         self.current_process = Some(process);
+        self.core = None;
+        self.launch_config = None;
+        self.async_run_pending.store(false, Ordering::SeqCst);
+        self.reset_console();
+        self.restart_fork_follower();
 
         // Update session state if we have one
         if let Some(session_id) = self.current_session {
@@ -797,6 +1826,10 @@ impl LldbManager {
         // Clear current process state
         self.current_process = None;
         self.current_target = None;
+        self.core = None;
+        self.async_run_pending.store(false, Ordering::SeqCst);
+        self.stop_console_drainer();
+        self.stop_fork_follower();
 
         // Update session state if we have one
         if let Some(session_id) = self.current_session {
@@ -812,6 +1845,7 @@ impl LldbManager {
         debug!("Continuing execution");
         
         let process = self.current_process.ok_or_else(|| IncodeError::lldb_op("No process to continue"))?;
+        self.sync_fork_breakpoints();
 
         let error = unsafe { CreateSBError() };
         unsafe { SBProcessContinue(process) };
@@ -823,6 +1857,174 @@ impl LldbManager {
         Ok(())
     }
 
+    /// Resume the process without waiting for it to stop
+    ///
+    /// The debugger is switched to asynchronous mode only for the resume itself, so
+    /// the eventual stop is left queued on the debugger listener for `wait_for_stop`
+    /// while every other operation keeps its synchronous behaviour.
+    pub fn continue_async(&self) -> IncodeResult<()> {
+        debug!("Continuing execution asynchronously");
+
+        let debugger = self.debugger.ok_or_else(|| IncodeError::lldb_init("No debugger instance"))?;
+        let process = self.current_process.ok_or_else(|| IncodeError::lldb_op("No process to continue"))?;
+
+        let state = unsafe { SBProcessGetState(process) };
+        if self.async_run_pending.load(Ordering::SeqCst) || state == StateType::Running || state == StateType::Stepping {
+            return Err(IncodeError::process("Process is already running - use wait_for_stop or interrupt_execution"));
+        }
+
+        self.sync_fork_breakpoints();
+        unsafe { SBDebuggerSetAsync(debugger, true) };
+        let error = unsafe { SBProcessContinue(process) };
+        unsafe { SBDebuggerSetAsync(debugger, false) };
+
+        let result = if !error.is_null() && unsafe { SBErrorFail(error) } {
+            Err(IncodeError::lldb_op(format!("Failed to continue process execution: {}", sb_error_message(error))))
+        } else {
+            Ok(())
+        };
+        if !error.is_null() {
+            unsafe { DisposeSBError(error) };
+        }
+        result?;
+
+        self.async_run_pending.store(true, Ordering::SeqCst);
+
+        if let Some(session_id) = self.current_session {
+            self.update_session_state(&session_id, SessionState::Running)?;
+        }
+
+        info!("Process resumed asynchronously");
+        Ok(())
+    }
+
+    /// Wait for the next stop after `continue_async`, giving up after `timeout_ms`
+    ///
+    /// Returns `IncodeError::Timeout` if the process is still running when the
+    /// deadline passes; the run stays pending so the call can simply be repeated.
+    /// Timeouts are capped at `MAX_STOP_WAIT_MS`.
+    pub fn wait_for_stop(&mut self, timeout_ms: u64) -> IncodeResult<StopEvent> {
+        let stop = self.wait_for_process_event(timeout_ms.min(MAX_STOP_WAIT_MS))?;
+
+        if let Some(process) = self.current_process {
+            let thread = unsafe { SBProcessGetSelectedThread(process) };
+            if !thread.is_null() && stop.thread_id.is_some() {
+                self.current_thread = Some(thread);
+                self.current_thread_id = stop.thread_id;
+                self.current_frame_index = 0;
+            }
+        }
+
+        if let Some(session_id) = self.current_session {
+            let session_state = match stop.state.as_str() {
+                "Exited" | "Crashed" => SessionState::Terminated,
+                "Detached" => SessionState::Created,
+                _ => SessionState::Stopped,
+            };
+            self.update_session_state(&session_id, session_state)?;
+        }
+
+        Ok(stop)
+    }
+
+    /// Pull process events off the debugger listener until the process comes to rest
+    fn wait_for_process_event(&self, timeout_ms: u64) -> IncodeResult<StopEvent> {
+        debug!("Waiting up to {}ms for process to stop", timeout_ms);
+
+        let debugger = self.debugger.ok_or_else(|| IncodeError::lldb_init("No debugger instance"))?;
+        let process = self.current_process.ok_or_else(|| IncodeError::no_process())?;
+        let start = Instant::now();
+
+        let state = if self.async_run_pending.load(Ordering::SeqCst) {
+            let listener = unsafe { SBDebuggerGetListener(debugger) };
+            if listener.is_null() {
+                return Err(IncodeError::lldb_op("Failed to get debugger listener"));
+            }
+
+            let deadline = start + Duration::from_millis(timeout_ms);
+            let event = unsafe { CreateSBEvent() };
+            let outcome = loop {
+                let remaining = deadline.saturating_duration_since(Instant::now());
+                if remaining.is_zero() {
+                    break None;
+                }
+
+                // SBListenerWaitForEvent only has whole-second resolution: block for
+                // a second at a time while that fits, then poll out the remainder.
+                let got_event = if remaining >= Duration::from_secs(1) {
+                    unsafe { SBListenerWaitForEvent(listener, 1, event) }
+                } else {
+                    let got = unsafe { SBListenerWaitForEvent(listener, 0, event) };
+                    if !got {
+                        std::thread::sleep(remaining.min(Duration::from_millis(10)));
+                    }
+                    got
+                };
+                if !got_event || !unsafe { SBProcessEventIsProcessEvent(event) } {
+                    continue;
+                }
+
+                let event_state = unsafe { SBProcessGetStateFromEvent(event) };
+                if event_state == StateType::Stopped && unsafe { SBProcessGetRestartedFromEvent(event) } {
+                    continue;
+                }
+                if is_rest_state(event_state) {
+                    break Some(event_state);
+                }
+            };
+            unsafe { DisposeSBEvent(event) };
+
+            match outcome {
+                Some(state) => {
+                    self.async_run_pending.store(false, Ordering::SeqCst);
+                    state
+                }
+                None => {
+                    debug!("Process still running after {}ms", timeout_ms);
+                    return Err(IncodeError::Timeout);
+                }
+            }
+        } else {
+            let state = unsafe { SBProcessGetState(process) };
+            if !is_rest_state(state) {
+                return Err(IncodeError::process("Process is running but was not resumed with continue_async"));
+            }
+            state
+        };
+
+        let pid = unsafe { SBProcessGetProcessID(process) } as u32;
+        let exit_status = if state == StateType::Exited {
+            Some(unsafe { SBProcessGetExitStatus(process) })
+        } else {
+            None
+        };
+
+        let (thread_id, stop_reason) = if state == StateType::Stopped || state == StateType::Crashed {
+            let thread = unsafe { SBProcessGetSelectedThread(process) };
+            if thread.is_null() {
+                (None, None)
+            } else {
+                let tid = unsafe { SBThreadGetThreadID(thread) } as u32;
+                let reason = unsafe { SBThreadGetStopReason(thread) };
+                (Some(tid), Some(format!("{:?}", reason)))
+            }
+        } else {
+            (None, None)
+        };
+
+        let stop = StopEvent {
+            pid,
+            state: state_name(state).to_string(),
+            thread_id,
+            stop_reason,
+            exit_status,
+            elapsed_ms: start.elapsed().as_millis() as u64,
+        };
+
+        info!("Process {} came to rest: {} after {}ms", pid, stop.state, stop.elapsed_ms);
+        Ok(stop)
+    }
+
     /// Kill current process
     pub fn kill_process(&mut self) -> IncodeResult<()> {
         debug!("Killing current process");
@@ -838,6 +2040,10 @@ impl LldbManager {
         // Clear current process state
         self.current_process = None;
         self.current_target = None;
+        self.core = None;
+        self.async_run_pending.store(false, Ordering::SeqCst);
+        self.stop_console_drainer();
+        self.stop_fork_follower();
 
         // Update session state if we have one
         if let Some(session_id) = self.current_session {
@@ -857,26 +2063,12 @@ impl LldbManager {
         let pid = unsafe { SBProcessGetProcessID(process) } as u32;
         let state = unsafe { SBProcessGetState(process) };
         
-        let state_str = match state {
-            StateType::Invalid => "Invalid",
-            StateType::Unloaded => "Unloaded",
-            StateType::Connected => "Connected",
-            StateType::Attaching => "Attaching",
-            StateType::Launching => "Launching",
-            StateType::Stopped => "Stopped",
-            StateType::Running => "Running",
-            StateType::Stepping => "Stepping",
-            StateType::Crashed => "Crashed",
-            StateType::Detached => "Detached",
-            StateType::Exited => "Exited",
-            StateType::Suspended => "Suspended",
-        };
-
         Ok(ProcessInfo {
             pid,
-            state: state_str.to_string(),
+            state: state_name(state).to_string(),
             executable_path: None, // TODO: implement
             memory_usage: None,    // TODO: implement
+            ..Default::default()
         })
     }
 
@@ -1050,6 +2242,27 @@ impl LldbManager {
         
         let process = self.current_process.ok_or_else(|| IncodeError::lldb_op("No active process to interrupt"))?;
 
+        if self.async_run_pending.load(Ordering::SeqCst) {
+            // A synchronous stop would hijack the stop event from the debugger
+            // listener, so halt asynchronously and collect the event ourselves.
+            let debugger = self.debugger.ok_or_else(|| IncodeError::lldb_init("No debugger instance"))?;
+            unsafe { SBDebuggerSetAsync(debugger, true) };
+            let error = unsafe { SBProcessStop(process) };
+            unsafe { SBDebuggerSetAsync(debugger, false) };
+            if !error.is_null() {
+                let failed = unsafe { SBErrorFail(error) };
+                let message = if failed { Some(sb_error_message(error)) } else { None };
+                unsafe { DisposeSBError(error) };
+                if let Some(message) = message {
+                    return Err(IncodeError::lldb_op(format!("Failed to interrupt process execution: {}", message)));
+                }
+            }
+
+            let stop = self.wait_for_process_event(5000)?;
+            info!("Successfully interrupted asynchronously running process ({})", stop.state);
+            return Ok(());
+        }
+
         // Use SBProcessStop instead of SBProcessSendAsyncInterrupt
         let error = unsafe { CreateSBError() };
         let _success = unsafe { SBProcessStop(process) };
@@ -1461,6 +2674,30 @@ impl LldbManager {
         }
 
         let mut buffer = vec![0u8; size];
+
+        // Reads the dump holds in full come straight from the mapped core.
+        // Anything else, such as file-backed pages the kernel left out of the
+        // dump, is read through LLDB, which falls back to the module files.
+        if let Some(ref core) = self.core {
+            let mut copied = 0;
+            while copied < size {
+                let at = address + copied as u64;
+                let Some(segment) = core.segment_at(at).filter(|segment| at - segment.vaddr < segment.filesz) else {
+                    break;
+                };
+                let in_file = (segment.filesz - (at - segment.vaddr)).min((size - copied) as u64) as usize;
+                let read = core.read_memory(at, &mut buffer[copied..copied + in_file]);
+                copied += read;
+                if read < in_file {
+                    break;
+                }
+            }
+            if copied == size && size > 0 {
+                debug!("Read {} bytes from core at 0x{:x}", size, address);
+                return Ok(buffer);
+            }
+        }
+
         let error = unsafe { CreateSBError() };
         let bytes_read = unsafe { 
             SBProcessReadMemory(process, address, buffer.as_mut_ptr() as *mut std::ffi::c_void, size, error)
@@ -1481,24 +2718,42 @@ impl LldbManager {
     /// Disassemble instructions at address
     pub fn disassemble(&self, address: u64, count: u32) -> IncodeResult<Vec<String>> {
         debug!("Disassembling {} instructions at 0x{:x}", count, address);
-        
+
+        Ok(self.disassemble_instructions(address, count)?
+            .instructions
+            .iter()
+            .map(disassembly::Instruction::text)
+            .collect())
+    }
+
+    /// Decode `count` instructions at `address` with symbolic branch and
+    /// RIP-relative operands. Runs inside a module are served from the cache
+    /// when an earlier request decoded at least as many instructions there.
+    pub fn disassemble_instructions(&self, address: u64, count: u32) -> IncodeResult<Disassembly> {
         if cfg!(test) {
             // Mock implementation for testing - generate realistic assembly
             let mut instructions = Vec::new();
             for i in 0..count {
                 let addr = address + (i as u64 * 4); // Assume 4-byte instructions
-                let instruction = match i % 6 {
-                    0 => format!("0x{:016x}: mov rax, rbx", addr),
-                    1 => format!("0x{:016x}: add rax, 0x10", addr),
-                    2 => format!("0x{:016x}: cmp rax, rdx", addr),
-                    3 => format!("0x{:016x}: je 0x{:x}", addr, addr + 8),
-                    4 => format!("0x{:016x}: call 0x{:x}", addr, addr + 0x100),
-                    5 => format!("0x{:016x}: ret", addr),
-                    _ => format!("0x{:016x}: nop", addr),
+                let (mnemonic, operands, target) = match i % 6 {
+                    0 => ("mov", "rax, rbx".to_string(), None),
+                    1 => ("add", "rax, 0x10".to_string(), None),
+                    2 => ("cmp", "rax, rdx".to_string(), None),
+                    3 => ("je", format!("0x{:x}", addr + 8), Some(addr + 8)),
+                    4 => ("call", format!("0x{:x}", addr + 0x100), Some(addr + 0x100)),
+                    _ => ("ret", String::new(), None),
                 };
-                instructions.push(instruction);
+                instructions.push(disassembly::Instruction {
+                    address: addr,
+                    size: 4,
+                    mnemonic: mnemonic.to_string(),
+                    operands,
+                    comment: None,
+                    target,
+                    symbol: None,
+                });
             }
-            return Ok(instructions);
+            return Ok(Disassembly { address, function: None, instructions, cached: false });
         }
 
         let target = self.current_target.ok_or_else(|| IncodeError::lldb_op("No active target for disassembly"))?;
@@ -1507,22 +2762,230 @@ impl LldbManager {
             return Err(IncodeError::lldb_op("Disassembly instruction count too large (max 1000)"));
         }
 
-        unsafe {
-            let addr_obj = SBTargetResolveLoadAddress(target, address);
-            let instruction_list = SBTargetReadInstructions(target, addr_obj, count);
-            if instruction_list.is_null() {
-                return Err(IncodeError::lldb_op(format!("Failed to disassemble at address 0x{:x}", address)));
+        let key = disassembly::cache_key(target, address);
+        if let Some(run) = key.as_ref().and_then(|key| self.disassembly.get(key)) {
+            if run.instructions.len() >= count as usize {
+                return Ok(Disassembly {
+                    address,
+                    function: run.function.clone(),
+                    instructions: run.at(address, count as usize),
+                    cached: true,
+                });
             }
-            
-            // For now, return mock-style data until we implement full LLDB instruction parsing
-            // TODO: Parse actual SBInstructionList object to extract real disassembly
-            let mut instructions = Vec::new();
-            for i in 0..count {
-                let addr = address + (i as u64 * 4); // Assume 4-byte instructions for x86_64
-                instructions.push(format!("0x{:016x}: <instruction_{}>", addr, i));
+        }
+
+        let decode_start = Instant::now();
+        let run = disassembly::decode(target, address, count)
+            .ok_or_else(|| IncodeError::lldb_op(format!("Failed to disassemble at address 0x{:x}", address)))?;
+        let cost_us = decode_start.elapsed().as_micros() as u64;
+        debug!("Decoded {} instructions at 0x{:x} in {}us", run.instructions.len(), address, cost_us);
+
+        let disassembly = Disassembly {
+            address,
+            function: run.function.clone(),
+            instructions: run.at(address, count as usize),
+            cached: false,
+        };
+        if let Some(key) = key {
+            let size = run.approx_bytes();
+            self.disassembly.insert(key, Arc::new(run), size, cost_us);
+        }
+        Ok(disassembly)
+    }
+
+    /// Drop decoded runs and CFGs that overlap `len` bytes just written at
+    /// `address`, so patched code is decoded again
+    fn forget_code(&self, address: u64, len: u64) {
+        let Some(target) = self.current_target else {
+            return;
+        };
+        // Code outside a module is never cached
+        let Some((path, uuid, file_address)) = disassembly::code_identity(target, address) else {
+            return;
+        };
+        let prefix = format!("{}@", session_snapshot::build_key(&path, uuid.as_deref()));
+        let written = file_address..file_address.saturating_add(len);
+        let overlaps = |key: &String, run_len: u64| {
+            key.starts_with(&prefix) && disassembly::key_file_address(key).map_or(false, |start| {
+                start < written.end && written.start < start.saturating_add(run_len)
+            })
+        };
+        self.disassembly.retain(|key, run| !overlaps(key, run.byte_len()));
+        self.function_cfgs.retain(|key, cfg| !overlaps(key, cfg.size));
+    }
+
+    /// Control-flow graph of the function containing `address`, with the
+    /// function's load address
+    pub fn function_cfg(&self, address: u64) -> IncodeResult<(u64, Arc<FunctionCfg>)> {
+        let target = self.current_target.ok_or_else(|| IncodeError::lldb_op("No active target"))?;
+        let (start, end, name) = disassembly::symbol_bounds(target, address)
+            .ok_or_else(|| IncodeError::lldb_op(format!("No function contains address 0x{:x}", address)))?;
+        let identity = disassembly::code_identity(target, start);
+        let key = identity.as_ref().map(|(path, uuid, file_address)| cfg_key(path, uuid, *file_address));
+        if let Some(cfg) = key.as_ref().and_then(|key| self.function_cfgs.get(key)) {
+            return Ok((start, cfg));
+        }
+
+        let build_start = Instant::now();
+        let run = disassembly::decode_range(target, start, end)
+            .ok_or_else(|| IncodeError::lldb_op(format!("Failed to disassemble function at 0x{:x}", start)))?;
+        let build_id = identity.and_then(|(_, uuid, _)| uuid);
+        let cfg = Arc::new(FunctionCfg::build(name, build_id, end - start, &run.instructions));
+        let cost_us = build_start.elapsed().as_micros() as u64;
+        debug!("Built CFG for 0x{:x}: {} blocks, {} loops in {}us", start, cfg.blocks.len(), cfg.loops.len(), cost_us);
+        if let Some(key) = key {
+            self.function_cfgs.insert(key, cfg.clone(), cfg.approx_bytes(), cost_us);
+        }
+        Ok((start, cfg))
+    }
+
+    /// Control-flow graphs of up to `max_functions` code symbols in the first
+    /// module whose path contains `module_filter`. Decoding goes through LLDB
+    /// one function at a time; the graph analysis runs on all cores.
+    pub fn module_cfgs(&self, module_filter: &str, max_functions: usize) -> IncodeResult<Vec<(u64, Arc<FunctionCfg>)>> {
+        let target = self.current_target.ok_or_else(|| IncodeError::lldb_op("No active target"))?;
+        let (module, (path, uuid)) = (0..unsafe { SBTargetGetNumModules(target) })
+            .map(|i| unsafe { SBTargetGetModuleAtIndex(target, i) })
+            .filter_map(|module| session_snapshot::module_identity(module).map(|identity| (module, identity)))
+            .find(|(_, (path, _))| path.contains(module_filter))
+            .ok_or_else(|| IncodeError::lldb_op(format!("No module matches {}", module_filter)))?;
+
+        let mut functions: Vec<(u64, u64, u64, Option<String>)> = Vec::new();
+        for i in 0..unsafe { SBModuleGetNumSymbols(module) } {
+            if functions.len() >= max_functions {
+                break;
+            }
+            let symbol = unsafe { SBModuleGetSymbolAtIndex(module, i) };
+            if symbol.is_null() || unsafe { SBSymbolGetType(symbol) } != SymbolType::Code {
+                continue;
+            }
+            let (start, end) = unsafe { (SBSymbolGetStartAddress(symbol), SBSymbolGetEndAddress(symbol)) };
+            if start.is_null() || end.is_null() {
+                continue;
+            }
+            let file_address = unsafe { SBAddressGetFileAddress(start) };
+            let (start, end) = unsafe { (SBAddressGetLoadAddress(start, target), SBAddressGetLoadAddress(end, target)) };
+            if start == u64::MAX || end <= start {
+                continue;
             }
-            Ok(instructions)
+            let name_ptr = unsafe { SBSymbolGetName(symbol) };
+            let name = (!name_ptr.is_null()).then(|| unsafe { std::ffi::CStr::from_ptr(name_ptr) }.to_string_lossy().into_owned());
+            functions.push((start, end, file_address, name));
+        }
+
+        let mut cfgs = Vec::with_capacity(functions.len());
+        let mut pending = Vec::new();
+        let mut pending_meta = Vec::new();
+        let decode_start = Instant::now();
+        for (start, end, file_address, name) in functions {
+            let key = cfg_key(&path, &uuid, file_address);
+            if let Some(cfg) = self.function_cfgs.get(&key) {
+                cfgs.push((start, cfg));
+                continue;
+            }
+            if let Some(run) = disassembly::decode_range(target, start, end) {
+                pending.push((name, uuid.clone(), end - start, run.instructions));
+                pending_meta.push((start, key));
+            }
+        }
+
+        let built = function_cfg::build_parallel(pending);
+        let cost_us = decode_start.elapsed().as_micros() as u64 / built.len().max(1) as u64;
+        debug!("Built {} CFGs for {} ({} cached)", built.len(), path, cfgs.len());
+        for ((start, key), cfg) in pending_meta.into_iter().zip(built) {
+            let cfg = Arc::new(cfg);
+            self.function_cfgs.insert(key, cfg.clone(), cfg.approx_bytes(), cost_us);
+            cfgs.push((start, cfg));
+        }
+        cfgs.sort_by_key(|(start, _)| *start);
+        Ok(cfgs)
+    }
+
+    /// Cross-reference index of the module containing `address`, with the
+    /// address as a file address and the module's slide. The first query for
+    /// a module build starts its sweep with worker processes and returns after
+    /// at most `wait`; without the worker binary, queries sweep the module
+    /// themselves a little at a time, again for at most `wait`.
+    fn xref_index_for(&self, address: u64, wait: Duration) -> IncodeResult<(Arc<XrefIndex>, u64, u64)> {
+        let target = self.current_target.ok_or_else(|| IncodeError::lldb_op("No active target"))?;
+        let deadline = Instant::now() + wait;
+        let resolved = unsafe { SBTargetResolveLoadAddress(target, address) };
+        if resolved.is_null() {
+            return Err(IncodeError::lldb_op(format!("Cannot resolve address 0x{:x}", address)));
+        }
+        let module = unsafe { SBAddressGetModule(resolved) };
+        let file_address = unsafe { SBAddressGetFileAddress(resolved) };
+        unsafe { DisposeSBAddress(resolved) };
+        let (path, uuid) = session_snapshot::module_identity(module)
+            .filter(|_| file_address != u64::MAX)
+            .ok_or_else(|| IncodeError::lldb_op(format!("Address 0x{:x} is not in a module", address)))?;
+        let slide = address.wrapping_sub(file_address);
+
+        let key = session_snapshot::build_key(&path, uuid.as_deref());
+        let index = match self.xref_indexes.get(&key) {
+            Some(index) => index,
+            None => {
+                let (sections, functions) = xref_index::module_layout(module);
+                let base = sections.first().map(|(start, _)| *start)
+                    .ok_or_else(|| IncodeError::lldb_op(format!("{} has no code sections", path)))?;
+                let chunks = xref_index::plan_chunks(&sections, &functions, xref_index::CHUNK_BYTES);
+                let index = Arc::new(XrefIndex::new(path.clone(), uuid, base, functions, &chunks));
+                // Until it is charged for real, cost the sweep by code size so it is not evicted mid-way
+                self.xref_indexes.insert(key.clone(), index.clone(), index.approx_bytes(), index.bytes_total / 16);
+                match crash_triage::default_worker_exe() {
+                    Some(worker_exe) => {
+                        let cache = self.xref_indexes.clone();
+                        let key = key.clone();
+                        xref_index::start_sweep(index.clone(), worker_exe, PathBuf::from(path), chunks, move |index| {
+                            charge_xref_index(&cache, key, index)
+                        });
+                    }
+                    None => index.defer(chunks),
+                }
+                index
+            }
+        };
+
+        // Only an in-process sweep leaves chunks pending; worker sweeps just need waiting on
+        if index.sweep_pending(target, module, deadline) {
+            charge_xref_index(&self.xref_indexes, key, &index);
         }
+        index.wait(deadline.saturating_duration_since(Instant::now()));
+        Ok((index, file_address, slide))
+    }
+
+    /// References to `address`, or to anywhere in its function when
+    /// `whole_function` is set. Waits up to `wait` for the module sweep; an
+    /// unfinished sweep gives the references found so far.
+    pub fn xrefs_to(&self, address: u64, whole_function: bool, wait: Duration) -> IncodeResult<XrefQuery> {
+        let (index, file_address, slide) = self.xref_index_for(address, wait)?;
+        let (start, end) = match index.function_at(file_address) {
+            Some(function) if whole_function => (function.start, function.end),
+            _ => (file_address, file_address + 1),
+        };
+        let hits = index.xrefs_to(start, end);
+        Ok(XrefQuery { index, slide, start, end, hits })
+    }
+
+    /// References made by the function containing `address`. Jumps that stay
+    /// inside the function are left out unless `include_local_jumps` is set.
+    pub fn xrefs_from(&self, address: u64, include_local_jumps: bool, wait: Duration) -> IncodeResult<XrefQuery> {
+        let (index, file_address, slide) = self.xref_index_for(address, wait)?;
+        let (start, end) = index.function_at(file_address)
+            .map(|function| (function.start, function.end))
+            .ok_or_else(|| IncodeError::lldb_op(format!("No function contains address 0x{:x}", address)))?;
+        let mut hits = index.xrefs_from(start, end);
+        if !include_local_jumps {
+            hits.retain(|hit| hit.kind != XrefKind::Jump || !(start..end).contains(&hit.to));
+        }
+        Ok(XrefQuery { index, slide, start, end, hits })
+    }
+
+    /// Start address of a function, for disassembly by name
+    pub fn function_address(&self, name: &str) -> IncodeResult<u64> {
+        let target = self.current_target.ok_or_else(|| IncodeError::lldb_op("No active target"))?;
+        disassembly::function_address(target, name)
+            .ok_or_else(|| IncodeError::lldb_op(format!("Function {} not found", name)))
     }
 
     /// Write data to memory at address
@@ -1549,6 +3012,7 @@ impl LldbManager {
             }
             
             info!("Wrote {} bytes to address 0x{:x}", bytes_written, address);
+            self.forget_code(address, bytes_written as u64);
             Ok(bytes_written as usize)
         }
     }
@@ -1649,21 +3113,30 @@ impl LldbManager {
             return Ok(regions);
         }
 
-        let _process = self.current_process.ok_or_else(|| IncodeError::lldb_op("No active process for memory regions"))?;
-        
-        // TODO: Implement actual memory region enumeration using LLDB API
-        // For now, return placeholder regions
-        let regions = vec![
-            MemoryRegion {
-                start_address: 0x100000000,
-                end_address: 0x100001000,
-                size: 0x1000,
-                permissions: "r-x".to_string(),
-                name: Some("TEXT_SEGMENT".to_string()),
-            },
-        ];
+        let process = self.current_process.ok_or_else(|| IncodeError::lldb_op("No active process for memory regions"))?;
+
+        if let Some(ref core) = self.core {
+            // Compact dumps record the whole map, not just what they captured
+            if !core.region_map.is_empty() {
+                return Ok(core.region_map.iter().map(|region| MemoryRegion {
+                    start_address: region.start,
+                    end_address: region.end,
+                    size: region.end.saturating_sub(region.start),
+                    permissions: region.permissions.chars().take(3).collect(),
+                    name: region.path.clone(),
+                }).collect());
+            }
+            return Ok(core.segments.iter().map(|segment| MemoryRegion {
+                start_address: segment.vaddr,
+                end_address: segment.end(),
+                size: segment.memsz,
+                permissions: segment.permissions(),
+                name: core.mapped_file_at(segment.vaddr).map(|file| file.path.clone()),
+            }).collect());
+        }
         
-        Ok(regions)
+        process_regions(process)
+            .ok_or_else(|| IncodeError::lldb_op("LLDB could not list the process's memory regions"))
     }
 
     /// Dump memory region to file
@@ -1888,20 +3361,213 @@ impl LldbManager {
             return Ok(result.to_string());
         }
 
-        let thread = self.current_thread.ok_or_else(|| IncodeError::lldb_op("No active thread for expression evaluation"))?;
-        let frame = if let Some(index) = frame_index {
-            unsafe { SBThreadGetFrameAtIndex(thread, index) }
-        } else {
-            unsafe { SBThreadGetSelectedFrame(thread) }
-        };
+        self.evaluate(frame_index, expression, expression::DEFAULT_TIMEOUT)
+            .map(|value| value.display())
+    }
 
+    /// Evaluate `expression` in frame `frame_index` (the current frame when
+    /// None). Plain lvalue paths are read from debug info without running
+    /// code; anything else goes through LLDB's expression evaluator.
+    pub fn evaluate(&self, frame_index: Option<u32>, expression: &str, timeout: Duration) -> IncodeResult<ExpressionValue> {
+        if expression.trim().is_empty() {
+            return Err(IncodeError::invalid_parameter("expression cannot be empty"));
+        }
+        let frame = self.expression_frame(frame_index)?;
+        let value = expression::evaluate(frame, expression, timeout)?;
+        debug!("Evaluated '{}' in {}us ({})", expression, value.elapsed_us,
+               if value.fast_path { "lvalue path" } else { "expression evaluator" });
+        Ok(value)
+    }
+
+    /// Decode `limit` elements from `offset` of the standard container that
+    /// `expression` denotes, reading its storage directly
+    pub fn decode_container(&self, expression: &str, frame_index: Option<u32>, offset: u64, limit: usize) -> IncodeResult<ContainerView> {
+        let process = self.current_process.ok_or_else(|| IncodeError::process("No active process"))?;
+        if expression::is_unsafe(expression) {
+            return Err(IncodeError::expression(format!("Unsafe expression detected: {}", expression)));
+        }
+        let frame = self.expression_frame(frame_index)?;
+        let value = expression::value_of(frame, expression, expression::DEFAULT_TIMEOUT)?;
+        let (container, address) = stl_decode::container_of(value)
+            .ok_or_else(|| IncodeError::invalid_parameter(format!("'{}' is not a supported standard container in memory", expression)))?;
+
+        let started = Instant::now();
+        let view = stl_decode::decode(&stl_decode::ProcessMemory(process), &container, address, offset, limit)
+            .map_err(|e| IncodeError::lldb_op(format!("Failed to decode {}: {}", container.type_info.name, e)))?;
+        debug!("Decoded {} of {} {} elements with {} reads ({} bytes) in {}us",
+               view.elements.len(), view.size, container.kind.name(), view.reads, view.bytes_read,
+               started.elapsed().as_micros());
+        Ok(view)
+    }
+
+    fn expression_frame(&self, frame_index: Option<u32>) -> IncodeResult<SBFrameRef> {
+        let thread = self.resolve_thread(None)?;
+        let frame = unsafe { SBThreadGetFrameAtIndex(thread, frame_index.unwrap_or(self.current_frame_index)) };
         if frame.is_null() {
-            return Err(IncodeError::lldb_op("Invalid frame for expression evaluation"));
+            return Err(IncodeError::frame("Invalid frame for expression evaluation"));
+        }
+        Ok(frame)
+    }
+
+    /// Work out how `expression` evaluates in the frame's context and keep
+    /// the plan under a handle. Preparing the same expression again returns
+    /// the same handle.
+    pub fn prepare_expression(&mut self, expression: &str, frame_index: Option<u32>) -> IncodeResult<(u32, Plan)> {
+        if expression.trim().is_empty() {
+            return Err(IncodeError::invalid_parameter("expression cannot be empty"));
+        }
+        // Handles are only ever made for expressions that pass, so evaluating
+        // one by handle needs no second check
+        if expression::is_unsafe(expression) {
+            return Err(IncodeError::expression(format!("Unsafe expression detected: {}", expression)));
+        }
+        let frame = self.expression_frame(frame_index)?;
+        let context = expression::frame_context(frame);
+        let plan = expression::plan(frame, expression);
+        let handle = self.prepared_expressions.prepare(expression, context.clone(), plan);
+        let plan = self.prepared_expressions.get(handle)
+            .and_then(|prepared| prepared.plan(&context))
+            .cloned()
+            .unwrap_or(Plan::Evaluator);
+        debug!("Prepared '{}' as handle {} ({})", expression, handle, plan.kind());
+        Ok((handle, plan))
+    }
+
+    /// Evaluate a prepared expression in the frame, reusing the plan made for
+    /// the frame's context. A frame from a context not seen before is a miss
+    /// and gets its own plan. Returns the value and the handle's hit and miss counts.
+    pub fn evaluate_prepared(&mut self, handle: u32, frame_index: Option<u32>, timeout: Duration) -> IncodeResult<(ExpressionValue, u64, u64)> {
+        let expression = self.prepared_expressions.get(handle)
+            .map(|prepared| prepared.expression.clone())
+            .ok_or_else(|| IncodeError::invalid_parameter(format!("No prepared expression with handle {}", handle)))?;
+        let frame = self.expression_frame(frame_index)?;
+        let context = expression::frame_context(frame);
+        let plan = self.prepared_plan(handle, &expression, frame, &context);
+
+        let value = expression::evaluate_plan(frame, &expression, &plan, timeout)?;
+        let (hits, misses) = self.prepared_expressions.get(handle)
+            .map_or((0, 0), |prepared| (prepared.hits, prepared.misses));
+        Ok((value, hits, misses))
+    }
+
+    /// A prepared expression's plan for `context`, planned and kept on a miss
+    fn prepared_plan(&mut self, handle: u32, expression: &str, frame: SBFrameRef, context: &str) -> Plan {
+        match self.prepared_expressions.lookup(handle, context) {
+            Some(plan) => plan,
+            None => {
+                let plan = expression::plan(frame, expression);
+                self.prepared_expressions.add_plan(handle, context.to_string(), plan.clone());
+                plan
+            }
+        }
+    }
+
+    pub fn release_expression(&mut self, handle: u32) -> bool {
+        self.prepared_expressions.release(handle)
+    }
+
+    pub fn prepared_expressions(&self) -> Vec<PreparedExpression> {
+        let mut prepared: Vec<PreparedExpression> = self.prepared_expressions.iter().cloned().collect();
+        prepared.sort_by_key(|prepared| prepared.id);
+        prepared
+    }
+
+    /// Watch `expression` at every stop. When the process is stopped the
+    /// watch is evaluated straight away and its first value returned here
+    /// rather than reported again as a change.
+    pub fn add_watch(&mut self, expression: &str) -> IncodeResult<Watch> {
+        if expression::is_unsafe(expression) {
+            return Err(IncodeError::expression(format!("Unsafe expression detected: {}", expression)));
+        }
+        let (id, _) = self.watches.add(expression).map_err(IncodeError::invalid_parameter)?;
+        if self.current_process.is_some() {
+            match self.evaluate_watches() {
+                Ok(_) => self.watches.acknowledge(id),
+                Err(e) => debug!("Watch {} not evaluated yet: {}", id, e),
+            }
+        }
+        self.watches.get(id).cloned().ok_or_else(|| IncodeError::lldb_op("Watch vanished"))
+    }
+
+    pub fn remove_watch(&mut self, id: u32) -> Option<Watch> {
+        let watch = self.watches.remove(id)?;
+        if let (Some(handle), true) = (watch.handle, watch.owns_handle) {
+            self.prepared_expressions.release(handle);
+        }
+        Some(watch)
+    }
+
+    pub fn clear_watches(&mut self) -> usize {
+        let watches = self.watches.clear();
+        for watch in &watches {
+            if let (Some(handle), true) = (watch.handle, watch.owns_handle) {
+                self.prepared_expressions.release(handle);
+            }
+        }
+        watches.len()
+    }
+
+    pub fn watches(&self) -> &WatchList {
+        &self.watches
+    }
+
+    /// Evaluate, as one batch in the selected frame, every watch not yet
+    /// evaluated at the current stop. Each goes through its prepared plan,
+    /// so lvalue paths skip the expression evaluator. Returns how many
+    /// values changed.
+    pub fn evaluate_watches(&mut self) -> IncodeResult<usize> {
+        if self.watches.is_empty() {
+            return Ok(0);
+        }
+        let process = self.current_process.ok_or_else(|| IncodeError::process("No process"))?;
+        if unsafe { SBProcessGetState(process) } != StateType::Stopped {
+            return Err(IncodeError::process("Process is not stopped"));
         }
+        let pid = unsafe { SBProcessGetProcessID(process) } as u32;
+        let stop_id = unsafe { SBProcessGetStopID(process, false) };
+        let stale = self.watches.stale(pid, stop_id);
+        if stale.is_empty() {
+            return Ok(0);
+        }
+        let frame = self.expression_frame(None)?;
+        let context = expression::frame_context(frame);
+
+        let started = Instant::now();
+        let mut results = Vec::with_capacity(stale.len());
+        let mut skipped = Vec::new();
+        for (id, expression) in stale {
+            let remaining = watch_list::BATCH_TIMEOUT.saturating_sub(started.elapsed());
+            if remaining.is_zero() {
+                skipped.push(id);
+                continue;
+            }
+            let handle = match self.watches.get(id).and_then(|watch| watch.handle) {
+                Some(handle) if self.prepared_expressions.get(handle).is_some() => handle,
+                _ => {
+                    let owned = !self.prepared_expressions.iter().any(|prepared| prepared.expression == expression);
+                    let handle = self.prepared_expressions.prepare(&expression, context.clone(), expression::plan(frame, &expression));
+                    self.watches.set_handle(id, handle, owned);
+                    handle
+                }
+            };
+            let plan = self.prepared_plan(handle, &expression, frame, &context);
+            let value = expression::evaluate_plan(frame, &expression, &plan, watch_list::EVALUATION_TIMEOUT.min(remaining))
+                .map(|value| value.display())
+                .map_err(|e| e.to_string());
+            results.push(WatchResult { id, value, path: plan.kind() });
+        }
+        let evaluated = results.len();
+        let elapsed_us = started.elapsed().as_micros() as u64;
+        let changed = self.watches.record(pid, stop_id, results, elapsed_us);
+        self.watches.mark_not_evaluated(&skipped);
+        debug!("Evaluated {} watches at stop {} in {}us, {} changed, {} not evaluated",
+               evaluated, stop_id, elapsed_us, changed, skipped.len());
+        Ok(changed)
+    }
 
-        // TODO: Implement actual expression evaluation in frame context using LLDB
-        // For now, return placeholder result
-        Ok(format!("<evaluated: {}>", expression))
+    /// Watches whose value changed since they were last reported
+    pub fn take_watch_changes(&mut self) -> Vec<Watch> {
+        self.watches.take_changes()
     }
 
     /// Get variables in current scope (combining local and global)
@@ -2015,55 +3681,104 @@ impl LldbManager {
             return Ok(globals);
         }
 
-        let _target = self.current_target.ok_or_else(|| IncodeError::lldb_op("No active target for global variables"))?;
-        
-        // Return test debuggee global variables for realistic testing
-        let globals = vec![
-            Variable {
-                name: "global_int".to_string(),
-                value: "42".to_string(),
-                var_type: "int".to_string(),
-                is_argument: false,
-                scope: "global".to_string(),
-            },
-            Variable {
-                name: "global_float".to_string(),
-                value: "3.14159".to_string(),
-                var_type: "float".to_string(),
-                is_argument: false,
-                scope: "global".to_string(),
-            },
-            Variable {
-                name: "global_double".to_string(),
-                value: "2.71828".to_string(),
-                var_type: "double".to_string(),
-                is_argument: false,
-                scope: "global".to_string(),
-            },
-            Variable {
-                name: "global_bool".to_string(),
-                value: "true".to_string(),
-                var_type: "bool".to_string(),
-                is_argument: false,
-                scope: "global".to_string(),
-            },
-            Variable {
-                name: "global_string".to_string(),
-                value: "\"Global String Value\"".to_string(),
-                var_type: "const char*".to_string(),
-                is_argument: false,
-                scope: "global".to_string(),
-            },
-        ];
-        
-        // Apply module filter if specified
-        let filtered_globals = if let Some(module_name) = module_filter {
-            globals.into_iter().filter(|v| v.name.contains(module_name)).collect()
-        } else {
-            globals
+        let filter = GlobalFilter {
+            module: module_filter.map(String::from),
+            name: None,
+            include_static: true,
         };
-        
-        Ok(filtered_globals)
+        // Every global, a page at a time
+        let mut globals = Vec::new();
+        loop {
+            let page = self.list_globals(&filter, globals.len(), global_vars::MAX_PAGE)?;
+            let has_more = page.has_more() && !page.globals.is_empty();
+            globals.extend(page.globals.iter().map(|global| Variable {
+                name: global.name.clone(),
+                value: global.display(),
+                var_type: global.type_name.clone(),
+                is_argument: false,
+                scope: global.storage.name().to_string(),
+            }));
+            if !has_more {
+                break;
+            }
+        }
+        Ok(globals)
+    }
+
+    /// Global layouts of every module in the target, in module order, with
+    /// each module. Modules missing from the cache are enumerated together by
+    /// one lookup, however many of them there are.
+    fn global_layouts(&self, target: SBTargetRef) -> Vec<(Arc<ModuleGlobals>, SBModuleRef)> {
+        let modules: Vec<(String, SBModuleRef)> = (0..unsafe { SBTargetGetNumModules(target) })
+            .filter_map(|i| {
+                let module = unsafe { SBTargetGetModuleAtIndex(target, i) };
+                let (path, uuid) = session_snapshot::module_identity(module)?;
+                Some((global_vars::module_key(&path, uuid.as_deref()), module))
+            })
+            .collect();
+
+        let cached: Vec<Option<Arc<ModuleGlobals>>> = modules.iter().map(|(key, _)| self.global_layouts.get(key)).collect();
+        let missing: HashSet<String> = modules.iter().zip(&cached)
+            .filter(|(_, layout)| layout.is_none())
+            .map(|((key, _), _)| key.clone())
+            .collect();
+        let mut enumerated: HashMap<String, Arc<ModuleGlobals>> = HashMap::new();
+        if !missing.is_empty() {
+            let started = Instant::now();
+            enumerated = global_vars::enumerate(target, &missing).into_iter()
+                .map(|(key, layout)| (key, Arc::new(layout)))
+                .collect();
+            let elapsed_us = started.elapsed().as_micros() as u64;
+            debug!("Enumerated globals of {} modules in {}us", enumerated.len(), elapsed_us);
+            // Every module enumerated shares the lookup's cost
+            for (key, layout) in &enumerated {
+                self.global_layouts.insert(key.clone(), layout.clone(), layout.approx_bytes(), elapsed_us / enumerated.len().max(1) as u64);
+            }
+        }
+
+        modules.into_iter().zip(cached)
+            .filter_map(|((key, module), layout)| Some((layout.or_else(|| enumerated.get(&key).cloned())?, module)))
+            .collect()
+    }
+
+    /// A page of globals and statics matching `filter`, values decoded from
+    /// bulk reads of each module's data sections: the live process when
+    /// there is one, the object files otherwise
+    pub fn list_globals(&self, filter: &GlobalFilter, offset: usize, limit: usize) -> IncodeResult<GlobalsPage> {
+        let target = self.current_target.ok_or_else(|| IncodeError::lldb_op("No active target for global variables"))?;
+        let started = Instant::now();
+        let layouts: Vec<_> = self.global_layouts(target).into_iter()
+            .filter(|(layout, _)| filter.module.as_deref().map_or(true, |module| layout.matches(module)))
+            .collect();
+
+        let live = self.current_process.map(stl_decode::ProcessMemory);
+        let files: Vec<global_vars::FileMemory> = layouts.iter()
+            .map(|(_, module)| global_vars::FileMemory { target, module: *module })
+            .collect();
+        let images: Vec<ModuleImage> = layouts.iter().zip(&files)
+            .map(|((layout, module), file)| {
+                // Slide from the first data section's load address
+                let slide = layout.sections.first().and_then(|section| {
+                    let resolved = unsafe { SBModuleResolveFileAddress(*module, section.file_address) };
+                    if resolved.is_null() {
+                        return None;
+                    }
+                    let load = unsafe { SBAddressGetLoadAddress(resolved, target) };
+                    unsafe { DisposeSBAddress(resolved) };
+                    (load != u64::MAX).then(|| load.wrapping_sub(section.file_address))
+                });
+                match (&live, slide) {
+                    (Some(process), Some(slide)) => ModuleImage { globals: layout, slide, memory: process, live: true },
+                    _ => ModuleImage { globals: layout, slide: 0, memory: file, live: false },
+                }
+            })
+            .collect();
+
+        let page = global_vars::read_page(&images, filter, offset, limit);
+        debug!("Decoded {} of {} globals across {} modules with {} reads ({} bytes) in {}us",
+               page.globals.len(), page.total, page.modules.len(), page.reads, page.bytes_read,
+               started.elapsed().as_micros());
+        Ok(page)
     }
 
     /// Get detailed variable information
@@ -2143,9 +3858,8 @@ impl LldbManager {
     /// Evaluate expression
     pub fn evaluate_expression(&self, expression: &str) -> IncodeResult<String> {
         debug!("Evaluating expression: {}", expression);
-        
-        // TODO: Implement actual expression evaluation
-        Err(IncodeError::not_implemented("evaluate_expression"))
+        self.evaluate(None, expression, expression::DEFAULT_TIMEOUT)
+            .map(|value| value.display())
     }
 
     /// Get thread list
@@ -2243,138 +3957,363 @@ impl LldbManager {
                         current_frame,
                     });
                 }
-                
-                debug!("Found {} threads", threads.len());
-                Ok(threads)
-            } else {
-                Err(IncodeError::no_process())
+                
+                debug!("Found {} threads", threads.len());
+                Ok(threads)
+            } else {
+                Err(IncodeError::no_process())
+            }
+        }
+    }
+
+    /// Get register values for current thread/frame
+    pub fn get_registers(&self, thread_id: Option<u32>, _include_metadata: bool) -> IncodeResult<RegisterState> {
+        debug!("Getting registers for thread: {:?}", thread_id);
+
+        let values = self.read_registers(thread_id)?;
+        let registers: HashMap<String, RegisterInfo> = values.iter()
+            .map(|(index, def)| (def.name.clone(), RegisterInfo {
+                name: def.name.clone(),
+                value: values.value(index).unwrap_or(0),
+                size: def.size,
+                register_type: def.kind.to_string(),
+                format: "hex".to_string(),
+                is_valid: true,
+                set: def.set.clone(),
+                bytes: values.bytes(index).map(<[u8]>::to_vec).unwrap_or_default(),
+            }))
+            .collect();
+
+        debug!("Found {} registers", registers.len());
+        Ok(RegisterState {
+            registers,
+            timestamp: std::time::SystemTime::now(),
+            thread_id: Some(values.thread_id),
+            frame_index: Some(values.frame_index),
+        })
+    }
+
+    /// Thread by ID, else the current thread, else the process's selected thread
+    fn resolve_thread(&self, thread_id: Option<u32>) -> IncodeResult<SBThreadRef> {
+        let process = self.current_process;
+        let thread = match thread_id {
+            Some(tid) => process
+                .map(|process| unsafe { SBProcessGetThreadByID(process, tid as lldb_tid_t) })
+                .filter(|thread| !thread.is_null())
+                .ok_or_else(|| IncodeError::thread(format!("Thread {} not found", tid)))?,
+            None => self.current_thread
+                .or_else(|| process.map(|process| unsafe { SBProcessGetSelectedThread(process) }))
+                .filter(|thread| !thread.is_null())
+                .ok_or_else(|| IncodeError::thread("No current thread selected"))?,
+        };
+        Ok(thread)
+    }
+
+    /// Register layout for `frame`, discovered once per architecture and register set shape
+    fn register_schema(&self, frame: SBFrameRef) -> IncodeResult<Arc<RegisterSchema>> {
+        let target = self.current_target.ok_or_else(|| IncodeError::lldb_op("No target loaded"))?;
+        // Every thread of a process shares one register shape, so the key is
+        // worked out once per process rather than walked on every read
+        let owner = self.current_process
+            .map(|process| (unsafe { SBProcessGetProcessID(process) } as u32, process as usize))
+            .unwrap_or((0, target as usize));
+        let known = self.register_schema_key.lock().ok()
+            .and_then(|known| known.as_ref().filter(|(process, _)| *process == owner).map(|(_, key)| key.clone()));
+        let key = match known {
+            Some(key) => key,
+            None => {
+                let triple = unsafe { SBTargetGetTriple(target) };
+                let triple = if triple.is_null() {
+                    String::new()
+                } else {
+                    unsafe { std::ffi::CStr::from_ptr(triple) }.to_string_lossy().into_owned()
+                };
+                let key = register_schema::schema_key(&triple, frame)
+                    .ok_or_else(|| IncodeError::frame("Cannot access registers"))?;
+                if let Ok(mut known) = self.register_schema_key.lock() {
+                    *known = Some((owner, key.clone()));
+                }
+                key
+            }
+        };
+        if let Some(schema) = self.register_schemas.get(&key) {
+            return Ok(schema);
+        }
+
+        let build_start = Instant::now();
+        let schema = RegisterSchema::build(key.clone(), frame)
+            .map(Arc::new)
+            .ok_or_else(|| IncodeError::frame("Cannot access registers"))?;
+        let cost_us = build_start.elapsed().as_micros() as u64;
+        debug!("Built register schema {} ({} registers) in {}us", key, schema.registers.len(), cost_us);
+        self.register_schemas.insert(key, schema.clone(), schema.approx_bytes(), cost_us);
+        Ok(schema)
+    }
+
+    /// Every register of a thread's selected frame, full width, in schema order
+    pub fn read_registers(&self, thread_id: Option<u32>) -> IncodeResult<RegisterValues> {
+        #[cfg(feature = "mock")]
+        {
+            debug!("Mock: Returning sample register values");
+            Ok(Self::mock_registers(thread_id.unwrap_or(1)))
+        }
+
+        #[cfg(not(feature = "mock"))]
+        {
+            let thread = self.resolve_thread(thread_id)?;
+            let frame = unsafe { SBThreadGetSelectedFrame(thread) };
+            if frame.is_null() {
+                return Err(IncodeError::frame("No current frame available"));
             }
+            let schema = self.register_schema(frame)?;
+            let tid = unsafe { SBThreadGetThreadID(thread) } as u32;
+            let frame_index = unsafe { SBFrameGetFrameID(frame) };
+            Ok(register_schema::read_values(&schema, frame, tid, frame_index))
         }
     }
 
-    /// Get register values for current thread/frame
-    pub fn get_registers(&self, thread_id: Option<u32>, _include_metadata: bool) -> IncodeResult<RegisterState> {
-        debug!("Getting registers for thread: {:?}", thread_id);
-        
+    /// Top-frame registers of every thread in one pass, sharing one schema
+    pub fn read_all_thread_registers(&self) -> IncodeResult<Vec<RegisterValues>> {
         #[cfg(feature = "mock")]
         {
-            debug!("Mock: Returning sample register state");
-            let mut registers = HashMap::new();
-            
-            // Common x86_64 registers
-            registers.insert("rax".to_string(), RegisterInfo {
-                name: "rax".to_string(),
-                value: 0x12345678,
-                size: 8,
-                register_type: "general".to_string(),
-                format: "hex".to_string(),
-                is_valid: true,
-            });
-            
-            registers.insert("rbx".to_string(), RegisterInfo {
-                name: "rbx".to_string(),
-                value: 0x87654321,
-                size: 8,
-                register_type: "general".to_string(),
-                format: "hex".to_string(),
-                is_valid: true,
-            });
-            
-            registers.insert("rip".to_string(), RegisterInfo {
-                name: "rip".to_string(),
-                value: 0x100001234,
-                size: 8,
-                register_type: "program_counter".to_string(),
-                format: "hex".to_string(),
-                is_valid: true,
-            });
-            
-            registers.insert("rsp".to_string(), RegisterInfo {
-                name: "rsp".to_string(),
-                value: 0x7fff5fbff000,
-                size: 8,
-                register_type: "stack_pointer".to_string(),
-                format: "hex".to_string(),
-                is_valid: true,
-            });
-            
-            Ok(RegisterState {
-                registers,
-                timestamp: std::time::SystemTime::now(),
-                thread_id,
-                frame_index: Some(0),
-            })
+            debug!("Mock: Returning sample register values for two threads");
+            Ok(vec![Self::mock_registers(1), Self::mock_registers(2)])
         }
-        
+
         #[cfg(not(feature = "mock"))]
         {
-            if let Some(current_thread) = self.current_thread {
-                let frame = unsafe { SBThreadGetSelectedFrame(current_thread) };
-                if frame.is_null() {
-                    return Err(IncodeError::frame("No current frame available"));
+            let process = self.current_process.ok_or_else(|| IncodeError::process("No process"))?;
+            let mut schema: Option<Arc<RegisterSchema>> = None;
+            let mut threads = Vec::new();
+            for i in 0..unsafe { SBProcessGetNumThreads(process) } as usize {
+                let thread = unsafe { SBProcessGetThreadAtIndex(process, i) };
+                if thread.is_null() {
+                    continue;
                 }
-                
-                let register_list = unsafe { SBFrameGetRegisters(frame) };
-                if register_list.is_null() {
-                    return Err(IncodeError::frame("Cannot access registers"));
+                let frame = unsafe { SBThreadGetFrameAtIndex(thread, 0) };
+                if frame.is_null() {
+                    continue;
                 }
-                
-                let mut registers = HashMap::new();
-                let num_register_sets = unsafe { SBValueListGetSize(register_list) };
-                
-                for i in 0..num_register_sets {
-                    let register_set = unsafe { SBValueListGetValueAtIndex(register_list, i) };
-                    if register_set.is_null() {
-                        continue;
-                    }
-                    
-                    let set_size = unsafe { SBValueGetNumChildren(register_set) };
-                    for j in 0..set_size {
-                        let register = unsafe { SBValueGetChildAtIndex(register_set, j) };
-                        if register.is_null() {
-                            continue;
-                        }
-                        
-                        let name_ptr = unsafe { SBValueGetName(register) };
-                        if name_ptr.is_null() {
-                            continue;
-                        }
-                        
-                        let name = unsafe {
-                            std::ffi::CStr::from_ptr(name_ptr)
-                                .to_string_lossy()
-                                .to_string()
-                        };
-                        
-                        let error = unsafe { CreateSBError() };
-                        let value = unsafe { SBValueGetValueAsUnsigned(register, error, 0) };
-                        
-                        registers.insert(name.clone(), RegisterInfo {
-                            name,
-                            value,
-                            size: 8, // TODO: Get actual size
-                            register_type: "general".to_string(), // TODO: Determine type
-                            format: "hex".to_string(),
-                            is_valid: true,
-                        });
-                    }
+                let schema = match &schema {
+                    Some(schema) => schema.clone(),
+                    None => schema.insert(self.register_schema(frame)?).clone(),
+                };
+                let tid = unsafe { SBThreadGetThreadID(thread) } as u32;
+                threads.push(register_schema::read_values(&schema, frame, tid, 0));
+            }
+            Ok(threads)
+        }
+    }
+
+    /// Sample x86_64 general purpose registers, for the mock build
+    #[cfg(feature = "mock")]
+    fn mock_registers(thread_id: u32) -> RegisterValues {
+        let set = "General Purpose Registers";
+        let mut schema = RegisterSchema::empty("x86_64-mock/4".to_string());
+        for (child_index, name) in ["rax", "rbx", "rip", "rsp"].into_iter().enumerate() {
+            schema.push(name.to_string(), set, 0, child_index as u32, 8, Some("unsigned long".to_string()));
+        }
+        schema.sets.push(set.to_string());
+
+        let mut values = RegisterValues::new(Arc::new(schema), thread_id, 0);
+        for (index, value) in [0x12345678u64, 0x87654321, 0x100001234, 0x7fff5fbff000].into_iter().enumerate() {
+            values.set_bytes(index, &value.to_le_bytes());
+        }
+        values
+    }
+
+    /// What changed in a thread's registers, locals and watched memory since
+    /// its previous stop. The first call for a thread reports everything.
+    pub fn stop_delta(&mut self, thread_id: Option<u32>, include_registers: bool, include_locals: bool) -> IncodeResult<StateDelta> {
+        let process = self.current_process.ok_or_else(|| IncodeError::process("No process"))?;
+        self.stop_deltas.bind_process(unsafe { SBProcessGetProcessID(process) } as u32);
+        let stop_id = unsafe { SBProcessGetStopID(process, false) };
+
+        let thread = self.resolve_thread(thread_id)?;
+        let frame = unsafe { SBThreadGetSelectedFrame(thread) };
+        if frame.is_null() {
+            return Err(IncodeError::frame("No current frame available"));
+        }
+        let tid = unsafe { SBThreadGetThreadID(thread) } as u32;
+        let registers = if include_registers {
+            let schema = self.register_schema(frame)?;
+            Some(register_schema::read_values(&schema, frame, tid, unsafe { SBFrameGetFrameID(frame) }))
+        } else {
+            None
+        };
+        let locals = if include_locals { stop_delta::capture_locals(frame) } else { Default::default() };
+        let memory = self.stop_deltas.watched()
+            .filter_map(|(address, size)| self.read_memory(address, size).ok().map(|bytes| (address, bytes)))
+            .collect();
+
+        let state = StopState { stop_id, pc: unsafe { SBFrameGetPC(frame) }, registers, locals, memory };
+        Ok(self.stop_deltas.record(tid, state))
+    }
+
+    /// Read `size` bytes at `address` at every stop and report changes in `stop_delta`
+    pub fn watch_memory_delta(&mut self, address: u64, size: usize) -> usize {
+        let size = size.min(stop_delta::MAX_WATCH_BYTES);
+        self.stop_deltas.watch(address, size);
+        size
+    }
+
+    pub fn unwatch_memory_delta(&mut self, address: u64) -> bool {
+        self.stop_deltas.unwatch(address)
+    }
+
+    /// Ranges compared at every stop, as (address, size)
+    pub fn watched_memory_deltas(&self) -> Vec<(u64, usize)> {
+        self.stop_deltas.watched().collect()
+    }
+
+    /// Forget stop history, so the next delta is a full baseline
+    pub fn reset_stop_deltas(&mut self, clear_watches: bool) {
+        self.stop_deltas.reset(clear_watches);
+    }
+
+    /// A thread_local variable in every thread, or in `thread_ids`. LLDB
+    /// resolves it once, in the selected thread, which gives its module TLS
+    /// index and offset; each thread's copy is then found from that thread's
+    /// thread pointer register and read directly, with no per-thread
+    /// expression or SBValue.
+    pub fn read_thread_local(&mut self, name: &str, thread_ids: Option<&[u32]>) -> IncodeResult<TlsView> {
+        let target = self.current_target.ok_or_else(|| IncodeError::lldb_op("No active target"))?;
+        let process = self.current_process.ok_or_else(|| IncodeError::process("No active process"))?;
+        if unsafe { SBProcessGetState(process) } != StateType::Stopped {
+            return Err(IncodeError::process("Process is not stopped"));
+        }
+        let triple = unsafe { SBTargetGetTriple(target) };
+        let triple = if triple.is_null() {
+            String::new()
+        } else {
+            unsafe { std::ffi::CStr::from_ptr(triple) }.to_string_lossy().into_owned()
+        };
+        let abi = TlsAbi::of(&triple)
+            .ok_or_else(|| IncodeError::not_implemented(format!("Native TLS access on {}", triple)))?;
+        let memory = stl_decode::ProcessMemory(process);
+
+        // Thread pointer of every requested thread, through the shared register schema
+        let mut schema: Option<Arc<RegisterSchema>> = None;
+        let mut threads = Vec::new();
+        for i in 0..unsafe { SBProcessGetNumThreads(process) } as usize {
+            let thread = unsafe { SBProcessGetThreadAtIndex(process, i) };
+            if thread.is_null() {
+                continue;
+            }
+            let tid = unsafe { SBThreadGetThreadID(thread) } as u32;
+            if thread_ids.map_or(false, |ids| !ids.contains(&tid)) {
+                continue;
+            }
+            let frame = unsafe { SBThreadGetFrameAtIndex(thread, 0) };
+            if frame.is_null() {
+                continue;
+            }
+            let schema = match &schema {
+                Some(schema) => schema.clone(),
+                None => schema.insert(self.register_schema(frame)?).clone(),
+            };
+            let index = schema.index_of(abi.register())
+                .ok_or_else(|| IncodeError::lldb_op(format!("No {} register to find thread-local storage", abi.register())))?;
+            let register_list = unsafe { SBFrameGetRegisters(frame) };
+            let mut bytes = [0u8; 8];
+            let read = !register_list.is_null()
+                && register_schema::register_value(register_list, &schema.registers[index])
+                    .map_or(false, |register| register_schema::read_register_bytes(register, &mut bytes));
+            if read {
+                threads.push((tid, u64::from_le_bytes(bytes)));
+            }
+        }
+        if threads.is_empty() {
+            return Err(IncodeError::thread("No thread with a readable thread pointer"));
+        }
+
+        // An exec or a module load or unload renumbers the DTV under the cache
+        let modules = module_list_fingerprint(target);
+        if modules != self.tls_modules {
+            self.tls_locations.clear();
+            self.tls_modules = modules;
+        }
+        let pid = unsafe { SBProcessGetProcessID(process) } as u32;
+        let key = (pid, name.to_string());
+        let (location, type_info) = match self.tls_locations.get(&key) {
+            Some(located) => located.clone(),
+            None => {
+                let located = self.locate_thread_local(target, process, abi, &memory, name)?;
+                // A static TLS guess is not kept, so the DTV is tried again next time
+                if located.0.is_authoritative() {
+                    self.tls_locations.retain(|(located_pid, _), _| *located_pid == pid);
+                    self.tls_locations.insert(key, located.clone());
                 }
-                
-                debug!("Found {} registers", registers.len());
-                Ok(RegisterState {
-                    registers,
-                    timestamp: std::time::SystemTime::now(),
-                    thread_id,
-                    frame_index: Some(0),
-                })
-            } else {
-                Err(IncodeError::thread("No current thread selected"))
+                located
             }
+        };
+
+        let started = Instant::now();
+        if !location.is_authoritative() {
+            warn!("Thread-local {} assumed to be in static TLS: the DTV was not readable", name);
+        }
+        let view = tls::read_across(&memory, abi, name, &type_info, location, &threads);
+        debug!("Read thread-local {} in {} threads via {} with {} reads in {}us",
+               name, view.threads.len(), location.method(), view.reads, started.elapsed().as_micros());
+        Ok(view)
+    }
+
+    /// Resolve `name` through LLDB in the selected thread and turn its address there into a TLS location
+    fn locate_thread_local(&self, target: SBTargetRef, process: SBProcessRef, abi: TlsAbi, memory: &dyn stl_decode::MemoryReader, name: &str) -> IncodeResult<(TlsLocation, TypeInfo)> {
+        let name_cstr = std::ffi::CString::new(name).map_err(|_| IncodeError::invalid_parameter("Invalid variable name"))?;
+        let list = unsafe { SBTargetFindGlobalVariables2(target, name_cstr.as_ptr(), 16, MatchType::Normal) };
+        let value = (0..if list.is_null() { 0 } else { unsafe { SBValueListGetSize(list) } })
+            .map(|i| unsafe { SBValueListGetValueAtIndex(list, i) })
+            .find(|value| !value.is_null() && unsafe { SBValueGetValueType(*value) } == ValueType::VariableThreadLocal)
+            .ok_or_else(|| IncodeError::invalid_parameter(format!("No thread_local variable named '{}'", name)))?;
+        let type_info = stl_decode::type_info(unsafe { SBValueGetType(value) })
+            .ok_or_else(|| IncodeError::lldb_op(format!("No type information for '{}'", name)))?;
+        let address = unsafe { SBValueGetLoadAddress(value) };
+        if address == u64::MAX {
+            return Err(IncodeError::lldb_op(format!("Cannot resolve '{}' in the selected thread", name)));
+        }
+
+        let thread = unsafe { SBProcessGetSelectedThread(process) };
+        let frame = if thread.is_null() { std::ptr::null_mut() } else { unsafe { SBThreadGetFrameAtIndex(thread, 0) } };
+        if frame.is_null() {
+            return Err(IncodeError::thread("No selected thread to resolve thread-local storage in"));
         }
+        let schema = self.register_schema(frame)?;
+        let thread_pointer = schema.index_of(abi.register())
+            .and_then(|index| {
+                let register_list = unsafe { SBFrameGetRegisters(frame) };
+                let register = register_schema::register_value(register_list, &schema.registers[index])?;
+                let mut bytes = [0u8; 8];
+                register_schema::read_register_bytes(register, &mut bytes).then(|| u64::from_le_bytes(bytes))
+            })
+            .ok_or_else(|| IncodeError::thread(format!("Cannot read {} of the selected thread", abi.register())))?;
+
+        let location = tls::locate(memory, abi, thread_pointer, address);
+        debug!("Located thread-local {} at 0x{:x} in the selected thread: {:?}", name, address, location);
+        Ok((location, type_info))
+    }
+
+    /// One register of a thread's selected frame: a schema lookup and two positional child reads
+    fn register_value(&self, register_name: &str, thread_id: Option<u32>) -> IncodeResult<(Arc<RegisterSchema>, usize, SBValueRef, u32)> {
+        let thread = self.resolve_thread(thread_id)?;
+        let frame = unsafe { SBThreadGetSelectedFrame(thread) };
+        if frame.is_null() {
+            return Err(IncodeError::frame("No current frame available"));
+        }
+        let schema = self.register_schema(frame)?;
+        let index = schema.index_of(register_name)
+            .ok_or_else(|| IncodeError::invalid_parameter(format!("Register '{}' not found", register_name)))?;
+        let register_list = unsafe { SBFrameGetRegisters(frame) };
+        if register_list.is_null() {
+            return Err(IncodeError::frame("Cannot access registers"));
+        }
+        let register = register_schema::register_value(register_list, &schema.registers[index])
+            .ok_or_else(|| IncodeError::invalid_parameter(format!("Register '{}' not available in this frame", register_name)))?;
+        Ok((schema, index, register, unsafe { SBThreadGetThreadID(thread) } as u32))
     }
 
     /// Set register value
-    pub fn set_register(&mut self, register_name: &str, value: u64, _thread_id: Option<u32>) -> IncodeResult<bool> {
+    pub fn set_register(&mut self, register_name: &str, value: u64, thread_id: Option<u32>) -> IncodeResult<bool> {
         debug!("Setting register {} to value: 0x{:x}", register_name, value);
         
         #[cfg(feature = "mock")]
@@ -2392,62 +4331,13 @@ impl LldbManager {
         
         #[cfg(not(feature = "mock"))]
         {
-            if let Some(current_thread) = self.current_thread {
-                let frame = unsafe { SBThreadGetSelectedFrame(current_thread) };
-                if frame.is_null() {
-                    return Err(IncodeError::frame("No current frame available"));
-                }
-                
-                let register_list = unsafe { SBFrameGetRegisters(frame) };
-                if register_list.is_null() {
-                    return Err(IncodeError::frame("Cannot access registers"));
-                }
-                
-                // Find the register by name
-                let num_register_sets = unsafe { SBValueListGetSize(register_list) };
-                for i in 0..num_register_sets {
-                    let register_set = unsafe { SBValueListGetValueAtIndex(register_list, i) };
-                    if register_set.is_null() {
-                        continue;
-                    }
-                    
-                    let set_size = unsafe { SBValueGetNumChildren(register_set) };
-                    for j in 0..set_size {
-                        let register = unsafe { SBValueGetChildAtIndex(register_set, j) };
-                        if register.is_null() {
-                            continue;
-                        }
-                        
-                        let name_ptr = unsafe { SBValueGetName(register) };
-                        if name_ptr.is_null() {
-                            continue;
-                        }
-                        
-                        let name = unsafe {
-                            std::ffi::CStr::from_ptr(name_ptr)
-                                .to_string_lossy()
-                                .to_string()
-                        };
-                        
-                        if name == register_name {
-                            let value_str = format!("0x{:x}", value);
-                            let value_cstr = std::ffi::CString::new(value_str)
-                                .map_err(|_| IncodeError::invalid_parameter("Invalid value format"))?;
-                            
-                            let success = unsafe {
-                                SBValueSetValueFromCString(register, value_cstr.as_ptr())
-                            };
-                            
-                            debug!("Register {} set to 0x{:x}, success: {}", register_name, value, success);
-                            return Ok(success);
-                        }
-                    }
-                }
-                
-                Err(IncodeError::invalid_parameter(format!("Register '{}' not found", register_name)))
-            } else {
-                Err(IncodeError::thread("No current thread selected"))
-            }
+            let (_, _, register, _) = self.register_value(register_name, thread_id)?;
+            let value_cstr = std::ffi::CString::new(format!("0x{:x}", value))
+                .map_err(|_| IncodeError::invalid_parameter("Invalid value format"))?;
+            let success = unsafe { SBValueSetValueFromCString(register, value_cstr.as_ptr()) };
+
+            debug!("Register {} set to 0x{:x}, success: {}", register_name, value, success);
+            Ok(success)
         }
     }
 
@@ -2478,17 +4368,31 @@ impl LldbManager {
                 register_type: reg_type.to_string(),
                 format: "hex".to_string(),
                 is_valid: true,
+                set: "General Purpose Registers".to_string(),
+                bytes: Vec::new(),
             })
         }
         
         #[cfg(not(feature = "mock"))]
         {
-            // Get current register state and find the specific register
-            let register_state = self.get_registers(thread_id, true)?;
-            
-            register_state.registers.get(register_name)
-                .cloned()
-                .ok_or_else(|| IncodeError::invalid_parameter(format!("Register '{}' not found", register_name)))
+            let (schema, index, register, _) = self.register_value(register_name, thread_id)?;
+            let def = &schema.registers[index];
+            let mut bytes = vec![0u8; def.size as usize];
+            let is_valid = register_schema::read_register_bytes(register, &mut bytes);
+            let mut low = [0u8; 8];
+            let len = bytes.len().min(8);
+            low[..len].copy_from_slice(&bytes[..len]);
+
+            Ok(RegisterInfo {
+                name: def.name.clone(),
+                value: u64::from_le_bytes(low),
+                size: def.size,
+                register_type: def.kind.to_string(),
+                format: "hex".to_string(),
+                is_valid,
+                set: def.set.clone(),
+                bytes,
+            })
         }
     }
 
@@ -3063,12 +4967,14 @@ impl LldbManager {
                     state: "Running".to_string(),
                     executable_path: Some("/usr/bin/test".to_string()),
                     memory_usage: Some(1024 * 1024), // 1MB
+                    ..Default::default()
                 },
                 ProcessInfo {
                     pid: 5678,
                     state: "Stopped".to_string(),
                     executable_path: Some("/bin/bash".to_string()),
                     memory_usage: Some(512 * 1024), // 512KB
+                    ..Default::default()
                 },
             ];
 
@@ -3078,6 +4984,7 @@ impl LldbManager {
                     state: "Running".to_string(),
                     executable_path: Some("/sbin/init".to_string()),
                     memory_usage: Some(256 * 1024), // 256KB
+                    ..Default::default()
                 });
             }
 
@@ -3096,54 +5003,100 @@ impl LldbManager {
 
         #[cfg(not(test))]
         {
-            use std::process::Command;
-            
-            let mut processes = Vec::new();
-            
-            // Use ps command to get process list
+            let process_filter = ProcessFilter {
+                name: filter.map(|f| f.to_string()),
+                include_system,
+                ..Default::default()
+            };
+            self.find_processes(&process_filter)
+        }
+    }
+
+    /// List processes matching name, command line, user and parent criteria
+    pub fn find_processes(&self, filter: &ProcessFilter) -> IncodeResult<Vec<ProcessInfo>> {
+        debug!("Finding processes matching {:?}", filter);
+
+        #[cfg(target_os = "linux")]
+        {
+            let processes = self.process_table.scan(filter)
+                .map_err(|e| IncodeError::lldb_op(format!("Failed to read /proc: {}", e)))?;
+            debug!("Found {} matching processes ({} cached)", processes.len(), self.process_table.cached_entries());
+            Ok(processes)
+        }
+
+        #[cfg(not(target_os = "linux"))]
+        {
+            self.list_processes_ps(filter)
+        }
+    }
+
+    /// Briefly attach to every process matching `options.filter` and collect
+    /// deduplicated stacks, focus-thread registers and memory region stats
+    pub fn snapshot_processes(&self, options: &SnapshotOptions) -> IncodeResult<FleetSnapshot> {
+        let targets = self.find_processes(&options.filter)?;
+
+        // Processes already under a debugger cannot be attached a second time
+        let mut exclude: Vec<u32> = self.list_child_sessions().iter().map(|child| child.pid).collect();
+        if let Some(process) = self.current_process {
+            exclude.push(unsafe { SBProcessGetProcessID(process) } as u32);
+        }
+
+        fleet_snapshot::snapshot_processes(targets, options, &exclude)
+    }
+
+    /// Process listing through `ps` for platforms without /proc
+    #[cfg(not(target_os = "linux"))]
+    fn list_processes_ps(&self, filter: &ProcessFilter) -> IncodeResult<Vec<ProcessInfo>> {
+        use std::process::Command;
+
+        // Both comm and args may contain spaces, and only the last column can be
+        // split off safely, so each comes from its own listing keyed by pid
+        let ps = |columns: &str| -> IncodeResult<HashMap<u32, (Vec<String>, String)>> {
             let output = Command::new("ps")
-                .args(["-eo", "pid,ppid,state,comm,rss"])
+                .args(["-eo", columns])
                 .output()
                 .map_err(|e| IncodeError::lldb_op(format!("Failed to execute ps command: {}", e)))?;
-
             if !output.status.success() {
                 return Err(IncodeError::lldb_op("ps command failed"));
             }
-
+            let width = columns.split(',').count();
             let stdout = String::from_utf8_lossy(&output.stdout);
-            for line in stdout.lines().skip(1) { // Skip header
-                let fields: Vec<&str> = line.split_whitespace().collect();
-                if fields.len() >= 5 {
-                    if let Ok(pid) = fields[0].parse::<u32>() {
-                        let ppid: u32 = fields[1].parse().unwrap_or(0);
-                        let state = fields[2].to_string();
-                        let comm = fields[3].to_string();
-                        let rss_kb: u64 = fields[4].parse().unwrap_or(0);
-
-                        // Filter system processes if not requested
-                        if !include_system && (pid == 1 || ppid == 0) {
-                            continue;
-                        }
+            Ok(stdout.lines().skip(1).filter_map(|line| { // Skip header
+                let mut fields: Vec<String> = Vec::with_capacity(width);
+                let mut rest = line.trim_start();
+                while fields.len() + 1 < width {
+                    let end = rest.find(char::is_whitespace)?;
+                    fields.push(rest[..end].to_string());
+                    rest = rest[end..].trim_start();
+                }
+                let pid = fields.first()?.parse().ok()?;
+                Some((pid, (fields, rest.trim_end().to_string())))
+            }).collect())
+        };
 
-                        // Apply filter if provided
-                        if let Some(filter_str) = filter {
-                            if !comm.contains(filter_str) {
-                                continue;
-                            }
-                        }
+        let mut args = ps("pid,args")?;
+        let mut processes = Vec::new();
+        for (pid, (fields, comm)) in ps("pid,ppid,uid,user,state,rss,comm")? {
+            let rss_kb: u64 = fields[5].parse().unwrap_or(0);
+            let process = ProcessInfo {
+                pid,
+                state: fields[4].clone(),
+                executable_path: Some(comm.clone()),
+                memory_usage: Some(rss_kb * 1024), // Convert KB to bytes
+                ppid: fields[1].parse().ok(),
+                name: Path::new(&comm).file_name().map(|n| n.to_string_lossy().into_owned()),
+                cmdline: args.remove(&pid).map(|(_, args)| args).filter(|c| !c.is_empty()),
+                uid: fields[2].parse().ok(),
+                user: Some(fields[3].clone()),
+            };
 
-                        processes.push(ProcessInfo {
-                            pid,
-                            state,
-                            executable_path: Some(comm),
-                            memory_usage: Some(rss_kb * 1024), // Convert KB to bytes
-                        });
-                    }
-                }
+            if filter.matches(&process) {
+                processes.push(process);
             }
-
-            Ok(processes)
         }
+        processes.sort_by_key(|process| process.pid);
+
+        Ok(processes)
     }
 
     /// Cleanup resources
@@ -3156,6 +5109,10 @@ impl LldbManager {
         
         // Cleanup LLDB resources in proper order
         // First clean up process and target
+        self.stop_console_drainer();
+        self.stop_fork_follower();
+        self.checkpoints.discard_all();
+        self.core = None;
         if let Some(process) = self.current_process.take() {
             unsafe {
                 let _result = SBProcessStop(process);
@@ -3180,6 +5137,11 @@ impl LldbManager {
             }
         }
 
+        // Spilled sessions do not outlive the server
+        if let Some(dir) = self.spill_dir.take() {
+            let _ = std::fs::remove_dir_all(dir);
+        }
+
         // Clear sessions
         let mut sessions = self.sessions.lock().unwrap();
         sessions.clear();
@@ -4097,13 +6059,13 @@ impl LldbManager {
     }
 
     /// Analyze crash dump and provide detailed crash information
-    pub fn analyze_crash(&self, core_file_path: Option<&str>) -> IncodeResult<CrashAnalysis> {
+    pub fn analyze_crash(&mut self, core_file_path: Option<&str>) -> IncodeResult<CrashAnalysis> {
         self._analyze_crash(core_file_path)
     }
 
     /// Analyze crash dump and provide detailed crash information
     #[allow(dead_code)]
-    fn _analyze_crash(&self, core_file_path: Option<&str>) -> IncodeResult<CrashAnalysis> {
+    fn _analyze_crash(&mut self, core_file_path: Option<&str>) -> IncodeResult<CrashAnalysis> {
         debug!("Analyzing crash, core file: {:?}", core_file_path);
         
         if cfg!(test) {
@@ -4116,7 +6078,7 @@ impl LldbManager {
                 faulting_thread: 1,
                 signal_number: 11,
                 signal_name: "SIGSEGV".to_string(),
-                exception_type: Some("EXC_BAD_ACCESS".to_string()),
+                exception_type: cfg!(target_os = "macos").then(|| "EXC_BAD_ACCESS".to_string()),
                 exception_codes: vec![1, 0],
                 crashed_thread_backtrace: vec![
                     "0x100001234 main + 52".to_string(),
@@ -4138,11 +6100,15 @@ impl LldbManager {
                     format!("Verify array bounds {}", "checking"),
                     format!("Review memory allocation/{}", "free"),
                 ],
+                signature: None,
+                signature_frames: vec![],
+                known_crash: None,
+                fault: None,
             });
         }
         
         // Validate we have debugging context or core file
-        if core_file_path.is_none() && self.current_target.is_none() {
+        if core_file_path.is_none() && self.current_target.is_none() && self.core.is_none() {
             // Return a graceful response indicating no crash to analyze
             return Ok(CrashAnalysis {
                 crash_type: "No crash".to_string(),
@@ -4161,18 +6127,77 @@ impl LldbManager {
                     "Launch a process with launch_process or attach to a running process".to_string(),
                     "Provide a core file path to analyze a previous crash".to_string(),
                 ],
+                signature: None,
+                signature_frames: vec![],
+                known_crash: None,
+                fault: None,
             });
         }
         
-        // In real implementation, we would:
-        // 1. Load core file if provided, or use current process
-        // 2. Get crashed thread information
-        // 3. Analyze registers and memory state
-        // 4. Extract crash details and generate report
-        
-        let crash_type = "SIGSEGV"; // Default for demonstration
-        let signal_number = 11;
-        let faulting_thread = 0u32;
+        // Load the core unless it is the one already being debugged
+        if let Some(path) = core_file_path {
+            let loaded = self.core.as_ref().map_or(false, |core| core.path() == Path::new(path));
+            if !loaded {
+                self.load_core(path, None)?;
+            }
+        }
+
+        // The core's siginfo has the fault details; a live process only has its stop info
+        let thread = self.current_process
+            .map(|process| unsafe { SBProcessGetSelectedThread(process) })
+            .filter(|thread| !thread.is_null());
+        let (signal_number, si_code, crash_address, faulting_thread) = match self.core.as_ref() {
+            Some(core) => {
+                let signal = core.signal.as_ref();
+                (
+                    // Cores without NT_SIGINFO still record the signal per thread
+                    signal.map_or_else(|| core.faulting_thread().map_or(0, |thread| thread.signal), |signal| signal.signo),
+                    signal.map(|signal| signal.code),
+                    signal.and_then(|signal| signal.fault_address),
+                    core.faulting_thread().map_or(0, |thread| thread.tid),
+                )
+            }
+            None => match thread {
+                Some(thread) if unsafe { SBThreadGetStopReason(thread) } == StopReason::Signal => {
+                    let signal = (unsafe { SBThreadGetStopReasonDataAtIndex(thread, 0) }) as i32;
+                    let (si_code, fault_address) = fault_decode::parse_stop_description(signal, &fault_decode::stop_description(thread));
+                    (signal, si_code, fault_address, unsafe { SBThreadGetThreadID(thread) } as u32)
+                }
+                Some(thread) => (0, None, None, unsafe { SBThreadGetThreadID(thread) } as u32),
+                None => (0, None, None, 0),
+            },
+        };
+        let crash_type = core_file::signal_name(signal_number);
+
+        // One pass over the faulting thread: registers, the instruction at the
+        // PC and the region table are all the fault decoder needs
+        let regions = self.get_memory_regions().unwrap_or_default();
+        let fault = thread.map(|thread| {
+            let registers = fleet_snapshot::general_registers(thread);
+            let pc = ["rip", "pc"].iter().find_map(|name| registers.get(*name).copied());
+            let instruction = match (self.current_target, pc) {
+                (Some(target), Some(pc)) => fault_decode::read_instruction(target, pc),
+                _ => None,
+            };
+            fault_decode::decode_fault(signal_number, si_code, crash_address, &registers, instruction, &regions)
+        });
+        let crash_address = fault.as_ref().and_then(|fault| fault.address()).or(crash_address);
+
+        // Signature of the faulting thread, and whether it has been seen before
+        let (signature_frames, signature) = match thread {
+            Some(thread) => {
+                let (frames, hash) = crash_triage::thread_signature(thread, signal_number, crash_triage::SIGNATURE_FRAMES);
+                (frames, Some(hash))
+            }
+            None => (Vec::new(), None),
+        };
+        let known_crash = match signature {
+            Some(hash) => self.lookup_crash(hash).unwrap_or_else(|e| {
+                warn!("Crash database lookup failed: {}", e);
+                None
+            }),
+            None => None,
+        };
         
         // Get backtrace for crashed thread
         let backtrace = match self.get_backtrace() {
@@ -4181,24 +6206,23 @@ impl LldbManager {
         };
         
         // Get register state
-        let register_state = match self.get_registers(Some(faulting_thread), true) {
+        let register_state = match self.get_registers(Some(faulting_thread).filter(|&tid| tid != 0), true) {
             Ok(regs) => format!("Registers captured: {} entries ", regs.registers.len()),
             Err(_) => "Unable to get register state ".to_string(),
         };
         
-        // Get memory regions
-        let memory_regions = match self.get_memory_regions() {
-            Ok(regions) => {
-                regions.into_iter().take(5).map(|region| {
-                    format!("{:#x}-{:#x} {} {}", 
-                        region.start_address, 
-                        region.end_address,
-                        region.permissions,
-                        region.name.unwrap_or_else(|| "[unknown]".to_string())
-                    )
-                }).collect()
-            },
-            Err(_) => vec!["Unable to get memory regions ".to_string()],
+        // Memory regions, from the table already read for the fault decoder
+        let memory_regions = if regions.is_empty() {
+            vec!["Unable to get memory regions ".to_string()]
+        } else {
+            regions.iter().take(5).map(|region| {
+                format!("{:#x}-{:#x} {} {}", 
+                    region.start_address, 
+                    region.end_address,
+                    region.permissions,
+                    region.name.as_deref().unwrap_or("[unknown]")
+                )
+            }).collect()
         };
         
         // Get loaded modules
@@ -4212,34 +6236,132 @@ impl LldbManager {
         };
         
         // Generate crash summary and recommendations
-        let crash_summary = format!("{}: Process crashed in thread {}", crash_type, faulting_thread);
-        let recommendations = vec![
+        let decoded = fault.as_ref().filter(|fault| fault.classification != "unknown");
+        let crash_summary = match (decoded, si_code, crash_address) {
+            (Some(fault), _, _) => format!("{}: {} in thread {}", crash_type, fault.description, faulting_thread),
+            (None, si_code, crash_address) => match (si_code, crash_address) {
+            (Some(code), Some(address)) => format!(
+                "{} (si_code {}) at {:#x} in thread {}", crash_type, code, address, faulting_thread
+            ),
+            (Some(code), None) => format!("{} (si_code {}) in thread {}", crash_type, code, faulting_thread),
+            _ => format!("{}: Process crashed in thread {}", crash_type, faulting_thread),
+            },
+        };
+        let mut recommendations = decoded.map(fault_decode::recommendations).unwrap_or_default();
+        recommendations.extend([
             format!("Review the crashed thread stack {}", "trace"),
             format!("Check for memory access {}", "violations"),
             format!("Verify proper error handling in the code {}", "flow"),
             format!("Consider using memory debugging {}", "utilities"),
-        ];
+        ]);
+        if let Some(known) = known_crash.as_ref() {
+            recommendations.insert(0, format!("Known crash: {}", known.describe()));
+        }
         
         info!("Crash analysis completed for {}", 
             core_file_path.unwrap_or(&format!("current {}", "target")));
         
         Ok(CrashAnalysis {
             crash_type: crash_type.to_string(),
-            crash_address: Some(0x0), // TODO: Extract actual crash address
+            crash_address,
             faulting_thread,
             signal_number,
             signal_name: crash_type.to_string(),
-            exception_type: Some("EXC_BAD_ACCESS".to_string()), // TODO: Platform-specific
-            exception_codes: vec![1, 0], // TODO: Extract actual exception codes
+            exception_type: None,
+            exception_codes: si_code.map(|code| vec![code as u32 as u64]).unwrap_or_default(),
             crashed_thread_backtrace: backtrace,
             register_state,
             memory_regions,
             loaded_modules,
             crash_summary,
             recommendations,
+            signature,
+            signature_frames,
+            known_crash,
+            fault,
         })
     }
 
+    pub fn crash_database_path(&self) -> &Path {
+        &self.crash_db_path
+    }
+
+    /// Bucket for `signature`, without creating a database that doesn't exist
+    pub fn lookup_crash(&self, signature: u64) -> IncodeResult<Option<CrashRecord>> {
+        match CrashDatabase::open_existing(&self.crash_db_path)? {
+            Some(db) => db.lookup(signature),
+            None => Ok(None),
+        }
+    }
+
+    /// Count an analyzed crash in the database; `None` if it has no signature
+    pub fn record_crash(&self, analysis: &CrashAnalysis, core_path: Option<&str>) -> IncodeResult<Option<CrashRecord>> {
+        if analysis.signature.is_none() {
+            return Ok(None);
+        }
+        let build = self.current_target.and_then(crash_triage::executable_build_id);
+        CrashDatabase::open(&self.crash_db_path)?.record(analysis, core_path, build.as_deref())
+    }
+
+    /// Bucket every core in `directory` by crash signature. Runs in separate
+    /// workers, so the current session and its process are left untouched.
+    pub fn triage_cores(&self, directory: &str, options: &TriageOptions) -> IncodeResult<TriageReport> {
+        crash_triage::triage_cores(directory, options)
+    }
+
+    /// Write a compact dump: thread contexts, stacks, memory referenced from
+    /// registers and stack words, modules with build IDs and the region map
+    pub fn generate_minidump(&self, output_path: &str, options: &MinidumpOptions) -> IncodeResult<MinidumpReport> {
+        debug!("Generating compact dump to: {}", output_path);
+
+        if output_path.is_empty() {
+            return Err(IncodeError::invalid_parameter("output_path required"));
+        }
+        let process = self.current_process.ok_or_else(IncodeError::no_process)?;
+        if unsafe { SBProcessGetState(process) } != StateType::Stopped {
+            return Err(IncodeError::process("Process must be stopped to write a compact dump"));
+        }
+        let pid = unsafe { SBProcessGetProcessID(process) } as u32;
+
+        // A loaded core has no /proc entry; its own tables stand in
+        let regions: Vec<MapEntry> = match self.core.as_ref() {
+            Some(core) if !core.region_map.is_empty() => core.region_map.iter().map(|region| MapEntry {
+                start: region.start,
+                end: region.end,
+                perms: region.permissions.clone(),
+                offset: 0,
+                path: region.path.clone(),
+            }).collect(),
+            Some(core) => core.segments.iter().map(|segment| MapEntry {
+                start: segment.vaddr,
+                end: segment.end(),
+                perms: segment.permissions() + "p",
+                offset: core.mapped_file_at(segment.vaddr).map_or(0, |file| file.file_offset),
+                path: core.mapped_file_at(segment.vaddr).map(|file| file.path.clone()),
+            }).collect(),
+            None => memory_map(pid)
+                .map_err(|e| IncodeError::process(format!("Cannot read memory map of PID {}: {}", pid, e)))?,
+        };
+
+        let build_ids: HashMap<String, String> = match self.core.as_ref().filter(|core| !core.modules.is_empty()) {
+            Some(core) => core.modules.iter()
+                .filter_map(|module| module.build_id.clone().map(|build_id| (module.path.clone(), build_id)))
+                .collect(),
+            None => self.list_modules(None, false)
+                .unwrap_or_default()
+                .into_iter()
+                .filter(|module| !module.uuid.is_empty() && module.uuid != "unknown")
+                .map(|module| (module.file_path, module.uuid))
+                .collect(),
+        };
+
+        if let Some(parent) = Path::new(output_path).parent().filter(|parent| !parent.as_os_str().is_empty()) {
+            std::fs::create_dir_all(parent)
+                .map_err(|_| IncodeError::lldb_op("Invalid output path - cannot create directory".to_string()))?;
+        }
+        minidump::write_minidump(process, pid, &regions, &build_ids, Path::new(output_path), options)
+    }
+
     /// Generate core dump file for current process state
     pub fn generate_core_dump(&self, output_path: &str) -> IncodeResult<String> {
         self._generate_core_dump(output_path)
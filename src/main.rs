@@ -6,6 +6,28 @@ mod mcp_server;
 mod lldb_manager;
 mod tools;
 mod error;
+mod cache_manager;
+mod checkpoint;
+mod console_buffer;
+mod core_file;
+mod crash_db;
+mod crash_triage;
+mod disassembly;
+mod expression;
+mod fault_decode;
+mod fleet_snapshot;
+mod fork_follower;
+mod function_cfg;
+mod global_vars;
+mod minidump;
+mod process_table;
+mod register_schema;
+mod session_snapshot;
+mod stl_decode;
+mod stop_delta;
+mod tls;
+mod watch_list;
+mod xref_index;
 
 use crate::mcp_server::McpServer;
 use crate::error::IncodeResult;
@@ -42,8 +64,58 @@ async fn main() -> IncodeResult<()> {
                 .help("Path to LLDB executable")
                 .value_name("PATH")
         )
+        .arg(
+            Arg::new("triage-worker")
+                .long("triage-worker")
+                .help("Print the crash signature of one core as JSON and exit (used by triage_cores)")
+                .value_name("CORE")
+                .hide(true)
+        )
+        .arg(
+            Arg::new("triage-frames")
+                .long("triage-frames")
+                .value_name("N")
+                .value_parser(clap::value_parser!(usize))
+                .default_value("5")
+                .hide(true)
+        )
+        .arg(
+            Arg::new("triage-analyze")
+                .long("triage-analyze")
+                .action(clap::ArgAction::SetTrue)
+                .hide(true)
+        )
+        .arg(
+            Arg::new("xref-worker")
+                .long("xref-worker")
+                .help("Sweep code ranges of one module for cross-references, one JSON line per range (used by xrefs_to)")
+                .value_name("MODULE")
+                .hide(true)
+        )
+        .arg(
+            Arg::new("xref-ranges")
+                .long("xref-ranges")
+                .value_name("RANGES")
+                .hide(true)
+        )
         .get_matches();
 
+    // Worker mode: one core in, one JSON line out, no MCP server
+    if let Some(core) = matches.get_one::<String>("triage-worker") {
+        let frames = *matches.get_one::<usize>("triage-frames").unwrap_or(&5);
+        let result = crash_triage::triage_worker(std::path::Path::new(core), frames, matches.get_flag("triage-analyze"));
+        println!("{}", result);
+        return Ok(());
+    }
+
+    if let Some(module) = matches.get_one::<String>("xref-worker") {
+        let ranges = xref_index::parse_ranges(matches.get_one::<String>("xref-ranges").map_or("", |ranges| ranges.as_str()));
+        xref_index::sweep_worker(std::path::Path::new(module), &ranges, |start, end, result| {
+            println!("{}", xref_index::chunk_json(start, end, &result));
+        });
+        return Ok(());
+    }
+
     if matches.get_flag("debug") {
         // Re-initialize with debug level but still to stderr
         tracing_subscriber::fmt()
@@ -0,0 +1,449 @@
+// Compact (minidump-style) dumps
+//
+// A full core of a large server is gigabytes, nearly all of it heap that a
+// crash report never touches. A compact dump keeps what post-mortem work
+// actually reads: every thread's registers and live stack, a window of memory
+// around each register value and stack word that points into mapped memory, the
+// module list with build IDs, and the full region map. It is written as an
+// ordinary ELF core, so load_core, LLDB and the core reader all open it.
+
+use std::collections::{BTreeMap, HashMap};
+use std::io::Write;
+use std::path::Path;
+use std::time::Instant;
+
+use lldb_sys::*;
+use tracing::{debug, info};
+
+use crate::core_file::{
+    align4, EM_AARCH64, EM_X86_64, ET_CORE, INCODE_NOTE_NAME, NT_FILE, NT_INCODE_MODULES, NT_INCODE_REGIONS,
+    NT_PRPSINFO, NT_PRSTATUS, PF_R, PF_W, PF_X, PN_XNUM, PRSTATUS_REGS_OFFSET, PT_LOAD, PT_NOTE,
+};
+use crate::error::{IncodeError, IncodeResult};
+use crate::fleet_snapshot::general_registers;
+use crate::process_table::MapEntry;
+
+/// Bytes below the stack pointer that leaf functions may still be using
+const RED_ZONE: u64 = 128;
+/// Page size the NT_FILE offsets are expressed in
+const FILE_NOTE_PAGE_SIZE: u64 = 4096;
+
+const X86_64_PRSTATUS_REGS: &[&str] = &[
+    "r15", "r14", "r13", "r12", "rbp", "rbx", "r11", "r10", "r9", "r8", "rax", "rcx", "rdx", "rsi", "rdi",
+    "orig_rax", "rip", "cs", "rflags", "rsp", "ss", "fs_base", "gs_base", "ds", "es", "fs", "gs",
+];
+
+/// How much memory a compact dump captures
+#[derive(Debug, Clone)]
+pub struct MinidumpOptions {
+    /// Stack captured above each thread's stack pointer
+    pub stack_bytes: u64,
+    /// Bytes captured on either side of each referenced address
+    pub reference_radius: u64,
+    /// Cap on captured memory; stacks are taken first, then references
+    pub max_bytes: u64,
+}
+
+impl Default for MinidumpOptions {
+    fn default() -> Self {
+        Self {
+            stack_bytes: 256 * 1024,
+            reference_radius: 256,
+            max_bytes: 32 * 1024 * 1024,
+        }
+    }
+}
+
+#[derive(Debug, Clone)]
+pub struct MinidumpReport {
+    pub path: String,
+    pub file_size: u64,
+    pub threads: usize,
+    /// PT_LOAD segments written
+    pub ranges: usize,
+    pub captured_bytes: u64,
+    pub modules: usize,
+    pub regions: usize,
+    /// Whether `max_bytes` stopped some references from being captured
+    pub truncated: bool,
+    pub elapsed_ms: u64,
+}
+
+struct DumpThread {
+    tid: u32,
+    signal: i32,
+    registers: BTreeMap<String, u64>,
+}
+
+/// Non-overlapping address ranges, merged on insert
+#[derive(Default)]
+struct RangeSet {
+    ranges: BTreeMap<u64, u64>,
+    bytes: u64,
+}
+
+impl RangeSet {
+    fn contains(&self, address: u64) -> bool {
+        self.ranges.range(..=address).next_back().map_or(false, |(_, &end)| address < end)
+    }
+
+    /// Bytes of `start..end` not already covered
+    fn uncovered(&self, start: u64, end: u64) -> u64 {
+        let covered: u64 = self.ranges
+            .range(..end)
+            .filter(|(_, &e)| e > start)
+            .map(|(&s, &e)| e.min(end) - s.max(start))
+            .sum();
+        (end - start) - covered
+    }
+
+    fn insert(&mut self, mut start: u64, mut end: u64) {
+        let overlapping: Vec<(u64, u64)> = self.ranges
+            .range(..=end)
+            .filter(|(_, &e)| e >= start)
+            .map(|(&s, &e)| (s, e))
+            .collect();
+        for (s, e) in overlapping {
+            self.ranges.remove(&s);
+            self.bytes -= e - s;
+            start = start.min(s);
+            end = end.max(e);
+        }
+        self.ranges.insert(start, end);
+        self.bytes += end - start;
+    }
+}
+
+/// Write a compact dump of the stopped `process` to `path`
+pub fn write_minidump(
+    process: SBProcessRef,
+    pid: u32,
+    regions: &[MapEntry],
+    build_ids: &HashMap<String, String>,
+    path: &Path,
+    options: &MinidumpOptions,
+) -> IncodeResult<MinidumpReport> {
+    let started = Instant::now();
+    let (machine, sp_name, register_names) = match std::env::consts::ARCH {
+        "x86_64" => (EM_X86_64, "rsp", X86_64_PRSTATUS_REGS.iter().map(|r| r.to_string()).collect::<Vec<_>>()),
+        "aarch64" => (
+            EM_AARCH64,
+            "sp",
+            (0..29).map(|i| format!("x{}", i)).chain(["fp", "lr", "sp", "pc", "cpsr"].map(String::from)).collect(),
+        ),
+        arch => return Err(IncodeError::lldb_op(format!("Compact dumps are not supported on {}", arch))),
+    };
+
+    let threads = collect_threads(process);
+    if threads.is_empty() {
+        return Err(IncodeError::thread("Process has no threads to dump"));
+    }
+
+    let mut regions: Vec<&MapEntry> = regions.iter().collect();
+    regions.sort_by_key(|region| region.start);
+    let capturable = |address: u64| -> Option<&MapEntry> {
+        let index = regions.partition_point(|region| region.start <= address);
+        let region = *regions.get(index.checked_sub(1)?)?;
+        let pseudo = region.path.as_deref().map_or(false, |path| path.starts_with("[vvar") || path == "[vsyscall]");
+        (address < region.end && region.is_readable() && !pseudo).then_some(region)
+    };
+
+    // Stacks first: they are what every backtrace and frame variable reads
+    let mut wanted = RangeSet::default();
+    let mut truncated = false;
+    for thread in &threads {
+        let Some(&sp) = thread.registers.get(sp_name) else {
+            continue;
+        };
+        let Some(region) = capturable(sp) else {
+            continue;
+        };
+        let start = sp.saturating_sub(RED_ZONE).max(region.start);
+        let end = sp.saturating_add(options.stack_bytes).min(region.end);
+        if wanted.bytes + wanted.uncovered(start, end) > options.max_bytes {
+            truncated = true;
+            continue;
+        }
+        wanted.insert(start, end);
+    }
+    let stacks: Vec<(u64, u64, Vec<u8>)> = wanted.ranges
+        .iter()
+        .map(|(&start, &end)| (start, end, read_memory(process, start, end - start)))
+        .collect();
+
+    // Then whatever registers and stack words point at, registers first
+    let candidates = threads
+        .iter()
+        .flat_map(|thread| thread.registers.values().copied())
+        .chain(stacks.iter().flat_map(|(_, _, data)| {
+            data.chunks_exact(8).map(|word| u64::from_le_bytes(word.try_into().unwrap()))
+        }));
+    for value in candidates {
+        if wanted.contains(value) {
+            continue;
+        }
+        let Some(region) = capturable(value) else {
+            continue;
+        };
+        let start = value.saturating_sub(options.reference_radius).max(region.start);
+        let end = value.saturating_add(options.reference_radius).min(region.end);
+        if wanted.bytes + wanted.uncovered(start, end) > options.max_bytes {
+            truncated = true;
+            continue;
+        }
+        wanted.insert(start, end);
+    }
+
+    let mut segments: Vec<(u64, u32, Vec<u8>)> = Vec::with_capacity(wanted.ranges.len());
+    for (&start, &end) in &wanted.ranges {
+        let data = read_range(process, start, end, &stacks);
+        if data.is_empty() {
+            continue;
+        }
+        let flags = capturable(start).map_or(PF_R, |region| {
+            PF_R | if region.is_writable() { PF_W } else { 0 } | if region.is_executable() { PF_X } else { 0 }
+        });
+        segments.push((start, flags, data));
+    }
+    debug!("Compact dump of PID {}: {} ranges, {} bytes", pid, segments.len(), wanted.bytes);
+
+    let modules = module_list(&regions, build_ids);
+    let mut notes = Vec::new();
+    push_note(&mut notes, "CORE", NT_PRPSINFO, &prpsinfo(pid, &regions));
+    for thread in &threads {
+        push_note(&mut notes, "CORE", NT_PRSTATUS, &prstatus(thread, &register_names));
+    }
+    push_note(&mut notes, "CORE", NT_FILE, &file_note(&regions));
+    push_note(&mut notes, INCODE_NOTE_NAME, NT_INCODE_MODULES, modules.join("\n").as_bytes());
+    let region_lines: Vec<String> = regions
+        .iter()
+        .map(|region| {
+            format!("{:x}\t{:x}\t{}\t{}", region.start, region.end, region.perms, region.path.as_deref().unwrap_or(""))
+        })
+        .collect();
+    push_note(&mut notes, INCODE_NOTE_NAME, NT_INCODE_REGIONS, region_lines.join("\n").as_bytes());
+
+    let file = std::fs::File::create(path)
+        .map_err(|e| IncodeError::invalid_parameter(format!("Cannot create {}: {}", path.display(), e)))?;
+    let mut out = std::io::BufWriter::new(file);
+    write_elf(&mut out, machine, &notes, &segments)
+        .and_then(|_| out.flush())
+        .map_err(|e| IncodeError::lldb_op(format!("Failed to write {}: {}", path.display(), e)))?;
+    drop(out);
+
+    let report = MinidumpReport {
+        path: path.to_string_lossy().into_owned(),
+        file_size: std::fs::metadata(path).map(|meta| meta.len()).unwrap_or(0),
+        threads: threads.len(),
+        ranges: segments.len(),
+        captured_bytes: segments.iter().map(|(_, _, data)| data.len() as u64).sum(),
+        modules: modules.len(),
+        regions: regions.len(),
+        truncated,
+        elapsed_ms: started.elapsed().as_millis() as u64,
+    };
+    info!("Wrote compact dump of PID {} to {} ({} bytes)", pid, report.path, report.file_size);
+    Ok(report)
+}
+
+/// Every thread's general registers, the selected (usually signalled) thread
+/// first as the kernel orders them in a core
+fn collect_threads(process: SBProcessRef) -> Vec<DumpThread> {
+    let selected = unsafe { SBProcessGetSelectedThread(process) };
+    let selected_tid = if selected.is_null() { None } else { Some(unsafe { SBThreadGetThreadID(selected) } as u32) };
+
+    let mut threads = Vec::new();
+    for i in 0..unsafe { SBProcessGetNumThreads(process) } {
+        let thread = unsafe { SBProcessGetThreadAtIndex(process, i as usize) };
+        if thread.is_null() {
+            continue;
+        }
+        let signal = if unsafe { SBThreadGetStopReason(thread) } == StopReason::Signal {
+            (unsafe { SBThreadGetStopReasonDataAtIndex(thread, 0) }) as i32
+        } else {
+            0
+        };
+        threads.push(DumpThread {
+            tid: unsafe { SBThreadGetThreadID(thread) } as u32,
+            signal,
+            registers: general_registers(thread),
+        });
+    }
+    threads.sort_by_key(|thread| Some(thread.tid) != selected_tid);
+    threads
+}
+
+fn read_memory(process: SBProcessRef, address: u64, size: u64) -> Vec<u8> {
+    let mut buffer = vec![0u8; size as usize];
+    let error = unsafe { CreateSBError() };
+    let read = unsafe {
+        SBProcessReadMemory(process, address, buffer.as_mut_ptr() as *mut std::ffi::c_void, buffer.len(), error)
+    };
+    unsafe { DisposeSBError(error) };
+    buffer.truncate(read.min(buffer.len()));
+    buffer
+}
+
+/// Bytes of `start..end`, reusing the stack ranges already read inside it.
+/// Like a single read, stops at the first byte that could not be read.
+fn read_range(process: SBProcessRef, start: u64, end: u64, stacks: &[(u64, u64, Vec<u8>)]) -> Vec<u8> {
+    let mut data = Vec::with_capacity((end - start) as usize);
+    let mut at = start;
+    // Ranges only merge after the stacks were read, so each lies wholly in one range
+    for (stack_start, stack_end, bytes) in stacks.iter().filter(|(s, e, _)| *s >= start && *e <= end) {
+        if *stack_start > at {
+            let gap = read_memory(process, at, stack_start - at);
+            let complete = gap.len() as u64 == stack_start - at;
+            data.extend_from_slice(&gap);
+            if !complete {
+                return data;
+            }
+        }
+        data.extend_from_slice(bytes);
+        if (bytes.len() as u64) < stack_end - stack_start {
+            return data;
+        }
+        at = *stack_end;
+    }
+    if at < end {
+        data.extend_from_slice(&read_memory(process, at, end - at));
+    }
+    data
+}
+
+/// One "base end build_id path" line per file-backed module
+fn module_list(regions: &[&MapEntry], build_ids: &HashMap<String, String>) -> Vec<String> {
+    let mut modules: Vec<(u64, u64, &str)> = Vec::new();
+    for region in regions {
+        let Some(path) = region.path.as_deref().filter(|path| path.starts_with('/')) else {
+            continue;
+        };
+        match modules.iter_mut().find(|(_, _, p)| *p == path) {
+            Some(module) => {
+                module.0 = module.0.min(region.start);
+                module.1 = module.1.max(region.end);
+            }
+            None => modules.push((region.start, region.end, path)),
+        }
+    }
+    modules
+        .into_iter()
+        .map(|(base, end, path)| {
+            let build_id = build_ids.get(path).map(String::as_str).unwrap_or("");
+            format!("{:x}\t{:x}\t{}\t{}", base, end, build_id, path)
+        })
+        .collect()
+}
+
+fn prpsinfo(pid: u32, regions: &[&MapEntry]) -> Vec<u8> {
+    let mut desc = vec![0u8; 136];
+    desc[24..28].copy_from_slice(&pid.to_le_bytes());
+    let command = regions
+        .iter()
+        .find_map(|region| region.path.as_deref().filter(|path| path.starts_with('/')))
+        .and_then(|path| Path::new(path).file_name())
+        .map(|name| name.to_string_lossy().into_owned())
+        .unwrap_or_default();
+    let len = command.len().min(15);
+    desc[40..40 + len].copy_from_slice(&command.as_bytes()[..len]);
+    desc
+}
+
+fn prstatus(thread: &DumpThread, register_names: &[String]) -> Vec<u8> {
+    let mut desc = vec![0u8; PRSTATUS_REGS_OFFSET + register_names.len() * 8 + 8];
+    desc[12..14].copy_from_slice(&(thread.signal as u16).to_le_bytes());
+    desc[32..36].copy_from_slice(&thread.tid.to_le_bytes());
+    for (i, name) in register_names.iter().enumerate() {
+        let value = thread.registers.get(name).copied().unwrap_or(0);
+        let offset = PRSTATUS_REGS_OFFSET + i * 8;
+        desc[offset..offset + 8].copy_from_slice(&value.to_le_bytes());
+    }
+    desc
+}
+
+fn file_note(regions: &[&MapEntry]) -> Vec<u8> {
+    let files: Vec<&&MapEntry> = regions
+        .iter()
+        .filter(|region| region.path.as_deref().map_or(false, |path| path.starts_with('/')))
+        .collect();
+    let mut desc = Vec::with_capacity(16 + files.len() * 64);
+    desc.extend_from_slice(&(files.len() as u64).to_le_bytes());
+    desc.extend_from_slice(&FILE_NOTE_PAGE_SIZE.to_le_bytes());
+    for region in &files {
+        desc.extend_from_slice(&region.start.to_le_bytes());
+        desc.extend_from_slice(&region.end.to_le_bytes());
+        desc.extend_from_slice(&(region.offset / FILE_NOTE_PAGE_SIZE).to_le_bytes());
+    }
+    for region in &files {
+        desc.extend_from_slice(region.path.as_deref().unwrap_or("").as_bytes());
+        desc.push(0);
+    }
+    desc
+}
+
+fn push_note(out: &mut Vec<u8>, name: &str, note_type: u32, desc: &[u8]) {
+    out.extend_from_slice(&(name.len() as u32 + 1).to_le_bytes());
+    out.extend_from_slice(&(desc.len() as u32).to_le_bytes());
+    out.extend_from_slice(&note_type.to_le_bytes());
+    out.extend_from_slice(name.as_bytes());
+    out.resize(out.len() + align4(name.len() + 1) - name.len(), 0);
+    out.extend_from_slice(desc);
+    out.resize(align4(out.len()), 0);
+}
+
+fn write_elf(out: &mut impl Write, machine: u16, notes: &[u8], segments: &[(u64, u32, Vec<u8>)]) -> std::io::Result<()> {
+    const EHDR_SIZE: u64 = 64;
+    const PHDR_SIZE: u64 = 56;
+    const SHDR_SIZE: u64 = 64;
+    let phnum = 1 + segments.len() as u64;
+    let notes_offset = EHDR_SIZE + phnum * PHDR_SIZE;
+    // e_phnum cannot hold the count; as in kernel cores it moves to the
+    // sh_info of a lone section header written after the data
+    let extended = phnum >= PN_XNUM as u64;
+
+    let mut header = [0u8; EHDR_SIZE as usize];
+    header[..7].copy_from_slice(b"\x7fELF\x02\x01\x01");
+    header[16..18].copy_from_slice(&ET_CORE.to_le_bytes());
+    header[18..20].copy_from_slice(&machine.to_le_bytes());
+    header[20..24].copy_from_slice(&1u32.to_le_bytes());
+    header[32..40].copy_from_slice(&EHDR_SIZE.to_le_bytes());
+    header[52..54].copy_from_slice(&(EHDR_SIZE as u16).to_le_bytes());
+    header[54..56].copy_from_slice(&(PHDR_SIZE as u16).to_le_bytes());
+    if extended {
+        let shoff = notes_offset + notes.len() as u64 + segments.iter().map(|(_, _, data)| data.len() as u64).sum::<u64>();
+        header[40..48].copy_from_slice(&shoff.to_le_bytes());
+        header[56..58].copy_from_slice(&PN_XNUM.to_le_bytes());
+        header[58..60].copy_from_slice(&(SHDR_SIZE as u16).to_le_bytes());
+        header[60..62].copy_from_slice(&1u16.to_le_bytes());
+    } else {
+        header[56..58].copy_from_slice(&(phnum as u16).to_le_bytes());
+    }
+    out.write_all(&header)?;
+
+    let mut write_phdr = |p_type: u32, flags: u32, offset: u64, vaddr: u64, size: u64, align: u64| {
+        let mut phdr = [0u8; PHDR_SIZE as usize];
+        phdr[0..4].copy_from_slice(&p_type.to_le_bytes());
+        phdr[4..8].copy_from_slice(&flags.to_le_bytes());
+        for (i, value) in [offset, vaddr, 0, size, size, align].iter().enumerate() {
+            phdr[8 + i * 8..16 + i * 8].copy_from_slice(&value.to_le_bytes());
+        }
+        out.write_all(&phdr)
+    };
+    write_phdr(PT_NOTE, 0, notes_offset, 0, notes.len() as u64, 4)?;
+    let mut offset = notes_offset + notes.len() as u64;
+    for (vaddr, flags, data) in segments {
+        write_phdr(PT_LOAD, *flags, offset, *vaddr, data.len() as u64, 1)?;
+        offset += data.len() as u64;
+    }
+
+    out.write_all(notes)?;
+    for (_, _, data) in segments {
+        out.write_all(data)?;
+    }
+    if extended {
+        let mut shdr = [0u8; SHDR_SIZE as usize];
+        shdr[44..48].copy_from_slice(&(phnum as u32).to_le_bytes());
+        out.write_all(&shdr)?;
+    }
+    Ok(())
+}
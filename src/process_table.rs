@@ -0,0 +1,461 @@
+// Native process enumeration backed by /proc
+//
+// Replaces forking `ps` for every listing: each PID directory is read directly,
+// the work is spread over a few scoped threads, and fields that never change for
+// the lifetime of a process (command line, executable) are cached across scans.
+
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Mutex;
+
+use crate::cache_manager::{cost_weight, CacheUsage, ManagedCache};
+use crate::lldb_manager::{MemoryRegion, ProcessInfo};
+
+/// Criteria for selecting processes from the system process table
+#[derive(Debug, Clone, Default)]
+pub struct ProcessFilter {
+    /// Substring of the process name or executable path
+    pub name: Option<String>,
+    /// Substring of the full command line
+    pub cmdline: Option<String>,
+    /// User name or numeric UID owning the process
+    pub user: Option<String>,
+    /// Only children of this parent PID
+    pub parent_pid: Option<u32>,
+    /// Include init and kernel-owned processes
+    pub include_system: bool,
+}
+
+impl ProcessFilter {
+    /// Check a process against every criterion that was set
+    pub fn matches(&self, process: &ProcessInfo) -> bool {
+        let ppid = process.ppid.unwrap_or(0);
+        if !self.include_system && (process.pid == 1 || ppid == 0) {
+            return false;
+        }
+
+        if let Some(parent_pid) = self.parent_pid {
+            if process.ppid != Some(parent_pid) {
+                return false;
+            }
+        }
+
+        if let Some(ref name) = self.name {
+            let in_name = process.name.as_deref().map_or(false, |n| n.contains(name.as_str()));
+            let in_path = process.executable_path.as_deref().map_or(false, |p| p.contains(name.as_str()));
+            if !in_name && !in_path {
+                return false;
+            }
+        }
+
+        if let Some(ref cmdline) = self.cmdline {
+            if !process.cmdline.as_deref().map_or(false, |c| c.contains(cmdline.as_str())) {
+                return false;
+            }
+        }
+
+        if let Some(ref user) = self.user {
+            let matched = match user.parse::<u32>() {
+                Ok(uid) => process.uid == Some(uid),
+                Err(_) => process.user.as_deref() == Some(user.as_str()),
+            };
+            if !matched {
+                return false;
+            }
+        }
+
+        true
+    }
+}
+
+/// Fields that are fixed for the lifetime of a process
+#[derive(Debug, Clone)]
+struct StaticFields {
+    cmdline: Option<String>,
+    exe: Option<String>,
+}
+
+/// A process key that survives PID reuse: (pid, start time in clock ticks)
+type ProcessKey = (u32, u64);
+
+/// Enumerates processes from /proc, caching static fields between scans
+pub struct ProcessTable {
+    static_cache: Mutex<HashMap<ProcessKey, StaticFields>>,
+    /// Cache manager floor when the cache was first considered after a scan
+    priority_floor: Mutex<Option<u64>>,
+    hits: AtomicU64,
+    misses: AtomicU64,
+    evictions: AtomicU64,
+}
+
+impl Default for ProcessTable {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl ProcessTable {
+    /// Maximum number of threads used to read /proc in parallel
+    const MAX_WORKERS: usize = 8;
+
+    pub fn new() -> Self {
+        Self {
+            static_cache: Mutex::new(HashMap::new()),
+            priority_floor: Mutex::new(None),
+            hits: AtomicU64::new(0),
+            misses: AtomicU64::new(0),
+            evictions: AtomicU64::new(0),
+        }
+    }
+
+    /// Number of processes whose static fields are currently cached
+    pub fn cached_entries(&self) -> usize {
+        self.static_cache.lock().unwrap().len()
+    }
+
+    /// Read every process under /proc and return those matching `filter`
+    pub fn scan(&self, filter: &ProcessFilter) -> std::io::Result<Vec<ProcessInfo>> {
+        let mut pids: Vec<u32> = std::fs::read_dir("/proc")?
+            .filter_map(|entry| entry.ok())
+            .filter_map(|entry| entry.file_name().to_str().and_then(|name| name.parse::<u32>().ok()))
+            .collect();
+        pids.sort_unstable();
+
+        let users = read_user_names();
+        let page_size = page_size();
+
+        // Workers only read the previous cache; the merged result replaces it so
+        // entries for processes that have gone away are dropped.
+        let previous = std::mem::take(&mut *self.static_cache.lock().unwrap());
+
+        let workers = std::thread::available_parallelism()
+            .map(|n| n.get())
+            .unwrap_or(1)
+            .clamp(1, Self::MAX_WORKERS);
+        let chunk_size = pids.len().div_ceil(workers).max(1);
+
+        let scanned: Vec<(ProcessKey, StaticFields, ProcessInfo)> = std::thread::scope(|scope| {
+            let handles: Vec<_> = pids
+                .chunks(chunk_size)
+                .map(|chunk| {
+                    let previous = &previous;
+                    let users = &users;
+                    scope.spawn(move || {
+                        chunk
+                            .iter()
+                            .filter_map(|&pid| read_process(pid, previous, users, page_size))
+                            .collect::<Vec<_>>()
+                    })
+                })
+                .collect();
+
+            handles
+                .into_iter()
+                .flat_map(|handle| handle.join().unwrap_or_default())
+                .collect()
+        });
+
+        let mut cache = HashMap::with_capacity(scanned.len());
+        let mut processes = Vec::new();
+        let hits = scanned.iter().filter(|(key, _, _)| previous.contains_key(key)).count() as u64;
+        self.hits.fetch_add(hits, Ordering::Relaxed);
+        self.misses.fetch_add(scanned.len() as u64 - hits, Ordering::Relaxed);
+        for (key, fields, process) in scanned {
+            cache.insert(key, fields);
+            if filter.matches(&process) {
+                processes.push(process);
+            }
+        }
+        *self.static_cache.lock().unwrap() = cache;
+        *self.priority_floor.lock().unwrap() = None;
+
+        Ok(processes)
+    }
+}
+
+impl StaticFields {
+    fn size(&self) -> usize {
+        std::mem::size_of::<(ProcessKey, Self)>()
+            + self.cmdline.as_ref().map_or(0, String::len)
+            + self.exe.as_ref().map_or(0, String::len)
+    }
+}
+
+/// Reading one process's cmdline and exe link, in microseconds
+const STATIC_FIELDS_COST_US: u64 = 30;
+
+/// The static-field cache is only ever replaced whole, so it is evicted whole
+impl ManagedCache for ProcessTable {
+    fn usage(&self) -> CacheUsage {
+        let cache = self.static_cache.lock().unwrap();
+        CacheUsage {
+            name: "process_table",
+            entries: cache.len(),
+            bytes: cache.values().map(StaticFields::size).sum(),
+            hits: self.hits.load(Ordering::Relaxed),
+            misses: self.misses.load(Ordering::Relaxed),
+            evictions: self.evictions.load(Ordering::Relaxed),
+        }
+    }
+
+    fn coldest(&self, floor: u64) -> Option<u64> {
+        let cache = self.static_cache.lock().unwrap();
+        if cache.is_empty() {
+            return None;
+        }
+        let bytes = cache.values().map(StaticFields::size).sum();
+        let stamped = *self.priority_floor.lock().unwrap().get_or_insert(floor);
+        Some(stamped + cost_weight(STATIC_FIELDS_COST_US * cache.len() as u64, bytes))
+    }
+
+    fn evict_coldest(&self) -> usize {
+        let evicted = std::mem::take(&mut *self.static_cache.lock().unwrap());
+        if !evicted.is_empty() {
+            self.evictions.fetch_add(1, Ordering::Relaxed);
+        }
+        evicted.values().map(StaticFields::size).sum()
+    }
+}
+
+/// Read one /proc/<pid> entry; `None` if the process vanished mid-scan
+fn read_process(
+    pid: u32,
+    previous: &HashMap<ProcessKey, StaticFields>,
+    users: &HashMap<u32, String>,
+    page_size: u64,
+) -> Option<(ProcessKey, StaticFields, ProcessInfo)> {
+    let stat = std::fs::read_to_string(format!("/proc/{}/stat", pid)).ok()?;
+    let stat = parse_stat(&stat)?;
+
+    let uid = std::fs::read_to_string(format!("/proc/{}/status", pid))
+        .ok()
+        .and_then(|status| parse_status_uid(&status));
+
+    let key = (pid, stat.start_time);
+    let fields = match previous.get(&key) {
+        Some(fields) => fields.clone(),
+        None => StaticFields {
+            cmdline: std::fs::read(format!("/proc/{}/cmdline", pid))
+                .ok()
+                .and_then(|raw| parse_cmdline(&raw)),
+            exe: std::fs::read_link(format!("/proc/{}/exe", pid))
+                .ok()
+                .map(|path| path.to_string_lossy().into_owned()),
+        },
+    };
+
+    let process = ProcessInfo {
+        pid,
+        state: state_name(stat.state).to_string(),
+        executable_path: fields.exe.clone().or_else(|| Some(stat.comm.clone())),
+        memory_usage: Some(stat.rss_pages * page_size),
+        ppid: Some(stat.ppid),
+        name: Some(stat.comm),
+        cmdline: fields.cmdline.clone(),
+        uid,
+        user: uid.and_then(|uid| users.get(&uid).cloned()),
+    };
+
+    Some((key, fields, process))
+}
+
+/// CPU time (user + system, in clock ticks) consumed so far by one thread
+pub fn thread_cpu_ticks(pid: u32, tid: u32) -> Option<u64> {
+    let stat = std::fs::read_to_string(format!("/proc/{}/task/{}/stat", pid, tid)).ok()?;
+    let close = stat.rfind(')')?;
+    let rest: Vec<&str> = stat.get(close + 1..)?.split_whitespace().collect();
+    // utime and stime are fields 14 and 15
+    let utime: u64 = rest.get(11)?.parse().ok()?;
+    let stime: u64 = rest.get(12)?.parse().ok()?;
+    Some(utime + stime)
+}
+
+/// Summary of a process's address space
+#[derive(Debug, Clone, Default)]
+pub struct RegionStats {
+    pub count: usize,
+    pub mapped_bytes: u64,
+    pub writable_bytes: u64,
+    pub executable_bytes: u64,
+    /// Mappings not backed by a file (heap, stacks, anonymous mmap)
+    pub anonymous_bytes: u64,
+}
+
+impl RegionStats {
+    pub fn from_regions(regions: &[MemoryRegion]) -> Self {
+        let mut stats = Self::default();
+        for region in regions {
+            stats.count += 1;
+            stats.mapped_bytes += region.size;
+            if region.permissions.as_bytes().get(1) == Some(&b'w') {
+                stats.writable_bytes += region.size;
+            }
+            if region.permissions.as_bytes().get(2) == Some(&b'x') {
+                stats.executable_bytes += region.size;
+            }
+            if region.name.as_deref().map_or(true, |name| !name.starts_with('/')) {
+                stats.anonymous_bytes += region.size;
+            }
+        }
+        stats
+    }
+}
+
+/// One line of /proc/<pid>/maps
+#[derive(Debug, Clone)]
+pub struct MapEntry {
+    pub start: u64,
+    pub end: u64,
+    /// e.g. "r-xp"
+    pub perms: String,
+    pub offset: u64,
+    /// Backing file or pseudo-name such as "[stack]"
+    pub path: Option<String>,
+}
+
+impl MapEntry {
+    pub fn is_readable(&self) -> bool {
+        self.perms.as_bytes().first() == Some(&b'r')
+    }
+
+    pub fn is_writable(&self) -> bool {
+        self.perms.as_bytes().get(1) == Some(&b'w')
+    }
+
+    pub fn is_executable(&self) -> bool {
+        self.perms.as_bytes().get(2) == Some(&b'x')
+    }
+}
+
+/// Every mapping of a process, in address order
+pub fn memory_map(pid: u32) -> std::io::Result<Vec<MapEntry>> {
+    let maps = std::fs::read_to_string(format!("/proc/{}/maps", pid))?;
+    Ok(maps.lines().filter_map(parse_maps_line).collect())
+}
+
+fn parse_maps_line(line: &str) -> Option<MapEntry> {
+    // The first five columns are single-space separated; the path is padded
+    // and may itself contain spaces
+    let mut fields = line.splitn(6, ' ');
+    let (start, end) = fields.next()?.split_once('-')?;
+    let perms = fields.next()?.to_string();
+    let offset = u64::from_str_radix(fields.next()?, 16).ok()?;
+    let path = fields.nth(2).map(str::trim_start).filter(|path| !path.is_empty());
+    Some(MapEntry {
+        start: u64::from_str_radix(start, 16).ok()?,
+        end: u64::from_str_radix(end, 16).ok()?,
+        perms,
+        offset,
+        path: path.map(String::from),
+    })
+}
+
+/// Fields of interest from /proc/<pid>/stat
+struct StatFields {
+    comm: String,
+    state: char,
+    ppid: u32,
+    start_time: u64,
+    rss_pages: u64,
+}
+
+fn parse_stat(stat: &str) -> Option<StatFields> {
+    // comm may itself contain spaces and parentheses, so split on the last ')'
+    let open = stat.find('(')?;
+    let close = stat.rfind(')')?;
+    let comm = stat.get(open + 1..close)?.to_string();
+    let rest: Vec<&str> = stat.get(close + 1..)?.split_whitespace().collect();
+
+    // `rest` starts at field 3 (state); see proc(5) for numbering
+    Some(StatFields {
+        comm,
+        state: rest.first()?.chars().next()?,
+        ppid: rest.get(1)?.parse().ok()?,
+        start_time: rest.get(19)?.parse().ok()?,
+        rss_pages: rest.get(21)?.parse().ok()?,
+    })
+}
+
+fn parse_status_uid(status: &str) -> Option<u32> {
+    status
+        .lines()
+        .find(|line| line.starts_with("Uid:"))
+        .and_then(|line| line.split_whitespace().nth(1))
+        .and_then(|uid| uid.parse().ok())
+}
+
+fn parse_cmdline(raw: &[u8]) -> Option<String> {
+    let args: Vec<String> = raw
+        .split(|&b| b == 0)
+        .filter(|arg| !arg.is_empty())
+        .map(|arg| String::from_utf8_lossy(arg).into_owned())
+        .collect();
+    if args.is_empty() {
+        None
+    } else {
+        Some(args.join(" "))
+    }
+}
+
+fn state_name(state: char) -> &'static str {
+    match state {
+        'R' => "Running",
+        'S' => "Sleeping",
+        'D' => "DiskSleep",
+        'T' => "Stopped",
+        't' => "TracingStop",
+        'Z' => "Zombie",
+        'X' | 'x' => "Dead",
+        'I' => "Idle",
+        'P' => "Parked",
+        _ => "Unknown",
+    }
+}
+
+fn read_user_names() -> HashMap<u32, String> {
+    std::fs::read_to_string("/etc/passwd")
+        .map(|passwd| {
+            passwd
+                .lines()
+                .filter_map(|line| {
+                    let mut fields = line.split(':');
+                    let name = fields.next()?;
+                    let uid = fields.nth(1)?.parse().ok()?;
+                    Some((uid, name.to_string()))
+                })
+                .collect()
+        })
+        .unwrap_or_default()
+}
+
+fn page_size() -> u64 {
+    let size = unsafe { libc::sysconf(libc::_SC_PAGESIZE) };
+    if size > 0 {
+        size as u64
+    } else {
+        4096
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_stat_comm_with_spaces() {
+        let stat = "4242 (Web Content) S 4100 4100 4100 0 -1 4194560 51234 0 12 0 \
+                    900 300 0 0 20 0 28 0 123456 2901000192 51200 18446744073709551615";
+        let fields = parse_stat(stat).expect("stat line should parse");
+        assert_eq!(fields.comm, "Web Content");
+        assert_eq!(fields.state, 'S');
+        assert_eq!(fields.ppid, 4100);
+        assert_eq!(fields.start_time, 123456);
+        assert_eq!(fields.rss_pages, 51200);
+
+        // comm may itself contain ')' followed by something that looks like fields
+        let stat = stat.replace("(Web Content)", "(a) R 1 (b)");
+        let fields = parse_stat(&stat).expect("stat line should parse");
+        assert_eq!(fields.comm, "a) R 1 (b");
+        assert_eq!(fields.ppid, 4100);
+    }
+}
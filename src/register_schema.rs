@@ -0,0 +1,320 @@
+// Register schema cache
+//
+// Which registers exist, how wide they are and where they sit in LLDB's
+// register value tree depends only on the architecture (and the CPU features
+// LLDB detected), so it is discovered once and shared. Reading values is then
+// one positional child lookup per register, with no name comparisons, into a
+// flat byte array laid out by the schema. Vector registers keep their full
+// width.
+
+use std::collections::HashMap;
+use std::ffi::CStr;
+use std::os::raw::c_void;
+use std::sync::Arc;
+
+use lldb_sys::*;
+use serde_json::{json, Value};
+
+/// One register, as laid out in the schema
+#[derive(Debug, Clone)]
+pub struct RegisterDef {
+    pub name: String,
+    /// Register set name, e.g. "General Purpose Registers"
+    pub set: String,
+    /// Position in LLDB's register value tree
+    pub set_index: u32,
+    pub child_index: u32,
+    /// Width in bytes; 16/32/64 for xmm/ymm/zmm
+    pub size: u32,
+    /// Byte offset of this register's value in `RegisterValues`
+    pub offset: u32,
+    pub type_name: Option<String>,
+    /// general, program_counter, stack_pointer, frame_pointer, flags,
+    /// floating_point, vector or other
+    pub kind: &'static str,
+}
+
+#[derive(Debug)]
+pub struct RegisterSchema {
+    /// Target triple plus register set shape, the cache key
+    pub key: String,
+    pub sets: Vec<String>,
+    pub registers: Vec<RegisterDef>,
+    /// Size of one thread's values
+    pub total_bytes: usize,
+    by_name: HashMap<String, usize>,
+}
+
+impl RegisterSchema {
+    /// Position of a register, case-insensitively
+    pub fn index_of(&self, name: &str) -> Option<usize> {
+        self.by_name.get(&name.to_ascii_lowercase()).copied()
+    }
+
+    /// Approximate heap size, for the cache budget
+    pub fn approx_bytes(&self) -> usize {
+        std::mem::size_of::<Self>()
+            + self.registers.iter().map(|def| {
+                std::mem::size_of::<RegisterDef>() * 2 + def.name.len() * 2 + def.type_name.as_ref().map_or(0, String::len)
+            }).sum::<usize>()
+            + self.sets.iter().map(String::len).sum::<usize>()
+    }
+
+    /// Discover the schema from any frame's register tree
+    pub(crate) fn build(key: String, frame: SBFrameRef) -> Option<Self> {
+        let register_list = unsafe { SBFrameGetRegisters(frame) };
+        if register_list.is_null() {
+            return None;
+        }
+
+        let mut schema = Self::empty(key);
+        for set_index in 0..unsafe { SBValueListGetSize(register_list) } {
+            let register_set = unsafe { SBValueListGetValueAtIndex(register_list, set_index) };
+            if register_set.is_null() {
+                continue;
+            }
+            let set = c_string(unsafe { SBValueGetName(register_set) }).unwrap_or_else(|| format!("set{}", set_index));
+            for child_index in 0..unsafe { SBValueGetNumChildren(register_set) } {
+                let register = unsafe { SBValueGetChildAtIndex(register_set, child_index) };
+                if register.is_null() {
+                    continue;
+                }
+                let Some(name) = c_string(unsafe { SBValueGetName(register) }) else {
+                    continue;
+                };
+                let size = (unsafe { SBValueGetByteSize(register) } as u32).max(1);
+                let type_name = c_string(unsafe { SBValueGetTypeName(register) });
+                schema.push(name, &set, set_index, child_index, size, type_name);
+            }
+            schema.sets.push(set);
+        }
+        (!schema.registers.is_empty()).then_some(schema)
+    }
+
+    pub(crate) fn empty(key: String) -> Self {
+        Self { key, sets: Vec::new(), registers: Vec::new(), total_bytes: 0, by_name: HashMap::new() }
+    }
+
+    /// Append a register after the last one, laying out its value slot
+    pub(crate) fn push(&mut self, name: String, set: &str, set_index: u32, child_index: u32, size: u32, type_name: Option<String>) {
+        let kind = register_kind(&name, set, size);
+        self.by_name.entry(name.to_ascii_lowercase()).or_insert(self.registers.len());
+        self.registers.push(RegisterDef {
+            name,
+            set: set.to_string(),
+            set_index,
+            child_index,
+            size,
+            offset: self.total_bytes as u32,
+            type_name,
+            kind,
+        });
+        self.total_bytes += size as usize;
+    }
+}
+
+/// Cache key for the frame's register layout: the triple alone is not enough,
+/// since the same triple exposes more sets on CPUs with AVX or AVX-512
+pub(crate) fn schema_key(triple: &str, frame: SBFrameRef) -> Option<String> {
+    let register_list = unsafe { SBFrameGetRegisters(frame) };
+    if register_list.is_null() {
+        return None;
+    }
+    let shape: Vec<String> = (0..unsafe { SBValueListGetSize(register_list) })
+        .map(|set_index| {
+            let register_set = unsafe { SBValueListGetValueAtIndex(register_list, set_index) };
+            if register_set.is_null() { 0 } else { unsafe { SBValueGetNumChildren(register_set) } }
+        })
+        .map(|count| count.to_string())
+        .collect();
+    Some(format!("{}/{}", triple, shape.join(",")))
+}
+
+pub fn register_kind(name: &str, set: &str, size: u32) -> &'static str {
+    let name = name.to_ascii_lowercase();
+    let set = set.to_ascii_lowercase();
+    match name.as_str() {
+        "rip" | "eip" | "ip" | "pc" => return "program_counter",
+        "rsp" | "esp" | "sp" => return "stack_pointer",
+        "rbp" | "ebp" | "fp" | "x29" => return "frame_pointer",
+        "rflags" | "eflags" | "cpsr" | "fpsr" | "fpcr" | "mxcsr" | "fctrl" | "fstat" => return "flags",
+        _ => {}
+    }
+    let numbered = |prefix: &str| name.strip_prefix(prefix).map_or(false, |rest| !rest.is_empty() && rest.chars().all(|c| c.is_ascii_digit()));
+    if ["xmm", "ymm", "zmm", "v", "q", "z"].iter().any(|prefix| numbered(prefix)) || size > 10 && !set.contains("float") {
+        "vector"
+    } else if set.contains("float") || ["st", "stmm", "d", "s"].iter().any(|prefix| numbered(prefix)) {
+        "floating_point"
+    } else if set.contains("general") {
+        "general"
+    } else {
+        "other"
+    }
+}
+
+fn c_string(ptr: *const std::os::raw::c_char) -> Option<String> {
+    if ptr.is_null() {
+        return None;
+    }
+    Some(unsafe { CStr::from_ptr(ptr) }.to_string_lossy().into_owned())
+}
+
+/// Register values of one thread's frame, stored flat in schema order
+#[derive(Debug, Clone)]
+pub struct RegisterValues {
+    pub schema: Arc<RegisterSchema>,
+    pub thread_id: u32,
+    pub frame_index: u32,
+    data: Vec<u8>,
+    valid: Vec<bool>,
+}
+
+impl RegisterValues {
+    pub fn new(schema: Arc<RegisterSchema>, thread_id: u32, frame_index: u32) -> Self {
+        let data = vec![0; schema.total_bytes];
+        let valid = vec![false; schema.registers.len()];
+        Self { schema, thread_id, frame_index, data, valid }
+    }
+
+    pub fn len(&self) -> usize {
+        self.schema.registers.len()
+    }
+
+    pub fn is_valid(&self, index: usize) -> bool {
+        self.valid.get(index).copied().unwrap_or(false)
+    }
+
+    /// Full-width little-endian bytes of register `index`
+    pub fn bytes(&self, index: usize) -> Option<&[u8]> {
+        let def = self.schema.registers.get(index)?;
+        self.is_valid(index).then(|| &self.data[def.offset as usize..(def.offset + def.size) as usize])
+    }
+
+    pub fn set_bytes(&mut self, index: usize, bytes: &[u8]) {
+        let Some(def) = self.schema.registers.get(index) else {
+            return;
+        };
+        let slot = &mut self.data[def.offset as usize..(def.offset + def.size) as usize];
+        let len = bytes.len().min(slot.len());
+        slot[..len].copy_from_slice(&bytes[..len]);
+        slot[len..].fill(0);
+        self.valid[index] = true;
+    }
+
+    /// Low 64 bits of register `index`
+    pub fn value(&self, index: usize) -> Option<u64> {
+        let bytes = self.bytes(index)?;
+        let mut low = [0u8; 8];
+        let len = bytes.len().min(8);
+        low[..len].copy_from_slice(&bytes[..len]);
+        Some(u64::from_le_bytes(low))
+    }
+
+    /// Full-width value as hex, most significant byte first
+    pub fn hex(&self, index: usize) -> Option<String> {
+        let bytes = self.bytes(index)?;
+        if bytes.len() <= 8 {
+            return self.value(index).map(|value| format!("0x{:x}", value));
+        }
+        Some(format!("0x{}", bytes.iter().rev().map(|byte| format!("{:02x}", byte)).collect::<String>()))
+    }
+
+    /// Valid registers as (index, def) pairs, in schema order
+    pub fn iter(&self) -> impl Iterator<Item = (usize, &RegisterDef)> {
+        self.schema.registers.iter().enumerate().filter(|(index, _)| self.is_valid(*index))
+    }
+
+    pub fn register_json(&self, index: usize, include_metadata: bool) -> Value {
+        let def = &self.schema.registers[index];
+        let mut register = json!({
+            "name": def.name,
+            "value": self.hex(index),
+            "decimal_value": self.value(index)
+        });
+        if def.size > 8 {
+            // Per-lane views are the caller's business; the raw bytes are exact
+            register["bytes"] = json!(self.bytes(index).map(|bytes| bytes.to_vec()));
+        }
+        if include_metadata {
+            register["size"] = json!(def.size);
+            register["type"] = json!(def.kind);
+            register["set"] = json!(def.set);
+            register["offset"] = json!(def.offset);
+            register["value_type"] = json!(def.type_name);
+            register["format"] = json!("hex");
+            register["is_valid"] = json!(true);
+        }
+        register
+    }
+}
+
+/// Resolve register `def` in a frame's register tree: two positional lookups
+pub(crate) fn register_value(register_list: SBValueListRef, def: &RegisterDef) -> Option<SBValueRef> {
+    let register_set = unsafe { SBValueListGetValueAtIndex(register_list, def.set_index) };
+    if register_set.is_null() {
+        return None;
+    }
+    let register = unsafe { SBValueGetChildAtIndex(register_set, def.child_index) };
+    (!register.is_null()).then_some(register)
+}
+
+/// Raw bytes of one register value, at most `out.len()`
+pub(crate) fn read_register_bytes(register: SBValueRef, out: &mut [u8]) -> bool {
+    let data = unsafe { SBValueGetData(register) };
+    if !data.is_null() {
+        let error = unsafe { CreateSBError() };
+        let len = out.len().min(unsafe { SBDataGetByteSize(data) });
+        let read = unsafe { SBDataReadRawData(data, error, 0, out.as_mut_ptr() as *mut c_void, len) };
+        let failed = unsafe { SBErrorFail(error) };
+        unsafe {
+            DisposeSBError(error);
+            DisposeSBData(data);
+        }
+        if !failed && read == len && len > 0 {
+            return true;
+        }
+    }
+
+    // Scalar fallback, which loses anything past 64 bits
+    let error = unsafe { CreateSBError() };
+    let value = unsafe { SBValueGetValueAsUnsigned(register, error, 0) };
+    let failed = unsafe { SBErrorFail(error) };
+    unsafe { DisposeSBError(error) };
+    if failed {
+        return false;
+    }
+    let bytes = value.to_le_bytes();
+    let len = out.len().min(8);
+    out[..len].copy_from_slice(&bytes[..len]);
+    true
+}
+
+/// Read every register of `frame` into a flat value array
+pub(crate) fn read_values(schema: &Arc<RegisterSchema>, frame: SBFrameRef, thread_id: u32, frame_index: u32) -> RegisterValues {
+    let mut values = RegisterValues::new(schema.clone(), thread_id, frame_index);
+    let register_list = unsafe { SBFrameGetRegisters(frame) };
+    if register_list.is_null() {
+        return values;
+    }
+
+    let mut scratch = vec![0u8; schema.registers.iter().map(|def| def.size as usize).max().unwrap_or(8)];
+    let mut set = (u32::MAX, std::ptr::null_mut());
+    for (index, def) in schema.registers.iter().enumerate() {
+        if set.0 != def.set_index {
+            set = (def.set_index, unsafe { SBValueListGetValueAtIndex(register_list, def.set_index) });
+        }
+        if set.1.is_null() {
+            continue;
+        }
+        let register = unsafe { SBValueGetChildAtIndex(set.1, def.child_index) };
+        if register.is_null() {
+            continue;
+        }
+        let out = &mut scratch[..def.size as usize];
+        out.fill(0);
+        if read_register_bytes(register, out) {
+            values.set_bytes(index, out);
+        }
+    }
+    values
+}
@@ -0,0 +1,1026 @@
+// Session snapshots
+//
+// A snapshot is everything needed to put a debugging session back: the
+// target and how it was launched, breakpoints and watchpoints, the selected
+// thread and frame, captured console output and the modules that were loaded.
+// Breakpoint locations are stored as module-relative file addresses, so a
+// restore re-creates them without symbol lookups when the module is
+// unchanged, and falls back to the original name or file:line spec when it is
+// not.
+//
+// The binary encoding is a magic, a format version and a sequence of tagged,
+// length-prefixed sections of LEB128 varints and length-prefixed strings.
+// Readers skip sections they do not know, so newer snapshots still load.
+
+use std::collections::HashMap;
+use std::ffi::{CStr, CString};
+use std::os::raw::c_char;
+
+use lldb_sys::*;
+use serde_json::{json, Value};
+use uuid::Uuid;
+
+use crate::console_buffer::{ConsoleBuffer, ConsoleStream};
+use crate::error::{IncodeError, IncodeResult};
+use crate::lldb_manager::{LaunchOptions, SessionState};
+
+pub const SNAPSHOT_MAGIC: &[u8; 8] = b"INCSNAP\0";
+pub const SNAPSHOT_VERSION: u16 = 1;
+/// Console output kept in a snapshot, newest first
+pub const CONSOLE_SNAPSHOT_BYTES: usize = 1024 * 1024;
+
+const SECTION_META: u8 = 1;
+const SECTION_TARGET: u8 = 2;
+const SECTION_MODULES: u8 = 3;
+const SECTION_BREAKPOINTS: u8 = 4;
+const SECTION_WATCHPOINTS: u8 = 5;
+const SECTION_CONSOLE: u8 = 6;
+
+/// Where a breakpoint location or watched address lives in its module
+#[derive(Debug, Clone, PartialEq)]
+pub struct ModuleOffset {
+    pub module: String,
+    pub uuid: Option<String>,
+    /// Address in the module's file, independent of where it was loaded
+    pub file_address: u64,
+}
+
+#[derive(Debug, Clone, PartialEq)]
+pub struct BreakpointSnapshot {
+    pub id: u32,
+    /// Original spec: a function name, `file:line` or `0x...` address
+    pub spec: String,
+    pub enabled: bool,
+    pub one_shot: bool,
+    pub ignore_count: u32,
+    pub hit_count: u32,
+    pub condition: Option<String>,
+    pub locations: Vec<ModuleOffset>,
+}
+
+#[derive(Debug, Clone, PartialEq)]
+pub struct WatchpointSnapshot {
+    pub id: u32,
+    pub address: u64,
+    pub size: u32,
+    pub read: bool,
+    pub write: bool,
+    pub enabled: bool,
+    pub condition: Option<String>,
+    /// Set for globals; heap and stack addresses only mean something in the same process
+    pub location: Option<ModuleOffset>,
+}
+
+#[derive(Debug, Clone, PartialEq)]
+pub struct ModuleSnapshot {
+    pub path: String,
+    pub uuid: Option<String>,
+}
+
+#[derive(Debug, Clone, PartialEq)]
+pub struct SessionSnapshot {
+    pub session_id: Uuid,
+    pub state: SessionState,
+    pub created_at: u64,
+    pub saved_at: u64,
+    pub target_path: Option<String>,
+    pub process_id: Option<u32>,
+    pub core_path: Option<String>,
+    pub launch: Option<LaunchOptions>,
+    pub selected_thread_id: Option<u32>,
+    pub selected_frame_index: u32,
+    pub modules: Vec<ModuleSnapshot>,
+    pub breakpoints: Vec<BreakpointSnapshot>,
+    pub watchpoints: Vec<WatchpointSnapshot>,
+    /// Most recent console output, oldest first
+    pub console: Vec<(ConsoleStream, String)>,
+}
+
+impl SessionSnapshot {
+    /// Compact binary encoding
+    pub fn encode(&self) -> Vec<u8> {
+        let mut out = Vec::with_capacity(256 + self.breakpoints.len() * 48);
+        out.extend_from_slice(SNAPSHOT_MAGIC);
+        out.extend_from_slice(&SNAPSHOT_VERSION.to_le_bytes());
+
+        let mut w = Writer::default();
+        w.bytes(self.session_id.as_bytes());
+        w.u64(state_code(&self.state) as u64);
+        w.u64(self.created_at);
+        w.u64(self.saved_at);
+        w.opt_u64(self.process_id.map(u64::from));
+        w.opt_u64(self.selected_thread_id.map(u64::from));
+        w.u64(self.selected_frame_index as u64);
+        w.section(SECTION_META, &mut out);
+
+        w.opt_str(self.target_path.as_deref());
+        w.opt_str(self.core_path.as_deref());
+        w.bool(self.launch.is_some());
+        if let Some(launch) = &self.launch {
+            w.u64(launch.args.len() as u64);
+            for arg in &launch.args {
+                w.str(arg);
+            }
+            let mut env: Vec<_> = launch.env.iter().collect();
+            env.sort();
+            w.u64(env.len() as u64);
+            for (key, value) in env {
+                w.str(key);
+                w.str(value);
+            }
+            w.opt_str(launch.working_dir.as_deref());
+            w.bool(launch.stop_at_entry);
+            w.bool(launch.preload_dependents);
+            w.bool(launch.load_symbols_on_demand);
+            w.opt_u64(launch.wait_for_stop_ms);
+        }
+        w.section(SECTION_TARGET, &mut out);
+
+        w.u64(self.modules.len() as u64);
+        for module in &self.modules {
+            w.str(&module.path);
+            w.opt_str(module.uuid.as_deref());
+        }
+        w.section(SECTION_MODULES, &mut out);
+
+        // Locations mostly share a handful of modules; store each path once
+        let mut module_table = StringTable::default();
+        let mut body = Writer::default();
+        body.u64(self.breakpoints.len() as u64);
+        for breakpoint in &self.breakpoints {
+            body.u64(breakpoint.id as u64);
+            body.str(&breakpoint.spec);
+            body.u64(breakpoint.enabled as u64 | (breakpoint.one_shot as u64) << 1);
+            body.u64(breakpoint.ignore_count as u64);
+            body.u64(breakpoint.hit_count as u64);
+            body.opt_str(breakpoint.condition.as_deref());
+            body.u64(breakpoint.locations.len() as u64);
+            for location in &breakpoint.locations {
+                body.u64(module_table.index(&location.module, location.uuid.as_deref()));
+                body.u64(location.file_address);
+            }
+        }
+        module_table.write(&mut w);
+        w.bytes(&body.buf);
+        w.section(SECTION_BREAKPOINTS, &mut out);
+
+        w.u64(self.watchpoints.len() as u64);
+        for watchpoint in &self.watchpoints {
+            w.u64(watchpoint.id as u64);
+            w.u64(watchpoint.address);
+            w.u64(watchpoint.size as u64);
+            w.u64(watchpoint.read as u64 | (watchpoint.write as u64) << 1 | (watchpoint.enabled as u64) << 2);
+            w.opt_str(watchpoint.condition.as_deref());
+            w.bool(watchpoint.location.is_some());
+            if let Some(location) = &watchpoint.location {
+                w.str(&location.module);
+                w.opt_str(location.uuid.as_deref());
+                w.u64(location.file_address);
+            }
+        }
+        w.section(SECTION_WATCHPOINTS, &mut out);
+
+        w.u64(self.console.len() as u64);
+        for (stream, text) in &self.console {
+            w.bool(*stream == ConsoleStream::Stderr);
+            w.str(text);
+        }
+        w.section(SECTION_CONSOLE, &mut out);
+        out
+    }
+
+    pub fn decode(data: &[u8]) -> IncodeResult<Self> {
+        if !is_binary_snapshot(data) {
+            return Err(IncodeError::session("Not an incode session snapshot"));
+        }
+        let version = u16::from_le_bytes([data[8], data[9]]);
+        if version > SNAPSHOT_VERSION {
+            return Err(IncodeError::session(format!(
+                "Session snapshot version {} is newer than supported version {}", version, SNAPSHOT_VERSION
+            )));
+        }
+
+        let mut snapshot = SessionSnapshot::new(Uuid::nil());
+        let mut sections = Reader::new(&data[10..]);
+        while !sections.is_empty() {
+            let tag = sections.byte()?;
+            let len = sections.u64()? as usize;
+            let mut r = Reader::new(sections.take(len)?);
+            match tag {
+                SECTION_META => {
+                    snapshot.session_id = Uuid::from_slice(r.take(16)?).map_err(|_| corrupt())?;
+                    snapshot.state = state_from_code(r.u64()? as u8);
+                    snapshot.created_at = r.u64()?;
+                    snapshot.saved_at = r.u64()?;
+                    snapshot.process_id = r.opt_u64()?.map(|pid| pid as u32);
+                    snapshot.selected_thread_id = r.opt_u64()?.map(|tid| tid as u32);
+                    snapshot.selected_frame_index = r.u64()? as u32;
+                }
+                SECTION_TARGET => {
+                    snapshot.target_path = r.opt_str()?;
+                    snapshot.core_path = r.opt_str()?;
+                    if r.bool()? {
+                        let args = (0..r.u64()?).map(|_| r.str()).collect::<IncodeResult<Vec<_>>>()?;
+                        let env = (0..r.u64()?).map(|_| Ok((r.str()?, r.str()?))).collect::<IncodeResult<HashMap<_, _>>>()?;
+                        snapshot.launch = Some(LaunchOptions {
+                            args,
+                            env,
+                            working_dir: r.opt_str()?,
+                            stop_at_entry: r.bool()?,
+                            preload_dependents: r.bool()?,
+                            load_symbols_on_demand: r.bool()?,
+                            wait_for_stop_ms: r.opt_u64()?,
+                        });
+                    }
+                }
+                SECTION_MODULES => {
+                    snapshot.modules = (0..r.u64()?)
+                        .map(|_| Ok(ModuleSnapshot { path: r.str()?, uuid: r.opt_str()? }))
+                        .collect::<IncodeResult<_>>()?;
+                }
+                SECTION_BREAKPOINTS => {
+                    let modules = (0..r.u64()?).map(|_| Ok((r.str()?, r.opt_str()?))).collect::<IncodeResult<Vec<_>>>()?;
+                    let count = r.u64()?;
+                    snapshot.breakpoints = Vec::with_capacity(count.min(1 << 20) as usize);
+                    for _ in 0..count {
+                        let id = r.u64()? as u32;
+                        let spec = r.str()?;
+                        let flags = r.u64()?;
+                        let ignore_count = r.u64()? as u32;
+                        let hit_count = r.u64()? as u32;
+                        let condition = r.opt_str()?;
+                        let locations = (0..r.u64()?)
+                            .map(|_| {
+                                let (module, uuid) = modules.get(r.u64()? as usize).cloned().ok_or_else(corrupt)?;
+                                Ok(ModuleOffset { module, uuid, file_address: r.u64()? })
+                            })
+                            .collect::<IncodeResult<_>>()?;
+                        snapshot.breakpoints.push(BreakpointSnapshot {
+                            id,
+                            spec,
+                            enabled: flags & 1 != 0,
+                            one_shot: flags & 2 != 0,
+                            ignore_count,
+                            hit_count,
+                            condition,
+                            locations,
+                        });
+                    }
+                }
+                SECTION_WATCHPOINTS => {
+                    snapshot.watchpoints = (0..r.u64()?)
+                        .map(|_| {
+                            let id = r.u64()? as u32;
+                            let address = r.u64()?;
+                            let size = r.u64()? as u32;
+                            let flags = r.u64()?;
+                            let condition = r.opt_str()?;
+                            let location = if r.bool()? {
+                                Some(ModuleOffset { module: r.str()?, uuid: r.opt_str()?, file_address: r.u64()? })
+                            } else {
+                                None
+                            };
+                            Ok(WatchpointSnapshot {
+                                id,
+                                address,
+                                size,
+                                read: flags & 1 != 0,
+                                write: flags & 2 != 0,
+                                enabled: flags & 4 != 0,
+                                condition,
+                                location,
+                            })
+                        })
+                        .collect::<IncodeResult<_>>()?;
+                }
+                SECTION_CONSOLE => {
+                    snapshot.console = (0..r.u64()?)
+                        .map(|_| {
+                            let stream = if r.bool()? { ConsoleStream::Stderr } else { ConsoleStream::Stdout };
+                            Ok((stream, r.str()?))
+                        })
+                        .collect::<IncodeResult<_>>()?;
+                }
+                _ => {} // Section from a newer version
+            }
+        }
+        if snapshot.session_id.is_nil() {
+            return Err(corrupt());
+        }
+        Ok(snapshot)
+    }
+
+    pub fn new(session_id: Uuid) -> Self {
+        Self {
+            session_id,
+            state: SessionState::Created,
+            created_at: 0,
+            saved_at: 0,
+            target_path: None,
+            process_id: None,
+            core_path: None,
+            launch: None,
+            selected_thread_id: None,
+            selected_frame_index: 0,
+            modules: Vec::new(),
+            breakpoints: Vec::new(),
+            watchpoints: Vec::new(),
+            console: Vec::new(),
+        }
+    }
+
+    /// JSON export; `from_json` reads it back
+    pub fn to_json(&self) -> Value {
+        let offset_json = |location: &ModuleOffset| json!({
+            "module": location.module,
+            "uuid": location.uuid,
+            "file_address": format!("0x{:x}", location.file_address)
+        });
+        json!({
+            "format_version": SNAPSHOT_VERSION,
+            "session_id": self.session_id.to_string(),
+            "state": format!("{:?}", self.state),
+            "created_at": self.created_at,
+            "saved_at": self.saved_at,
+            "target_path": self.target_path,
+            "process_id": self.process_id,
+            "process_info": {
+                "process_id": self.process_id,
+                "state": format!("{:?}", self.state),
+                "target_path": self.target_path
+            },
+            "core_path": self.core_path,
+            "launch": self.launch.as_ref().map(|launch| json!({
+                "args": launch.args,
+                "env": launch.env,
+                "working_dir": launch.working_dir,
+                "stop_at_entry": launch.stop_at_entry,
+                "preload_dependents": launch.preload_dependents,
+                "load_symbols_on_demand": launch.load_symbols_on_demand,
+                "wait_for_stop_ms": launch.wait_for_stop_ms
+            })),
+            "current_thread_id": self.selected_thread_id,
+            "current_frame_index": self.selected_frame_index,
+            "has_target": self.target_path.is_some() || self.core_path.is_some(),
+            "has_process": self.process_id.is_some(),
+            "modules": self.modules.iter().map(|module| json!({ "path": module.path, "uuid": module.uuid })).collect::<Vec<_>>(),
+            "breakpoints": self.breakpoints.iter().map(|breakpoint| json!({
+                "id": breakpoint.id,
+                "spec": breakpoint.spec,
+                "enabled": breakpoint.enabled,
+                "one_shot": breakpoint.one_shot,
+                "ignore_count": breakpoint.ignore_count,
+                "hit_count": breakpoint.hit_count,
+                "condition": breakpoint.condition,
+                "locations": breakpoint.locations.iter().map(offset_json).collect::<Vec<_>>()
+            })).collect::<Vec<_>>(),
+            "watchpoints": self.watchpoints.iter().map(|watchpoint| json!({
+                "id": watchpoint.id,
+                "address": format!("0x{:x}", watchpoint.address),
+                "size": watchpoint.size,
+                "read": watchpoint.read,
+                "write": watchpoint.write,
+                "enabled": watchpoint.enabled,
+                "condition": watchpoint.condition,
+                "location": watchpoint.location.as_ref().map(offset_json)
+            })).collect::<Vec<_>>(),
+            "console": self.console.iter().map(|(stream, text)| json!({ "stream": stream.as_str(), "text": text })).collect::<Vec<_>>()
+        })
+    }
+
+    /// Read a JSON export, including the older ID-and-flags session files
+    pub fn from_json(data: &Value) -> IncodeResult<Self> {
+        let session_id = data["session_id"].as_str()
+            .ok_or_else(|| IncodeError::session("Missing session_id in session data"))?;
+        let session_id = Uuid::parse_str(session_id)
+            .map_err(|e| IncodeError::session(format!("Invalid session ID: {}", e)))?;
+        let state = data["state"].as_str()
+            .ok_or_else(|| IncodeError::session("Missing state in session data"))?;
+
+        let text = |value: &Value| value.as_str().map(String::from);
+        let hex = |value: &Value| value.as_str().and_then(|s| u64::from_str_radix(s.trim_start_matches("0x"), 16).ok());
+        let offset = |value: &Value| -> Option<ModuleOffset> {
+            Some(ModuleOffset { module: text(&value["module"])?, uuid: text(&value["uuid"]), file_address: hex(&value["file_address"])? })
+        };
+        let array = |value: &Value| value.as_array().cloned().unwrap_or_default();
+
+        let mut snapshot = SessionSnapshot::new(session_id);
+        snapshot.state = state_from_name(state);
+        snapshot.created_at = data["created_at"].as_u64().unwrap_or(0);
+        snapshot.saved_at = data["saved_at"].as_u64().unwrap_or(0);
+        snapshot.target_path = text(&data["target_path"]);
+        snapshot.process_id = data["process_id"].as_u64().map(|pid| pid as u32);
+        snapshot.core_path = text(&data["core_path"]);
+        snapshot.launch = data["launch"].as_object().map(|launch| LaunchOptions {
+            args: launch.get("args").map(array).unwrap_or_default().iter().filter_map(text).collect(),
+            env: launch.get("env").and_then(Value::as_object)
+                .map(|env| env.iter().filter_map(|(key, value)| Some((key.clone(), text(value)?))).collect())
+                .unwrap_or_default(),
+            working_dir: launch.get("working_dir").and_then(text),
+            stop_at_entry: launch.get("stop_at_entry").and_then(Value::as_bool).unwrap_or(false),
+            preload_dependents: launch.get("preload_dependents").and_then(Value::as_bool).unwrap_or(false),
+            load_symbols_on_demand: launch.get("load_symbols_on_demand").and_then(Value::as_bool).unwrap_or(true),
+            wait_for_stop_ms: launch.get("wait_for_stop_ms").and_then(Value::as_u64),
+        });
+        snapshot.selected_thread_id = data["current_thread_id"].as_u64().map(|tid| tid as u32);
+        snapshot.selected_frame_index = data["current_frame_index"].as_u64().unwrap_or(0) as u32;
+        snapshot.modules = array(&data["modules"]).iter()
+            .filter_map(|module| Some(ModuleSnapshot { path: text(&module["path"])?, uuid: text(&module["uuid"]) }))
+            .collect();
+        snapshot.breakpoints = array(&data["breakpoints"]).iter()
+            .filter_map(|breakpoint| Some(BreakpointSnapshot {
+                id: breakpoint["id"].as_u64()? as u32,
+                spec: text(&breakpoint["spec"])?,
+                enabled: breakpoint["enabled"].as_bool().unwrap_or(true),
+                one_shot: breakpoint["one_shot"].as_bool().unwrap_or(false),
+                ignore_count: breakpoint["ignore_count"].as_u64().unwrap_or(0) as u32,
+                hit_count: breakpoint["hit_count"].as_u64().unwrap_or(0) as u32,
+                condition: text(&breakpoint["condition"]),
+                locations: array(&breakpoint["locations"]).iter().filter_map(offset).collect(),
+            }))
+            .collect();
+        snapshot.watchpoints = array(&data["watchpoints"]).iter()
+            .filter_map(|watchpoint| Some(WatchpointSnapshot {
+                id: watchpoint["id"].as_u64()? as u32,
+                address: hex(&watchpoint["address"])?,
+                size: watchpoint["size"].as_u64()? as u32,
+                read: watchpoint["read"].as_bool().unwrap_or(false),
+                write: watchpoint["write"].as_bool().unwrap_or(true),
+                enabled: watchpoint["enabled"].as_bool().unwrap_or(true),
+                condition: text(&watchpoint["condition"]),
+                location: offset(&watchpoint["location"]),
+            }))
+            .collect();
+        snapshot.console = array(&data["console"]).iter()
+            .filter_map(|segment| {
+                let stream = if segment["stream"].as_str() == Some("stderr") { ConsoleStream::Stderr } else { ConsoleStream::Stdout };
+                Some((stream, text(&segment["text"])?))
+            })
+            .collect();
+        Ok(snapshot)
+    }
+}
+
+/// What `restore_session` brings back besides the session record
+#[derive(Debug, Clone)]
+pub struct RestoreOptions {
+    /// Reload the core, relaunch the program or re-attach to the process
+    pub restore_target: bool,
+    pub restore_breakpoints: bool,
+}
+
+impl Default for RestoreOptions {
+    fn default() -> Self {
+        Self { restore_target: true, restore_breakpoints: true }
+    }
+}
+
+#[derive(Debug, Clone)]
+pub struct SessionRestore {
+    pub session_id: Uuid,
+    /// How the target came back, e.g. "launched /bin/app"
+    pub target: Option<String>,
+    pub pid: Option<u32>,
+    /// (saved id, new id) pairs
+    pub breakpoints_by_offset: Vec<(u32, u32)>,
+    pub breakpoints_by_spec: Vec<(u32, u32)>,
+    pub breakpoints_failed: Vec<String>,
+    pub watchpoints_restored: usize,
+    pub watchpoints_skipped: Vec<String>,
+    pub modules_matched: usize,
+    /// Saved modules that are missing or were rebuilt since
+    pub modules_changed: Vec<String>,
+    pub console_segments: usize,
+    pub restore_ms: u64,
+}
+
+impl SessionRestore {
+    pub(crate) fn new(session_id: Uuid) -> Self {
+        Self {
+            session_id,
+            target: None,
+            pid: None,
+            breakpoints_by_offset: Vec::new(),
+            breakpoints_by_spec: Vec::new(),
+            breakpoints_failed: Vec::new(),
+            watchpoints_restored: 0,
+            watchpoints_skipped: Vec::new(),
+            modules_matched: 0,
+            modules_changed: Vec::new(),
+            console_segments: 0,
+            restore_ms: 0,
+        }
+    }
+
+    pub fn to_json(&self) -> Value {
+        let pairs = |pairs: &[(u32, u32)]| pairs.iter().map(|(saved, new)| json!({ "saved_id": saved, "id": new })).collect::<Vec<_>>();
+        json!({
+            "session_id": self.session_id.to_string(),
+            "target": self.target,
+            "pid": self.pid,
+            "breakpoints": {
+                "by_offset": pairs(&self.breakpoints_by_offset),
+                "by_spec": pairs(&self.breakpoints_by_spec),
+                "failed": self.breakpoints_failed
+            },
+            "watchpoints": {
+                "restored": self.watchpoints_restored,
+                "skipped": self.watchpoints_skipped
+            },
+            "modules": {
+                "matched": self.modules_matched,
+                "changed": self.modules_changed
+            },
+            "console_segments": self.console_segments,
+            "restore_ms": self.restore_ms
+        })
+    }
+}
+
+pub fn is_binary_snapshot(data: &[u8]) -> bool {
+    data.len() >= 10 && &data[..8] == SNAPSHOT_MAGIC
+}
+
+fn state_code(state: &SessionState) -> u8 {
+    match state {
+        SessionState::Created => 0,
+        SessionState::Attached => 1,
+        SessionState::Running => 2,
+        SessionState::Stopped => 3,
+        SessionState::Terminated => 4,
+    }
+}
+
+fn state_from_code(code: u8) -> SessionState {
+    match code {
+        1 => SessionState::Attached,
+        2 => SessionState::Running,
+        3 => SessionState::Stopped,
+        4 => SessionState::Terminated,
+        _ => SessionState::Created,
+    }
+}
+
+pub(crate) fn state_from_name(name: &str) -> SessionState {
+    match name {
+        "Attached" => SessionState::Attached,
+        "Running" => SessionState::Running,
+        "Stopped" => SessionState::Stopped,
+        "Terminated" => SessionState::Terminated,
+        _ => SessionState::Created,
+    }
+}
+
+fn corrupt() -> IncodeError {
+    IncodeError::session("Corrupt session snapshot")
+}
+
+#[derive(Default)]
+struct Writer {
+    buf: Vec<u8>,
+}
+
+impl Writer {
+    fn u64(&mut self, mut value: u64) {
+        loop {
+            let byte = (value & 0x7f) as u8;
+            value >>= 7;
+            if value == 0 {
+                self.buf.push(byte);
+                return;
+            }
+            self.buf.push(byte | 0x80);
+        }
+    }
+
+    fn bool(&mut self, value: bool) {
+        self.buf.push(value as u8);
+    }
+
+    fn opt_u64(&mut self, value: Option<u64>) {
+        match value {
+            Some(value) => {
+                self.bool(true);
+                self.u64(value);
+            }
+            None => self.bool(false),
+        }
+    }
+
+    fn bytes(&mut self, bytes: &[u8]) {
+        self.buf.extend_from_slice(bytes);
+    }
+
+    fn str(&mut self, text: &str) {
+        self.u64(text.len() as u64);
+        self.buf.extend_from_slice(text.as_bytes());
+    }
+
+    fn opt_str(&mut self, text: Option<&str>) {
+        match text {
+            Some(text) => {
+                self.bool(true);
+                self.str(text);
+            }
+            None => self.bool(false),
+        }
+    }
+
+    /// Move the buffered payload into `out` as one tagged section
+    fn section(&mut self, tag: u8, out: &mut Vec<u8>) {
+        out.push(tag);
+        let mut len = Writer::default();
+        len.u64(self.buf.len() as u64);
+        out.extend_from_slice(&len.buf);
+        out.append(&mut self.buf);
+    }
+}
+
+struct Reader<'a> {
+    data: &'a [u8],
+}
+
+impl<'a> Reader<'a> {
+    fn new(data: &'a [u8]) -> Self {
+        Self { data }
+    }
+
+    fn is_empty(&self) -> bool {
+        self.data.is_empty()
+    }
+
+    fn take(&mut self, len: usize) -> IncodeResult<&'a [u8]> {
+        if len > self.data.len() {
+            return Err(corrupt());
+        }
+        let (head, tail) = self.data.split_at(len);
+        self.data = tail;
+        Ok(head)
+    }
+
+    fn byte(&mut self) -> IncodeResult<u8> {
+        Ok(self.take(1)?[0])
+    }
+
+    fn u64(&mut self) -> IncodeResult<u64> {
+        let mut value = 0u64;
+        for shift in (0..64).step_by(7) {
+            let byte = self.byte()?;
+            value |= ((byte & 0x7f) as u64) << shift;
+            if byte & 0x80 == 0 {
+                return Ok(value);
+            }
+        }
+        Err(corrupt())
+    }
+
+    fn bool(&mut self) -> IncodeResult<bool> {
+        Ok(self.byte()? != 0)
+    }
+
+    fn opt_u64(&mut self) -> IncodeResult<Option<u64>> {
+        if self.bool()? { self.u64().map(Some) } else { Ok(None) }
+    }
+
+    fn str(&mut self) -> IncodeResult<String> {
+        let len = self.u64()? as usize;
+        String::from_utf8(self.take(len)?.to_vec()).map_err(|_| corrupt())
+    }
+
+    fn opt_str(&mut self) -> IncodeResult<Option<String>> {
+        if self.bool()? { self.str().map(Some) } else { Ok(None) }
+    }
+}
+
+/// Module paths deduplicated for the breakpoint section
+#[derive(Default)]
+struct StringTable {
+    entries: Vec<(String, Option<String>)>,
+    index: HashMap<String, u64>,
+}
+
+impl StringTable {
+    fn index(&mut self, module: &str, uuid: Option<&str>) -> u64 {
+        if let Some(&index) = self.index.get(module) {
+            return index;
+        }
+        let index = self.entries.len() as u64;
+        self.entries.push((module.to_string(), uuid.map(String::from)));
+        self.index.insert(module.to_string(), index);
+        index
+    }
+
+    fn write(&self, w: &mut Writer) {
+        w.u64(self.entries.len() as u64);
+        for (module, uuid) in &self.entries {
+            w.str(module);
+            w.opt_str(uuid.as_deref());
+        }
+    }
+}
+
+fn c_text(ptr: *const c_char) -> Option<String> {
+    if ptr.is_null() {
+        return None;
+    }
+    let text = unsafe { CStr::from_ptr(ptr) }.to_string_lossy().into_owned();
+    (!text.is_empty()).then_some(text)
+}
+
+pub(crate) fn file_spec_path(spec: SBFileSpecRef) -> Option<String> {
+    if spec.is_null() {
+        return None;
+    }
+    let mut buffer = vec![0u8; 4096];
+    let len = unsafe { SBFileSpecGetPath(spec, buffer.as_mut_ptr() as *mut c_char, buffer.len()) } as usize;
+    (len > 0).then(|| String::from_utf8_lossy(&buffer[..len.min(buffer.len())]).into_owned())
+}
+
+pub(crate) fn module_identity(module: SBModuleRef) -> Option<(String, Option<String>)> {
+    if module.is_null() {
+        return None;
+    }
+    let path = file_spec_path(unsafe { SBModuleGetFileSpec(module) })?;
+    Some((path, c_text(unsafe { SBModuleGetUUIDString(module) })))
+}
+
+/// Cache key of one module build. The UUID names a build exactly; without
+/// one, the file's size and modification time stand in, so a binary rebuilt
+/// at the same path does not hit entries made from the old one.
+pub(crate) fn build_key(path: &str, uuid: Option<&str>) -> String {
+    if let Some(uuid) = uuid {
+        return format!("{}#{}", path, uuid);
+    }
+    let stamp = std::fs::metadata(path).ok().map(|metadata| {
+        let modified = metadata.modified().ok()
+            .and_then(|modified| modified.duration_since(std::time::UNIX_EPOCH).ok())
+            .map_or(0, |modified| modified.as_nanos());
+        format!("{}:{}", metadata.len(), modified)
+    });
+    format!("{}#{}", path, stamp.unwrap_or_default())
+}
+
+/// Module-relative position of a resolved address
+fn module_offset(address: SBAddressRef) -> Option<ModuleOffset> {
+    if address.is_null() {
+        return None;
+    }
+    let (module, uuid) = module_identity(unsafe { SBAddressGetModule(address) })?;
+    Some(ModuleOffset { module, uuid, file_address: unsafe { SBAddressGetFileAddress(address) } })
+}
+
+/// Original location spec, recovered from the breakpoint description:
+/// "SBBreakpoint: id = 1, name = 'main', locations = 1" and the like
+pub fn parse_breakpoint_spec(description: &str) -> Option<String> {
+    let field = |name: &str| {
+        let start = description.find(&format!("{} = ", name))? + name.len() + 3;
+        let rest = &description[start..];
+        match rest.strip_prefix('\'') {
+            Some(quoted) => quoted.split('\'').next().map(String::from),
+            None => rest.split(',').next().map(|value| value.trim().to_string()),
+        }
+    };
+    if let (Some(file), Some(line)) = (field("file"), field("line")) {
+        return Some(format!("{}:{}", file, line));
+    }
+    if let Some(name) = field("name").or_else(|| field("names").map(|names| names.trim_matches(|c| c == '{' || c == '}').to_string())) {
+        return Some(name);
+    }
+    field("address").map(|address| match u64::from_str_radix(address.trim_start_matches("0x"), 16) {
+        Ok(value) => format!("0x{:x}", value),
+        Err(_) => address,
+    })
+}
+
+fn breakpoint_description(breakpoint: SBBreakpointRef) -> String {
+    unsafe {
+        let stream = CreateSBStream();
+        SBBreakpointGetDescription(breakpoint, stream);
+        let text = c_text(SBStreamGetData(stream)).unwrap_or_default();
+        DisposeSBStream(stream);
+        text
+    }
+}
+
+pub(crate) fn capture_breakpoints(target: SBTargetRef) -> Vec<BreakpointSnapshot> {
+    let count = unsafe { SBTargetGetNumBreakpoints(target) };
+    let mut breakpoints = Vec::with_capacity(count as usize);
+    for i in 0..count {
+        let breakpoint = unsafe { SBTargetGetBreakpointAtIndex(target, i) };
+        if breakpoint.is_null() {
+            continue;
+        }
+        let locations = (0..unsafe { SBBreakpointGetNumLocations(breakpoint) } as u32)
+            .filter_map(|index| {
+                let location = unsafe { SBBreakpointGetLocationAtIndex(breakpoint, index) };
+                if location.is_null() {
+                    return None;
+                }
+                let address = unsafe { SBBreakpointLocationGetAddress(location) };
+                let offset = module_offset(address);
+                unsafe {
+                    if !address.is_null() {
+                        DisposeSBAddress(address);
+                    }
+                    DisposeSBBreakpointLocation(location);
+                }
+                offset
+            })
+            .collect::<Vec<_>>();
+        let spec = parse_breakpoint_spec(&breakpoint_description(breakpoint))
+            .or_else(|| locations.first().map(|location| format!("0x{:x}", location.file_address)))
+            .unwrap_or_default();
+        breakpoints.push(BreakpointSnapshot {
+            id: unsafe { SBBreakpointGetID(breakpoint) } as u32,
+            spec,
+            enabled: unsafe { SBBreakpointIsEnabled(breakpoint) },
+            one_shot: unsafe { SBBreakpointIsOneShot(breakpoint) },
+            ignore_count: unsafe { SBBreakpointGetIgnoreCount(breakpoint) },
+            hit_count: unsafe { SBBreakpointGetHitCount(breakpoint) },
+            condition: c_text(unsafe { SBBreakpointGetCondition(breakpoint) }),
+            locations,
+        });
+        unsafe { DisposeSBBreakpoint(breakpoint) };
+    }
+    breakpoints
+}
+
+pub(crate) fn capture_watchpoints(target: SBTargetRef) -> Vec<WatchpointSnapshot> {
+    (0..unsafe { SBTargetGetNumWatchpoints(target) })
+        .filter_map(|i| {
+            let watchpoint = unsafe { SBTargetGetWatchpointAtIndex(target, i) };
+            if watchpoint.is_null() {
+                return None;
+            }
+            let address = unsafe { SBWatchpointGetWatchAddress(watchpoint) };
+            let resolved = unsafe { SBTargetResolveLoadAddress(target, address) };
+            // Only addresses inside a module section can be relocated into another process
+            let location = (!resolved.is_null() && !unsafe { SBAddressGetSection(resolved) }.is_null())
+                .then(|| module_offset(resolved))
+                .flatten();
+            if !resolved.is_null() {
+                unsafe { DisposeSBAddress(resolved) };
+            }
+            let snapshot = WatchpointSnapshot {
+                id: unsafe { SBWatchpointGetID(watchpoint) } as u32,
+                address,
+                size: unsafe { SBWatchpointGetWatchSize(watchpoint) } as u32,
+                read: unsafe { SBWatchpointIsWatchingReads(watchpoint) },
+                write: unsafe { SBWatchpointIsWatchingWrites(watchpoint) },
+                enabled: unsafe { SBWatchpointIsEnabled(watchpoint) },
+                condition: c_text(unsafe { SBWatchpointGetCondition(watchpoint) }),
+                location,
+            };
+            unsafe { DisposeSBWatchpoint(watchpoint) };
+            Some(snapshot)
+        })
+        .collect()
+}
+
+pub(crate) fn capture_modules(target: SBTargetRef) -> Vec<ModuleSnapshot> {
+    (0..unsafe { SBTargetGetNumModules(target) })
+        .filter_map(|i| module_identity(unsafe { SBTargetGetModuleAtIndex(target, i) }))
+        .map(|(path, uuid)| ModuleSnapshot { path, uuid })
+        .collect()
+}
+
+pub(crate) fn capture_console(console: &ConsoleBuffer) -> Vec<(ConsoleStream, String)> {
+    let end = console.end_cursor();
+    let read = console.read(end.saturating_sub(CONSOLE_SNAPSHOT_BYTES as u64), CONSOLE_SNAPSHOT_BYTES, None);
+    read.segments.into_iter().map(|segment| (segment.stream, segment.text)).collect()
+}
+
+/// Target modules by UUID and by path, looked up once per restore
+pub(crate) struct ModuleIndex {
+    by_uuid: HashMap<String, SBModuleRef>,
+    by_path: HashMap<String, SBModuleRef>,
+}
+
+impl ModuleIndex {
+    pub(crate) fn new(target: SBTargetRef) -> Self {
+        let mut index = Self { by_uuid: HashMap::new(), by_path: HashMap::new() };
+        for i in 0..unsafe { SBTargetGetNumModules(target) } {
+            let module = unsafe { SBTargetGetModuleAtIndex(target, i) };
+            if let Some((path, uuid)) = module_identity(module) {
+                if let Some(uuid) = uuid {
+                    index.by_uuid.insert(uuid, module);
+                }
+                index.by_path.insert(path, module);
+            }
+        }
+        index
+    }
+
+    /// The module an offset was recorded against, only if it is the same build
+    fn find(&self, location: &ModuleOffset) -> Option<SBModuleRef> {
+        match location.uuid.as_deref() {
+            Some(uuid) => self.by_uuid.get(uuid).copied(),
+            None => self.by_path.get(&location.module).copied(),
+        }
+    }
+
+    pub(crate) fn contains(&self, module: &ModuleSnapshot) -> bool {
+        match module.uuid.as_deref() {
+            Some(uuid) => self.by_uuid.contains_key(uuid),
+            None => self.by_path.contains_key(&module.path),
+        }
+    }
+
+    fn resolve(&self, location: &ModuleOffset) -> Option<SBAddressRef> {
+        let module = self.find(location)?;
+        let address = unsafe { SBModuleResolveFileAddress(module, location.file_address) };
+        (!address.is_null()).then_some(address)
+    }
+}
+
+/// How a breakpoint came back
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum BreakpointRestore {
+    /// Straight from the saved module offset
+    ByOffset(u32),
+    /// The module changed or was not loaded yet; re-resolved from the spec
+    BySpec(u32),
+    Failed,
+}
+
+pub(crate) fn restore_breakpoint(target: SBTargetRef, modules: &ModuleIndex, saved: &BreakpointSnapshot) -> BreakpointRestore {
+    // A single resolved location is re-created at its address; anything else
+    // (pending, or one spec resolving to many places) needs the spec to stay one breakpoint
+    let by_offset = match saved.locations.as_slice() {
+        [location] => modules.resolve(location).map(|address| {
+            let breakpoint = unsafe { SBTargetBreakpointCreateBySBAddress(target, address) };
+            unsafe { DisposeSBAddress(address) };
+            breakpoint
+        }),
+        _ => None,
+    };
+    let (breakpoint, restored_by_offset) = match by_offset.filter(|breakpoint| !breakpoint.is_null()) {
+        Some(breakpoint) => (breakpoint, true),
+        None => (create_from_spec(target, &saved.spec), false),
+    };
+    if breakpoint.is_null() {
+        return BreakpointRestore::Failed;
+    }
+
+    unsafe {
+        SBBreakpointSetEnabled(breakpoint, saved.enabled);
+        SBBreakpointSetOneShot(breakpoint, saved.one_shot);
+        SBBreakpointSetIgnoreCount(breakpoint, saved.ignore_count);
+        if let Some(condition) = saved.condition.as_deref().and_then(|condition| CString::new(condition).ok()) {
+            SBBreakpointSetCondition(breakpoint, condition.as_ptr());
+        }
+    }
+    let id = unsafe { SBBreakpointGetID(breakpoint) } as u32;
+    if restored_by_offset { BreakpointRestore::ByOffset(id) } else { BreakpointRestore::BySpec(id) }
+}
+
+fn create_from_spec(target: SBTargetRef, spec: &str) -> SBBreakpointRef {
+    if let Some(hex) = spec.strip_prefix("0x") {
+        return match u64::from_str_radix(hex, 16) {
+            Ok(address) => unsafe { SBTargetBreakpointCreateByAddress(target, address) },
+            Err(_) => std::ptr::null_mut(),
+        };
+    }
+    if let Some((file, line)) = spec.rsplit_once(':').filter(|(_, line)| line.parse::<u32>().is_ok()) {
+        let Ok(file) = CString::new(file) else {
+            return std::ptr::null_mut();
+        };
+        return unsafe { SBTargetBreakpointCreateByLocation(target, file.as_ptr(), line.parse().unwrap()) };
+    }
+    match CString::new(spec) {
+        Ok(name) if !spec.is_empty() => unsafe { SBTargetBreakpointCreateByName(target, name.as_ptr(), std::ptr::null()) },
+        _ => std::ptr::null_mut(),
+    }
+}
+
+/// Re-create a watchpoint; `same_process` allows absolute heap and stack addresses
+pub(crate) fn restore_watchpoint(target: SBTargetRef, modules: &ModuleIndex, saved: &WatchpointSnapshot, same_process: bool) -> Option<u32> {
+    let address = match saved.location.as_ref() {
+        Some(location) => {
+            let resolved = modules.resolve(location)?;
+            let address = unsafe { SBAddressGetLoadAddress(resolved, target) };
+            unsafe { DisposeSBAddress(resolved) };
+            address
+        }
+        None if same_process => saved.address,
+        None => return None,
+    };
+    if address == u64::MAX {
+        return None;
+    }
+
+    let error = unsafe { CreateSBError() };
+    let watchpoint = unsafe { SBTargetWatchAddress(target, address, saved.size as usize, saved.read, saved.write, error) };
+    let failed = watchpoint.is_null() || unsafe { SBErrorFail(error) };
+    unsafe { DisposeSBError(error) };
+    if failed {
+        return None;
+    }
+    unsafe {
+        SBWatchpointSetEnabled(watchpoint, saved.enabled);
+        if let Some(condition) = saved.condition.as_deref().and_then(|condition| CString::new(condition).ok()) {
+            SBWatchpointSetCondition(watchpoint, condition.as_ptr());
+        }
+    }
+    Some(unsafe { SBWatchpointGetID(watchpoint) } as u32)
+}
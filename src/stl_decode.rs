@@ -0,0 +1,943 @@
+// Native standard-library container decoders
+//
+// LLDB's synthetic children produce container elements one SBValue at a
+// time, which for a large vector means a child fetch per element. These
+// decoders know the libstdc++ and libc++ layouts (64-bit, little-endian)
+// and read container storage directly: a vector page is one bulk read,
+// strings are decoded from the container's own bytes when small-string
+// optimised, and node-based containers cost one read per node. Element
+// values are decoded in Rust for scalars, pointers and strings; anything
+// else is reported by address so it can be inspected with a path
+// expression such as `items[3]`.
+
+use std::cell::Cell;
+use std::ffi::CStr;
+
+use lldb_sys::*;
+use serde_json::{json, Value};
+
+/// Elements decoded per request at most
+pub const MAX_PAGE: usize = 10_000;
+/// Largest single bulk read
+const MAX_READ_BYTES: usize = 16 * 1024 * 1024;
+/// Longest string read for one element
+const MAX_STRING_BYTES: usize = 4096;
+/// Raw bytes shown for an element that cannot be decoded
+const RAW_PREVIEW_BYTES: usize = 64;
+/// C strings are read in aligned chunks of this size so no read crosses a page
+const C_STRING_CHUNK: u64 = 256;
+
+/// Process memory as the decoders see it
+pub trait MemoryReader {
+    fn read(&self, address: u64, size: usize) -> Option<Vec<u8>>;
+}
+
+/// Counts reads so callers can see what a decode cost
+pub struct CountingReader<'a> {
+    inner: &'a dyn MemoryReader,
+    pub reads: Cell<usize>,
+    pub bytes: Cell<usize>,
+}
+
+impl<'a> CountingReader<'a> {
+    pub fn new(inner: &'a dyn MemoryReader) -> Self {
+        Self { inner, reads: Cell::new(0), bytes: Cell::new(0) }
+    }
+}
+
+impl MemoryReader for CountingReader<'_> {
+    fn read(&self, address: u64, size: usize) -> Option<Vec<u8>> {
+        self.reads.set(self.reads.get() + 1);
+        let bytes = self.inner.read(address, size)?;
+        self.bytes.set(self.bytes.get() + bytes.len());
+        (bytes.len() == size).then_some(bytes)
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum StdLib {
+    LibStdCxx,
+    LibCxx,
+}
+
+impl StdLib {
+    pub fn name(self) -> &'static str {
+        match self {
+            StdLib::LibStdCxx => "libstdc++",
+            StdLib::LibCxx => "libc++",
+        }
+    }
+
+    /// libc++ puts everything in an inline namespace: std::__1::vector
+    pub fn of(type_name: &str) -> Self {
+        if type_name.contains("std::__1::") || type_name.contains("std::__2::") {
+            StdLib::LibCxx
+        } else {
+            StdLib::LibStdCxx
+        }
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ContainerKind {
+    String,
+    Vector,
+    /// map and multimap
+    Map,
+    /// set and multiset
+    Set,
+    UnorderedMap,
+    UnorderedSet,
+    Deque,
+    SharedPtr,
+}
+
+impl ContainerKind {
+    pub fn name(self) -> &'static str {
+        match self {
+            ContainerKind::String => "string",
+            ContainerKind::Vector => "vector",
+            ContainerKind::Map => "map",
+            ContainerKind::Set => "set",
+            ContainerKind::UnorderedMap => "unordered_map",
+            ContainerKind::UnorderedSet => "unordered_set",
+            ContainerKind::Deque => "deque",
+            ContainerKind::SharedPtr => "shared_ptr",
+        }
+    }
+
+    /// Kind of a canonical type name, None for types without a decoder and
+    /// for pointers and references to containers
+    pub fn of(type_name: &str) -> Option<Self> {
+        let base = type_name.trim_start_matches("const ");
+        let base = base.strip_prefix("std::")?;
+        let base = ["__1::", "__2::", "__cxx11::"].iter()
+            .find_map(|ns| base.strip_prefix(ns))
+            .unwrap_or(base);
+        let template = &base[..base.find('<')?];
+        // Pointers and references to containers, and types nested in them
+        if !base[base.rfind('>')? + 1..].trim().is_empty() {
+            return None;
+        }
+        Some(match template {
+            "basic_string" if base.starts_with("basic_string<char,") || base.starts_with("basic_string<char>") => ContainerKind::String,
+            // Packed bits, not elements
+            "vector" if base.starts_with("vector<bool,") || base.starts_with("vector<bool>") => return None,
+            "vector" => ContainerKind::Vector,
+            "map" | "multimap" => ContainerKind::Map,
+            "set" | "multiset" => ContainerKind::Set,
+            "unordered_map" | "unordered_multimap" => ContainerKind::UnorderedMap,
+            "unordered_set" | "unordered_multiset" => ContainerKind::UnorderedSet,
+            "deque" => ContainerKind::Deque,
+            "shared_ptr" => ContainerKind::SharedPtr,
+            _ => return None,
+        })
+    }
+}
+
+/// A canonical type name and its size
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct TypeInfo {
+    pub name: String,
+    pub size: usize,
+}
+
+impl TypeInfo {
+    pub fn new(name: impl Into<String>, size: usize) -> Self {
+        Self { name: name.into(), size }
+    }
+}
+
+/// Where a tree or hash node keeps its element, read from the debug info of
+/// the node type and, for maps, of std::pair<const K, V>
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct NodeLayout {
+    /// Offset of the element within a node
+    pub value: usize,
+    /// Size of the element (the whole pair for maps)
+    pub entry_size: usize,
+    /// Offset of the mapped value within the pair; 0 for sets
+    pub second: usize,
+}
+
+/// A container variable: canonical type, template arguments and location
+#[derive(Debug, Clone)]
+pub struct ContainerType {
+    pub kind: ContainerKind,
+    pub library: StdLib,
+    pub type_info: TypeInfo,
+    pub arguments: Vec<TypeInfo>,
+    /// Node layout of maps, sets and hash tables; None when the debug info
+    /// does not describe it
+    pub layout: Option<NodeLayout>,
+}
+
+impl ContainerType {
+    pub fn new(type_info: TypeInfo, arguments: Vec<TypeInfo>) -> Option<Self> {
+        let kind = ContainerKind::of(&type_info.name)?;
+        Some(Self { kind, library: StdLib::of(&type_info.name), type_info, arguments, layout: None })
+    }
+
+    pub fn with_layout(mut self, layout: NodeLayout) -> Self {
+        self.layout = Some(layout);
+        self
+    }
+
+    fn argument(&self, index: usize) -> Result<&TypeInfo, String> {
+        self.arguments.get(index)
+            .filter(|argument| argument.size > 0)
+            .ok_or_else(|| format!("template argument {} of {} is unknown", index, self.type_info.name))
+    }
+
+    fn layout(&self) -> Result<NodeLayout, String> {
+        self.layout.ok_or_else(|| format!("node layout of {} is not in the debug info", self.type_info.name))
+    }
+}
+
+/// One page of a decoded container
+#[derive(Debug, Clone)]
+pub struct ContainerView {
+    pub kind: ContainerKind,
+    pub library: StdLib,
+    pub type_name: String,
+    pub address: u64,
+    /// Element count of the whole container
+    pub size: u64,
+    pub offset: u64,
+    pub elements: Vec<Value>,
+    /// Extra facts: capacity, use counts, bucket count
+    pub details: Value,
+    pub reads: usize,
+    pub bytes_read: usize,
+}
+
+impl ContainerView {
+    pub fn to_json(&self) -> Value {
+        let shown = self.elements.len() as u64;
+        json!({
+            "kind": self.kind.name(),
+            "library": self.library.name(),
+            "type": self.type_name,
+            "address": format!("0x{:x}", self.address),
+            "size": self.size,
+            "offset": self.offset,
+            "count": shown,
+            // A string is one element however long it is
+            "has_more": self.kind != ContainerKind::String && self.offset + shown < self.size,
+            "elements": self.elements,
+            "details": self.details,
+            "memory_reads": self.reads,
+            "bytes_read": self.bytes_read
+        })
+    }
+}
+
+fn word(bytes: &[u8], offset: usize) -> u64 {
+    bytes.get(offset..offset + 8)
+        .map_or(0, |b| u64::from_le_bytes(b.try_into().unwrap()))
+}
+
+fn read_word(memory: &dyn MemoryReader, address: u64) -> Result<u64, String> {
+    memory.read(address, 8)
+        .map(|bytes| word(&bytes, 0))
+        .ok_or_else(|| format!("cannot read 0x{:x}", address))
+}
+
+/// NUL-terminated text at `address`, at most MAX_STRING_BYTES of it; None
+/// when nothing there is readable
+fn read_c_string(memory: &dyn MemoryReader, address: u64) -> Option<String> {
+    let mut text = Vec::new();
+    let mut at = address;
+    while text.len() < MAX_STRING_BYTES {
+        let Some(bytes) = memory.read(at, (C_STRING_CHUNK - at % C_STRING_CHUNK) as usize).filter(|bytes| !bytes.is_empty()) else {
+            if text.is_empty() {
+                return None;
+            }
+            break;
+        };
+        if let Some(end) = bytes.iter().position(|byte| *byte == 0) {
+            text.extend_from_slice(&bytes[..end]);
+            break;
+        }
+        text.extend_from_slice(&bytes);
+        at += bytes.len() as u64;
+    }
+    text.truncate(MAX_STRING_BYTES);
+    Some(String::from_utf8_lossy(&text).into_owned())
+}
+
+fn is_c_string(name: &str) -> bool {
+    matches!(name.trim_end_matches("const").trim_end(), "char *" | "const char *")
+}
+
+fn is_string(type_info: &TypeInfo) -> bool {
+    ContainerKind::of(&type_info.name) == Some(ContainerKind::String)
+}
+
+/// Text of a std::string whose object bytes are `bytes`, located at `address`
+pub fn decode_string(memory: &dyn MemoryReader, library: StdLib, bytes: &[u8], address: u64) -> Result<String, String> {
+    let (data, length, inline) = match library {
+        // {char* p; size_t length; union { char local[16]; size_t capacity; }}
+        StdLib::LibStdCxx => {
+            let (data, length) = (word(bytes, 0), word(bytes, 8));
+            (data, length, (data == address + 16).then_some(16usize))
+        }
+        // Short: byte 0 is size << 1, text from byte 1. Long: {cap | 1, size, data}.
+        StdLib::LibCxx => match bytes.first() {
+            Some(flag) if flag & 1 == 0 => (address + 1, (flag >> 1) as u64, Some(1)),
+            Some(_) => (word(bytes, 16), word(bytes, 8), None),
+            None => return Err("empty string object".to_string()),
+        },
+    };
+    if length > 1 << 32 {
+        return Err(format!("implausible string length {}", length));
+    }
+    let shown = (length as usize).min(MAX_STRING_BYTES);
+    let text = match inline {
+        Some(start) => bytes.get(start..start + shown)
+            .ok_or_else(|| format!("implausible inline string length {}", length))?
+            .to_vec(),
+        None if shown == 0 => Vec::new(),
+        None => memory.read(data, shown).ok_or_else(|| format!("cannot read string data at 0x{:x}", data))?,
+    };
+    let mut text = String::from_utf8_lossy(&text).into_owned();
+    if shown < length as usize {
+        text.push_str("...");
+    }
+    Ok(text)
+}
+
+/// Value of one element from its bytes
+pub fn decode_element(memory: &dyn MemoryReader, type_info: &TypeInfo, bytes: &[u8], address: u64) -> Value {
+    let name = type_info.name.trim_start_matches("const ").trim();
+    if is_string(type_info) {
+        return match decode_string(memory, StdLib::of(name), bytes, address) {
+            Ok(text) => json!(text),
+            Err(error) => json!({ "address": format!("0x{:x}", address), "error": error }),
+        };
+    }
+    let signed = |size: usize| -> Option<i64> {
+        Some(match size {
+            1 => bytes.first().map(|b| *b as i8 as i64)?,
+            2 => i16::from_le_bytes(bytes.get(..2)?.try_into().ok()?) as i64,
+            4 => i32::from_le_bytes(bytes.get(..4)?.try_into().ok()?) as i64,
+            8 => i64::from_le_bytes(bytes.get(..8)?.try_into().ok()?),
+            _ => return None,
+        })
+    };
+    let unsigned = |size: usize| -> Option<u64> {
+        let mut buffer = [0u8; 8];
+        buffer[..size.min(8)].copy_from_slice(bytes.get(..size.min(8))?);
+        Some(u64::from_le_bytes(buffer))
+    };
+    let decoded = if is_c_string(name) {
+        // The pointed-to text, or the pointer when it is null or unreadable
+        unsigned(8).map(|pointer| {
+            (pointer != 0).then(|| read_c_string(memory, pointer)).flatten()
+                .map_or_else(|| json!(format!("0x{:x}", pointer)), |text| json!(text))
+        })
+    } else if name.ends_with('*') {
+        unsigned(8).map(|pointer| json!(format!("0x{:x}", pointer)))
+    } else {
+        match name {
+            "bool" => bytes.first().map(|b| json!(*b != 0)),
+            "float" => bytes.get(..4).map(|b| json!(f32::from_le_bytes(b.try_into().unwrap()))),
+            "double" => bytes.get(..8).map(|b| json!(f64::from_le_bytes(b.try_into().unwrap()))),
+            "char" | "signed char" | "short" | "int" | "long" | "long long" | "wchar_t"
+                | "int8_t" | "int16_t" | "int32_t" | "int64_t" => signed(type_info.size).map(|v| json!(v)),
+            "unsigned char" | "unsigned short" | "unsigned int" | "unsigned long" | "unsigned long long"
+                | "char8_t" | "char16_t" | "char32_t" | "uint8_t" | "uint16_t" | "uint32_t" | "uint64_t" | "size_t" => unsigned(type_info.size).map(|v| json!(v)),
+            _ => None,
+        }
+    };
+    decoded.unwrap_or_else(|| {
+        let preview: String = bytes.iter().take(RAW_PREVIEW_BYTES).map(|byte| format!("{:02x}", byte)).collect();
+        json!({ "address": format!("0x{:x}", address), "type": type_info.name, "bytes": preview })
+    })
+}
+
+/// Decode a map node's or set node's value at `address`
+fn decode_entry(memory: &dyn MemoryReader, container: &ContainerType, layout: NodeLayout, bytes: &[u8], address: u64) -> Result<Value, String> {
+    match container.kind {
+        ContainerKind::Map | ContainerKind::UnorderedMap => {
+            let (key, mapped) = (container.argument(0)?, container.argument(1)?);
+            Ok(json!({
+                "key": decode_element(memory, key, bytes, address),
+                "value": decode_element(memory, mapped, bytes.get(layout.second..).unwrap_or_default(), address + layout.second as u64)
+            }))
+        }
+        _ => Ok(decode_element(memory, container.argument(0)?, bytes, address)),
+    }
+}
+
+/// Decode `limit` elements of the container at `address` starting at `offset`
+pub fn decode(memory: &dyn MemoryReader, container: &ContainerType, address: u64, offset: u64, limit: usize) -> Result<ContainerView, String> {
+    let counting = CountingReader::new(memory);
+    let memory: &dyn MemoryReader = &counting;
+    let limit = limit.min(MAX_PAGE);
+    let object = memory.read(address, container.type_info.size.max(8))
+        .ok_or_else(|| format!("cannot read {} at 0x{:x}", container.type_info.name, address))?;
+
+    let (size, elements, details) = match container.kind {
+        ContainerKind::String => {
+            let text = decode_string(memory, container.library, &object, address)?;
+            let length = match container.library {
+                StdLib::LibStdCxx => word(&object, 8),
+                StdLib::LibCxx if object[0] & 1 == 0 => (object[0] >> 1) as u64,
+                StdLib::LibCxx => word(&object, 8),
+            };
+            (length, vec![json!(text)], json!({}))
+        }
+        ContainerKind::Vector => decode_vector(memory, container, &object, offset, limit)?,
+        ContainerKind::Map | ContainerKind::Set => decode_tree(memory, container, &object, address, offset, limit)?,
+        ContainerKind::UnorderedMap | ContainerKind::UnorderedSet => decode_hashtable(memory, container, &object, offset, limit)?,
+        ContainerKind::Deque => decode_deque(memory, container, &object, offset, limit)?,
+        ContainerKind::SharedPtr => decode_shared_ptr(memory, container, &object)?,
+    };
+
+    Ok(ContainerView {
+        kind: container.kind,
+        library: container.library,
+        type_name: container.type_info.name.clone(),
+        address,
+        size,
+        offset: if container.kind == ContainerKind::String { 0 } else { offset },
+        elements,
+        details,
+        reads: counting.reads.get(),
+        bytes_read: counting.bytes.get(),
+    })
+}
+
+type Decoded = (u64, Vec<Value>, Value);
+
+/// Elements [first, first + count) of contiguous storage at `data`, in one read
+fn decode_contiguous(memory: &dyn MemoryReader, element: &TypeInfo, data: u64, first: u64, count: usize) -> Result<Vec<Value>, String> {
+    if count == 0 {
+        return Ok(Vec::new());
+    }
+    let start = data + first * element.size as u64;
+    let length = count * element.size;
+    if length > MAX_READ_BYTES {
+        return Err(format!("page of {} bytes is too large; lower the limit", length));
+    }
+    let bytes = memory.read(start, length).ok_or_else(|| format!("cannot read elements at 0x{:x}", start))?;
+    Ok(bytes.chunks_exact(element.size)
+        .enumerate()
+        .map(|(i, chunk)| decode_element(memory, element, chunk, start + (i * element.size) as u64))
+        .collect())
+}
+
+/// {begin, end, end_of_storage} in both libraries
+fn decode_vector(memory: &dyn MemoryReader, container: &ContainerType, object: &[u8], offset: u64, limit: usize) -> Result<Decoded, String> {
+    let element = container.argument(0)?;
+    let (begin, end, capacity_end) = (word(object, 0), word(object, 8), word(object, 16));
+    if end < begin || capacity_end < end || (end - begin) % element.size as u64 != 0 {
+        return Err("vector looks uninitialized".to_string());
+    }
+    let size = (end - begin) / element.size as u64;
+    let first = offset.min(size);
+    let count = ((size - first) as usize).min(limit);
+    let elements = decode_contiguous(memory, element, begin, first, count)?;
+    let details = json!({
+        "data": format!("0x{:x}", begin),
+        "capacity": (capacity_end - begin) / element.size as u64
+    });
+    Ok((size, elements, details))
+}
+
+/// Red-black tree walk in order. libstdc++ nodes are {color, parent, left,
+/// right, value} under a header embedded in the container; libc++ nodes are
+/// {left, right, parent, is_black, value} under an end node whose left is the root.
+fn decode_tree(memory: &dyn MemoryReader, container: &ContainerType, object: &[u8], address: u64, offset: u64, limit: usize) -> Result<Decoded, String> {
+    let layout = container.layout()?;
+    let value = layout.value;
+    // Offsets of parent, left and right within a node
+    let (parent, left, right, size, first, end) = match container.library {
+        StdLib::LibStdCxx => (8, 16, 24, word(object, 40), word(object, 24), address + 8),
+        StdLib::LibCxx => (16, 0, 8, word(object, 16), word(object, 0), address + 8),
+    };
+    if size > 1 << 40 {
+        return Err("tree looks uninitialized".to_string());
+    }
+    let node_bytes = value + layout.entry_size;
+
+    let mut elements = Vec::new();
+    let mut node = first;
+    let mut index = 0u64;
+    while node != end && node != 0 && elements.len() < limit && index < size {
+        let bytes = memory.read(node, node_bytes).ok_or_else(|| format!("cannot read tree node at 0x{:x}", node))?;
+        if index >= offset {
+            elements.push(decode_entry(memory, container, layout, &bytes[value..], node + value as u64)?);
+        }
+        index += 1;
+        // In-order successor: leftmost of the right subtree, else the first
+        // ancestor reached from a left child. Neither path is longer than the
+        // tree has nodes, so a longer one means the links are corrupt.
+        let right_child = word(&bytes, right);
+        let mut depth = 0u64;
+        node = if right_child != 0 {
+            let mut next = right_child;
+            loop {
+                let left_child = read_word(memory, next + left as u64)?;
+                if left_child == 0 {
+                    break next;
+                }
+                next = left_child;
+                depth += 1;
+                if depth > size {
+                    return Err(format!("tree links loop below 0x{:x}", right_child));
+                }
+            }
+        } else {
+            let mut child = node;
+            let mut up = word(&bytes, parent);
+            loop {
+                if up == end || up == 0 || read_word(memory, up + right as u64)? != child {
+                    break up;
+                }
+                child = up;
+                up = read_word(memory, up + parent as u64)?;
+                depth += 1;
+                if depth > size {
+                    return Err(format!("tree links loop above 0x{:x}", node));
+                }
+            }
+        };
+    }
+    Ok((size, elements, json!({})))
+}
+
+/// Singly linked node list. libstdc++: {buckets, bucket_count, before_begin.next,
+/// element_count}, nodes {next, value}. libc++: {buckets, bucket_count,
+/// first_node.next, size}, nodes {next, hash, value}.
+fn decode_hashtable(memory: &dyn MemoryReader, container: &ContainerType, object: &[u8], offset: u64, limit: usize) -> Result<Decoded, String> {
+    let layout = container.layout()?;
+    let value = layout.value;
+    let (first, size) = (word(object, 16), word(object, 24));
+    if size > 1 << 40 {
+        return Err("hash table looks uninitialized".to_string());
+    }
+
+    let mut elements = Vec::new();
+    let mut node = first;
+    let mut index = 0u64;
+    while node != 0 && elements.len() < limit && index < size {
+        if index < offset {
+            node = read_word(memory, node)?;
+        } else {
+            let bytes = memory.read(node, value + layout.entry_size).ok_or_else(|| format!("cannot read hash node at 0x{:x}", node))?;
+            elements.push(decode_entry(memory, container, layout, &bytes[value..], node + value as u64)?);
+            node = word(&bytes, 0);
+        }
+        index += 1;
+    }
+    Ok((size, elements, json!({ "bucket_count": word(object, 8) })))
+}
+
+/// Fixed-size blocks reached through a map of block pointers
+fn decode_deque(memory: &dyn MemoryReader, container: &ContainerType, object: &[u8], offset: u64, limit: usize) -> Result<Decoded, String> {
+    let element = container.argument(0)?;
+    let element_size = element.size as u64;
+    // Block pointer array, index of the first element within it, element count, elements per block
+    let (blocks, start, size, per_block) = match container.library {
+        // {map, map_size, start{cur, first, last, node}, finish{cur, first, last, node}}
+        StdLib::LibStdCxx => {
+            let per_block = if element_size < 512 { 512 / element_size } else { 1 };
+            let (start_cur, start_first, start_node) = (word(object, 16), word(object, 24), word(object, 40));
+            let (finish_cur, finish_first, finish_node) = (word(object, 48), word(object, 56), word(object, 72));
+            if finish_node < start_node || start_cur < start_first || finish_cur < finish_first {
+                return Err("deque looks uninitialized".to_string());
+            }
+            let start = (start_cur - start_first) / element_size;
+            let size = ((finish_node - start_node) / 8) * per_block + (finish_cur - finish_first) / element_size - start;
+            (start_node, start, size, per_block)
+        }
+        // {map{first, begin, end, end_cap}, start, size}
+        StdLib::LibCxx => {
+            let per_block = if element_size < 256 { 4096 / element_size } else { 16 };
+            (word(object, 8), word(object, 32), word(object, 40), per_block)
+        }
+    };
+    if size > 1 << 40 {
+        return Err("deque looks uninitialized".to_string());
+    }
+
+    let first = offset.min(size);
+    let count = ((size - first) as usize).min(limit);
+    let mut elements = Vec::with_capacity(count);
+    if count > 0 {
+        // One read for the block pointers covering the page, then one per block
+        let first_block = (start + first) / per_block;
+        let last_block = (start + first + count as u64 - 1) / per_block;
+        let pointers = memory.read(blocks + first_block * 8, ((last_block - first_block + 1) * 8) as usize)
+            .ok_or_else(|| "cannot read deque block map".to_string())?;
+        let mut index = start + first;
+        while elements.len() < count {
+            let block = word(&pointers, ((index / per_block - first_block) * 8) as usize);
+            let within = index % per_block;
+            let take = ((per_block - within) as usize).min(count - elements.len());
+            elements.extend(decode_contiguous(memory, element, block, within, take)?);
+            index += take as u64;
+        }
+    }
+    Ok((size, elements, json!({ "block_size": per_block })))
+}
+
+/// {pointer, control block}. libstdc++ control blocks are {vptr, use, weak}
+/// with the owners holding one weak reference; libc++ ones are
+/// {vptr, owners - 1, weak owners}.
+fn decode_shared_ptr(memory: &dyn MemoryReader, container: &ContainerType, object: &[u8]) -> Result<Decoded, String> {
+    let (pointer, control) = (word(object, 0), word(object, 8));
+    let (use_count, weak_count) = if control == 0 {
+        (0, 0)
+    } else {
+        let length = if container.library == StdLib::LibStdCxx { 8 } else { 16 };
+        let counts = memory.read(control + 8, length).ok_or_else(|| format!("cannot read control block at 0x{:x}", control))?;
+        match container.library {
+            StdLib::LibStdCxx => {
+                let use_count = i32::from_le_bytes(counts[0..4].try_into().unwrap()) as i64;
+                let weak = i32::from_le_bytes(counts[4..8].try_into().unwrap()) as i64;
+                // The owners together hold one weak reference
+                (use_count, weak - (use_count > 0) as i64)
+            }
+            StdLib::LibCxx => (word(&counts, 0) as i64 + 1, word(&counts, 8) as i64),
+        }
+    };
+
+    let mut elements = Vec::new();
+    if let (Some(element), true) = (container.arguments.first().filter(|element| element.size > 0), pointer != 0 && use_count > 0) {
+        if let Some(bytes) = memory.read(pointer, element.size.min(RAW_PREVIEW_BYTES.max(32))) {
+            elements.push(decode_element(memory, element, &bytes, pointer));
+        }
+    }
+    let details = json!({
+        "pointer": format!("0x{:x}", pointer),
+        "use_count": use_count,
+        "weak_count": weak_count
+    });
+    Ok(((pointer != 0) as u64, elements, details))
+}
+
+/// Reads through the debugged process
+pub(crate) struct ProcessMemory(pub SBProcessRef);
+
+impl MemoryReader for ProcessMemory {
+    fn read(&self, address: u64, size: usize) -> Option<Vec<u8>> {
+        let mut buffer = vec![0u8; size];
+        let error = unsafe { CreateSBError() };
+        let read = unsafe { SBProcessReadMemory(self.0, address, buffer.as_mut_ptr() as *mut std::ffi::c_void, size, error) };
+        unsafe { DisposeSBError(error) };
+        buffer.truncate(read);
+        (read > 0).then_some(buffer)
+    }
+}
+
+pub(crate) fn type_info(sb_type: SBTypeRef) -> Option<TypeInfo> {
+    if sb_type.is_null() {
+        return None;
+    }
+    let canonical = unsafe { SBTypeGetCanonicalType(sb_type) };
+    if unsafe { SBTypeGetName(canonical) }.is_null() {
+        return None;
+    }
+    Some(TypeInfo { name: type_name(canonical), size: unsafe { SBTypeGetByteSize(canonical) } as usize })
+}
+
+fn type_name(sb_type: SBTypeRef) -> String {
+    let name_ptr = unsafe { SBTypeGetName(sb_type) };
+    if name_ptr.is_null() {
+        return String::new();
+    }
+    unsafe { CStr::from_ptr(name_ptr) }.to_string_lossy().into_owned()
+}
+
+fn member_name(member: SBTypeMemberRef) -> String {
+    let name_ptr = unsafe { SBTypeMemberGetName(member) };
+    if name_ptr.is_null() {
+        return String::new();
+    }
+    unsafe { CStr::from_ptr(name_ptr) }.to_string_lossy().into_owned()
+}
+
+fn fields(sb_type: SBTypeRef) -> Vec<SBTypeMemberRef> {
+    (0..unsafe { SBTypeGetNumberOfFields(sb_type) })
+        .map(|i| unsafe { SBTypeGetFieldAtIndex(sb_type, i) })
+        .filter(|member| !member.is_null())
+        .collect()
+}
+
+fn base_classes(sb_type: SBTypeRef) -> Vec<SBTypeMemberRef> {
+    (0..unsafe { SBTypeGetNumberOfDirectBaseClasses(sb_type) })
+        .map(|i| unsafe { SBTypeGetDirectBaseClassAtIndex(sb_type, i) })
+        .filter(|member| !member.is_null())
+        .collect()
+}
+
+/// Byte offset of the field named one of `names`, looking through base
+/// classes and anonymous members (libc++ keeps node values in an anonymous union)
+fn field_offset(sb_type: SBTypeRef, names: &[&str], depth: usize) -> Option<usize> {
+    let fields = fields(sb_type);
+    if let Some(field) = fields.iter().find(|field| names.contains(&member_name(**field).as_str())) {
+        return Some(unsafe { SBTypeMemberGetOffsetInBytes(*field) } as usize);
+    }
+    if depth == 0 {
+        return None;
+    }
+    fields.into_iter()
+        .filter(|field| member_name(*field).is_empty())
+        .chain(base_classes(sb_type))
+        .find_map(|member| {
+            let inner = unsafe { SBTypeGetCanonicalType(SBTypeMemberGetType(member)) };
+            Some(unsafe { SBTypeMemberGetOffsetInBytes(member) } as usize + field_offset(inner, names, depth - 1)?)
+        })
+}
+
+/// Whether `name` is a tree or hash node type rather than a node base or an
+/// allocator of nodes
+fn is_node_type(name: &str) -> bool {
+    let base = name.split('<').next().unwrap_or_default();
+    matches!(base.rsplit("::").next(), Some("_Rb_tree_node" | "__tree_node" | "_Hash_node" | "__hash_node")) && base.len() < name.len()
+}
+
+/// The node type a container allocates: its node allocator's value_type,
+/// found through the container's members and the template arguments of its
+/// allocators and compressed pairs
+fn node_type(sb_type: SBTypeRef, depth: usize) -> Option<SBTypeRef> {
+    let canonical = unsafe { SBTypeGetCanonicalType(sb_type) };
+    let name = type_name(canonical);
+    if is_node_type(&name) {
+        return Some(canonical);
+    }
+    if depth == 0 || unsafe { SBTypeIsPointerType(canonical) } {
+        return None;
+    }
+    let base = name.split('<').next().unwrap_or_default();
+    let arguments = if base.contains("alloc") || base.contains("compressed_pair") {
+        (0..unsafe { SBTypeGetNumberOfTemplateArguments(canonical) })
+            .map(|i| unsafe { SBTypeGetTemplateArgumentType(canonical, i) })
+            .collect()
+    } else {
+        Vec::new()
+    };
+    fields(canonical).into_iter()
+        .chain(base_classes(canonical))
+        .map(|member| unsafe { SBTypeMemberGetType(member) })
+        .chain(arguments)
+        .filter(|inner| !inner.is_null())
+        .find_map(|inner| node_type(inner, depth - 1))
+}
+
+/// Node layout from the debug info: the element type is the value_type of the
+/// container's allocator (its last template argument), `second` is read from
+/// the pair type and the element's offset from the node type. None when any
+/// of them is missing, so the decoders refuse rather than guess.
+fn node_layout(kind: ContainerKind, canonical: SBTypeRef) -> Option<NodeLayout> {
+    let count = unsafe { SBTypeGetNumberOfTemplateArguments(canonical) };
+    let allocator = unsafe { SBTypeGetTemplateArgumentType(canonical, count.checked_sub(1)?) };
+    let allocator = unsafe { SBTypeGetCanonicalType(allocator) };
+    if allocator.is_null() || unsafe { SBTypeGetNumberOfTemplateArguments(allocator) } == 0 {
+        return None;
+    }
+    let element = unsafe { SBTypeGetCanonicalType(SBTypeGetTemplateArgumentType(allocator, 0)) };
+    let entry_size = unsafe { SBTypeGetByteSize(element) } as usize;
+    if entry_size == 0 {
+        return None;
+    }
+    let second = match kind {
+        ContainerKind::Map | ContainerKind::UnorderedMap => field_offset(element, &["second"], 2)?,
+        _ => 0,
+    };
+    let node = node_type(canonical, 6)?;
+    let value = field_offset(node, &["_M_storage", "_M_value_field", "__value_"], 3)?;
+    Some(NodeLayout { value, entry_size, second })
+}
+
+/// Container type and load address of `value`, or None when it is not a
+/// container these decoders know or does not live in memory
+pub(crate) fn container_of(value: SBValueRef) -> Option<(ContainerType, u64)> {
+    // A reference's own type and address are those of the referring variable
+    let value = if unsafe { SBTypeIsReferenceType(SBValueGetType(value)) } {
+        unsafe { SBValueDereference(value) }
+    } else {
+        value
+    };
+    if value.is_null() {
+        return None;
+    }
+    let sb_type = unsafe { SBValueGetType(value) };
+    let info = type_info(sb_type)?;
+    let canonical = unsafe { SBTypeGetCanonicalType(sb_type) };
+    let arguments = (0..unsafe { SBTypeGetNumberOfTemplateArguments(canonical) })
+        .map(|i| type_info(unsafe { SBTypeGetTemplateArgumentType(canonical, i) }).unwrap_or(TypeInfo::new("", 0)))
+        .collect();
+    let address = unsafe { SBValueGetLoadAddress(value) };
+    if address == u64::MAX {
+        return None;
+    }
+    let container = ContainerType::new(info, arguments)?;
+    let node_based = matches!(container.kind, ContainerKind::Map | ContainerKind::Set | ContainerKind::UnorderedMap | ContainerKind::UnorderedSet);
+    match node_based.then(|| node_layout(container.kind, canonical)).flatten() {
+        Some(layout) => Some((container.with_layout(layout), address)),
+        None => Some((container, address)),
+    }
+}
+
+/// Byte regions standing in for process memory in unit tests. A read may
+/// span adjacent regions and fails if any byte of it is missing.
+#[cfg(test)]
+#[derive(Default)]
+pub(crate) struct FakeMemory {
+    regions: std::collections::BTreeMap<u64, Vec<u8>>,
+    pub reads: Cell<usize>,
+}
+
+#[cfg(test)]
+impl FakeMemory {
+    pub fn put(&mut self, address: u64, bytes: Vec<u8>) {
+        self.regions.insert(address, bytes);
+    }
+
+    pub fn words(&mut self, address: u64, words: &[u64]) {
+        self.put(address, words.iter().flat_map(|word| word.to_le_bytes()).collect());
+    }
+}
+
+#[cfg(test)]
+impl MemoryReader for FakeMemory {
+    fn read(&self, address: u64, size: usize) -> Option<Vec<u8>> {
+        self.reads.set(self.reads.get() + 1);
+        let mut bytes = Vec::with_capacity(size);
+        while bytes.len() < size {
+            let at = address + bytes.len() as u64;
+            let (start, region) = self.regions.range(..=at).next_back()?;
+            let rest = region.get((at - start) as usize..).filter(|rest| !rest.is_empty())?;
+            bytes.extend_from_slice(&rest[..rest.len().min(size - bytes.len())]);
+        }
+        Some(bytes)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_native_container_decoders() {
+        let int = TypeInfo::new("int", 4);
+        let gnu_string = TypeInfo::new("std::__cxx11::basic_string<char, std::char_traits<char>, std::allocator<char> >", 32);
+        let mut memory = FakeMemory::default();
+
+        // A million-element vector: the page costs one bulk read after the object itself
+        let elements: Vec<u8> = (0..1_000_000i32).flat_map(|i| i.to_le_bytes()).collect();
+        memory.put(0x100000, elements);
+        memory.words(0x1000, &[0x100000, 0x100000 + 4_000_000, 0x100000 + 4_000_000]);
+        let vector = ContainerType::new(TypeInfo::new("std::vector<int, std::allocator<int> >", 24), vec![int.clone()]).unwrap();
+        let view = decode(&memory, &vector, 0x1000, 999_990, 20).unwrap();
+        assert_eq!(view.size, 1_000_000);
+        assert_eq!(view.elements.first(), Some(&json!(999_990)));
+        assert_eq!(view.elements.len(), 10);
+        assert_eq!(view.reads, 2);
+
+        // libstdc++ strings: inline and heap; libc++ short string
+        let mut inline = vec![0u8; 32];
+        inline[..8].copy_from_slice(&0x2010u64.to_le_bytes());
+        inline[8..16].copy_from_slice(&2u64.to_le_bytes());
+        inline[16..18].copy_from_slice(b"hi");
+        memory.put(0x2000, inline);
+        memory.words(0x2100, &[0x2200, 11, 11, 0]);
+        memory.put(0x2200, b"hello world".to_vec());
+        let string = ContainerType::new(gnu_string.clone(), vec![TypeInfo::new("char", 1)]).unwrap();
+        assert_eq!(decode(&memory, &string, 0x2000, 0, 1).unwrap().elements, vec![json!("hi")]);
+        assert_eq!(decode(&memory, &string, 0x2100, 0, 1).unwrap().elements, vec![json!("hello world")]);
+        let mut short = vec![0u8; 24];
+        short[0] = 5 << 1;
+        short[1..6].copy_from_slice(b"short");
+        memory.put(0x2300, short);
+        let libcxx_string = ContainerType::new(
+            TypeInfo::new("std::__1::basic_string<char, std::__1::char_traits<char>, std::__1::allocator<char> >", 24),
+            vec![TypeInfo::new("char", 1)],
+        ).unwrap();
+        assert_eq!(decode(&memory, &libcxx_string, 0x2300, 0, 1).unwrap().elements, vec![json!("short")]);
+
+        // libstdc++ map<int, int> with root 2, children 1 and 3; header at object + 8
+        let (object, header) = (0x3000u64, 0x3008u64);
+        let node = |parent: u64, left: u64, right: u64, key: i32, value: i32| {
+            let mut bytes: Vec<u8> = [0u64, parent, left, right].iter().flat_map(|w| w.to_le_bytes()).collect();
+            bytes.extend(key.to_le_bytes());
+            bytes.extend(value.to_le_bytes());
+            bytes
+        };
+        memory.put(0x3100, node(0x3200, 0, 0, 1, 10));
+        memory.put(0x3200, node(header, 0x3100, 0x3300, 2, 20));
+        memory.put(0x3300, node(0x3200, 0, 0, 3, 30));
+        memory.words(object, &[0, 0, 0x3200, 0x3100, 0x3300, 3]);
+        let map = ContainerType::new(
+            TypeInfo::new("std::map<int, int, std::less<int>, std::allocator<std::pair<int const, int> > >", 48),
+            vec![int.clone(), int.clone()],
+        ).unwrap();
+        assert!(decode(&memory, &map, object, 0, 10).is_err());
+        let map = map.with_layout(NodeLayout { value: 32, entry_size: 8, second: 4 });
+        let view = decode(&memory, &map, object, 0, 10).unwrap();
+        assert_eq!(view.size, 3);
+        assert_eq!(view.elements, vec![
+            json!({"key": 1, "value": 10}),
+            json!({"key": 2, "value": 20}),
+            json!({"key": 3, "value": 30}),
+        ]);
+        assert_eq!(decode(&memory, &map, object, 2, 10).unwrap().elements, vec![json!({"key": 3, "value": 30})]);
+
+        // libstdc++ unordered_set<int>: nodes {next, value}
+        memory.words(0x4000, &[0, 7, 0x4100, 2, 0, 0, 0]);
+        memory.put(0x4100, [0x4200u64.to_le_bytes().to_vec(), 5i32.to_le_bytes().to_vec(), vec![0; 4]].concat());
+        memory.put(0x4200, [0u64.to_le_bytes().to_vec(), 6i32.to_le_bytes().to_vec(), vec![0; 4]].concat());
+        let set = ContainerType::new(
+            TypeInfo::new("std::unordered_set<int, std::hash<int>, std::equal_to<int>, std::allocator<int> >", 56),
+            vec![int.clone()],
+        ).unwrap().with_layout(NodeLayout { value: 8, entry_size: 4, second: 0 });
+        assert_eq!(decode(&memory, &set, 0x4000, 0, 10).unwrap().elements, vec![json!(5), json!(6)]);
+
+        // libstdc++ deque<int> of 200 starting 100 elements into its first 128-element block
+        let blocks = [0x50000u64, 0x51000, 0x52000];
+        for (b, block) in blocks.iter().enumerate() {
+            memory.put(*block, (0..128i32).flat_map(|i| (b as i32 * 128 + i - 100).to_le_bytes()).collect());
+        }
+        memory.words(0x5800, &blocks);
+        memory.words(0x5000, &[
+            0x5800, 3,
+            blocks[0] + 400, blocks[0], blocks[0] + 512, 0x5800,
+            blocks[2] + 176, blocks[2], blocks[2] + 512, 0x5810,
+        ]);
+        let deque = ContainerType::new(TypeInfo::new("std::deque<int, std::allocator<int> >", 80), vec![int.clone()]).unwrap();
+        let view = decode(&memory, &deque, 0x5000, 20, 20).unwrap();
+        assert_eq!(view.size, 200);
+        let values: Vec<i64> = view.elements.iter().map(|v| v.as_i64().unwrap()).collect();
+        assert_eq!(values, (20..40).collect::<Vec<i64>>());
+
+        // libstdc++ shared_ptr<int> with two owners and one weak_ptr
+        memory.words(0x6000, &[0x6100, 0x6200]);
+        memory.put(0x6100, 42i32.to_le_bytes().to_vec());
+        memory.put(0x6200, [0u64.to_le_bytes().to_vec(), 2i32.to_le_bytes().to_vec(), 2i32.to_le_bytes().to_vec()].concat());
+        let shared = ContainerType::new(TypeInfo::new("std::shared_ptr<int>", 16), vec![int.clone()]).unwrap();
+        let view = decode(&memory, &shared, 0x6000, 0, 1).unwrap();
+        assert_eq!(view.elements, vec![json!(42)]);
+        assert_eq!((view.details["use_count"].as_i64(), view.details["weak_count"].as_i64()), (Some(2), Some(1)));
+
+        // vector<std::string> decodes each element as a string
+        memory.words(0x7000, &[0x2000, 0x2000 + 32, 0x2000 + 32]);
+        let strings = ContainerType::new(TypeInfo::new("std::vector<std::__cxx11::basic_string<char> >", 24), vec![gnu_string]).unwrap();
+        assert_eq!(decode(&memory, &strings, 0x7000, 0, 10).unwrap().elements, vec![json!("hi")]);
+
+        assert!(ContainerType::new(TypeInfo::new("std::vector<bool, std::allocator<bool> >", 40), vec![]).is_none());
+        assert_eq!(ContainerKind::of("std::vector<int, std::allocator<int> >"), Some(ContainerKind::Vector));
+        assert_eq!(ContainerKind::of("std::vector<int, std::allocator<int> > *"), None);
+        assert_eq!(ContainerKind::of("const std::vector<int, std::allocator<int> > &"), None);
+        assert_eq!(ContainerKind::of("std::shared_ptr<int> &&"), None);
+
+        // A tree whose left links loop is an error, not a hang
+        memory.put(0x8100, node(0x8008, 0, 0x8200, 1, 10));
+        memory.put(0x8200, node(0x8100, 0x8200, 0, 2, 20));
+        memory.words(0x8000, &[0, 0, 0x8100, 0x8100, 0x8200, 3]);
+        assert!(decode(&memory, &map, 0x8000, 0, 10).is_err());
+    }
+}
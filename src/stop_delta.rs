@@ -0,0 +1,347 @@
+// Stop-to-stop state deltas
+//
+// While stepping, almost nothing changes between two stops: a couple of
+// registers, one or two locals, a few bytes of watched memory. The tracker
+// keeps each thread's state at its last two stops and reports only what
+// differs, so a step costs a handful of entries instead of the whole
+// register file.
+
+use std::collections::hash_map::Entry;
+use std::collections::{BTreeMap, HashMap};
+use std::ffi::CStr;
+
+use lldb_sys::*;
+use serde_json::{json, Map, Value};
+
+use crate::register_schema::RegisterValues;
+
+/// Locals are flattened this many levels into aggregates
+const LOCAL_DEPTH: u32 = 2;
+/// Cap on flattened locals per frame, so a large array cannot blow up a step
+const MAX_LOCALS: usize = 256;
+/// Cap on one watched memory range
+pub const MAX_WATCH_BYTES: usize = 64 * 1024;
+/// Changed bytes this close together are reported as one run
+const RUN_GAP: usize = 8;
+
+/// One thread's state at one stop
+#[derive(Debug, Clone, Default)]
+pub struct StopState {
+    pub stop_id: u32,
+    pub pc: u64,
+    pub registers: Option<RegisterValues>,
+    /// Flattened locals, path -> value
+    pub locals: BTreeMap<String, String>,
+    /// Watched ranges, start address -> bytes read at this stop
+    pub memory: BTreeMap<u64, Vec<u8>>,
+}
+
+/// What changed for one thread since its previous stop
+#[derive(Debug, Clone, Default)]
+pub struct StateDelta {
+    pub thread_id: u32,
+    pub stop_id: u32,
+    pub previous_stop_id: Option<u32>,
+    pub pc: u64,
+    /// Changed registers as (name, new value in hex)
+    pub registers: Vec<(String, String)>,
+    pub locals: Vec<(String, String)>,
+    pub locals_removed: Vec<String>,
+    /// Changed memory as runs of (address, new bytes)
+    pub memory: Vec<(u64, Vec<u8>)>,
+    pub unchanged_registers: usize,
+    pub unchanged_locals: usize,
+    pub unchanged_memory_bytes: usize,
+}
+
+impl StateDelta {
+    /// True when this is the thread's first reported stop and everything is listed
+    pub fn is_baseline(&self) -> bool {
+        self.previous_stop_id.is_none()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.registers.is_empty() && self.locals.is_empty() && self.locals_removed.is_empty() && self.memory.is_empty()
+    }
+
+    /// Compact encoding: name -> value maps, memory as [address, hex bytes] pairs
+    pub fn to_json(&self) -> Value {
+        let registers: Map<String, Value> = self.registers.iter().map(|(name, value)| (name.clone(), json!(value))).collect();
+        let locals: Map<String, Value> = self.locals.iter().map(|(name, value)| (name.clone(), json!(value))).collect();
+        let memory: Vec<Value> = self.memory.iter()
+            .map(|(address, bytes)| json!([format!("0x{:x}", address), hex_bytes(bytes)]))
+            .collect();
+
+        let mut delta = json!({
+            "thread_id": self.thread_id,
+            "stop_id": self.stop_id,
+            "previous_stop_id": self.previous_stop_id,
+            "baseline": self.is_baseline(),
+            "pc": format!("0x{:x}", self.pc),
+            "registers": registers,
+            "unchanged": {
+                "registers": self.unchanged_registers,
+                "locals": self.unchanged_locals,
+                "memory_bytes": self.unchanged_memory_bytes
+            }
+        });
+        if !locals.is_empty() {
+            delta["locals"] = Value::Object(locals);
+        }
+        if !self.locals_removed.is_empty() {
+            delta["locals_removed"] = json!(self.locals_removed);
+        }
+        if !memory.is_empty() {
+            delta["memory"] = json!(memory);
+        }
+        delta
+    }
+}
+
+/// A thread's last stop and the one before it
+#[derive(Debug)]
+struct ThreadHistory {
+    current: StopState,
+    previous: Option<StopState>,
+}
+
+/// Per-thread stop history of the current process
+#[derive(Debug, Default)]
+pub struct StopDeltaTracker {
+    process_id: Option<u32>,
+    threads: HashMap<u32, ThreadHistory>,
+    /// Memory ranges read at every stop, start address -> size
+    watched: BTreeMap<u64, usize>,
+}
+
+impl StopDeltaTracker {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Forget all history; watched ranges are kept unless `watches` is set
+    pub fn reset(&mut self, watches: bool) {
+        self.threads.clear();
+        if watches {
+            self.watched.clear();
+        }
+    }
+
+    /// Drop history belonging to another process
+    pub fn bind_process(&mut self, process_id: u32) {
+        if self.process_id != Some(process_id) {
+            self.process_id = Some(process_id);
+            self.threads.clear();
+        }
+    }
+
+    pub fn watch(&mut self, address: u64, size: usize) {
+        self.watched.insert(address, size.min(MAX_WATCH_BYTES));
+    }
+
+    pub fn unwatch(&mut self, address: u64) -> bool {
+        self.watched.remove(&address).is_some()
+    }
+
+    pub fn watched(&self) -> impl Iterator<Item = (u64, usize)> + '_ {
+        self.watched.iter().map(|(address, size)| (*address, *size))
+    }
+
+    /// Record `state` as the thread's state at its stop and diff it against the
+    /// stop before. Asking twice at the same stop diffs against the same
+    /// previous stop again rather than reporting an empty delta.
+    pub fn record(&mut self, thread_id: u32, state: StopState) -> StateDelta {
+        let history = match self.threads.entry(thread_id) {
+            Entry::Occupied(entry) => {
+                let history = entry.into_mut();
+                if history.current.stop_id == state.stop_id {
+                    history.current = state;
+                } else {
+                    history.previous = Some(std::mem::replace(&mut history.current, state));
+                }
+                history
+            }
+            Entry::Vacant(entry) => entry.insert(ThreadHistory { current: state, previous: None }),
+        };
+        diff_states(thread_id, history.previous.as_ref(), &history.current)
+    }
+}
+
+/// Diff `current` against `previous`; with no previous stop everything is reported
+pub fn diff_states(thread_id: u32, previous: Option<&StopState>, current: &StopState) -> StateDelta {
+    let mut delta = StateDelta {
+        thread_id,
+        stop_id: current.stop_id,
+        previous_stop_id: previous.map(|state| state.stop_id),
+        pc: current.pc,
+        ..StateDelta::default()
+    };
+
+    if let Some(values) = &current.registers {
+        // Only comparable when both stops share a layout
+        let before = previous
+            .and_then(|state| state.registers.as_ref())
+            .filter(|before| before.schema.key == values.schema.key);
+        for (index, def) in values.iter() {
+            let changed = before.map_or(true, |before| before.bytes(index) != values.bytes(index));
+            if changed {
+                delta.registers.push((def.name.clone(), values.hex(index).unwrap_or_default()));
+            } else {
+                delta.unchanged_registers += 1;
+            }
+        }
+    }
+
+    let no_locals = BTreeMap::new();
+    let before = previous.map_or(&no_locals, |state| &state.locals);
+    for (name, value) in &current.locals {
+        if before.get(name) == Some(value) {
+            delta.unchanged_locals += 1;
+        } else {
+            delta.locals.push((name.clone(), value.clone()));
+        }
+    }
+    if previous.is_some() {
+        delta.locals_removed = before.keys().filter(|name| !current.locals.contains_key(*name)).cloned().collect();
+    }
+
+    for (address, bytes) in &current.memory {
+        match previous.and_then(|state| state.memory.get(address)) {
+            Some(old) => {
+                let runs = diff_bytes(*address, old, bytes);
+                let changed: usize = runs.iter().map(|(_, run)| run.len()).sum();
+                delta.unchanged_memory_bytes += bytes.len().saturating_sub(changed);
+                delta.memory.extend(runs);
+            }
+            None if !bytes.is_empty() => delta.memory.push((*address, bytes.clone())),
+            None => {}
+        }
+    }
+    delta
+}
+
+/// Runs of bytes in `new` that differ from `old`, merging runs fewer than
+/// `RUN_GAP` bytes apart. Bytes past the end of `old` count as changed.
+pub fn diff_bytes(address: u64, old: &[u8], new: &[u8]) -> Vec<(u64, Vec<u8>)> {
+    let mut runs: Vec<(usize, usize)> = Vec::new();
+    for (offset, byte) in new.iter().enumerate() {
+        if old.get(offset) == Some(byte) {
+            continue;
+        }
+        match runs.last_mut() {
+            Some((_, end)) if offset - *end <= RUN_GAP => *end = offset + 1,
+            _ => runs.push((offset, offset + 1)),
+        }
+    }
+    runs.into_iter()
+        .map(|(start, end)| (address + start as u64, new[start..end].to_vec()))
+        .collect()
+}
+
+fn hex_bytes(bytes: &[u8]) -> String {
+    bytes.iter().map(|byte| format!("{:02x}", byte)).collect()
+}
+
+fn c_string(ptr: *const std::os::raw::c_char) -> Option<String> {
+    if ptr.is_null() {
+        return None;
+    }
+    Some(unsafe { CStr::from_ptr(ptr) }.to_string_lossy().into_owned())
+}
+
+/// Arguments and locals of `frame`, flattened a couple of levels into aggregates
+pub(crate) fn capture_locals(frame: SBFrameRef) -> BTreeMap<String, String> {
+    let mut locals = BTreeMap::new();
+    let variables = unsafe { SBFrameGetVariables(frame, true, true, false, true) };
+    if variables.is_null() {
+        return locals;
+    }
+    for i in 0..unsafe { SBValueListGetSize(variables) } {
+        let variable = unsafe { SBValueListGetValueAtIndex(variables, i) };
+        if variable.is_null() {
+            continue;
+        }
+        if let Some(name) = c_string(unsafe { SBValueGetName(variable) }) {
+            flatten_value(variable, name, 0, &mut locals);
+        }
+        if locals.len() >= MAX_LOCALS {
+            break;
+        }
+    }
+    locals
+}
+
+fn flatten_value(value: SBValueRef, path: String, depth: u32, out: &mut BTreeMap<String, String>) {
+    if out.len() >= MAX_LOCALS {
+        return;
+    }
+    let scalar = c_string(unsafe { SBValueGetValue(value) })
+        .or_else(|| c_string(unsafe { SBValueGetSummary(value) }));
+    let children = unsafe { SBValueGetNumChildren(value) };
+    // Pointers have a value and a pointee child; the value is what changes
+    if scalar.is_some() || children == 0 || depth >= LOCAL_DEPTH {
+        out.insert(path, scalar.unwrap_or_else(|| format!("{{{} children}}", children)));
+        return;
+    }
+    for i in 0..children {
+        let child = unsafe { SBValueGetChildAtIndex(value, i) };
+        if child.is_null() {
+            continue;
+        }
+        let Some(name) = c_string(unsafe { SBValueGetName(child) }) else {
+            continue;
+        };
+        let child_path = if name.starts_with('[') { format!("{}{}", path, name) } else { format!("{}.{}", path, name) };
+        flatten_value(child, child_path, depth + 1, out);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_stop_delta_reports_only_changes() {
+        // Nearby changed bytes coalesce into one run, distant ones do not
+        let old = vec![0u8; 64];
+        let mut new = old.clone();
+        new[2] = 1;
+        new[5] = 1;
+        new[40] = 7;
+        let runs = diff_bytes(0x1000, &old, &new);
+        assert_eq!(runs, vec![(0x1002, vec![1, 0, 0, 1]), (0x1028, vec![7])]);
+        assert!(diff_bytes(0x1000, &old, &old).is_empty());
+
+        let state = |stop_id: u32, i: &str, bytes: &[u8]| StopState {
+            stop_id,
+            pc: 0x400000 + stop_id as u64,
+            locals: [("i".to_string(), i.to_string()), ("name".to_string(), "\"abc\"".to_string())].into_iter().collect(),
+            memory: [(0x2000u64, bytes.to_vec())].into_iter().collect(),
+            ..StopState::default()
+        };
+
+        let mut tracker = StopDeltaTracker::new();
+        let first = tracker.record(1, state(1, "0", &[0, 0, 0, 0]));
+        assert!(first.is_baseline(), "First stop should be a full baseline");
+        assert_eq!(first.locals.len(), 2);
+
+        let second = tracker.record(1, state(2, "1", &[0, 0, 9, 0]));
+        assert_eq!(second.previous_stop_id, Some(1));
+        assert_eq!(second.locals, vec![("i".to_string(), "1".to_string())]);
+        assert_eq!(second.unchanged_locals, 1);
+        assert_eq!(second.memory, vec![(0x2002, vec![9])]);
+        assert_eq!(second.unchanged_memory_bytes, 3);
+
+        // Asking again at the same stop repeats the same delta
+        let again = tracker.record(1, state(2, "1", &[0, 0, 9, 0]));
+        assert_eq!(again.previous_stop_id, Some(1));
+        assert_eq!(again.locals, second.locals);
+
+        let unchanged = tracker.record(1, state(3, "1", &[0, 0, 9, 0]));
+        assert!(unchanged.is_empty(), "Nothing changed between stops 2 and 3");
+
+        // Another process starts over
+        tracker.bind_process(42);
+        assert!(tracker.record(1, state(4, "1", &[0; 4])).is_baseline());
+    }
+}
@@ -0,0 +1,300 @@
+// Native thread-local storage resolution
+//
+// A thread_local lives at a different address in every thread. LLDB finds
+// it by running DW_OP_form_tls_address through the dynamic loader in one
+// thread's context, so showing a variable across threads means selecting
+// each thread in turn and resolving it again. Here the variable is
+// resolved once, in the selected thread, and turned into a module TLS index
+// and an offset into that module's TLS block. The module index comes from
+// the thread's dynamic thread vector (DTV). Every thread's copy is then
+// found from its own thread pointer register (fs_base on x86-64, tpidr on
+// AArch64): dtv = tcb->dtv, address = dtv[module].val + offset. That is
+// two word reads per thread before the value itself.
+//
+// The DTV layout is glibc's: tcb->dtv points at dtv[0], dtv[-1] holds the
+// slot count, and each slot is { void *val; void *to_free; }, so only glibc
+// Linux targets are handled. When the DTV cannot be read that way, the
+// variable is assumed to be in static TLS, at a fixed distance from the
+// thread pointer, and the result is marked as not authoritative.
+
+use serde_json::{json, Value};
+
+use crate::stl_decode::{self, CountingReader, MemoryReader, TypeInfo};
+
+/// Bytes per DTV slot
+const DTV_SLOT: u64 = 16;
+/// glibc's TLS_DTV_UNALLOCATED: the thread has not touched the module's TLS yet
+const DTV_UNALLOCATED: u64 = u64::MAX;
+/// Slot counts past this are taken as a misread DTV
+const MAX_DTV_SLOTS: u64 = 4096;
+
+/// Thread pointer conventions of the architectures handled
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum TlsAbi {
+    /// TLS variant II: the TCB sits at the thread pointer, static TLS below it
+    X86_64,
+    /// TLS variant I: the thread pointer is the TCB, static TLS above it
+    AArch64,
+}
+
+impl TlsAbi {
+    /// The ABI of a glibc Linux triple. Other systems and C libraries (Apple,
+    /// musl, Android's bionic) lay out their TCB and DTV differently.
+    pub fn of(triple: &str) -> Option<Self> {
+        if !triple.contains("-linux-gnu") {
+            return None;
+        }
+        match triple.split('-').next().unwrap_or_default() {
+            "x86_64" => Some(TlsAbi::X86_64),
+            "aarch64" => Some(TlsAbi::AArch64),
+            _ => None,
+        }
+    }
+
+    /// Register holding the thread pointer
+    pub fn register(self) -> &'static str {
+        match self {
+            TlsAbi::X86_64 => "fs_base",
+            TlsAbi::AArch64 => "tpidr",
+        }
+    }
+
+    /// Offset of tcb->dtv from the thread pointer
+    fn dtv_offset(self) -> u64 {
+        match self {
+            TlsAbi::X86_64 => 8,
+            TlsAbi::AArch64 => 0,
+        }
+    }
+}
+
+/// Where a thread-local lives, relative to each thread
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum TlsLocation {
+    /// Offset into the module's block, found through the thread's DTV
+    Dtv { module_id: u64, offset: u64 },
+    /// Fixed distance from the thread pointer (static TLS)
+    ThreadPointer { delta: i64 },
+}
+
+impl TlsLocation {
+    pub fn method(&self) -> &'static str {
+        match self {
+            TlsLocation::Dtv { .. } => "dtv",
+            TlsLocation::ThreadPointer { .. } => "thread_pointer",
+        }
+    }
+
+    /// Whether the location was read from the DTV rather than assumed
+    pub fn is_authoritative(&self) -> bool {
+        matches!(self, TlsLocation::Dtv { .. })
+    }
+
+    pub fn to_json(&self) -> Value {
+        match self {
+            TlsLocation::Dtv { module_id, offset } => {
+                json!({ "method": self.method(), "authoritative": true, "module_id": module_id, "offset": offset })
+            }
+            TlsLocation::ThreadPointer { delta } => json!({
+                "method": self.method(),
+                "authoritative": false,
+                "delta": delta,
+                "note": "DTV not readable; assumed static TLS at the same distance from every thread pointer"
+            }),
+        }
+    }
+}
+
+fn read_word(memory: &dyn MemoryReader, address: u64) -> Option<u64> {
+    let bytes = memory.read(address, 8)?;
+    Some(u64::from_le_bytes(bytes.get(..8)?.try_into().ok()?))
+}
+
+fn dtv_of(memory: &dyn MemoryReader, abi: TlsAbi, thread_pointer: u64) -> Option<u64> {
+    read_word(memory, thread_pointer.checked_add(abi.dtv_offset())?).filter(|dtv| *dtv != 0)
+}
+
+/// Work out where a variable lives from one thread, whose thread pointer is
+/// `thread_pointer`, where it is known to be at `address`. The module is
+/// the DTV slot whose block starts closest below the address.
+pub fn locate(memory: &dyn MemoryReader, abi: TlsAbi, thread_pointer: u64, address: u64) -> TlsLocation {
+    let static_tls = TlsLocation::ThreadPointer { delta: address.wrapping_sub(thread_pointer) as i64 };
+    let Some(dtv) = dtv_of(memory, abi, thread_pointer) else {
+        return static_tls;
+    };
+    let Some(slots) = read_word(memory, dtv.wrapping_sub(DTV_SLOT)).filter(|slots| (1..=MAX_DTV_SLOTS).contains(slots)) else {
+        return static_tls;
+    };
+    // Slots 1..=slots in one read
+    let Some(table) = memory.read(dtv + DTV_SLOT, (slots * DTV_SLOT) as usize) else {
+        return static_tls;
+    };
+    let best = table.chunks_exact(DTV_SLOT as usize)
+        .enumerate()
+        .map(|(i, slot)| (i as u64 + 1, u64::from_le_bytes(slot[..8].try_into().unwrap())))
+        .filter(|(_, block)| *block != 0 && *block != DTV_UNALLOCATED && *block <= address)
+        .max_by_key(|(_, block)| *block);
+    match best {
+        Some((module_id, block)) => TlsLocation::Dtv { module_id, offset: address - block },
+        None => static_tls,
+    }
+}
+
+/// Address of the variable in the thread whose thread pointer is `thread_pointer`
+pub fn resolve(memory: &dyn MemoryReader, abi: TlsAbi, location: &TlsLocation, thread_pointer: u64) -> Result<u64, String> {
+    match *location {
+        TlsLocation::ThreadPointer { delta } => Ok(thread_pointer.wrapping_add(delta as u64)),
+        TlsLocation::Dtv { module_id, offset } => {
+            let dtv = dtv_of(memory, abi, thread_pointer)
+                .ok_or_else(|| format!("cannot read the DTV pointer at 0x{:x}", thread_pointer + abi.dtv_offset()))?;
+            let slot = dtv + module_id * DTV_SLOT;
+            match read_word(memory, slot) {
+                None => Err(format!("cannot read DTV slot {} at 0x{:x}", module_id, slot)),
+                Some(0) | Some(DTV_UNALLOCATED) => Err("TLS block not allocated in this thread yet".to_string()),
+                Some(block) => Ok(block + offset),
+            }
+        }
+    }
+}
+
+/// One thread's copy of a thread-local
+#[derive(Debug, Clone)]
+pub struct ThreadValue {
+    pub thread_id: u32,
+    pub thread_pointer: u64,
+    pub address: Option<u64>,
+    pub value: Value,
+}
+
+impl ThreadValue {
+    pub fn to_json(&self) -> Value {
+        json!({
+            "thread_id": self.thread_id,
+            "thread_pointer": format!("0x{:x}", self.thread_pointer),
+            "address": self.address.map(|address| format!("0x{:x}", address)),
+            "value": self.value,
+        })
+    }
+}
+
+/// A thread-local across threads
+#[derive(Debug, Clone)]
+pub struct TlsView {
+    pub name: String,
+    pub type_name: String,
+    pub location: TlsLocation,
+    pub threads: Vec<ThreadValue>,
+    pub reads: usize,
+    pub bytes_read: usize,
+}
+
+impl TlsView {
+    pub fn to_json(&self) -> Value {
+        json!({
+            "name": self.name,
+            "type": self.type_name,
+            "location": self.location.to_json(),
+            "authoritative": self.location.is_authoritative(),
+            "threads": self.threads.iter().map(ThreadValue::to_json).collect::<Vec<_>>(),
+            "thread_count": self.threads.len(),
+            "reads": self.reads,
+            "bytes_read": self.bytes_read,
+        })
+    }
+}
+
+/// Read the variable in each of `threads`, given as (thread id, thread pointer)
+pub fn read_across(
+    memory: &dyn MemoryReader,
+    abi: TlsAbi,
+    name: &str,
+    type_info: &TypeInfo,
+    location: TlsLocation,
+    threads: &[(u32, u64)],
+) -> TlsView {
+    let memory = CountingReader::new(memory);
+    let values = threads.iter().map(|&(thread_id, thread_pointer)| {
+        let (address, value) = match resolve(&memory, abi, &location, thread_pointer) {
+            Ok(address) => {
+                let value = match memory.read(address, type_info.size) {
+                    Some(bytes) => stl_decode::decode_element(&memory, type_info, &bytes, address),
+                    None => json!({ "address": format!("0x{:x}", address), "error": "memory not readable" }),
+                };
+                (Some(address), value)
+            }
+            Err(error) => (None, json!({ "error": error })),
+        };
+        ThreadValue { thread_id, thread_pointer, address, value }
+    }).collect();
+    TlsView {
+        name: name.to_string(),
+        type_name: type_info.name.clone(),
+        location,
+        threads: values,
+        reads: memory.reads.get(),
+        bytes_read: memory.bytes.get(),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::stl_decode::FakeMemory;
+
+    #[test]
+    fn test_native_tls_resolution() {
+        assert_eq!(TlsAbi::of("x86_64-unknown-linux-gnu"), Some(TlsAbi::X86_64));
+        assert_eq!(TlsAbi::of("aarch64-unknown-linux-gnu").map(TlsAbi::register), Some("tpidr"));
+        assert_eq!(TlsAbi::of("riscv64-unknown-linux-gnu"), None);
+        for other in ["arm64-apple-macosx14.0.0", "arm64e-apple-ios", "x86_64-apple-macosx", "x86_64-unknown-linux-musl", "aarch64-unknown-linux-android"] {
+            assert_eq!(TlsAbi::of(other), None, "{}", other);
+        }
+
+        // glibc x86-64: tcb->dtv at tp + 8, dtv[-1] = slot count, 16-byte slots.
+        // Module 1 is static TLS below the thread pointer, module 2 was dlopened.
+        let mut memory = FakeMemory::default();
+        let threads = [(101u32, 0x7000_0000u64), (102, 0x7100_0000), (103, 0x7200_0000)];
+        for (n, &(_, tp)) in threads.iter().enumerate() {
+            let dtv = 0x5000_0000 + n as u64 * 0x1000;
+            memory.words(tp + 8, &[dtv]);
+            memory.words(dtv - 16, &[2]);
+            memory.words(dtv + 16, &[tp - 0x40]);
+            memory.words(dtv + 24, &[0]);
+            // The third thread never touched module 2's TLS
+            memory.words(dtv + 32, &[if n == 2 { u64::MAX } else { 0x6000_0000 + n as u64 * 0x1000 }]);
+            memory.words(dtv + 40, &[0]);
+            memory.words(tp - 0x40 + 8, &[800 + n as u64]);
+            memory.words(0x6000_0000 + n as u64 * 0x1000 + 0x10, &[0xfeed + n as u64]);
+        }
+
+        // The selected thread found thread_local_id at tp - 0x38: module 1, offset 8
+        let location = locate(&memory, TlsAbi::X86_64, 0x7000_0000, 0x7000_0000 - 0x38);
+        assert_eq!(location, TlsLocation::Dtv { module_id: 1, offset: 8 });
+        assert!(location.is_authoritative());
+        assert_eq!(resolve(&memory, TlsAbi::X86_64, &location, 0x7100_0000), Ok(0x7100_0000 - 0x38));
+
+        let int = TypeInfo::new("int", 4);
+        let view = read_across(&memory, TlsAbi::X86_64, "thread_local_id", &int, location, &threads);
+        assert_eq!(view.threads.len(), 3);
+        assert_eq!(view.threads.iter().map(|t| t.value.clone()).collect::<Vec<_>>(), vec![json!(800), json!(801), json!(802)]);
+        // Per thread: DTV pointer, DTV slot, value
+        assert_eq!(view.reads, 9);
+
+        // A dlopened module: found through its DTV slot, unallocated in one thread
+        let location = locate(&memory, TlsAbi::X86_64, 0x7000_0000, 0x6000_0010);
+        assert_eq!(location, TlsLocation::Dtv { module_id: 2, offset: 0x10 });
+        let long = TypeInfo::new("long", 8);
+        let view = read_across(&memory, TlsAbi::X86_64, "plugin_state", &long, location, &threads);
+        assert_eq!(view.threads[1].value, json!(0xfeed + 1));
+        assert_eq!(view.threads[2].address, None);
+        assert!(view.threads[2].value["error"].as_str().unwrap().contains("not allocated"));
+
+        // No readable DTV: static TLS at a fixed distance from the thread pointer
+        let bare = FakeMemory::default();
+        let location = locate(&bare, TlsAbi::AArch64, 0x9000, 0x9010);
+        assert_eq!(location, TlsLocation::ThreadPointer { delta: 0x10 });
+        assert!(!location.is_authoritative());
+        assert_eq!(location.to_json()["authoritative"], false);
+        assert_eq!(resolve(&bare, TlsAbi::AArch64, &location, 0xa000), Ok(0xa010));
+    }
+}
@@ -2,12 +2,17 @@ use async_trait::async_trait;
 use serde_json::{json, Value};
 use std::collections::HashMap;
 use crate::error::{IncodeError, IncodeResult};
+use crate::crash_triage::{crash_record_json, TriageOptions};
+use crate::fault_decode::fault_json;
 use crate::lldb_manager::LldbManager;
+use crate::minidump::MinidumpOptions;
 use super::{Tool, ToolResponse};
 
-// Advanced Analysis Tools (2 tools)
+// Advanced Analysis Tools (4 tools)
 pub struct AnalyzeCrashTool;
 pub struct GenerateCoreDumpTool;
+pub struct LoadCoreTool;
+pub struct TriageCoresTool;
 
 /// Analyze crash dumps and provide detailed crash information
 #[async_trait]
@@ -37,6 +42,11 @@ impl Tool for AnalyzeCrashTool {
                 "default": 10,
                 "minimum": 1,
                 "maximum": 100
+            },
+            "record": {
+                "type": "boolean",
+                "description": "Count this crash in the persistent crash signature database",
+                "default": false
             }
         })
     }
@@ -57,7 +67,19 @@ impl Tool for AnalyzeCrashTool {
             .and_then(|v| v.as_u64())
             .unwrap_or(10) as usize;
 
+        let record = arguments.get("record")
+            .and_then(|v| v.as_bool())
+            .unwrap_or(false);
+
         let analysis = lldb_manager.analyze_crash(core_file_path)?;
+        let recorded = if record {
+            match lldb_manager.record_crash(&analysis, core_file_path) {
+                Ok(recorded) => recorded,
+                Err(e) => return Ok(ToolResponse::Error(e.to_string())),
+            }
+        } else {
+            None
+        };
         
         let has_crash = analysis.crash_type != "No crash";
         
@@ -71,6 +93,8 @@ impl Tool for AnalyzeCrashTool {
                 "thread_id": analysis.faulting_thread,
                 "exception_type": analysis.exception_type,
                 "exception_codes": analysis.exception_codes,
+                "si_code": analysis.fault.as_ref().and_then(|fault| fault.si_code_name),
+                "classification": analysis.fault.as_ref().map(|fault| fault.classification),
             },
             "crash_type": analysis.crash_type,
             "crash_address": analysis.crash_address.map(|addr| format!("0x{:x}", addr)),
@@ -87,6 +111,11 @@ impl Tool for AnalyzeCrashTool {
             "loaded_modules": analysis.loaded_modules,
             "crash_summary": analysis.crash_summary,
             "analysis_summary": analysis.crash_summary,
+            "signature": analysis.signature.map(|hash| format!("{:016x}", hash)),
+            "signature_frames": analysis.signature_frames,
+            "known_crash": analysis.known_crash.as_ref().map(crash_record_json),
+            "recorded": recorded.as_ref().map(crash_record_json),
+            "fault": analysis.fault.as_ref().map(fault_json),
             "core_file": core_file_path,
             "analyzed_at": std::time::SystemTime::now()
                 .duration_since(std::time::UNIX_EPOCH)
@@ -126,13 +155,28 @@ impl Tool for GenerateCoreDumpTool {
             "format": {
                 "type": "string",
                 "enum": ["auto", "elf", "macho", "minidump"],
-                "description": "Core dump format (default: auto - detect from platform)",
+                "description": "Core dump format (default: auto - detect from platform). minidump writes a compact ELF core with thread contexts, stacks and referenced memory only",
                 "default": "auto"
             },
             "include_memory": {
                 "type": "boolean",
                 "description": "Include full memory contents in core dump",
                 "default": true
+            },
+            "stack_bytes": {
+                "type": "integer",
+                "description": "minidump: stack captured above each thread's stack pointer",
+                "default": 262144
+            },
+            "reference_bytes": {
+                "type": "integer",
+                "description": "minidump: bytes captured on either side of each address found in registers or on stacks",
+                "default": 256
+            },
+            "max_bytes": {
+                "type": "integer",
+                "description": "minidump: cap on captured memory",
+                "default": 33554432
             }
         })
     }
@@ -154,6 +198,35 @@ impl Tool for GenerateCoreDumpTool {
             .and_then(|v| v.as_bool())
             .unwrap_or(true);
 
+        if format == "minidump" {
+            let defaults = MinidumpOptions::default();
+            let options = MinidumpOptions {
+                stack_bytes: arguments.get("stack_bytes").and_then(|v| v.as_u64()).unwrap_or(defaults.stack_bytes),
+                reference_radius: arguments.get("reference_bytes").and_then(|v| v.as_u64()).unwrap_or(defaults.reference_radius),
+                max_bytes: arguments.get("max_bytes").and_then(|v| v.as_u64()).unwrap_or(defaults.max_bytes),
+            };
+            return match lldb_manager.generate_minidump(output_path, &options) {
+                Ok(report) => Ok(ToolResponse::Success(json!({
+                    "success": true,
+                    "output_path": report.path,
+                    "core_dump_path": report.path,
+                    "format": format,
+                    "include_memory": false,
+                    "file_exists": true,
+                    "file_size": report.file_size,
+                    "threads": report.threads,
+                    "memory_ranges": report.ranges,
+                    "captured_bytes": report.captured_bytes,
+                    "modules": report.modules,
+                    "regions": report.regions,
+                    "truncated": report.truncated,
+                    "elapsed_ms": report.elapsed_ms,
+                    "status": "generated"
+                }).to_string())),
+                Err(e) => Ok(ToolResponse::Error(e.to_string())),
+            };
+        }
+
         let result = match lldb_manager.generate_core_dump(output_path) {
             Ok(r) => r,
             Err(IncodeError::ProcessError(_)) => {
@@ -198,6 +271,185 @@ impl Tool for GenerateCoreDumpTool {
     }
 }
 
+/// Open a core file as the current process for offline inspection
+#[async_trait]
+impl Tool for LoadCoreTool {
+    fn name(&self) -> &'static str {
+        "load_core"
+    }
+
+    fn description(&self) -> &'static str {
+        "Load a core file so thread, register, memory and stack tools inspect it like a stopped process"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "core_file_path": {
+                "type": "string",
+                "description": "Path to the ELF core file"
+            },
+            "executable": {
+                "type": "string",
+                "description": "Executable that produced the core (optional, taken from the core's file mappings if not specified)"
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let core_file_path = arguments.get("core_file_path")
+            .and_then(|v| v.as_str())
+            .ok_or_else(|| IncodeError::mcp("Missing required parameter: core_file_path"))?;
+        let executable = arguments.get("executable").and_then(|v| v.as_str());
+
+        match lldb_manager.load_core(core_file_path, executable) {
+            Ok(summary) => Ok(ToolResponse::Json(json!({
+                "core_file": summary.path,
+                "executable": summary.executable,
+                "pid": summary.pid,
+                "command": summary.command,
+                "file_size": summary.file_size,
+                "segments": summary.segments,
+                "mapped_bytes": summary.mapped_bytes,
+                "threads": summary.threads,
+                "faulting_thread": summary.faulting_thread,
+                "faulting_pc": summary.faulting_pc.map(|addr| format!("0x{:x}", addr)),
+                "faulting_sp": summary.faulting_sp.map(|addr| format!("0x{:x}", addr)),
+                "signal": summary.signal.as_ref().map(|signal| json!({
+                    "number": signal.signo,
+                    "name": crate::core_file::signal_name(signal.signo),
+                    "code": signal.code,
+                    "errno": signal.errno,
+                    "fault_address": signal.fault_address.map(|addr| format!("0x{:x}", addr)),
+                    "sender_pid": signal.sender_pid
+                })),
+                "load_ms": summary.load_ms
+            }))),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+/// Bucket a directory of cores by crash signature
+#[async_trait]
+impl Tool for TriageCoresTool {
+    fn name(&self) -> &'static str {
+        "triage_cores"
+    }
+
+    fn description(&self) -> &'static str {
+        "Triage a directory of core files in parallel workers, bucketing them by normalized crash signature with one analyzed representative per bucket"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "directory": {
+                "type": "string",
+                "description": "Directory containing core files"
+            },
+            "frames": {
+                "type": "integer",
+                "description": "Top frames of the faulting thread that make up a signature",
+                "default": 5,
+                "minimum": 1,
+                "maximum": 32
+            },
+            "name_pattern": {
+                "type": "string",
+                "description": "Only consider files whose name contains this (optional)"
+            },
+            "max_workers": {
+                "type": "integer",
+                "description": "Upper bound on parallel workers (defaults to the CPU count, further limited by available memory)"
+            },
+            "worker_memory_mb": {
+                "type": "integer",
+                "description": "Memory assumed per worker when bounding concurrency",
+                "default": 1024
+            },
+            "max_cores": {
+                "type": "integer",
+                "description": "Maximum number of cores to triage",
+                "default": 1000
+            },
+            "timeout_secs": {
+                "type": "integer",
+                "description": "Per-core worker timeout",
+                "default": 120
+            },
+            "analyze": {
+                "type": "boolean",
+                "description": "Run the full crash analysis on each bucket's representative",
+                "default": true
+            },
+            "record": {
+                "type": "boolean",
+                "description": "Count every triaged core in the persistent crash signature database; cores already recorded are not counted twice. Bucket history is reported either way.",
+                "default": false
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let directory = arguments.get("directory")
+            .and_then(|v| v.as_str())
+            .ok_or_else(|| IncodeError::mcp("Missing required parameter: directory"))?;
+
+        let defaults = TriageOptions::default();
+        let options = TriageOptions {
+            frames: arguments.get("frames").and_then(|v| v.as_u64()).map_or(defaults.frames, |n| n.clamp(1, 32) as usize),
+            max_workers: arguments.get("max_workers").and_then(|v| v.as_u64()).map(|n| n as usize),
+            worker_memory_bytes: arguments.get("worker_memory_mb")
+                .and_then(|v| v.as_u64())
+                .map_or(defaults.worker_memory_bytes, |mb| mb * 1024 * 1024),
+            name_pattern: arguments.get("name_pattern").and_then(|v| v.as_str()).map(String::from),
+            max_cores: arguments.get("max_cores").and_then(|v| v.as_u64()).map_or(defaults.max_cores, |n| n as usize),
+            timeout: arguments.get("timeout_secs")
+                .and_then(|v| v.as_u64())
+                .map_or(defaults.timeout, std::time::Duration::from_secs),
+            analyze: arguments.get("analyze").and_then(|v| v.as_bool()).unwrap_or(defaults.analyze),
+            worker_exe: None,
+            database: Some(lldb_manager.crash_database_path().to_path_buf()),
+            record: arguments.get("record").and_then(|v| v.as_bool()).unwrap_or(false),
+        };
+
+        match lldb_manager.triage_cores(directory, &options) {
+            Ok(report) => Ok(ToolResponse::Json(json!({
+                "directory": report.directory,
+                "cores_found": report.cores_found,
+                "cores_triaged": report.cores_triaged,
+                "bucket_count": report.buckets.len(),
+                "buckets": report.buckets.iter().map(|bucket| json!({
+                    "signature": format!("{:016x}", bucket.hash),
+                    "signal": crate::core_file::signal_name(bucket.signal),
+                    "frames": bucket.frames,
+                    "count": bucket.count,
+                    "representative": bucket.representative,
+                    "cores": bucket.cores,
+                    "analysis": bucket.analysis,
+                    "history": bucket.history.as_ref().map(crash_record_json)
+                })).collect::<Vec<_>>(),
+                "failures": report.failures.iter().map(|failure| json!({
+                    "core": failure.core_path,
+                    "error": failure.error
+                })).collect::<Vec<_>>(),
+                "workers": report.workers,
+                "out_of_process": report.out_of_process,
+                "database_buckets": report.database_buckets,
+                "elapsed_ms": report.elapsed_ms
+            }))),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
 // Keep the old PlaceholderTool for compatibility
 pub struct PlaceholderTool;
 
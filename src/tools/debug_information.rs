@@ -1,4 +1,4 @@
-use crate::lldb_manager::{LldbManager, FunctionInfo};
+use crate::lldb_manager::{LldbManager, FunctionInfo, MAX_STOP_WAIT_MS};
 use crate::error::IncodeResult;
 use crate::tools::{Tool, ToolResponse};
 use std::collections::HashMap;
@@ -373,6 +373,143 @@ impl Tool for GetSourceCodeTool {
     }
 }
 
+pub fn function_cfg(
+    lldb_manager: &LldbManager,
+    arguments: HashMap<String, Value>,
+) -> IncodeResult<Value> {
+    debug!("Debug Information: function_cfg called with args: {:?}", arguments);
+
+    if let Some(module) = arguments.get("module").and_then(|v| v.as_str()) {
+        let max_functions = arguments.get("max_functions")
+            .and_then(|v| v.as_u64())
+            .unwrap_or(500) as usize;
+        let include_graphs = arguments.get("include_graphs")
+            .and_then(|v| v.as_bool())
+            .unwrap_or(false);
+
+        return match lldb_manager.module_cfgs(module, max_functions) {
+            Ok(cfgs) => {
+                let functions: Vec<Value> = cfgs.iter()
+                    .map(|(start, cfg)| if include_graphs { cfg.to_json(*start) } else { cfg.summary_json(*start) })
+                    .collect();
+                Ok(json!({
+                    "success": true,
+                    "module": module,
+                    "function_count": functions.len(),
+                    "functions": functions
+                }))
+            }
+            Err(e) => {
+                error!("Failed to build CFGs for module {}: {}", module, e);
+                Ok(json!({
+                    "success": false,
+                    "error": e.to_string()
+                }))
+            }
+        };
+    }
+
+    let address = code_address(lldb_manager, arguments.get("function"))?
+        .ok_or_else(|| crate::error::IncodeError::invalid_parameter("function (name or address) or module is required"))?;
+
+    match lldb_manager.function_cfg(address) {
+        Ok((start, cfg)) => {
+            debug!("CFG for 0x{:x}: {} blocks, {} loops", start, cfg.blocks.len(), cfg.loops.len());
+            let mut result = cfg.to_json(start);
+            result["success"] = json!(true);
+            Ok(result)
+        }
+        Err(e) => {
+            error!("Failed to build CFG at 0x{:x}: {}", address, e);
+            Ok(json!({
+                "success": false,
+                "error": e.to_string()
+            }))
+        }
+    }
+}
+
+/// Function name or code address argument; a name that resolves to no
+/// function is an error, not a missing argument
+fn code_address(lldb_manager: &LldbManager, value: Option<&Value>) -> IncodeResult<Option<u64>> {
+    Ok(match value {
+        Some(Value::String(s)) if s.starts_with("0x") || s.starts_with("0X") => Some(u64::from_str_radix(&s[2..], 16)
+            .map_err(|_| crate::error::IncodeError::invalid_parameter(format!("Invalid address: {}", s)))?),
+        Some(Value::String(name)) => Some(lldb_manager.function_address(name)?),
+        Some(v) => v.as_u64(),
+        None => None,
+    })
+}
+
+fn xref_options(arguments: &HashMap<String, Value>) -> (std::time::Duration, usize) {
+    let wait_ms = arguments.get("wait_ms")
+        .and_then(|v| v.as_u64())
+        .unwrap_or(1000)
+        .min(MAX_STOP_WAIT_MS);
+    let max_results = arguments.get("max_results")
+        .and_then(|v| v.as_u64())
+        .unwrap_or(500) as usize;
+    (std::time::Duration::from_millis(wait_ms), max_results)
+}
+
+pub fn xrefs_to(
+    lldb_manager: &LldbManager,
+    arguments: HashMap<String, Value>,
+) -> IncodeResult<Value> {
+    debug!("Debug Information: xrefs_to called with args: {:?}", arguments);
+
+    let address = code_address(lldb_manager, arguments.get("target"))?
+        .ok_or_else(|| crate::error::IncodeError::invalid_parameter("target (function name or address) is required"))?;
+    let whole_function = arguments.get("whole_function")
+        .and_then(|v| v.as_bool())
+        .unwrap_or(false);
+    let (wait, max_results) = xref_options(&arguments);
+
+    match lldb_manager.xrefs_to(address, whole_function, wait) {
+        Ok(query) => {
+            let mut result = query.to_json(max_results);
+            result["success"] = json!(true);
+            Ok(result)
+        }
+        Err(e) => {
+            error!("Failed to find references to 0x{:x}: {}", address, e);
+            Ok(json!({
+                "success": false,
+                "error": e.to_string()
+            }))
+        }
+    }
+}
+
+pub fn xrefs_from(
+    lldb_manager: &LldbManager,
+    arguments: HashMap<String, Value>,
+) -> IncodeResult<Value> {
+    debug!("Debug Information: xrefs_from called with args: {:?}", arguments);
+
+    let address = code_address(lldb_manager, arguments.get("function"))?
+        .ok_or_else(|| crate::error::IncodeError::invalid_parameter("function (name or address) is required"))?;
+    let include_local_jumps = arguments.get("include_local_jumps")
+        .and_then(|v| v.as_bool())
+        .unwrap_or(false);
+    let (wait, max_results) = xref_options(&arguments);
+
+    match lldb_manager.xrefs_from(address, include_local_jumps, wait) {
+        Ok(query) => {
+            let mut result = query.to_json(max_results);
+            result["success"] = json!(true);
+            Ok(result)
+        }
+        Err(e) => {
+            error!("Failed to find references from 0x{:x}: {}", address, e);
+            Ok(json!({
+                "success": false,
+                "error": e.to_string()
+            }))
+        }
+    }
+}
+
 pub struct ListFunctionsTool;
 
 #[async_trait]
@@ -478,4 +615,136 @@ impl Tool for GetDebugInfoTool {
             Err(e) => Ok(ToolResponse::Error(e.to_string())),
         }
     }
-}
\ No newline at end of file
+}
+pub struct FunctionCfgTool;
+
+#[async_trait]
+impl Tool for FunctionCfgTool {
+    fn name(&self) -> &'static str {
+        "function_cfg"
+    }
+    
+    fn description(&self) -> &'static str {
+        "Build a function's control-flow graph: basic blocks, edges, dominators and loops"
+    }
+    
+    fn parameters(&self) -> Value {
+        json!({
+            "function": {
+                "type": ["string", "number"],
+                "description": "Function name, or any address inside the function"
+            },
+            "module": {
+                "type": "string",
+                "description": "Build graphs for every function of the module whose path contains this, instead of one function"
+            },
+            "max_functions": {
+                "type": "number",
+                "description": "Limit on functions in module mode",
+                "default": 500
+            },
+            "include_graphs": {
+                "type": "boolean",
+                "description": "In module mode, return full graphs instead of per-function summaries",
+                "default": false
+            }
+        })
+    }
+    
+    async fn execute(&self, arguments: HashMap<String, Value>, manager: &mut LldbManager) -> IncodeResult<ToolResponse> {
+        match function_cfg(manager, arguments) {
+            Ok(result) => Ok(ToolResponse::Success(result.to_string())),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+pub struct XrefsToTool;
+
+#[async_trait]
+impl Tool for XrefsToTool {
+    fn name(&self) -> &'static str {
+        "xrefs_to"
+    }
+    
+    fn description(&self) -> &'static str {
+        "Find callers, jumps and data references to an address or function across its module"
+    }
+    
+    fn parameters(&self) -> Value {
+        json!({
+            "target": {
+                "type": ["string", "number"],
+                "description": "Function name or address to find references to"
+            },
+            "whole_function": {
+                "type": "boolean",
+                "description": "Count references to any address inside the containing function, not just the exact address",
+                "default": false
+            },
+            "wait_ms": {
+                "type": "number",
+                "description": "How long to wait for the module sweep; partial results are returned if it is still running",
+                "default": 1000,
+                "maximum": MAX_STOP_WAIT_MS
+            },
+            "max_results": {
+                "type": "number",
+                "description": "Maximum references to return",
+                "default": 500
+            }
+        })
+    }
+    
+    async fn execute(&self, arguments: HashMap<String, Value>, manager: &mut LldbManager) -> IncodeResult<ToolResponse> {
+        match xrefs_to(manager, arguments) {
+            Ok(result) => Ok(ToolResponse::Success(result.to_string())),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+pub struct XrefsFromTool;
+
+#[async_trait]
+impl Tool for XrefsFromTool {
+    fn name(&self) -> &'static str {
+        "xrefs_from"
+    }
+    
+    fn description(&self) -> &'static str {
+        "List the calls, jumps and data references made by a function"
+    }
+    
+    fn parameters(&self) -> Value {
+        json!({
+            "function": {
+                "type": ["string", "number"],
+                "description": "Function name, or any address inside the function"
+            },
+            "include_local_jumps": {
+                "type": "boolean",
+                "description": "Include jumps whose target is inside the function itself",
+                "default": false
+            },
+            "wait_ms": {
+                "type": "number",
+                "description": "How long to wait for the module sweep; partial results are returned if it is still running",
+                "default": 1000,
+                "maximum": MAX_STOP_WAIT_MS
+            },
+            "max_results": {
+                "type": "number",
+                "description": "Maximum references to return",
+                "default": 500
+            }
+        })
+    }
+    
+    async fn execute(&self, arguments: HashMap<String, Value>, manager: &mut LldbManager) -> IncodeResult<ToolResponse> {
+        match xrefs_from(manager, arguments) {
+            Ok(result) => Ok(ToolResponse::Success(result.to_string())),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
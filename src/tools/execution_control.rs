@@ -3,17 +3,44 @@ use serde_json::{json, Value};
 use std::collections::HashMap;
 use tracing::debug;
 use crate::error::{IncodeError, IncodeResult};
-use crate::lldb_manager::LldbManager;
+use crate::checkpoint::Checkpoint;
+use crate::lldb_manager::{LldbManager, MAX_STOP_WAIT_MS};
 use super::{Tool, ToolResponse};
 
-// Execution Control Tools (7 tools)
+// Execution Control Tools (13 tools)
 pub struct ContinueExecutionTool;
+pub struct ContinueAsyncTool;
+pub struct WaitForStopTool;
 pub struct StepOverTool;
 pub struct StepIntoTool;
 pub struct StepOutTool;
 pub struct StepInstructionTool;
 pub struct RunUntilTool;
 pub struct InterruptExecutionTool;
+pub struct CheckpointTool;
+pub struct ListCheckpointsTool;
+pub struct RestoreCheckpointTool;
+pub struct DeleteCheckpointTool;
+
+/// Evaluate watch expressions at the stop just reached. A step that leaves
+/// the process running or exited has nothing to evaluate.
+fn note_stop(lldb_manager: &mut LldbManager) {
+    if let Err(e) = lldb_manager.evaluate_watches() {
+        debug!("Watches not evaluated at this stop: {}", e);
+    }
+}
+
+/// `message`, with any watches that changed since last reported attached
+fn stop_response(lldb_manager: &mut LldbManager, message: String) -> ToolResponse {
+    let changes = lldb_manager.take_watch_changes();
+    if changes.is_empty() {
+        return ToolResponse::Success(message);
+    }
+    ToolResponse::Json(json!({
+        "message": message,
+        "watches": changes.iter().map(|watch| watch.to_json()).collect::<Vec<_>>()
+    }))
+}
 
 
 // F0007: continue_execution - Fully implemented
@@ -48,7 +75,98 @@ impl Tool for ContinueExecutionTool {
     ) -> IncodeResult<ToolResponse> {
         // TODO: Handle thread_id and ignore_breakpoints parameters in future iterations
         match lldb_manager.continue_execution() {
-            Ok(_) => Ok(ToolResponse::Success("Process execution continued successfully".to_string())),
+            Ok(_) => {
+                note_stop(lldb_manager);
+                Ok(stop_response(lldb_manager, "Process execution continued successfully".to_string()))
+            }
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+// continue_async - resume without blocking the server
+#[async_trait]
+impl Tool for ContinueAsyncTool {
+    fn name(&self) -> &'static str {
+        "continue_async"
+    }
+
+    fn description(&self) -> &'static str {
+        "Resume process execution and return immediately (pair with wait_for_stop or interrupt_execution)"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({})
+    }
+
+    async fn execute(
+        &self,
+        _arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        match lldb_manager.continue_async() {
+            Ok(_) => Ok(ToolResponse::Success("Process resumed - use wait_for_stop to wait for the next stop".to_string())),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+// wait_for_stop - wait for the next stop event with a timeout
+#[async_trait]
+impl Tool for WaitForStopTool {
+    fn name(&self) -> &'static str {
+        "wait_for_stop"
+    }
+
+    fn description(&self) -> &'static str {
+        "Wait for the process to stop after continue_async, or time out while it keeps running"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "timeout_ms": {
+                "type": "integer",
+                "description": "Maximum time in milliseconds to wait for a stop event; longer runs take repeated calls",
+                "default": 5000,
+                "minimum": 0,
+                "maximum": MAX_STOP_WAIT_MS
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let timeout_ms = arguments.get("timeout_ms")
+            .and_then(|v| v.as_u64())
+            .unwrap_or(5000)
+            .min(MAX_STOP_WAIT_MS);
+
+        match lldb_manager.wait_for_stop(timeout_ms) {
+            Ok(stop) => {
+                note_stop(lldb_manager);
+                let mut result = json!({
+                    "stopped": true,
+                    "timed_out": false,
+                    "pid": stop.pid,
+                    "state": stop.state,
+                    "thread_id": stop.thread_id,
+                    "stop_reason": stop.stop_reason,
+                    "exit_status": stop.exit_status,
+                    "elapsed_ms": stop.elapsed_ms
+                });
+                let changes = lldb_manager.take_watch_changes();
+                if !changes.is_empty() {
+                    result["watches"] = json!(changes.iter().map(|watch| watch.to_json()).collect::<Vec<_>>());
+                }
+                Ok(ToolResponse::Json(result))
+            }
+            Err(IncodeError::Timeout) => Ok(ToolResponse::Json(json!({
+                "stopped": false,
+                "timed_out": true,
+                "timeout_ms": timeout_ms,
+                "message": "Process is still running - call wait_for_stop again or interrupt_execution"
+            }))),
             Err(e) => Ok(ToolResponse::Error(e.to_string())),
         }
     }
@@ -87,6 +205,7 @@ impl Tool for StepOverTool {
         for i in 0..count {
             match lldb_manager.step_over() {
                 Ok(_) => {
+                    note_stop(lldb_manager);
                     if count > 1 {
                         debug!("Completed step {} of {}", i + 1, count);
                     }
@@ -107,7 +226,7 @@ impl Tool for StepOverTool {
         } else {
             "Successfully stepped over current instruction".to_string()
         };
-        Ok(ToolResponse::Success(msg))
+        Ok(stop_response(lldb_manager, msg))
     }
 }
 // F0009: step_into - Fully implemented
@@ -152,6 +271,7 @@ impl Tool for StepIntoTool {
         for i in 0..count {
             match lldb_manager.step_into() {
                 Ok(_) => {
+                    note_stop(lldb_manager);
                     if count > 1 {
                         debug!("Completed step into {} of {}", i + 1, count);
                     }
@@ -172,7 +292,7 @@ impl Tool for StepIntoTool {
         } else {
             "Successfully stepped into function call".to_string()
         };
-        Ok(ToolResponse::Success(msg))
+        Ok(stop_response(lldb_manager, msg))
     }
 }
 // F0010: step_out - Fully implemented
@@ -209,6 +329,7 @@ impl Tool for StepOutTool {
         for i in 0..count {
             match lldb_manager.step_out() {
                 Ok(_) => {
+                    note_stop(lldb_manager);
                     if count > 1 {
                         debug!("Completed step out {} of {}", i + 1, count);
                     }
@@ -229,7 +350,7 @@ impl Tool for StepOutTool {
         } else {
             "Successfully stepped out of current function".to_string()
         };
-        Ok(ToolResponse::Success(msg))
+        Ok(stop_response(lldb_manager, msg))
     }
 }
 // F0011: step_instruction - Fully implemented
@@ -275,6 +396,7 @@ impl Tool for StepInstructionTool {
         for i in 0..count {
             match lldb_manager.step_instruction(step_over) {
                 Ok(_) => {
+                    note_stop(lldb_manager);
                     if count > 1 {
                         debug!("Completed instruction step {} of {}", i + 1, count);
                     }
@@ -296,7 +418,7 @@ impl Tool for StepInstructionTool {
         } else {
             format!("Successfully stepped {} single instruction", step_type)
         };
-        Ok(ToolResponse::Success(msg))
+        Ok(stop_response(lldb_manager, msg))
     }
 }
 // F0012: run_until - Fully implemented
@@ -385,7 +507,8 @@ impl Tool for RunUntilTool {
                 } else {
                     "Successfully initiated run until operation".to_string()
                 };
-                Ok(ToolResponse::Success(msg))
+                note_stop(lldb_manager);
+                Ok(stop_response(lldb_manager, msg))
             }
             Err(e) => Ok(ToolResponse::Error(e.to_string())),
         }
@@ -429,4 +552,167 @@ impl Tool for InterruptExecutionTool {
             Err(e) => Ok(ToolResponse::Error(e.to_string())),
         }
     }
-}
\ No newline at end of file
+}
+// Checkpoints: checkpoint / list_checkpoints / restore_checkpoint / delete_checkpoint
+#[async_trait]
+impl Tool for CheckpointTool {
+    fn name(&self) -> &'static str {
+        "checkpoint"
+    }
+
+    fn description(&self) -> &'static str {
+        "Save the stopped process as a frozen fork() clone that can be restored later"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "description": {
+                "type": "string",
+                "description": "Note to identify the checkpoint"
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let description = arguments.get("description").and_then(|v| v.as_str());
+
+        match lldb_manager.checkpoint(description) {
+            Ok(checkpoint) => Ok(ToolResponse::Json(checkpoint_json(&checkpoint))),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+#[async_trait]
+impl Tool for ListCheckpointsTool {
+    fn name(&self) -> &'static str {
+        "list_checkpoints"
+    }
+
+    fn description(&self) -> &'static str {
+        "List saved checkpoints and whether their frozen processes are still alive"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({})
+    }
+
+    async fn execute(
+        &self,
+        _arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let checkpoints: Vec<Value> = lldb_manager.list_checkpoints().iter().map(checkpoint_json).collect();
+        Ok(ToolResponse::Json(json!({
+            "count": checkpoints.len(),
+            "checkpoints": checkpoints
+        })))
+    }
+}
+
+#[async_trait]
+impl Tool for RestoreCheckpointTool {
+    fn name(&self) -> &'static str {
+        "restore_checkpoint"
+    }
+
+    fn description(&self) -> &'static str {
+        "Kill the current process and continue debugging from a checkpoint"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "checkpoint_id": {
+                "type": "integer",
+                "description": "Checkpoint to restore"
+            },
+            "keep": {
+                "type": "boolean",
+                "description": "Re-take the checkpoint after restoring so it can be restored again",
+                "default": false
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let id = arguments.get("checkpoint_id")
+            .and_then(|v| v.as_u64())
+            .ok_or_else(|| IncodeError::mcp("Missing required parameter: checkpoint_id"))? as u32;
+        let keep = arguments.get("keep").and_then(|v| v.as_bool()).unwrap_or(false);
+
+        match lldb_manager.restore_checkpoint(id, keep) {
+            Ok(restore) => Ok(ToolResponse::Json(json!({
+                "restored": checkpoint_json(&restore.checkpoint),
+                "pid": restore.pid,
+                "pc": format!("0x{:x}", restore.pc),
+                "pc_matches": restore.pc_matches,
+                "registers_restored": restore.registers_restored,
+                "registers_failed": restore.registers_failed,
+                "kept": restore.kept.as_ref().map(checkpoint_json)
+            }))),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+#[async_trait]
+impl Tool for DeleteCheckpointTool {
+    fn name(&self) -> &'static str {
+        "delete_checkpoint"
+    }
+
+    fn description(&self) -> &'static str {
+        "Discard a checkpoint and kill its frozen process"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "checkpoint_id": {
+                "type": "integer",
+                "description": "Checkpoint to delete"
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let id = arguments.get("checkpoint_id")
+            .and_then(|v| v.as_u64())
+            .ok_or_else(|| IncodeError::mcp("Missing required parameter: checkpoint_id"))? as u32;
+
+        match lldb_manager.delete_checkpoint(id) {
+            Ok(checkpoint) => Ok(ToolResponse::Success(format!(
+                "Deleted checkpoint {} (PID {})", checkpoint.id, checkpoint.pid
+            ))),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+fn checkpoint_json(checkpoint: &Checkpoint) -> Value {
+    json!({
+        "id": checkpoint.id,
+        "pid": checkpoint.pid,
+        "origin_pid": checkpoint.origin_pid,
+        "thread_id": checkpoint.thread_id,
+        "pc": format!("0x{:x}", checkpoint.pc),
+        "description": checkpoint.description,
+        "created_at": checkpoint.created_at
+            .duration_since(std::time::UNIX_EPOCH)
+            .map(|d| d.as_secs())
+            .unwrap_or(0),
+        "registers_saved": checkpoint.registers.len(),
+        "alive": crate::checkpoint::clone_alive(checkpoint.pid)
+    })
+}
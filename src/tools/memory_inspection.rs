@@ -2,6 +2,7 @@ use async_trait::async_trait;
 use serde_json::{json, Value};
 use std::collections::HashMap;
 use crate::error::{IncodeError, IncodeResult};
+use crate::disassembly::Instruction;
 use crate::lldb_manager::LldbManager;
 use super::{Tool, ToolResponse};
 
@@ -326,8 +327,8 @@ impl Tool for DisassembleTool {
             },
             "format": {
                 "type": "string",
-                "description": "Disassembly output format",
-                "enum": ["default", "verbose", "compact"],
+                "description": "Disassembly output format; structured returns one object per instruction with its branch target and symbol",
+                "enum": ["default", "verbose", "compact", "structured"],
                 "default": "default"
             }
         })
@@ -358,20 +359,24 @@ impl Tool for DisassembleTool {
             u64::from_str_radix(address_str, 16)
                 .map_err(|_| IncodeError::mcp(format!("Invalid address format: {}", address_str)))?
         } else {
-            // TODO: Implement function name to address resolution
-            return Ok(ToolResponse::Error(format!("Function name resolution not yet implemented: {}", address_str)));
+            match lldb_manager.function_address(address_str) {
+                Ok(address) => address,
+                Err(e) => return Ok(ToolResponse::Error(e.to_string())),
+            }
         };
 
-        match lldb_manager.disassemble(address, count) {
-            Ok(instructions) => {
-                let formatted_instructions = Self::format_disassembly(&instructions, format);
+        match lldb_manager.disassemble_instructions(address, count) {
+            Ok(disassembly) => {
+                let formatted_instructions = Self::format_disassembly(&disassembly.instructions, format);
                 
                 Ok(ToolResponse::Json(json!({
-                    "address": format!("0x{:x}", address),
-                    "count": instructions.len(),
+                    "address": format!("0x{:x}", disassembly.address),
+                    "function": disassembly.function,
+                    "count": disassembly.instructions.len(),
                     "format": format,
                     "instructions": formatted_instructions,
-                    "message": format!("Disassembled {} instructions from address 0x{:x}", instructions.len(), address)
+                    "cached": disassembly.cached,
+                    "message": format!("Disassembled {} instructions from address 0x{:x}", disassembly.instructions.len(), disassembly.address)
                 })))
             }
             Err(e) => Ok(ToolResponse::Error(e.to_string())),
@@ -380,22 +385,26 @@ impl Tool for DisassembleTool {
 }
 
 impl DisassembleTool {
-    fn format_disassembly(instructions: &[String], format: &str) -> Value {
+    fn format_disassembly(instructions: &[Instruction], format: &str) -> Value {
         match format {
             "compact" => {
                 let compact: Vec<String> = instructions.iter()
-                    .map(|inst| inst.split(": ").nth(1).unwrap_or(inst).to_string())
+                    .map(|inst| {
+                        let text = inst.text();
+                        text.split_once(": ").map_or(text.clone(), |(_, rest)| rest.to_string())
+                    })
                     .collect();
                 json!(compact)
             },
             "verbose" => {
                 let verbose: Vec<String> = instructions.iter()
                     .enumerate()
-                    .map(|(i, inst)| format!("[{}] {}", i + 1, inst))
+                    .map(|(i, inst)| format!("[{}] {}", i + 1, inst.text()))
                     .collect();
                 json!(verbose)
             },
-            _ => json!(instructions) // default format
+            "structured" => json!(instructions.iter().map(Instruction::to_json).collect::<Vec<_>>()),
+            _ => json!(instructions.iter().map(Instruction::text).collect::<Vec<_>>()) // default format
         }
     }
 }
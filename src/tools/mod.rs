@@ -108,7 +108,10 @@ impl ToolRegistry {
         let tool = self.tools.get(name)
             .ok_or_else(|| IncodeError::mcp(format!("Unknown tool: {}", name)))?;
         
-        tool.execute(arguments, lldb_manager).await
+        let response = tool.execute(arguments, lldb_manager).await;
+        // Whatever the tool cached is held to the memory budget before the next request
+        lldb_manager.enforce_cache_budget();
+        response
     }
 
     // Tool registration methods for each category
@@ -120,16 +123,26 @@ impl ToolRegistry {
         self.register_tool(Box::new(process_control::KillProcessTool));
         self.register_tool(Box::new(process_control::GetProcessInfoTool));
         self.register_tool(Box::new(process_control::ListProcessesTool));
+        self.register_tool(Box::new(process_control::SetForkPolicyTool));
+        self.register_tool(Box::new(process_control::ListChildSessionsTool));
+        self.register_tool(Box::new(process_control::ControlChildSessionTool));
+        self.register_tool(Box::new(process_control::SnapshotProcessesTool));
     }
 
     fn register_execution_control_tools(&mut self) {
         self.register_tool(Box::new(execution_control::ContinueExecutionTool));
+        self.register_tool(Box::new(execution_control::ContinueAsyncTool));
+        self.register_tool(Box::new(execution_control::WaitForStopTool));
         self.register_tool(Box::new(execution_control::StepOverTool));
         self.register_tool(Box::new(execution_control::StepIntoTool));
         self.register_tool(Box::new(execution_control::StepOutTool));
         self.register_tool(Box::new(execution_control::StepInstructionTool));
         self.register_tool(Box::new(execution_control::RunUntilTool));
         self.register_tool(Box::new(execution_control::InterruptExecutionTool));
+        self.register_tool(Box::new(execution_control::CheckpointTool));
+        self.register_tool(Box::new(execution_control::ListCheckpointsTool));
+        self.register_tool(Box::new(execution_control::RestoreCheckpointTool));
+        self.register_tool(Box::new(execution_control::DeleteCheckpointTool));
     }
 
     fn register_breakpoint_tools(&mut self) {
@@ -173,6 +186,11 @@ impl ToolRegistry {
         self.register_tool(Box::new(variables::GetVariableInfoTool));
         self.register_tool(Box::new(variables::SetVariableTool));
         self.register_tool(Box::new(variables::LookupSymbolTool));
+        self.register_tool(Box::new(variables::PrepareExpressionTool));
+        self.register_tool(Box::new(variables::DecodeContainerTool));
+        self.register_tool(Box::new(variables::AddWatchExpressionTool));
+        self.register_tool(Box::new(variables::ListWatchExpressionsTool));
+        self.register_tool(Box::new(variables::GetWatchesTool));
         // Keep placeholder for backward compatibility
         self.register_tool(Box::new(variables::PlaceholderTool));
     }
@@ -183,6 +201,7 @@ impl ToolRegistry {
         self.register_tool(Box::new(thread_management::GetThreadInfoTool));
         self.register_tool(Box::new(thread_management::SuspendThreadTool));
         self.register_tool(Box::new(thread_management::ResumeThreadTool));
+        self.register_tool(Box::new(thread_management::ReadThreadLocalTool));
         // Keep placeholder for backward compatibility
         self.register_tool(Box::new(threads::PlaceholderTool));
     }
@@ -192,6 +211,8 @@ impl ToolRegistry {
         self.register_tool(Box::new(register_inspection::SetRegisterTool));
         self.register_tool(Box::new(register_inspection::GetRegisterInfoTool));
         self.register_tool(Box::new(register_inspection::SaveRegisterStateTool));
+        self.register_tool(Box::new(register_inspection::GetStopDeltaTool));
+        self.register_tool(Box::new(register_inspection::WatchMemoryTool));
         // Keep placeholder for backward compatibility
         self.register_tool(Box::new(registers::PlaceholderTool));
     }
@@ -201,6 +222,9 @@ impl ToolRegistry {
         self.register_tool(Box::new(debug_information::ListFunctionsTool));
         self.register_tool(Box::new(debug_information::GetLineInfoTool));
         self.register_tool(Box::new(debug_information::GetDebugInfoTool));
+        self.register_tool(Box::new(debug_information::FunctionCfgTool));
+        self.register_tool(Box::new(debug_information::XrefsToTool));
+        self.register_tool(Box::new(debug_information::XrefsFromTool));
         // Keep placeholder for backward compatibility
         self.register_tool(Box::new(debug_info::PlaceholderTool));
     }
@@ -223,6 +247,7 @@ impl ToolRegistry {
         self.register_tool(Box::new(session_management::SaveSessionTool));
         self.register_tool(Box::new(session_management::LoadSessionTool));
         self.register_tool(Box::new(session_management::CleanupSessionTool));
+        self.register_tool(Box::new(session_management::ManageMemoryTool));
         // Keep placeholder for compatibility
         self.register_tool(Box::new(session_management::PlaceholderTool));
     }
@@ -230,6 +255,8 @@ impl ToolRegistry {
     fn register_advanced_analysis_tools(&mut self) {
         self.register_tool(Box::new(advanced_analysis::AnalyzeCrashTool));
         self.register_tool(Box::new(advanced_analysis::GenerateCoreDumpTool));
+        self.register_tool(Box::new(advanced_analysis::LoadCoreTool));
+        self.register_tool(Box::new(advanced_analysis::TriageCoresTool));
         // Keep placeholder for compatibility
         self.register_tool(Box::new(advanced_analysis::PlaceholderTool));
     }
@@ -2,10 +2,17 @@ use async_trait::async_trait;
 use serde_json::{json, Value};
 use std::collections::HashMap;
 
+use crate::console_buffer::ConsoleBuffer;
 use crate::error::{IncodeError, IncodeResult};
-use crate::lldb_manager::LldbManager;
+use crate::fleet_snapshot::SnapshotOptions;
+use crate::fork_follower::{ChildCommand, ChildSessionInfo, ForkPolicy};
+use crate::lldb_manager::{LaunchOptions, LldbManager, MAX_STOP_WAIT_MS};
+use crate::process_table::ProcessFilter;
 use super::{Tool, ToolResponse};
 
+/// Console bytes returned by one read unless the caller asks for more
+const DEFAULT_CONSOLE_READ_BYTES: usize = 64 * 1024;
+
 // F0001: launch_process
 pub struct LaunchProcessTool;
 
@@ -37,6 +44,26 @@ impl Tool for LaunchProcessTool {
             "working_dir": {
                 "type": "string",
                 "description": "Working directory for the process"
+            },
+            "stop_at_entry": {
+                "type": "boolean",
+                "description": "Stop at the program entry point before any user code runs",
+                "default": false
+            },
+            "preload_dependents": {
+                "type": "boolean",
+                "description": "Load all dependent shared libraries when creating the target",
+                "default": false
+            },
+            "load_symbols_on_demand": {
+                "type": "boolean",
+                "description": "Only load symbols and debug info for modules as they are needed",
+                "default": true
+            },
+            "wait_for_stop_ms": {
+                "type": "integer",
+                "description": "Wait up to this long for the first stop (e.g. a breakpoint) and report its timing",
+                "maximum": MAX_STOP_WAIT_MS
             }
         })
     }
@@ -65,41 +92,40 @@ impl Tool for LaunchProcessTool {
         let working_dir = arguments.get("working_dir")
             .and_then(|v| v.as_str());
 
-        // Handle working directory by changing current directory if specified
-        let original_dir = if let Some(wd) = working_dir {
-            let current = std::env::current_dir().ok();
-            if let Err(e) = std::env::set_current_dir(wd) {
-                return Ok(ToolResponse::Error(format!("Failed to change to working directory {}: {}", wd, e)));
-            }
-            current
-        } else {
-            None
+        let options = LaunchOptions {
+            args,
+            env,
+            working_dir: working_dir.map(String::from),
+            stop_at_entry: arguments.get("stop_at_entry").and_then(|v| v.as_bool()).unwrap_or(false),
+            preload_dependents: arguments.get("preload_dependents").and_then(|v| v.as_bool()).unwrap_or(false),
+            load_symbols_on_demand: arguments.get("load_symbols_on_demand").and_then(|v| v.as_bool()).unwrap_or(true),
+            wait_for_stop_ms: arguments.get("wait_for_stop_ms").and_then(|v| v.as_u64()).map(|ms| ms.min(MAX_STOP_WAIT_MS)),
         };
 
-        // Launch the process
-        let result = lldb_manager.launch_process(executable, &args, &env);
-
-        // Restore original directory if we changed it
-        if let Some(orig_dir) = original_dir {
-            if let Err(e) = std::env::set_current_dir(&orig_dir) {
-                eprintln!("Warning: Failed to restore original directory: {}", e);
-            }
-        }
-
-        match result {
-            Ok(pid) => {
+        match lldb_manager.launch_process_with(executable, &options) {
+            Ok(report) => {
                 // Get initial console output from the launched process
-                let console_output = lldb_manager.get_console_output()
+                let console_output = lldb_manager.get_console_output(None, DEFAULT_CONSOLE_READ_BYTES, None)
+                    .map(|read| read.text())
                     .unwrap_or_else(|_| "No console output available yet".to_string());
                 
                 Ok(ToolResponse::Json(json!({
                     "success": true,
-                    "pid": pid,
+                    "pid": report.pid,
+                    "state": report.state,
                     "executable": executable,
                     "working_dir": working_dir,
-                    "message": format!("Successfully launched process {} with PID {} - process running independently", executable, pid),
+                    "modules_at_exec": report.modules_at_exec,
+                    "modules_loaded": report.modules_loaded,
+                    "timing": {
+                        "target_create_ms": report.timing.target_create_ms,
+                        "exec_ms": report.timing.exec_ms,
+                        "first_stop_ms": report.timing.first_stop_ms,
+                        "total_ms": report.timing.total_ms
+                    },
+                    "message": format!("Successfully launched process {} with PID {} ({})", executable, report.pid, report.state),
                     "console_output": console_output,
-                    "note": "Process is running independently. Use get_console_output to read more output."
+                    "note": "Use get_console_output to read more output."
                 })))
             },
             Err(e) => Ok(ToolResponse::Error(e.to_string())),
@@ -117,24 +143,57 @@ impl Tool for GetConsoleOutputTool {
     }
 
     fn description(&self) -> &'static str {
-        "Get current console output (stdout/stderr) from the running debugged process"
+        "Get new console output (stdout/stderr) from the debugged process, resuming from a cursor"
     }
 
     fn parameters(&self) -> Value {
-        json!({})
+        json!({
+            "cursor": {
+                "type": "integer",
+                "description": "next_cursor from a previous call; omit to continue after the last call without a cursor"
+            },
+            "max_bytes": {
+                "type": "integer",
+                "description": "Maximum bytes of output to consume",
+                "default": DEFAULT_CONSOLE_READ_BYTES
+            },
+            "pattern": {
+                "type": "string",
+                "description": "Only return lines containing this text"
+            }
+        })
     }
 
     async fn execute(
         &self,
-        _arguments: HashMap<String, Value>,
+        arguments: HashMap<String, Value>,
         lldb_manager: &mut LldbManager,
     ) -> IncodeResult<ToolResponse> {
-        match lldb_manager.get_console_output() {
-            Ok(output) => Ok(ToolResponse::Json(json!({
-                "success": true,
-                "console_output": output,
-                "message": "Retrieved console output from running process"
-            }))),
+        let cursor = arguments.get("cursor").and_then(|v| v.as_u64());
+        let max_bytes = arguments.get("max_bytes")
+            .and_then(|v| v.as_u64())
+            .map(|n| (n as usize).clamp(1, ConsoleBuffer::DEFAULT_CAPACITY))
+            .unwrap_or(DEFAULT_CONSOLE_READ_BYTES);
+        let pattern = arguments.get("pattern").and_then(|v| v.as_str());
+
+        match lldb_manager.get_console_output(cursor, max_bytes, pattern) {
+            Ok(read) => {
+                let segments: Vec<Value> = read.segments.iter().map(|segment| json!({
+                    "stream": segment.stream.as_str(),
+                    "seq": segment.seq,
+                    "text": segment.text
+                })).collect();
+
+                Ok(ToolResponse::Json(json!({
+                    "success": true,
+                    "console_output": read.text(),
+                    "segments": segments,
+                    "next_cursor": read.next_cursor,
+                    "dropped_bytes": read.dropped_bytes,
+                    "has_more": read.has_more,
+                    "message": format!("Retrieved {} console segments", segments.len())
+                })))
+            }
             Err(e) => Ok(ToolResponse::Error(e.to_string())),
         }
     }
@@ -308,14 +367,26 @@ impl Tool for ListProcessesTool {
     }
 
     fn description(&self) -> &'static str {
-        "List all debuggable processes on system"
+        "List all debuggable processes on system, filtered by name, command line, user or parent PID"
     }
 
     fn parameters(&self) -> Value {
         json!({
             "filter": {
                 "type": "string",
-                "description": "Filter processes by name pattern"
+                "description": "Filter processes by name or executable path pattern"
+            },
+            "cmdline": {
+                "type": "string",
+                "description": "Filter processes whose full command line contains this pattern"
+            },
+            "user": {
+                "type": "string",
+                "description": "Filter processes by owning user name or numeric UID"
+            },
+            "parent_pid": {
+                "type": "integer",
+                "description": "Only list direct children of this process ID"
             },
             "include_system": {
                 "type": "boolean",
@@ -330,19 +401,33 @@ impl Tool for ListProcessesTool {
         arguments: HashMap<String, Value>,
         lldb_manager: &mut LldbManager,
     ) -> IncodeResult<ToolResponse> {
-        let filter = arguments.get("filter")
-            .and_then(|v| v.as_str());
-
-        let include_system = arguments.get("include_system")
-            .and_then(|v| v.as_bool())
-            .unwrap_or(false);
+        let string_arg = |key: &str| arguments.get(key)
+            .and_then(|v| v.as_str())
+            .map(|s| s.to_string());
+
+        let filter = ProcessFilter {
+            name: string_arg("filter"),
+            cmdline: string_arg("cmdline"),
+            user: string_arg("user"),
+            parent_pid: arguments.get("parent_pid")
+                .and_then(|v| v.as_u64())
+                .map(|pid| pid as u32),
+            include_system: arguments.get("include_system")
+                .and_then(|v| v.as_bool())
+                .unwrap_or(false),
+        };
 
-        match lldb_manager.list_processes(filter, include_system) {
+        match lldb_manager.find_processes(&filter) {
             Ok(processes) => {
                 let process_data: Vec<Value> = processes.into_iter().map(|p| json!({
                     "pid": p.pid,
+                    "ppid": p.ppid,
+                    "name": p.name,
                     "state": p.state,
                     "executable_path": p.executable_path,
+                    "cmdline": p.cmdline,
+                    "user": p.user,
+                    "uid": p.uid,
                     "memory_usage": p.memory_usage
                 })).collect();
 
@@ -354,4 +439,286 @@ impl Tool for ListProcessesTool {
             Err(e) => Ok(ToolResponse::Error(e.to_string())),
         }
     }
-}
\ No newline at end of file
+}
+// Fork following: set_fork_policy
+pub struct SetForkPolicyTool;
+
+#[async_trait]
+impl Tool for SetForkPolicyTool {
+    fn name(&self) -> &'static str {
+        "set_fork_policy"
+    }
+
+    fn description(&self) -> &'static str {
+        "Choose whether fork/vfork follows the parent, the child, or debugs both (each child in its own session)"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "policy": {
+                "type": "string",
+                "enum": ["parent", "child", "both"],
+                "description": "Which process stays under the debugger after fork"
+            },
+            "stop_on_exec": {
+                "type": "boolean",
+                "description": "Stop when the debuggee calls exec"
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let policy = arguments.get("policy")
+            .and_then(|v| v.as_str())
+            .ok_or_else(|| IncodeError::mcp("Missing policy parameter"))?;
+        let policy = match ForkPolicy::parse(policy) {
+            Ok(policy) => policy,
+            Err(e) => return Ok(ToolResponse::Error(e.to_string())),
+        };
+        let stop_on_exec = arguments.get("stop_on_exec").and_then(|v| v.as_bool());
+
+        match lldb_manager.set_fork_policy(policy, stop_on_exec) {
+            Ok(()) => Ok(ToolResponse::Json(json!({
+                "success": true,
+                "policy": policy.as_str(),
+                "stop_on_exec": stop_on_exec,
+                "message": format!("Fork policy set to {}", policy.as_str())
+            }))),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+// Fork following: list_child_sessions
+pub struct ListChildSessionsTool;
+
+#[async_trait]
+impl Tool for ListChildSessionsTool {
+    fn name(&self) -> &'static str {
+        "list_child_sessions"
+    }
+
+    fn description(&self) -> &'static str {
+        "List forked child processes being debugged under the 'both' fork policy"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({})
+    }
+
+    async fn execute(
+        &self,
+        _arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let children: Vec<Value> = lldb_manager.list_child_sessions().iter().map(child_session_json).collect();
+
+        Ok(ToolResponse::Json(json!({
+            "policy": lldb_manager.fork_policy().as_str(),
+            "children": children,
+            "count": children.len()
+        })))
+    }
+}
+
+// Fork following: control_child_session
+pub struct ControlChildSessionTool;
+
+#[async_trait]
+impl Tool for ControlChildSessionTool {
+    fn name(&self) -> &'static str {
+        "control_child_session"
+    }
+
+    fn description(&self) -> &'static str {
+        "Continue, interrupt, kill or detach a followed child process"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "pid": {
+                "type": "integer",
+                "description": "PID of the child process"
+            },
+            "action": {
+                "type": "string",
+                "enum": ["continue", "interrupt", "kill", "detach"],
+                "description": "What to do with the child"
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let pid = arguments.get("pid")
+            .and_then(|v| v.as_u64())
+            .ok_or_else(|| IncodeError::mcp("Missing pid parameter"))? as u32;
+        let action = arguments.get("action")
+            .and_then(|v| v.as_str())
+            .ok_or_else(|| IncodeError::mcp("Missing action parameter"))?;
+        let command = match ChildCommand::parse(action) {
+            Ok(command) => command,
+            Err(e) => return Ok(ToolResponse::Error(e.to_string())),
+        };
+
+        match lldb_manager.control_child_session(pid, command) {
+            Ok(child) => Ok(ToolResponse::Json(json!({
+                "success": true,
+                "action": action,
+                "child": child_session_json(&child)
+            }))),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+fn child_session_json(child: &ChildSessionInfo) -> Value {
+    json!({
+        "session_id": child.session_id.to_string(),
+        "pid": child.pid,
+        "parent_pid": child.parent_pid,
+        "state": child.state,
+        "stop_reason": child.stop_reason,
+        "breakpoints": child.breakpoints,
+        "attach_ms": child.attach_ms,
+        "error": child.error
+    })
+}
+
+// Fleet inspection: snapshot_processes
+pub struct SnapshotProcessesTool;
+
+#[async_trait]
+impl Tool for SnapshotProcessesTool {
+    fn name(&self) -> &'static str {
+        "snapshot_processes"
+    }
+
+    fn description(&self) -> &'static str {
+        "Attach to every matching process in parallel, collect deduplicated stacks, focus-thread registers and memory stats, then detach"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "filter": {
+                "type": "string",
+                "description": "Substring of the process name or executable path"
+            },
+            "cmdline": {
+                "type": "string",
+                "description": "Substring of the full command line"
+            },
+            "user": {
+                "type": "string",
+                "description": "Owning user name or numeric UID"
+            },
+            "parent_pid": {
+                "type": "integer",
+                "description": "Only snapshot direct children of this process ID (e.g. prefork workers)"
+            },
+            "max_concurrency": {
+                "type": "integer",
+                "description": "Processes attached at the same time",
+                "default": 8
+            },
+            "max_processes": {
+                "type": "integer",
+                "description": "Fail instead of snapshotting more processes than this",
+                "default": 256
+            },
+            "max_frames": {
+                "type": "integer",
+                "description": "Frames captured per thread",
+                "default": 64
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let string_arg = |key: &str| arguments.get(key)
+            .and_then(|v| v.as_str())
+            .map(|s| s.to_string());
+        let number_arg = |key: &str| arguments.get(key).and_then(|v| v.as_u64());
+
+        let filter = ProcessFilter {
+            name: string_arg("filter"),
+            cmdline: string_arg("cmdline"),
+            user: string_arg("user"),
+            parent_pid: number_arg("parent_pid").map(|pid| pid as u32),
+            include_system: false,
+        };
+        if filter.name.is_none() && filter.cmdline.is_none() && filter.parent_pid.is_none() {
+            return Ok(ToolResponse::Error("At least one of filter, cmdline or parent_pid is required".to_string()));
+        }
+
+        let defaults = SnapshotOptions::default();
+        let options = SnapshotOptions {
+            filter,
+            max_concurrency: number_arg("max_concurrency").map_or(defaults.max_concurrency, |n| n as usize),
+            max_processes: number_arg("max_processes").map_or(defaults.max_processes, |n| n as usize),
+            max_frames: number_arg("max_frames").map_or(defaults.max_frames, |n| n as u32),
+        };
+
+        match lldb_manager.snapshot_processes(&options) {
+            Ok(snapshot) => {
+                let processes: Vec<Value> = snapshot.processes.iter().map(|p| json!({
+                    "pid": p.pid,
+                    "name": p.name,
+                    "thread_count": p.thread_count,
+                    "stack_ids": p.stack_ids,
+                    "stopped_ms": p.stopped_ms,
+                    "error": p.error,
+                    "focus_thread": p.focus_thread.as_ref().map(|t| json!({
+                        "tid": t.tid,
+                        "reason": t.reason,
+                        "stop_reason": t.stop_reason,
+                        "cpu_ticks": t.cpu_ticks,
+                        "registers": t.registers.iter()
+                            .map(|(name, value)| (name.clone(), json!(format!("0x{:x}", value))))
+                            .collect::<serde_json::Map<String, Value>>()
+                    })),
+                    "regions": p.regions.as_ref().map(|r| json!({
+                        "count": r.count,
+                        "mapped_bytes": r.mapped_bytes,
+                        "writable_bytes": r.writable_bytes,
+                        "executable_bytes": r.executable_bytes,
+                        "anonymous_bytes": r.anonymous_bytes
+                    }))
+                })).collect();
+
+                let unique_stacks: Vec<Value> = snapshot.unique_stacks.iter().map(|s| json!({
+                    "id": s.id,
+                    "thread_count": s.thread_count,
+                    "process_count": s.pids.len(),
+                    "pids": s.pids,
+                    "frames": s.frames
+                })).collect();
+
+                let failed = snapshot.processes.iter().filter(|p| p.error.is_some()).count();
+
+                Ok(ToolResponse::Json(json!({
+                    "success": true,
+                    "process_count": processes.len(),
+                    "failed_count": failed,
+                    "thread_count": snapshot.thread_count,
+                    "unique_stack_count": unique_stacks.len(),
+                    "elapsed_ms": snapshot.elapsed_ms,
+                    "unique_stacks": unique_stacks,
+                    "processes": processes
+                })))
+            }
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
@@ -1,4 +1,5 @@
-use crate::lldb_manager::{LldbManager, RegisterInfo};
+use crate::lldb_manager::LldbManager;
+use crate::register_schema::RegisterValues;
 use crate::error::IncodeResult;
 use crate::tools::{Tool, ToolResponse};
 use std::collections::HashMap;
@@ -22,48 +23,65 @@ pub fn get_registers(
         
     let register_filter = arguments.get("register_filter")
         .and_then(|v| v.as_str());
-    
-    match lldb_manager.get_registers(thread_id, include_metadata) {
-        Ok(register_state) => {
-            debug!("Found {} registers", register_state.registers.len());
-            
-            // Apply filter if specified
-            let filtered_registers: Vec<(&String, &RegisterInfo)> = if let Some(filter) = register_filter {
-                register_state.registers.iter()
-                    .filter(|(name, _)| name.to_lowercase().contains(&filter.to_lowercase()))
-                    .collect()
-            } else {
-                register_state.registers.iter().collect()
-            };
-            
-            let register_list: Vec<Value> = filtered_registers.iter().map(|(_, reg_info)| {
-                if include_metadata {
-                    json!({
-                        "name": reg_info.name,
-                        "value": format!("0x{:x}", reg_info.value),
-                        "decimal_value": reg_info.value,
-                        "size": reg_info.size,
-                        "type": reg_info.register_type,
-                        "format": reg_info.format,
-                        "is_valid": reg_info.is_valid
-                    })
-                } else {
+
+    let all_threads = arguments.get("all_threads")
+        .and_then(|v| v.as_bool())
+        .unwrap_or(false);
+
+    let timestamp = std::time::SystemTime::now().duration_since(std::time::UNIX_EPOCH)
+        .unwrap_or_default().as_secs();
+
+    if all_threads {
+        return match lldb_manager.read_all_thread_registers() {
+            Ok(threads) => {
+                debug!("Read registers of {} threads", threads.len());
+                let thread_list: Vec<Value> = threads.iter().map(|values| {
+                    let register_list = register_list(values, register_filter, include_metadata);
                     json!({
-                        "name": reg_info.name,
-                        "value": format!("0x{:x}", reg_info.value),
-                        "decimal_value": reg_info.value
+                        "thread_id": values.thread_id,
+                        "frame_index": values.frame_index,
+                        "total_count": register_list.len(),
+                        "registers": register_list
                     })
-                }
-            }).collect();
+                }).collect();
+
+                Ok(json!({
+                    "success": true,
+                    "threads": thread_list,
+                    "thread_count": threads.len(),
+                    "schema": threads.first().map(|values| json!({
+                        "key": values.schema.key,
+                        "register_sets": values.schema.sets,
+                        "register_count": values.schema.registers.len(),
+                        "bytes_per_thread": values.schema.total_bytes
+                    })),
+                    "timestamp": timestamp,
+                    "filter_applied": register_filter
+                }))
+            }
+            Err(e) => {
+                error!("Failed to get registers of all threads: {}", e);
+                Ok(json!({
+                    "success": false,
+                    "error": e.to_string(),
+                    "threads": []
+                }))
+            }
+        };
+    }
+    
+    match lldb_manager.read_registers(thread_id) {
+        Ok(values) => {
+            debug!("Found {} registers", values.len());
+            let register_list = register_list(&values, register_filter, include_metadata);
             
             Ok(json!({
                 "success": true,
+                "total_count": register_list.len(),
                 "registers": register_list,
-                "total_count": filtered_registers.len(),
-                "thread_id": register_state.thread_id,
-                "frame_index": register_state.frame_index,
-                "timestamp": register_state.timestamp.duration_since(std::time::UNIX_EPOCH)
-                    .unwrap_or_default().as_secs(),
+                "thread_id": values.thread_id,
+                "frame_index": values.frame_index,
+                "timestamp": timestamp,
                 "filter_applied": register_filter
             }))
         }
@@ -78,6 +96,15 @@ pub fn get_registers(
     }
 }
 
+/// Registers in schema order, optionally filtered by name substring
+fn register_list(values: &RegisterValues, register_filter: Option<&str>, include_metadata: bool) -> Vec<Value> {
+    let filter = register_filter.map(str::to_lowercase);
+    values.iter()
+        .filter(|(_, def)| filter.as_ref().map_or(true, |filter| def.name.to_lowercase().contains(filter)))
+        .map(|(index, _)| values.register_json(index, include_metadata))
+        .collect()
+}
+
 pub fn set_register(
     lldb_manager: &mut LldbManager,
     arguments: HashMap<String, Value>,
@@ -160,6 +187,9 @@ pub fn get_register_info(
                     "name": reg_info.name,
                     "value": format!("0x{:x}", reg_info.value),
                     "decimal_value": reg_info.value,
+                    "bytes": (reg_info.size > 8).then(|| reg_info.bytes.clone()),
+                    "full_value": (reg_info.size > 8).then(|| format!("0x{}", reg_info.bytes.iter().rev().map(|byte| format!("{:02x}", byte)).collect::<String>())),
+                    "set": reg_info.set,
                     "size": reg_info.size,
                     "size_description": match reg_info.size {
                         1 => "8-bit",
@@ -167,6 +197,8 @@ pub fn get_register_info(
                         4 => "32-bit",
                         8 => "64-bit",
                         16 => "128-bit",
+                        32 => "256-bit",
+                        64 => "512-bit",
                         _ => "unknown"
                     },
                     "type": reg_info.register_type,
@@ -256,6 +288,109 @@ pub fn save_register_state(
     }
 }
 
+pub fn get_stop_delta(
+    lldb_manager: &mut LldbManager,
+    arguments: HashMap<String, Value>,
+) -> IncodeResult<Value> {
+    debug!("Register Inspection: get_stop_delta called with args: {:?}", arguments);
+
+    let thread_id = arguments.get("thread_id")
+        .and_then(|v| v.as_u64())
+        .map(|v| v as u32);
+
+    let include_registers = arguments.get("include_registers")
+        .and_then(|v| v.as_bool())
+        .unwrap_or(true);
+
+    let include_locals = arguments.get("include_locals")
+        .and_then(|v| v.as_bool())
+        .unwrap_or(true);
+
+    if arguments.get("reset").and_then(|v| v.as_bool()).unwrap_or(false) {
+        lldb_manager.reset_stop_deltas(false);
+    }
+
+    let mut watching = Vec::new();
+    for range in arguments.get("watch_memory").and_then(|v| v.as_array()).into_iter().flatten() {
+        let address = range.get("address")
+            .and_then(parse_address)
+            .ok_or_else(|| crate::error::IncodeError::invalid_parameter("watch_memory entries need an address"))?;
+        let size = range.get("size")
+            .and_then(|v| v.as_u64())
+            .ok_or_else(|| crate::error::IncodeError::invalid_parameter("watch_memory entries need a size"))?;
+        let size = lldb_manager.watch_memory_delta(address, size as usize);
+        watching.push(json!({ "address": format!("0x{:x}", address), "size": size }));
+    }
+    for address in arguments.get("unwatch_memory").and_then(|v| v.as_array()).into_iter().flatten() {
+        if let Some(address) = parse_address(address) {
+            lldb_manager.unwatch_memory_delta(address);
+        }
+    }
+
+    match lldb_manager.stop_delta(thread_id, include_registers, include_locals) {
+        Ok(delta) => {
+            debug!("Stop delta for thread {}: {} registers, {} locals, {} memory runs changed",
+                   delta.thread_id, delta.registers.len(), delta.locals.len(), delta.memory.len());
+            let mut result = delta.to_json();
+            result["success"] = json!(true);
+            result["changed"] = json!(!delta.is_empty());
+            if !watching.is_empty() {
+                result["watching"] = json!(watching);
+            }
+            Ok(result)
+        }
+        Err(e) => {
+            error!("Failed to get stop delta: {}", e);
+            Ok(json!({
+                "success": false,
+                "error": e.to_string()
+            }))
+        }
+    }
+}
+
+pub fn watch_memory(
+    lldb_manager: &mut LldbManager,
+    arguments: HashMap<String, Value>,
+) -> IncodeResult<Value> {
+    debug!("Register Inspection: watch_memory called with args: {:?}", arguments);
+
+    let address = arguments.get("address")
+        .and_then(parse_address)
+        .ok_or_else(|| crate::error::IncodeError::invalid_parameter("address is required"))?;
+
+    let remove = arguments.get("remove")
+        .and_then(|v| v.as_bool())
+        .unwrap_or(false);
+
+    let mut result = json!({
+        "success": true,
+        "address": format!("0x{:x}", address)
+    });
+    if remove {
+        result["removed"] = json!(lldb_manager.unwatch_memory_delta(address));
+    } else {
+        let size = arguments.get("size")
+            .and_then(|v| v.as_u64())
+            .ok_or_else(|| crate::error::IncodeError::invalid_parameter("size is required"))?;
+        result["size"] = json!(lldb_manager.watch_memory_delta(address, size as usize));
+    }
+    result["watching"] = json!(lldb_manager.watched_memory_deltas().iter()
+        .map(|(address, size)| json!({ "address": format!("0x{:x}", address), "size": size }))
+        .collect::<Vec<_>>());
+    Ok(result)
+}
+
+/// Address as a number or a hex string with or without 0x
+fn parse_address(value: &Value) -> Option<u64> {
+    if let Some(s) = value.as_str() {
+        let s = s.trim_start_matches("0x").trim_start_matches("0X");
+        u64::from_str_radix(s, 16).ok()
+    } else {
+        value.as_u64()
+    }
+}
+
 // Tool implementations for MCP protocol
 
 pub struct GetRegistersTool;
@@ -267,7 +402,7 @@ impl Tool for GetRegistersTool {
     }
     
     fn description(&self) -> &'static str {
-        "Get all CPU registers for current thread"
+        "Get all CPU registers for the current thread, or every thread at once, with vector registers at full width"
     }
     
     fn parameters(&self) -> Value {
@@ -284,6 +419,11 @@ impl Tool for GetRegistersTool {
             "register_filter": {
                 "type": "string",
                 "description": "Filter registers by name (case-insensitive substring match)"
+            },
+            "all_threads": {
+                "type": "boolean",
+                "description": "Read the top-frame registers of every thread in one pass",
+                "default": false
             }
         })
     }
@@ -398,4 +538,102 @@ impl Tool for SaveRegisterStateTool {
             Err(e) => Ok(ToolResponse::Error(e.to_string())),
         }
     }
-}
\ No newline at end of file
+}
+
+pub struct GetStopDeltaTool;
+
+#[async_trait]
+impl Tool for GetStopDeltaTool {
+    fn name(&self) -> &'static str {
+        "get_stop_delta"
+    }
+    
+    fn description(&self) -> &'static str {
+        "Get only the registers, locals and watched memory that changed since the thread's previous stop"
+    }
+    
+    fn parameters(&self) -> Value {
+        json!({
+            "thread_id": {
+                "type": "number",
+                "description": "Thread ID (uses current thread if not specified)"
+            },
+            "include_registers": {
+                "type": "boolean",
+                "description": "Compare register values",
+                "default": true
+            },
+            "include_locals": {
+                "type": "boolean",
+                "description": "Compare arguments and locals of the selected frame",
+                "default": true
+            },
+            "watch_memory": {
+                "type": "array",
+                "description": "Memory ranges to compare at every stop from now on, e.g. [{\"address\": \"0x7fff0000\", \"size\": 64}]",
+                "items": {
+                    "type": "object",
+                    "properties": {
+                        "address": { "type": ["string", "number"] },
+                        "size": { "type": "number" }
+                    }
+                }
+            },
+            "unwatch_memory": {
+                "type": "array",
+                "description": "Start addresses of watched ranges to stop comparing",
+                "items": { "type": ["string", "number"] }
+            },
+            "reset": {
+                "type": "boolean",
+                "description": "Forget previous stops and report a full baseline",
+                "default": false
+            }
+        })
+    }
+    
+    async fn execute(&self, arguments: HashMap<String, Value>, manager: &mut LldbManager) -> IncodeResult<ToolResponse> {
+        match get_stop_delta(manager, arguments) {
+            Ok(result) => Ok(ToolResponse::Success(result.to_string())),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+pub struct WatchMemoryTool;
+
+#[async_trait]
+impl Tool for WatchMemoryTool {
+    fn name(&self) -> &'static str {
+        "watch_memory"
+    }
+    
+    fn description(&self) -> &'static str {
+        "Add or remove a memory range that get_stop_delta compares at every stop"
+    }
+    
+    fn parameters(&self) -> Value {
+        json!({
+            "address": {
+                "type": ["string", "number"],
+                "description": "Start address of the range (hex string or number)"
+            },
+            "size": {
+                "type": "number",
+                "description": "Bytes to compare, capped per range (required unless removing)"
+            },
+            "remove": {
+                "type": "boolean",
+                "description": "Stop comparing the range that starts at address",
+                "default": false
+            }
+        })
+    }
+    
+    async fn execute(&self, arguments: HashMap<String, Value>, manager: &mut LldbManager) -> IncodeResult<ToolResponse> {
+        match watch_memory(manager, arguments) {
+            Ok(result) => Ok(ToolResponse::Success(result.to_string())),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
@@ -3,14 +3,16 @@ use serde_json::{json, Value};
 use std::collections::HashMap;
 use crate::error::{IncodeError, IncodeResult};
 use crate::lldb_manager::LldbManager;
+use crate::session_snapshot::{self, RestoreOptions, SessionSnapshot};
 use super::{Tool, ToolResponse};
 use uuid::Uuid;
 
-// Session Management Tools (4 tools)
+// Session Management Tools (5 tools)
 pub struct CreateSessionTool;
 pub struct SaveSessionTool;
 pub struct LoadSessionTool;
 pub struct CleanupSessionTool;
+pub struct ManageMemoryTool;
 
 /// Create new debugging session
 #[async_trait]
@@ -105,6 +107,12 @@ impl Tool for SaveSessionTool {
                 "description": "Include variable state in saved session",
                 "default": true
             },
+            "format": {
+                "type": "string",
+                "enum": ["binary", "json"],
+                "description": "binary: compact versioned snapshot (.session); json: readable export (.json)",
+                "default": "binary"
+            },
             "session_id": {
                 "type": "string",
                 "description": "UUID of the session to save (optional, uses current session if not specified)"
@@ -124,7 +132,7 @@ impl Tool for SaveSessionTool {
         let save_path = arguments.get("save_path")
             .and_then(|v| v.as_str());
         
-        let _include_breakpoints = arguments.get("include_breakpoints")
+        let include_breakpoints = arguments.get("include_breakpoints")
             .and_then(|v| v.as_bool())
             .unwrap_or(true);
         
@@ -132,6 +140,14 @@ impl Tool for SaveSessionTool {
             .and_then(|v| v.as_bool())
             .unwrap_or(true);
 
+        let binary = match arguments.get("format").and_then(|v| v.as_str()).unwrap_or("binary") {
+            "binary" => true,
+            "json" => false,
+            other => return Ok(ToolResponse::Error(
+                IncodeError::invalid_parameter(format!("Unknown format '{}': expected binary or json", other)).to_string()
+            )),
+        };
+
         let session_id = if let Some(id_str) = arguments.get("session_id").and_then(|v| v.as_str()) {
             Uuid::parse_str(id_str)
                 .map_err(|e| IncodeError::invalid_parameter(format!("Invalid session ID: {}", e)))?
@@ -140,10 +156,21 @@ impl Tool for SaveSessionTool {
                 .ok_or_else(|| IncodeError::lldb_op("No current session to save"))?
         };
 
-        let session_data = lldb_manager.save_session(&session_id)?;
+        let mut snapshot = lldb_manager.snapshot_session(&session_id)?;
+        if !include_breakpoints {
+            snapshot.breakpoints.clear();
+            snapshot.watchpoints.clear();
+        }
+        let session_data = if binary {
+            snapshot.encode()
+        } else {
+            serde_json::to_string_pretty(&snapshot.to_json())
+                .map_err(|e| IncodeError::lldb_op(format!("Failed to serialize session: {}", e)))?
+                .into_bytes()
+        };
         
         // Generate file path
-        let file_name = format!("{}.json", session_name);
+        let file_name = format!("{}.{}", session_name, if binary { "session" } else { "json" });
         let file_path = if let Some(dir) = save_path {
             std::path::Path::new(dir).join(&file_name)
         } else {
@@ -175,7 +202,12 @@ impl Tool for SaveSessionTool {
             "saved_at": std::time::SystemTime::now()
                 .duration_since(std::time::UNIX_EPOCH)
                 .unwrap_or_default().as_secs().to_string(),
-            "size": session_data.len()
+            "format": if binary { "binary" } else { "json" },
+            "size": session_data.len(),
+            "breakpoints": snapshot.breakpoints.len(),
+            "watchpoints": snapshot.watchpoints.len(),
+            "modules": snapshot.modules.len(),
+            "console_segments": snapshot.console.len()
         }).to_string()))
     }
 }
@@ -195,7 +227,7 @@ impl Tool for LoadSessionTool {
         json!({
             "file_path": {
                 "type": "string",
-                "description": "Path to saved session file to load"
+                "description": "Path to a saved session file (binary snapshot or JSON) to load"
             },
             "session_name": {
                 "type": "string",
@@ -212,7 +244,7 @@ impl Tool for LoadSessionTool {
             },
             "restore_target": {
                 "type": "boolean",
-                "description": "Restore target process from session",
+                "description": "Reload the core, relaunch (stopped at entry) or re-attach the saved target",
                 "default": false
             }
         })
@@ -223,18 +255,19 @@ impl Tool for LoadSessionTool {
         arguments: HashMap<String, Value>,
         lldb_manager: &mut LldbManager,
     ) -> IncodeResult<ToolResponse> {
-        let _restore_breakpoints = arguments.get("restore_breakpoints")
-            .and_then(|v| v.as_bool())
-            .unwrap_or(true);
-        
-        let _restore_target = arguments.get("restore_target")
-            .and_then(|v| v.as_bool())
-            .unwrap_or(false);
+        let options = RestoreOptions {
+            restore_breakpoints: arguments.get("restore_breakpoints")
+                .and_then(|v| v.as_bool())
+                .unwrap_or(true),
+            restore_target: arguments.get("restore_target")
+                .and_then(|v| v.as_bool())
+                .unwrap_or(false),
+        };
         
         // Get session data from file_path, session_name, or direct session_data
         let session_data = if let Some(file_path) = arguments.get("file_path").and_then(|v| v.as_str()) {
             // Load from file path
-            match std::fs::read_to_string(file_path) {
+            match std::fs::read(file_path) {
                 Ok(data) => data,
                 Err(e) => {
                     return Ok(ToolResponse::Success(json!({
@@ -244,10 +277,11 @@ impl Tool for LoadSessionTool {
                 }
             }
         } else if let Some(session_name) = arguments.get("session_name").and_then(|v| v.as_str()) {
-            // Load by session name - look in default session directory
+            // Load by session name - look in default session directory, binary snapshot first
             let sessions_dir = std::env::temp_dir().join("incode_sessions");
-            let file_path = sessions_dir.join(format!("{}.json", session_name));
-            match std::fs::read_to_string(&file_path) {
+            let binary_path = sessions_dir.join(format!("{}.session", session_name));
+            let file_path = if binary_path.exists() { binary_path } else { sessions_dir.join(format!("{}.json", session_name)) };
+            match std::fs::read(&file_path) {
                 Ok(data) => data,
                 Err(e) => {
                     return Ok(ToolResponse::Success(json!({
@@ -258,7 +292,7 @@ impl Tool for LoadSessionTool {
             }
         } else if let Some(data) = arguments.get("session_data").and_then(|v| v.as_str()) {
             // Use provided session data directly
-            data.to_string()
+            data.as_bytes().to_vec()
         } else {
             return Ok(ToolResponse::Success(json!({
                 "success": false,
@@ -266,8 +300,15 @@ impl Tool for LoadSessionTool {
             }).to_string()));
         };
 
-        let session_id = match lldb_manager.load_session(&session_data) {
-            Ok(id) => id,
+        let snapshot = if session_snapshot::is_binary_snapshot(&session_data) {
+            SessionSnapshot::decode(&session_data)
+        } else {
+            serde_json::from_slice::<Value>(&session_data)
+                .map_err(|e| IncodeError::session(format!("Failed to parse session data: {}", e)))
+                .and_then(|data| SessionSnapshot::from_json(&data))
+        };
+        let restore = match snapshot.and_then(|snapshot| lldb_manager.restore_session(&snapshot, &options)) {
+            Ok(restore) => restore,
             Err(e) => {
                 return Ok(ToolResponse::Success(json!({
                     "success": false,
@@ -278,23 +319,26 @@ impl Tool for LoadSessionTool {
         
         let mut response = json!({
             "success": true,
-            "session_id": session_id.to_string(),
+            "session_id": restore.session_id.to_string(),
             "loaded_at": std::time::SystemTime::now()
                 .duration_since(std::time::UNIX_EPOCH)
                 .unwrap_or_default().as_secs().to_string(),
-            "session_state": "loaded"
+            "session_state": "loaded",
+            "restore": restore.to_json()
         });
         
         // Add restoration info
-        let restored_components = if _restore_breakpoints {
-            vec!["breakpoints"]
-        } else {
-            vec![]
-        };
-        
-        if !restored_components.is_empty() {
-            response["restored_components"] = json!(restored_components);
+        let mut restored_components = vec!["selection"];
+        if restore.target.is_some() {
+            restored_components.push("target");
         }
+        if options.restore_breakpoints {
+            restored_components.push("breakpoints");
+        }
+        if restore.console_segments > 0 {
+            restored_components.push("console");
+        }
+        response["restored_components"] = json!(restored_components);
         
         Ok(ToolResponse::Success(response.to_string()))
     }
@@ -411,6 +455,73 @@ impl Tool for CleanupSessionTool {
     }
 }
 
+/// Report and bound the memory held by caches and idle sessions
+#[async_trait]
+impl Tool for ManageMemoryTool {
+    fn name(&self) -> &'static str {
+        "manage_memory"
+    }
+    
+    fn description(&self) -> &'static str {
+        "Report per-cache memory use and set the cache budget, RSS ceiling and idle-session spilling"
+    }
+    
+    fn parameters(&self) -> Value {
+        json!({
+            "budget_mb": {
+                "type": "integer",
+                "description": "Memory all caches together may hold, in MiB"
+            },
+            "rss_limit_mb": {
+                "type": "integer",
+                "description": "Hard resident set ceiling in MiB; caches are emptied to stay under it (0 removes the ceiling)"
+            },
+            "idle_session_secs": {
+                "type": "integer",
+                "description": "Spill sessions without a live process to disk after this many idle seconds"
+            },
+            "enforce": {
+                "type": "boolean",
+                "description": "Evict and spill now rather than after the next tool call",
+                "default": true
+            }
+        })
+    }
+    
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let mut config = lldb_manager.cache_manager().config();
+        if let Some(budget_mb) = arguments.get("budget_mb").and_then(|v| v.as_u64()) {
+            if budget_mb == 0 {
+                return Ok(ToolResponse::Error(IncodeError::invalid_parameter("budget_mb must be at least 1").to_string()));
+            }
+            config.budget_bytes = (budget_mb * 1024 * 1024) as usize;
+        }
+        if let Some(rss_limit_mb) = arguments.get("rss_limit_mb").and_then(|v| v.as_u64()) {
+            config.rss_limit_bytes = (rss_limit_mb > 0).then(|| rss_limit_mb * 1024 * 1024);
+        }
+        if let Some(idle_secs) = arguments.get("idle_session_secs").and_then(|v| v.as_u64()) {
+            config.idle_session_secs = idle_secs;
+        }
+        lldb_manager.cache_manager().set_config(config);
+
+        let enforce = arguments.get("enforce")
+            .and_then(|v| v.as_bool())
+            .unwrap_or(true);
+        let enforced = enforce.then(|| lldb_manager.enforce_cache_budget());
+
+        let mut response = lldb_manager.cache_report();
+        response["success"] = json!(true);
+        if let Some(enforced) = enforced {
+            response["enforced"] = enforced.to_json();
+        }
+        Ok(ToolResponse::Success(response.to_string()))
+    }
+}
+
 // Keep the old PlaceholderTool for compatibility
 pub struct PlaceholderTool;
 
@@ -538,15 +538,20 @@ impl Tool for EvaluateInFrameTool {
             return Ok(ToolResponse::Error(format!("Unsafe expression detected: {}", expression)));
         }
 
-        match lldb_manager.evaluate_in_frame(frame_index, expression) {
-            Ok(raw_result) => {
-                let formatted_result = Self::format_result(&raw_result, format);
+        match lldb_manager.evaluate(frame_index, expression, std::time::Duration::from_millis(timeout_ms)) {
+            Ok(value) => {
+                let raw_result = value.display();
+                let formatted_result = Self::format_result(value.value.as_deref().unwrap_or(&raw_result), format);
                 
                 Ok(ToolResponse::Json(json!({
                     "expression": expression,
                     "frame_index": frame_index.unwrap_or(0),
                     "raw_result": raw_result,
                     "formatted_result": formatted_result,
+                    "type": value.type_name,
+                    "address": value.address.map(|address| format!("0x{:x}", address)),
+                    "fast_path": value.fast_path,
+                    "elapsed_us": value.elapsed_us,
                     "format": format,
                     "timeout_ms": timeout_ms,
                     "success": true,
@@ -253,6 +253,38 @@ pub fn resume_thread(
     }))
 }
 
+pub fn read_thread_local(
+    lldb_manager: &mut LldbManager,
+    arguments: HashMap<String, Value>,
+) -> IncodeResult<Value> {
+    debug!("Thread Management: read_thread_local called with args: {:?}", arguments);
+
+    let name = arguments.get("name")
+        .and_then(|v| v.as_str())
+        .filter(|s| !s.is_empty())
+        .ok_or_else(|| crate::error::IncodeError::invalid_parameter("name is required"))?;
+
+    let thread_ids: Option<Vec<u32>> = arguments.get("thread_ids")
+        .and_then(|v| v.as_array())
+        .map(|ids| ids.iter().filter_map(|id| id.as_u64()).map(|id| id as u32).collect());
+
+    match lldb_manager.read_thread_local(name, thread_ids.as_deref()) {
+        Ok(view) => {
+            let mut result = view.to_json();
+            result["success"] = json!(true);
+            Ok(result)
+        }
+        Err(e) => {
+            error!("Failed to read thread-local {}: {}", name, e);
+            Ok(json!({
+                "success": false,
+                "error": e.to_string(),
+                "name": name
+            }))
+        }
+    }
+}
+
 // Tool implementations for MCP protocol
 
 pub struct ListThreadsTool;
@@ -418,4 +450,38 @@ impl Tool for ResumeThreadTool {
             Err(e) => Ok(ToolResponse::Error(e.to_string())),
         }
     }
-}
\ No newline at end of file
+}
+
+pub struct ReadThreadLocalTool;
+
+#[async_trait]
+impl Tool for ReadThreadLocalTool {
+    fn name(&self) -> &'static str {
+        "read_thread_local"
+    }
+    
+    fn description(&self) -> &'static str {
+        "Read a thread_local variable in every thread at once, from each thread's TLS block without expression evaluation"
+    }
+    
+    fn parameters(&self) -> Value {
+        json!({
+            "name": {
+                "type": "string",
+                "description": "Name of the thread_local variable"
+            },
+            "thread_ids": {
+                "type": "array",
+                "items": { "type": "number" },
+                "description": "Only these threads (default: all threads)"
+            }
+        })
+    }
+    
+    async fn execute(&self, arguments: HashMap<String, Value>, manager: &mut LldbManager) -> IncodeResult<ToolResponse> {
+        match read_thread_local(manager, arguments) {
+            Ok(result) => Ok(ToolResponse::Success(result.to_string())),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
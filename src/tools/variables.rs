@@ -2,16 +2,22 @@ use async_trait::async_trait;
 use serde_json::{json, Value};
 use std::collections::HashMap;
 use crate::error::{IncodeError, IncodeResult};
+use crate::global_vars::{self, GlobalFilter, GlobalValue, Storage};
 use crate::lldb_manager::LldbManager;
 use super::{Tool, ToolResponse};
 
-// Variable & Symbol Inspection Tools (6 tools)
+// Variable & Symbol Inspection Tools (11 tools)
 pub struct GetVariablesTool;
 pub struct GetGlobalVariablesTool;
 pub struct EvaluateExpressionTool;
 pub struct GetVariableInfoTool;
 pub struct SetVariableTool;
 pub struct LookupSymbolTool;
+pub struct PrepareExpressionTool;
+pub struct DecodeContainerTool;
+pub struct AddWatchExpressionTool;
+pub struct ListWatchExpressionsTool;
+pub struct GetWatchesTool;
 
 // F0035: get_variables - Fully implemented
 #[async_trait]
@@ -156,14 +162,14 @@ impl Tool for GetGlobalVariablesTool {
     }
 
     fn description(&self) -> &'static str {
-        "Get global and static variables with their current values"
+        "Get global and static variables with their current values, decoded from bulk reads of each module's data sections"
     }
 
     fn parameters(&self) -> Value {
         json!({
             "module_filter": {
                 "type": "string",
-                "description": "Filter globals by module/library name (optional)",
+                "description": "Only globals of modules whose file name or path contains this (optional)",
                 "default": ""
             },
             "name_pattern": {
@@ -176,6 +182,17 @@ impl Tool for GetGlobalVariablesTool {
                 "description": "Include static variables",
                 "default": true
             },
+            "offset": {
+                "type": "integer",
+                "description": "Matching globals to skip, for paging",
+                "default": 0
+            },
+            "limit": {
+                "type": "integer",
+                "description": "Globals to return at most",
+                "default": global_vars::DEFAULT_PAGE,
+                "maximum": global_vars::MAX_PAGE
+            },
             "format": {
                 "type": "string",
                 "description": "Output format for global variable information",
@@ -202,37 +219,49 @@ impl Tool for GetGlobalVariablesTool {
             .and_then(|v| v.as_bool())
             .unwrap_or(true);
 
+        let offset = arguments.get("offset")
+            .and_then(|v| v.as_u64())
+            .unwrap_or(0) as usize;
+
+        let limit = arguments.get("limit")
+            .and_then(|v| v.as_u64())
+            .map(|v| v as usize)
+            .unwrap_or(global_vars::DEFAULT_PAGE);
+
         let format = arguments.get("format")
             .and_then(|v| v.as_str())
             .unwrap_or("detailed");
 
-        match lldb_manager.get_global_variables(module_filter) {
-            Ok(mut global_vars) => {
-                // Apply name filter
-                if let Some(pattern) = name_pattern {
-                    global_vars.retain(|var| var.name.contains(pattern));
-                }
+        let filter = GlobalFilter {
+            module: module_filter.map(String::from),
+            name: name_pattern.map(String::from),
+            include_static,
+        };
 
-                // Apply static filter
-                if !include_static {
-                    global_vars.retain(|var| var.scope != "static");
-                }
+        match lldb_manager.list_globals(&filter, offset, limit) {
+            Ok(page) => {
+                let formatted_globals = Self::format_global_variables(&page.globals, format);
 
-                let formatted_globals = Self::format_global_variables(&global_vars, format);
-                
-                let global_count = global_vars.iter().filter(|v| v.scope == "global").count();
-                let static_count = global_vars.iter().filter(|v| v.scope == "static").count();
+                let global_count = page.globals.iter().filter(|v| v.storage == Storage::Global).count();
+                let static_count = page.globals.iter().filter(|v| v.storage == Storage::Static).count();
 
                 Ok(ToolResponse::Json(json!({
-                    "total_globals": global_vars.len(),
+                    "total_globals": page.total,
+                    "returned": page.globals.len(),
+                    "offset": page.offset,
+                    "has_more": page.has_more(),
                     "global_variables": global_count,
                     "static_variables": static_count,
                     "module_filter": module_filter.unwrap_or(""),
+                    "modules": page.modules,
                     "name_pattern": name_pattern.unwrap_or(""),
                     "include_static": include_static,
                     "format": format,
+                    "reads": page.reads,
+                    "bytes_read": page.bytes_read,
                     "variables": formatted_globals,
-                    "message": format!("Found {} global variables", global_vars.len())
+                    "message": format!("Found {} global variables, showing {} from offset {}",
+                                       page.total, page.globals.len(), page.offset)
                 })))
             }
             Err(e) => Ok(ToolResponse::Error(e.to_string())),
@@ -241,11 +270,11 @@ impl Tool for GetGlobalVariablesTool {
 }
 
 impl GetGlobalVariablesTool {
-    fn format_global_variables(variables: &[crate::lldb_manager::Variable], format: &str) -> Value {
+    fn format_global_variables(variables: &[GlobalValue], format: &str) -> Value {
         match format {
             "compact" => {
                 let compact: Vec<String> = variables.iter().map(|var| {
-                    format!("{}: {} = {} [{}]", var.name, var.var_type, var.value, var.scope)
+                    format!("{}: {} = {} [{}]", var.name, var.type_name, var.display(), var.storage.name())
                 }).collect();
                 json!(compact)
             },
@@ -254,28 +283,18 @@ impl GetGlobalVariablesTool {
                 json!(names)
             },
             "addresses_only" => {
-                let addresses: Vec<String> = variables.iter()
-                    .filter_map(|var| {
-                        if var.value.starts_with("0x") {
-                            Some(var.value.clone())
-                        } else {
-                            None
-                        }
-                    })
+                let addresses: Vec<Value> = variables.iter()
+                    .map(|var| json!({ "name": var.name, "address": format!("0x{:x}", var.address) }))
                     .collect();
                 json!(addresses)
             },
             _ => { // "detailed" format
                 let detailed: Vec<Value> = variables.iter().map(|var| {
-                    json!({
-                        "name": var.name,
-                        "type": var.var_type,
-                        "value": var.value,
-                        "scope": var.scope,
-                        "is_pointer": var.value.starts_with("0x"),
-                        "is_string": var.value.starts_with("\"") && var.value.ends_with("\""),
-                        "storage_class": if var.scope == "static" { "static" } else { "global" }
-                    })
+                    let mut detail = var.to_json();
+                    detail["is_pointer"] = json!(var.type_name.ends_with('*'));
+                    detail["is_string"] = json!(var.value.is_string());
+                    detail["storage_class"] = json!(var.storage.name());
+                    detail
                 }).collect();
                 json!(detailed)
             }
@@ -312,6 +331,10 @@ impl Tool for EvaluateExpressionTool {
                 "default": 5000,
                 "minimum": 100,
                 "maximum": 30000
+            },
+            "handle": {
+                "type": "integer",
+                "description": "Handle from prepare_expression; evaluates that expression reusing its plan instead of 'expression'"
             }
         })
     }
@@ -321,6 +344,23 @@ impl Tool for EvaluateExpressionTool {
         arguments: HashMap<String, Value>,
         lldb_manager: &mut LldbManager,
     ) -> IncodeResult<ToolResponse> {
+        if let Some(handle) = arguments.get("handle").and_then(|v| v.as_u64()) {
+            let timeout_ms = arguments.get("timeout_ms")
+                .and_then(|v| v.as_u64())
+                .unwrap_or(5000);
+            return match lldb_manager.evaluate_prepared(handle as u32, None, std::time::Duration::from_millis(timeout_ms)) {
+                Ok((value, hits, misses)) => {
+                    let mut result = value.to_json();
+                    result["handle"] = json!(handle);
+                    result["raw_result"] = json!(value.display());
+                    result["cache"] = json!({ "hits": hits, "misses": misses });
+                    result["success"] = json!(true);
+                    Ok(ToolResponse::Json(result))
+                }
+                Err(e) => Ok(ToolResponse::Error(e.to_string())),
+            };
+        }
+
         let expression = arguments.get("expression")
             .and_then(|v| v.as_str())
             .ok_or_else(|| IncodeError::mcp("Missing expression parameter"))?;
@@ -338,14 +378,19 @@ impl Tool for EvaluateExpressionTool {
             return Ok(ToolResponse::Error(format!("Unsafe expression detected: {}", expression)));
         }
 
-        match lldb_manager.evaluate_expression(expression) {
-            Ok(raw_result) => {
-                let formatted_result = Self::format_expression_result(&raw_result, format);
+        match lldb_manager.evaluate(None, expression, std::time::Duration::from_millis(timeout_ms)) {
+            Ok(value) => {
+                let raw_result = value.display();
+                let formatted_result = Self::format_expression_result(value.value.as_deref().unwrap_or(&raw_result), format);
                 
                 Ok(ToolResponse::Json(json!({
                     "expression": expression,
                     "raw_result": raw_result,
                     "formatted_result": formatted_result,
+                    "type": value.type_name,
+                    "address": value.address.map(|address| format!("0x{:x}", address)),
+                    "fast_path": value.fast_path,
+                    "elapsed_us": value.elapsed_us,
                     "format": format,
                     "timeout_ms": timeout_ms,
                     "success": true,
@@ -359,15 +404,7 @@ impl Tool for EvaluateExpressionTool {
 
 impl EvaluateExpressionTool {
     fn is_unsafe_expression(expr: &str) -> bool {
-        let dangerous_patterns = [
-            "system(", "exec(", "fork(", "kill(", 
-            "delete ", "free(", "malloc(", "realloc(",
-            "memcpy(", "memset(", "strcpy(",
-            "exit(", "abort(", "_exit(",
-            "remove(", "unlink(", "rmdir(",
-        ];
-        
-        dangerous_patterns.iter().any(|pattern| expr.contains(pattern))
+        crate::expression::is_unsafe(expr)
     }
 
     fn format_expression_result(result: &str, format: &str) -> Value {
@@ -623,6 +660,302 @@ impl Tool for LookupSymbolTool {
     }
 }
 
+// prepare_expression - plan an expression once for repeated evaluation
+#[async_trait]
+impl Tool for PrepareExpressionTool {
+    fn name(&self) -> &'static str {
+        "prepare_expression"
+    }
+
+    fn description(&self) -> &'static str {
+        "Prepare an expression once for repeated evaluation and return a handle for evaluate_expression"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "expression": {
+                "type": "string",
+                "description": "Expression to prepare (e.g., 'node->next->value', 'shared_work_queue.size()')"
+            },
+            "frame_index": {
+                "type": "integer",
+                "description": "Frame whose context to prepare for (default: current frame)"
+            },
+            "release": {
+                "type": "integer",
+                "description": "Handle to release instead of preparing"
+            },
+            "list": {
+                "type": "boolean",
+                "description": "List prepared expressions with their hit and miss counts",
+                "default": false
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        if let Some(handle) = arguments.get("release").and_then(|v| v.as_u64()) {
+            let released = lldb_manager.release_expression(handle as u32);
+            return Ok(ToolResponse::Json(json!({
+                "handle": handle,
+                "released": released,
+                "success": released
+            })));
+        }
+
+        if arguments.get("list").and_then(|v| v.as_bool()).unwrap_or(false) {
+            let prepared: Vec<Value> = lldb_manager.prepared_expressions().iter().map(|prepared| json!({
+                "handle": prepared.id,
+                "expression": prepared.expression,
+                "contexts": prepared.contexts(),
+                "hits": prepared.hits,
+                "misses": prepared.misses
+            })).collect();
+            return Ok(ToolResponse::Json(json!({
+                "prepared": prepared,
+                "success": true
+            })));
+        }
+
+        let expression = arguments.get("expression")
+            .and_then(|v| v.as_str())
+            .ok_or_else(|| IncodeError::invalid_parameter("expression required"))?;
+        let frame_index = arguments.get("frame_index")
+            .and_then(|v| v.as_u64())
+            .map(|v| v as u32);
+
+        match lldb_manager.prepare_expression(expression, frame_index) {
+            Ok((handle, plan)) => Ok(ToolResponse::Json(json!({
+                "handle": handle,
+                "expression": expression,
+                "plan": plan.kind(),
+                "success": true,
+                "message": format!("Evaluate with evaluate_expression {{\"handle\": {}}}", handle)
+            }))),
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+// decode_container - read standard containers straight from memory
+#[async_trait]
+impl Tool for DecodeContainerTool {
+    fn name(&self) -> &'static str {
+        "decode_container"
+    }
+
+    fn description(&self) -> &'static str {
+        "Decode a libstdc++/libc++ string, vector, map, set, unordered_map, deque or shared_ptr with bulk memory reads, one page at a time"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "expression": {
+                "type": "string",
+                "description": "Variable or path naming the container (e.g., 'local_vector', 'state->items')"
+            },
+            "offset": {
+                "type": "integer",
+                "description": "Index of the first element to return",
+                "default": 0
+            },
+            "limit": {
+                "type": "integer",
+                "description": "Maximum elements to return",
+                "default": 100,
+                "maximum": 10000
+            },
+            "frame_index": {
+                "type": "integer",
+                "description": "Frame to resolve the expression in (default: current frame)"
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let expression = arguments.get("expression")
+            .and_then(|v| v.as_str())
+            .ok_or_else(|| IncodeError::invalid_parameter("expression required"))?;
+        let offset = arguments.get("offset")
+            .and_then(|v| v.as_u64())
+            .unwrap_or(0);
+        let limit = arguments.get("limit")
+            .and_then(|v| v.as_u64())
+            .unwrap_or(100) as usize;
+        let frame_index = arguments.get("frame_index")
+            .and_then(|v| v.as_u64())
+            .map(|v| v as u32);
+
+        match lldb_manager.decode_container(expression, frame_index, offset, limit) {
+            Ok(view) => {
+                let mut result = view.to_json();
+                result["expression"] = json!(expression);
+                result["success"] = json!(true);
+                Ok(ToolResponse::Json(result))
+            }
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+// add_watch_expression - evaluate an expression at every stop
+#[async_trait]
+impl Tool for AddWatchExpressionTool {
+    fn name(&self) -> &'static str {
+        "add_watch_expression"
+    }
+
+    fn description(&self) -> &'static str {
+        "Watch an expression or lvalue path: it is evaluated server-side at every stop and changes are attached to step and continue results"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "expression": {
+                "type": "string",
+                "description": "Expression to watch, evaluated in the selected frame (e.g., 'node->next->value', 'queue.size()')"
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let expression = arguments.get("expression")
+            .and_then(|v| v.as_str())
+            .ok_or_else(|| IncodeError::invalid_parameter("expression required"))?;
+
+        match lldb_manager.add_watch(expression) {
+            Ok(watch) => {
+                let mut result = watch.to_json();
+                result["success"] = json!(true);
+                result["watches"] = json!(lldb_manager.watches().len());
+                Ok(ToolResponse::Json(result))
+            }
+            Err(e) => Ok(ToolResponse::Error(e.to_string())),
+        }
+    }
+}
+
+// list_watch_expressions - show or remove watches
+#[async_trait]
+impl Tool for ListWatchExpressionsTool {
+    fn name(&self) -> &'static str {
+        "list_watch_expressions"
+    }
+
+    fn description(&self) -> &'static str {
+        "List watch expressions with their last values and evaluation paths, or remove them"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "remove": {
+                "type": "integer",
+                "description": "Id of a watch to remove"
+            },
+            "clear": {
+                "type": "boolean",
+                "description": "Remove every watch",
+                "default": false
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        if let Some(id) = arguments.get("remove").and_then(|v| v.as_u64()) {
+            let removed = lldb_manager.remove_watch(id as u32);
+            return Ok(ToolResponse::Json(json!({
+                "id": id,
+                "removed": removed.is_some(),
+                "success": removed.is_some()
+            })));
+        }
+
+        if arguments.get("clear").and_then(|v| v.as_bool()).unwrap_or(false) {
+            let removed = lldb_manager.clear_watches();
+            return Ok(ToolResponse::Json(json!({
+                "removed": removed,
+                "success": true
+            })));
+        }
+
+        let watches = lldb_manager.watches();
+        Ok(ToolResponse::Json(json!({
+            "watches": watches.iter().map(|watch| watch.to_json()).collect::<Vec<_>>(),
+            "count": watches.len(),
+            "batches": watches.batches,
+            "last_batch_us": watches.last_batch_us,
+            "success": true
+        })))
+    }
+}
+
+// get_watches - changed watch values at the current stop
+#[async_trait]
+impl Tool for GetWatchesTool {
+    fn name(&self) -> &'static str {
+        "get_watches"
+    }
+
+    fn description(&self) -> &'static str {
+        "Evaluate all watch expressions at the current stop in one batch and return those that changed since last reported, with their history"
+    }
+
+    fn parameters(&self) -> Value {
+        json!({
+            "all": {
+                "type": "boolean",
+                "description": "Return every watch, not only the changed ones",
+                "default": false
+            }
+        })
+    }
+
+    async fn execute(
+        &self,
+        arguments: HashMap<String, Value>,
+        lldb_manager: &mut LldbManager,
+    ) -> IncodeResult<ToolResponse> {
+        let all = arguments.get("all")
+            .and_then(|v| v.as_bool())
+            .unwrap_or(false);
+
+        if let Err(e) = lldb_manager.evaluate_watches() {
+            return Ok(ToolResponse::Error(e.to_string()));
+        }
+        let changed = lldb_manager.take_watch_changes();
+        let watches = lldb_manager.watches();
+        let reported: Vec<Value> = if all {
+            watches.iter().map(|watch| watch.to_json()).collect()
+        } else {
+            changed.iter().map(|watch| watch.to_json()).collect()
+        };
+
+        Ok(ToolResponse::Json(json!({
+            "watches": reported,
+            "changed": changed.len(),
+            "unchanged": watches.len() - changed.len(),
+            "batch_us": watches.last_batch_us,
+            "success": true
+        })))
+    }
+}
+
 // Keep the old PlaceholderTool for compatibility with tool registry
 pub struct PlaceholderTool;
 
@@ -0,0 +1,296 @@
+// Watch expressions evaluated at every stop
+//
+// Agents stepping through code tend to re-evaluate the same handful of
+// expressions after each step, one tool call apiece. A watch list moves
+// that server-side: registered expressions are evaluated as one batch when
+// the process stops, through their prepared plans, and only watches whose
+// value changed are reported, each with its recent history.
+
+use std::collections::{BTreeSet, VecDeque};
+use std::time::Duration;
+
+use serde_json::{json, Value};
+
+/// Values kept per watch
+pub const MAX_HISTORY: usize = 16;
+/// Watches at most
+pub const MAX_WATCHES: usize = 256;
+/// Time one watch may take to evaluate before it reports an error
+pub const EVALUATION_TIMEOUT: Duration = Duration::from_millis(500);
+/// Time one batch may take; watches left when it runs out are not evaluated
+/// at that stop
+pub const BATCH_TIMEOUT: Duration = Duration::from_secs(5);
+
+/// A watch's value at one stop
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct WatchSample {
+    pub stop_id: u32,
+    pub value: String,
+    pub error: bool,
+}
+
+impl WatchSample {
+    pub fn to_json(&self) -> Value {
+        if self.error {
+            json!({ "stop_id": self.stop_id, "error": self.value })
+        } else {
+            json!({ "stop_id": self.stop_id, "value": self.value })
+        }
+    }
+}
+
+/// The result of evaluating one watch at one stop
+#[derive(Debug, Clone)]
+pub struct WatchResult {
+    pub id: u32,
+    pub value: Result<String, String>,
+    /// Plan kind the evaluation took ("lvalue_path", "container_size", "evaluator")
+    pub path: &'static str,
+}
+
+#[derive(Debug, Clone)]
+pub struct Watch {
+    pub id: u32,
+    pub expression: String,
+    /// Prepared expression handle, set at the first evaluation
+    pub handle: Option<u32>,
+    /// Whether the handle was prepared for this watch and goes with it
+    pub owns_handle: bool,
+    /// Values that differed from the one before, oldest first
+    pub history: VecDeque<WatchSample>,
+    /// Process and stop this watch was last evaluated at
+    evaluated_at: Option<(u32, u32)>,
+    /// Skipped at the latest batch because the batch ran out of time
+    pub not_evaluated: bool,
+    pub evaluations: u64,
+    pub path: Option<&'static str>,
+}
+
+impl Watch {
+    pub fn current(&self) -> Option<&WatchSample> {
+        self.history.back()
+    }
+
+    pub fn previous(&self) -> Option<&WatchSample> {
+        self.history.len().checked_sub(2).and_then(|i| self.history.get(i))
+    }
+
+    pub fn to_json(&self) -> Value {
+        let current = self.current();
+        json!({
+            "id": self.id,
+            "expression": self.expression,
+            "value": current.filter(|sample| !sample.error).map(|sample| &sample.value),
+            "error": current.filter(|sample| sample.error).map(|sample| &sample.value),
+            "previous": self.previous().map(|sample| &sample.value),
+            "changed_at_stop": current.map(|sample| sample.stop_id),
+            "evaluated_at_stop": self.evaluated_at.map(|(_, stop_id)| stop_id),
+            "not_evaluated": self.not_evaluated,
+            "evaluations": self.evaluations,
+            "path": self.path,
+            "history": self.history.iter().map(WatchSample::to_json).collect::<Vec<_>>(),
+        })
+    }
+}
+
+/// Registered watches, their histories and the changes not yet reported
+#[derive(Debug, Default)]
+pub struct WatchList {
+    next_id: u32,
+    watches: Vec<Watch>,
+    /// Watches that changed since changes were last taken
+    pending: BTreeSet<u32>,
+    pub batches: u64,
+    pub last_batch_us: u64,
+}
+
+impl WatchList {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Register `expression`; the same expression keeps its watch. Returns
+    /// the id and whether the watch is new.
+    pub fn add(&mut self, expression: &str) -> Result<(u32, bool), String> {
+        let expression = expression.trim();
+        if expression.is_empty() {
+            return Err("expression cannot be empty".to_string());
+        }
+        if let Some(watch) = self.watches.iter().find(|watch| watch.expression == expression) {
+            return Ok((watch.id, false));
+        }
+        if self.watches.len() >= MAX_WATCHES {
+            return Err(format!("at most {} watch expressions", MAX_WATCHES));
+        }
+        self.next_id += 1;
+        self.watches.push(Watch {
+            id: self.next_id,
+            expression: expression.to_string(),
+            handle: None,
+            owns_handle: false,
+            history: VecDeque::new(),
+            evaluated_at: None,
+            not_evaluated: false,
+            evaluations: 0,
+            path: None,
+        });
+        Ok((self.next_id, true))
+    }
+
+    pub fn remove(&mut self, id: u32) -> Option<Watch> {
+        let index = self.watches.iter().position(|watch| watch.id == id)?;
+        self.pending.remove(&id);
+        Some(self.watches.remove(index))
+    }
+
+    pub fn clear(&mut self) -> Vec<Watch> {
+        self.pending.clear();
+        std::mem::take(&mut self.watches)
+    }
+
+    pub fn get(&self, id: u32) -> Option<&Watch> {
+        self.watches.iter().find(|watch| watch.id == id)
+    }
+
+    pub fn set_handle(&mut self, id: u32, handle: u32, owned: bool) {
+        if let Some(watch) = self.watches.iter_mut().find(|watch| watch.id == id) {
+            watch.handle = Some(handle);
+            watch.owns_handle = owned;
+        }
+    }
+
+    pub fn iter(&self) -> impl Iterator<Item = &Watch> {
+        self.watches.iter()
+    }
+
+    pub fn len(&self) -> usize {
+        self.watches.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.watches.is_empty()
+    }
+
+    /// Ids and expressions of the watches not yet evaluated at this stop
+    pub fn stale(&self, pid: u32, stop_id: u32) -> Vec<(u32, String)> {
+        self.watches.iter()
+            .filter(|watch| watch.evaluated_at != Some((pid, stop_id)))
+            .map(|watch| (watch.id, watch.expression.clone()))
+            .collect()
+    }
+
+    /// Store one batch of results for a stop; returns how many watches changed
+    pub fn record(&mut self, pid: u32, stop_id: u32, results: Vec<WatchResult>, elapsed_us: u64) -> usize {
+        let mut changed = 0;
+        for result in results {
+            let Some(watch) = self.watches.iter_mut().find(|watch| watch.id == result.id) else {
+                continue;
+            };
+            watch.evaluated_at = Some((pid, stop_id));
+            watch.not_evaluated = false;
+            watch.evaluations += 1;
+            watch.path = Some(result.path);
+            let (value, error) = match result.value {
+                Ok(value) => (value, false),
+                Err(message) => (message, true),
+            };
+            if watch.current().map_or(false, |sample| sample.value == value && sample.error == error) {
+                continue;
+            }
+            watch.history.push_back(WatchSample { stop_id, value, error });
+            if watch.history.len() > MAX_HISTORY {
+                watch.history.pop_front();
+            }
+            self.pending.insert(watch.id);
+            changed += 1;
+        }
+        self.batches += 1;
+        self.last_batch_us = elapsed_us;
+        changed
+    }
+
+    /// Flag watches a batch had no time left for. They keep their last value
+    /// and stay stale, so the next batch at the same stop picks them up.
+    pub fn mark_not_evaluated(&mut self, ids: &[u32]) {
+        for watch in self.watches.iter_mut().filter(|watch| ids.contains(&watch.id)) {
+            watch.not_evaluated = true;
+        }
+    }
+
+    /// Treat a watch's current value as reported
+    pub fn acknowledge(&mut self, id: u32) {
+        self.pending.remove(&id);
+    }
+
+    /// Watches that changed since the last call, in id order
+    pub fn take_changes(&mut self) -> Vec<Watch> {
+        let pending = std::mem::take(&mut self.pending);
+        self.watches.iter().filter(|watch| pending.contains(&watch.id)).cloned().collect()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_watch_list_reports_changes_with_history() {
+        let result = |id: u32, value: Result<&str, &str>| WatchResult {
+            id,
+            value: value.map(String::from).map_err(String::from),
+            path: "lvalue_path",
+        };
+
+        let mut watches = WatchList::new();
+        let (counter, new) = watches.add("state->counter").unwrap();
+        assert!(new);
+        assert_eq!(watches.add(" state->counter ").unwrap(), (counter, false), "same expression, same watch");
+        let (name, _) = watches.add("name.size()").unwrap();
+        assert!(watches.add("  ").is_err());
+
+        // First stop: everything is new
+        assert_eq!(watches.stale(100, 1).len(), 2);
+        assert_eq!(watches.record(100, 1, vec![result(counter, Ok("0")), result(name, Ok("3"))], 12), 2);
+        assert!(watches.stale(100, 1).is_empty(), "evaluated once per stop");
+        assert_eq!(watches.take_changes().len(), 2);
+        assert!(watches.take_changes().is_empty(), "changes are reported once");
+
+        // Second stop: only the counter moved
+        assert_eq!(watches.record(100, 2, vec![result(counter, Ok("1")), result(name, Ok("3"))], 8), 1);
+        let changes = watches.take_changes();
+        assert_eq!(changes.len(), 1);
+        assert_eq!(changes[0].id, counter);
+        let json = changes[0].to_json();
+        assert_eq!(json["value"], "1");
+        assert_eq!(json["previous"], "0");
+        assert_eq!(json["changed_at_stop"], 2);
+        assert_eq!(json["history"].as_array().unwrap().len(), 2);
+
+        // Going out of scope and back is a change each way
+        watches.record(100, 3, vec![result(counter, Err("no variable named 'state'")), result(name, Ok("3"))], 8);
+        watches.record(100, 4, vec![result(counter, Ok("1")), result(name, Ok("3"))], 8);
+        let changes = watches.take_changes();
+        assert_eq!(changes.len(), 1);
+        assert_eq!(changes[0].previous().map(|sample| sample.error), Some(true));
+
+        // A watch the batch had no time for keeps its value and stays stale
+        watches.mark_not_evaluated(&[name]);
+        assert_eq!(watches.get(name).unwrap().to_json()["not_evaluated"], true);
+        assert_eq!(watches.get(name).unwrap().current().unwrap().value, "3");
+        assert!(watches.take_changes().is_empty());
+        watches.record(100, 5, vec![result(name, Ok("3"))], 8);
+        assert_eq!(watches.get(name).unwrap().to_json()["not_evaluated"], false);
+
+        // A new process restarts stop ids without being mistaken for the old stop
+        assert_eq!(watches.stale(200, 4).len(), 2);
+
+        // History is bounded; a removed watch is no longer reported
+        for stop in 5..5 + MAX_HISTORY as u32 * 2 {
+            watches.record(100, stop, vec![result(counter, Ok(&stop.to_string()))], 1);
+        }
+        assert_eq!(watches.get(counter).unwrap().history.len(), MAX_HISTORY);
+        assert!(watches.remove(counter).is_some());
+        assert!(watches.take_changes().is_empty());
+        assert_eq!(watches.len(), 1);
+    }
+}
@@ -0,0 +1,793 @@
+// Module-wide cross-reference index
+//
+// A linear sweep over a module's code sections records every direct call,
+// direct jump and RIP-relative data reference. The sweep is cut into chunks
+// at function starts and run by worker processes (`incode --xref-worker`),
+// each with its own debugger, because one LLDB instance cannot decode on
+// several threads. Workers stream one chunk at a time back to a background
+// thread, so queries answer from whatever is swept so far and never wait on
+// the whole module. Without the worker binary, each query sweeps further
+// chunks itself with the server's debugger for as long as it is willing to
+// wait. Indexes are keyed by module path and build ID; addresses
+// are file addresses stored as 32-bit offsets from the module's lowest code
+// address, so one index serves every run of the same build.
+
+use std::collections::{BTreeMap, HashSet, VecDeque};
+use std::ffi::{CStr, CString};
+use std::io::{BufRead, BufReader};
+use std::os::raw::c_void;
+use std::path::{Path, PathBuf};
+use std::process::{Command, Stdio};
+use std::sync::mpsc::{self, RecvTimeoutError};
+use std::sync::{Arc, Mutex};
+use std::time::{Duration, Instant};
+
+use lldb_sys::*;
+use serde_json::{json, Value};
+use tracing::{debug, info, warn};
+
+use crate::disassembly::operand_target;
+use crate::function_cfg::{flow, Flow};
+
+/// Target size of one sweep chunk; chunks end at a function start
+pub const CHUNK_BYTES: u64 = 1024 * 1024;
+/// Bytes handed to the decoder at once within a chunk
+const DECODE_WINDOW: usize = 64 * 1024;
+/// Longest x86 instruction; a window's tail this close to its end is re-decoded
+const MAX_INSTRUCTION_BYTES: usize = 15;
+/// Time a worker process gets per chunk of its share before it is killed
+const WORKER_CHUNK_TIMEOUT: Duration = Duration::from_secs(60);
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, PartialOrd, Ord)]
+pub enum XrefKind {
+    Call,
+    Jump,
+    Data,
+}
+
+impl XrefKind {
+    pub fn name(self) -> &'static str {
+        match self {
+            XrefKind::Call => "call",
+            XrefKind::Jump => "jump",
+            XrefKind::Data => "data",
+        }
+    }
+
+    fn code(self) -> u64 {
+        match self {
+            XrefKind::Call => 0,
+            XrefKind::Jump => 1,
+            XrefKind::Data => 2,
+        }
+    }
+
+    fn from_code(code: u64) -> Option<Self> {
+        match code {
+            0 => Some(XrefKind::Call),
+            1 => Some(XrefKind::Jump),
+            2 => Some(XrefKind::Data),
+            _ => None,
+        }
+    }
+}
+
+/// What an instruction refers to, if anything
+pub fn classify(mnemonic: &str, operands: &str, address: u64, size: u32) -> Option<(u64, XrefKind)> {
+    let target = operand_target(mnemonic, operands, address, size)?;
+    // A jump or call through memory refers to the pointer slot, which is data
+    if operands.contains('[') {
+        return Some((target, XrefKind::Data));
+    }
+    match flow(mnemonic, true) {
+        Flow::Call => Some((target, XrefKind::Call)),
+        Flow::Jump | Flow::ConditionalJump => Some((target, XrefKind::Jump)),
+        _ => Some((target, XrefKind::Data)),
+    }
+}
+
+/// One reference, as offsets from the index base
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+struct Xref {
+    from: u32,
+    to: u32,
+    kind: XrefKind,
+}
+
+/// Xrefs of one swept chunk: sorted by source, plus an index sorted by target
+#[derive(Debug, Default)]
+struct ChunkXrefs {
+    xrefs: Vec<Xref>,
+    by_to: Vec<u32>,
+}
+
+impl ChunkXrefs {
+    fn new(mut xrefs: Vec<Xref>) -> Self {
+        xrefs.sort_unstable_by_key(|xref| (xref.from, xref.to));
+        let mut by_to: Vec<u32> = (0..xrefs.len() as u32).collect();
+        by_to.sort_unstable_by_key(|&i| (xrefs[i as usize].to, xrefs[i as usize].from));
+        Self { xrefs, by_to }
+    }
+}
+
+/// A function symbol, in file addresses
+#[derive(Debug, Clone, PartialEq)]
+pub struct FunctionSymbol {
+    pub start: u64,
+    pub end: u64,
+    pub name: String,
+}
+
+/// A resolved reference, in file addresses
+#[derive(Debug, Clone, PartialEq)]
+pub struct XrefHit {
+    pub from: u64,
+    pub to: u64,
+    pub kind: XrefKind,
+}
+
+#[derive(Debug, Clone)]
+pub struct SweepProgress {
+    pub chunks_done: usize,
+    pub chunks_total: usize,
+    pub bytes_done: u64,
+    pub bytes_total: u64,
+    pub xrefs: usize,
+    pub errors: Vec<String>,
+    pub elapsed_ms: u64,
+    pub complete: bool,
+}
+
+impl SweepProgress {
+    pub fn to_json(&self) -> Value {
+        json!({
+            "complete": self.complete,
+            "chunks_done": self.chunks_done,
+            "chunks_total": self.chunks_total,
+            "swept_bytes": self.bytes_done,
+            "total_bytes": self.bytes_total,
+            "xrefs_indexed": self.xrefs,
+            "errors": self.errors,
+            "elapsed_ms": self.elapsed_ms
+        })
+    }
+}
+
+#[derive(Debug, Default)]
+struct SweepState {
+    /// Swept chunks by start offset
+    runs: BTreeMap<u32, ChunkXrefs>,
+    chunks_done: usize,
+    bytes_done: u64,
+    errors: Vec<String>,
+    finished: Option<Duration>,
+}
+
+/// Cross-references of one module build, filled in as the sweep progresses
+#[derive(Debug)]
+pub struct XrefIndex {
+    pub module: String,
+    pub build_id: Option<String>,
+    /// Lowest code file address; stored offsets are relative to it
+    pub base: u64,
+    /// Sorted by start
+    pub functions: Vec<FunctionSymbol>,
+    pub chunks_total: usize,
+    pub bytes_total: u64,
+    started: Instant,
+    state: Mutex<SweepState>,
+    /// Chunks left for queries to sweep in-process, when there are no workers
+    pending: Mutex<VecDeque<(u64, u64)>>,
+}
+
+impl XrefIndex {
+    pub fn new(module: String, build_id: Option<String>, base: u64, mut functions: Vec<FunctionSymbol>, chunks: &[(u64, u64)]) -> Self {
+        functions.sort_by_key(|function| function.start);
+        Self {
+            module,
+            build_id,
+            base,
+            functions,
+            chunks_total: chunks.len(),
+            bytes_total: chunks.iter().map(|(start, end)| end - start).sum(),
+            started: Instant::now(),
+            state: Mutex::new(SweepState::default()),
+            pending: Mutex::new(VecDeque::new()),
+        }
+    }
+
+    fn offset(&self, address: u64) -> Option<u32> {
+        address.checked_sub(self.base).and_then(|offset| u32::try_from(offset).ok())
+    }
+
+    /// Record a swept chunk's references, in file addresses. References
+    /// outside the 4 GiB window above the base cannot be stored and are
+    /// dropped; a chunk starting outside it is recorded as failed.
+    pub fn add_chunk(&self, start: u64, end: u64, hits: impl IntoIterator<Item = (u64, u64, XrefKind)>) {
+        let Some(key) = self.offset(start) else {
+            self.chunk_failed(start, end, "chunk outside the indexed range".to_string());
+            return;
+        };
+        let xrefs: Vec<Xref> = hits.into_iter()
+            .filter_map(|(from, to, kind)| Some(Xref { from: self.offset(from)?, to: self.offset(to)?, kind }))
+            .collect();
+        let mut state = self.state.lock().unwrap();
+        state.runs.insert(key, ChunkXrefs::new(xrefs));
+        self.chunk_done(&mut state, end - start);
+    }
+
+    pub fn chunk_failed(&self, start: u64, end: u64, error: String) {
+        let mut state = self.state.lock().unwrap();
+        if state.errors.len() < 16 {
+            state.errors.push(format!("0x{:x}-0x{:x}: {}", start, end, error));
+        }
+        self.chunk_done(&mut state, end - start);
+    }
+
+    fn chunk_done(&self, state: &mut SweepState, bytes: u64) {
+        state.chunks_done += 1;
+        state.bytes_done += bytes;
+        if state.chunks_done >= self.chunks_total && state.finished.is_none() {
+            state.finished = Some(self.started.elapsed());
+        }
+    }
+
+    pub fn is_complete(&self) -> bool {
+        self.state.lock().unwrap().finished.is_some()
+    }
+
+    pub fn progress(&self) -> SweepProgress {
+        let state = self.state.lock().unwrap();
+        SweepProgress {
+            chunks_done: state.chunks_done,
+            chunks_total: self.chunks_total,
+            bytes_done: state.bytes_done,
+            bytes_total: self.bytes_total,
+            xrefs: state.runs.values().map(|run| run.xrefs.len()).sum(),
+            errors: state.errors.clone(),
+            elapsed_ms: state.finished.unwrap_or_else(|| self.started.elapsed()).as_millis() as u64,
+            complete: state.finished.is_some(),
+        }
+    }
+
+    /// Leave `chunks` for `sweep_pending` instead of worker processes
+    pub fn defer(&self, chunks: Vec<(u64, u64)>) {
+        self.pending.lock().unwrap().extend(chunks);
+    }
+
+    /// Sweep deferred chunks on this thread until they run out or `deadline`
+    /// passes, always at least one so every query makes progress. True when
+    /// this call finished the sweep.
+    pub fn sweep_pending(&self, target: SBTargetRef, module: SBModuleRef, deadline: Instant) -> bool {
+        let mut swept = false;
+        loop {
+            let Some((start, end)) = self.pending.lock().unwrap().pop_front() else {
+                break;
+            };
+            match sweep_range(target, module, start, end) {
+                Ok(hits) => self.add_chunk(start, end, hits),
+                Err(error) => self.chunk_failed(start, end, error),
+            }
+            swept = true;
+            if Instant::now() >= deadline {
+                break;
+            }
+        }
+        swept && self.is_complete()
+    }
+
+    /// Block until the sweep finishes or `timeout` passes; true when complete
+    pub fn wait(&self, timeout: Duration) -> bool {
+        let deadline = Instant::now() + timeout;
+        loop {
+            if self.is_complete() {
+                return true;
+            }
+            if Instant::now() >= deadline {
+                return false;
+            }
+            std::thread::sleep(Duration::from_millis(20));
+        }
+    }
+
+    fn hit(&self, xref: &Xref) -> XrefHit {
+        XrefHit { from: self.base + xref.from as u64, to: self.base + xref.to as u64, kind: xref.kind }
+    }
+
+    /// References into [start, end), sorted by target then source
+    pub fn xrefs_to(&self, start: u64, end: u64) -> Vec<XrefHit> {
+        let (Some(lo), Some(hi)) = (self.offset(start), self.offset(end.max(start + 1)).or(Some(u32::MAX))) else {
+            return Vec::new();
+        };
+        let state = self.state.lock().unwrap();
+        let mut hits: Vec<XrefHit> = Vec::new();
+        for run in state.runs.values() {
+            let first = run.by_to.partition_point(|&i| run.xrefs[i as usize].to < lo);
+            hits.extend(run.by_to[first..].iter()
+                .map(|&i| &run.xrefs[i as usize])
+                .take_while(|xref| xref.to < hi)
+                .map(|xref| self.hit(xref)));
+        }
+        hits.sort_by_key(|hit| (hit.to, hit.from));
+        hits
+    }
+
+    /// References made by instructions in [start, end), sorted by source
+    pub fn xrefs_from(&self, start: u64, end: u64) -> Vec<XrefHit> {
+        let (Some(lo), Some(hi)) = (self.offset(start), self.offset(end.max(start + 1)).or(Some(u32::MAX))) else {
+            return Vec::new();
+        };
+        let state = self.state.lock().unwrap();
+        // Chunks are disjoint and keyed by start: only those overlapping the range can match
+        let first_run = state.runs.range(..=lo).next_back().map_or(0, |(&key, _)| key);
+        let mut hits = Vec::new();
+        for run in state.runs.range(first_run..hi).map(|(_, run)| run) {
+            let first = run.xrefs.partition_point(|xref| xref.from < lo);
+            hits.extend(run.xrefs[first..].iter().take_while(|xref| xref.from < hi).map(|xref| self.hit(xref)));
+        }
+        hits
+    }
+
+    /// Function containing file address `address`
+    pub fn function_at(&self, address: u64) -> Option<&FunctionSymbol> {
+        let index = self.functions.partition_point(|function| function.start <= address).checked_sub(1)?;
+        let function = &self.functions[index];
+        (address < function.end).then_some(function)
+    }
+
+    /// `address` as function or function+0xoffset
+    pub fn symbolize(&self, address: u64) -> Option<String> {
+        let function = self.function_at(address)?;
+        Some(match address - function.start {
+            0 => function.name.clone(),
+            offset => format!("{}+0x{:x}", function.name, offset),
+        })
+    }
+
+    pub fn approx_bytes(&self) -> usize {
+        let state = self.state.lock().unwrap();
+        std::mem::size_of::<Self>()
+            + self.functions.iter().map(|function| std::mem::size_of::<FunctionSymbol>() + function.name.len()).sum::<usize>()
+            + state.runs.values().map(|run| run.xrefs.len() * std::mem::size_of::<Xref>() + run.by_to.len() * 4).sum::<usize>()
+    }
+}
+
+/// Result of one xref query: hits in file addresses plus what is needed to
+/// report them at load addresses
+#[derive(Debug)]
+pub struct XrefQuery {
+    pub index: Arc<XrefIndex>,
+    /// Load address minus file address for the module in this process
+    pub slide: u64,
+    /// Queried range, file addresses
+    pub start: u64,
+    pub end: u64,
+    pub hits: Vec<XrefHit>,
+}
+
+impl XrefQuery {
+    fn load(&self, address: u64) -> u64 {
+        address.wrapping_add(self.slide)
+    }
+
+    fn address_json(&self, address: u64) -> Value {
+        match self.index.symbolize(address) {
+            Some(symbol) => json!({ "address": format!("0x{:x}", self.load(address)), "symbol": symbol }),
+            None => json!({ "address": format!("0x{:x}", self.load(address)) }),
+        }
+    }
+
+    /// Report with at most `max_results` references, at load addresses
+    pub fn to_json(&self, max_results: usize) -> Value {
+        let xrefs: Vec<Value> = self.hits.iter().take(max_results).map(|hit| json!({
+            "kind": hit.kind.name(),
+            "from": self.address_json(hit.from),
+            "to": self.address_json(hit.to)
+        })).collect();
+        json!({
+            "module": self.index.module,
+            "build_id": self.index.build_id,
+            "range": {
+                "start": self.address_json(self.start),
+                "end": format!("0x{:x}", self.load(self.end))
+            },
+            "count": self.hits.len(),
+            "truncated": self.hits.len() > max_results,
+            "xrefs": xrefs,
+            "sweep": self.index.progress().to_json()
+        })
+    }
+}
+
+/// Cut code sections into chunks of about `chunk_bytes`, ending each chunk at
+/// a function start so the decoder starts every chunk in sync
+pub fn plan_chunks(sections: &[(u64, u64)], functions: &[FunctionSymbol], chunk_bytes: u64) -> Vec<(u64, u64)> {
+    let mut chunks = Vec::new();
+    for &(section_start, section_end) in sections {
+        let mut start = section_start;
+        while start < section_end {
+            let wanted = start.saturating_add(chunk_bytes);
+            let first = functions.partition_point(|function| function.start < wanted);
+            let end = functions.get(first)
+                .map(|function| function.start)
+                .filter(|&cut| cut < section_end)
+                .unwrap_or(section_end);
+            chunks.push((start, end));
+            start = end;
+        }
+    }
+    chunks
+}
+
+fn c_text(ptr: *const std::os::raw::c_char) -> Option<String> {
+    if ptr.is_null() {
+        return None;
+    }
+    let text = unsafe { CStr::from_ptr(ptr) }.to_string_lossy().into_owned();
+    (!text.is_empty()).then_some(text)
+}
+
+fn collect_code_sections(section: SBSectionRef, out: &mut Vec<(u64, u64)>) {
+    let children = unsafe { SBSectionGetNumSubSections(section) };
+    if children > 0 {
+        for i in 0..children {
+            let child = unsafe { SBSectionGetSubSectionAtIndex(section, i) };
+            if !child.is_null() {
+                collect_code_sections(child, out);
+            }
+        }
+    } else if unsafe { SBSectionGetSectionType(section) } == SectionType::Code {
+        let start = unsafe { SBSectionGetFileAddress(section) };
+        let size = unsafe { SBSectionGetByteSize(section) };
+        if start != u64::MAX && size > 0 {
+            out.push((start, start + size));
+        }
+    }
+}
+
+/// Code sections and function symbols of a module, in file addresses
+pub(crate) fn module_layout(module: SBModuleRef) -> (Vec<(u64, u64)>, Vec<FunctionSymbol>) {
+    let mut sections = Vec::new();
+    for i in 0..unsafe { SBModuleGetNumSections(module) } {
+        let section = unsafe { SBModuleGetSectionAtIndex(module, i) };
+        if !section.is_null() {
+            collect_code_sections(section, &mut sections);
+        }
+    }
+    sections.sort_unstable();
+
+    let mut functions = Vec::new();
+    for i in 0..unsafe { SBModuleGetNumSymbols(module) } {
+        let symbol = unsafe { SBModuleGetSymbolAtIndex(module, i) };
+        if symbol.is_null() || !matches!(unsafe { SBSymbolGetType(symbol) }, SymbolType::Code | SymbolType::Trampoline) {
+            continue;
+        }
+        let (start, end) = unsafe { (SBSymbolGetStartAddress(symbol), SBSymbolGetEndAddress(symbol)) };
+        if start.is_null() || end.is_null() {
+            continue;
+        }
+        let (start, end) = unsafe { (SBAddressGetFileAddress(start), SBAddressGetFileAddress(end)) };
+        let Some(name) = c_text(unsafe { SBSymbolGetName(symbol) }) else {
+            continue;
+        };
+        if start != u64::MAX && end > start {
+            functions.push(FunctionSymbol { start, end, name });
+        }
+    }
+    functions.sort_by_key(|function| function.start);
+    functions.dedup_by_key(|function| function.start);
+    (sections, functions)
+}
+
+/// References made by the code in [start, end) of `module`, in file addresses
+pub(crate) fn sweep_range(target: SBTargetRef, module: SBModuleRef, start: u64, end: u64) -> Result<Vec<(u64, u64, XrefKind)>, String> {
+    let size = (end - start) as usize;
+    let base = unsafe { SBModuleResolveFileAddress(module, start) };
+    if base.is_null() {
+        return Err("address not in module".to_string());
+    }
+    let mut bytes = vec![0u8; size];
+    let error = unsafe { CreateSBError() };
+    let read = unsafe { SBTargetReadMemory(target, base, bytes.as_mut_ptr() as *mut c_void, size, error) };
+    unsafe {
+        DisposeSBError(error);
+        DisposeSBAddress(base);
+    }
+    if read == 0 {
+        return Err("unreadable".to_string());
+    }
+    bytes.truncate(read);
+
+    let flavor = CString::new("intel").map_err(|e| e.to_string())?;
+    let mut hits = Vec::new();
+    let mut position = 0usize;
+    while position < bytes.len() {
+        let window_end = (position + DECODE_WINDOW).min(bytes.len());
+        let last_window = window_end == bytes.len();
+        let address = start + position as u64;
+        let window_base = unsafe { SBModuleResolveFileAddress(module, address) };
+        if window_base.is_null() {
+            break;
+        }
+        let list = unsafe {
+            SBTargetGetInstructionsWithFlavor(target, window_base, flavor.as_ptr(),
+                bytes[position..window_end].as_mut_ptr() as *mut c_void, window_end - position)
+        };
+        unsafe { DisposeSBAddress(window_base) };
+        if list.is_null() {
+            break;
+        }
+
+        let mut offset = position;
+        for i in 0..unsafe { SBInstructionListGetSize(list) } {
+            let instruction = unsafe { SBInstructionListGetInstructionAtIndex(list, i as u32) };
+            if instruction.is_null() {
+                break;
+            }
+            let size = unsafe { SBInstructionGetByteSize(instruction) };
+            // An instruction cut by the window edge is decoded again at the next window
+            if size == 0 || (!last_window && offset + size + MAX_INSTRUCTION_BYTES > window_end) {
+                unsafe { DisposeSBInstruction(instruction) };
+                break;
+            }
+            let mnemonic = c_text(unsafe { SBInstructionGetMnemonic(instruction, target) }).unwrap_or_default();
+            let operands = c_text(unsafe { SBInstructionGetOperands(instruction, target) }).unwrap_or_default();
+            unsafe { DisposeSBInstruction(instruction) };
+            let here = start + offset as u64;
+            if let Some((to, kind)) = classify(&mnemonic, &operands, here, size as u32) {
+                hits.push((here, to, kind));
+            }
+            offset += size;
+        }
+        unsafe { DisposeSBInstructionList(list) };
+        // Always make progress, even over bytes that do not decode
+        position = if offset > position { offset } else { position + 1 };
+    }
+    Ok(hits)
+}
+
+/// Body of a sweep worker: open `module_path` in a private debugger and
+/// sweep each range, reporting chunks as they finish
+pub fn sweep_worker(module_path: &Path, ranges: &[(u64, u64)], mut emit: impl FnMut(u64, u64, Result<Vec<(u64, u64, XrefKind)>, String>)) {
+    let path = match CString::new(module_path.to_string_lossy().as_bytes()) {
+        Ok(path) => path,
+        Err(e) => {
+            ranges.iter().for_each(|&(start, end)| emit(start, end, Err(e.to_string())));
+            return;
+        }
+    };
+    unsafe { SBDebuggerInitialize() };
+    let debugger = unsafe { SBDebuggerCreate() };
+    if debugger.is_null() {
+        ranges.iter().for_each(|&(start, end)| emit(start, end, Err("failed to create debugger".to_string())));
+        return;
+    }
+    unsafe { SBDebuggerSetAsync(debugger, false) };
+    let target = unsafe { SBDebuggerCreateTarget2(debugger, path.as_ptr()) };
+    let module = if target.is_null() { std::ptr::null_mut() } else { unsafe { SBTargetGetModuleAtIndex(target, 0) } };
+    for &(start, end) in ranges {
+        let result = if module.is_null() {
+            Err("failed to open module".to_string())
+        } else {
+            sweep_range(target, module, start, end)
+        };
+        emit(start, end, result);
+    }
+    unsafe { SBDebuggerDestroy(debugger) };
+}
+
+/// One chunk as a worker output line
+pub fn chunk_json(start: u64, end: u64, result: &Result<Vec<(u64, u64, XrefKind)>, String>) -> Value {
+    match result {
+        Ok(hits) => json!({
+            "start": start,
+            "end": end,
+            "xrefs": hits.iter().map(|(from, to, kind)| [*from, *to, kind.code()]).collect::<Vec<_>>()
+        }),
+        Err(error) => json!({ "start": start, "end": end, "error": error }),
+    }
+}
+
+/// Record one worker output line. Returns the chunk start when the line is
+/// a well-formed report of a chunk in `share` not reported before.
+fn record_chunk_json(index: &XrefIndex, share: &[(u64, u64)], reported: &HashSet<u64>, line: &str) -> Option<u64> {
+    let value = serde_json::from_str::<Value>(line).ok()?;
+    let chunk = (value["start"].as_u64()?, value["end"].as_u64()?);
+    if !share.contains(&chunk) || reported.contains(&chunk.0) {
+        return None;
+    }
+    let (start, end) = chunk;
+    match value["xrefs"].as_array() {
+        Some(xrefs) => index.add_chunk(start, end, xrefs.iter().filter_map(|xref| {
+            Some((xref.get(0)?.as_u64()?, xref.get(1)?.as_u64()?, XrefKind::from_code(xref.get(2)?.as_u64()?)?))
+        })),
+        None => index.chunk_failed(start, end, value["error"].as_str().unwrap_or("worker error").to_string()),
+    }
+    Some(start)
+}
+
+/// Parse "start-end,start-end" in hex, as passed to `--xref-ranges`
+pub fn parse_ranges(text: &str) -> Vec<(u64, u64)> {
+    text.split(',')
+        .filter_map(|range| range.split_once('-'))
+        .filter_map(|(start, end)| Some((u64::from_str_radix(start, 16).ok()?, u64::from_str_radix(end, 16).ok()?)))
+        .filter(|(start, end)| end > start)
+        .collect()
+}
+
+fn format_ranges(ranges: &[(u64, u64)]) -> String {
+    ranges.iter().map(|(start, end)| format!("{:x}-{:x}", start, end)).collect::<Vec<_>>().join(",")
+}
+
+/// Sweep `chunks` of `module_path` into `index` with `worker_exe` processes.
+/// Returns at once; `on_complete` runs once, on the thread that finishes the sweep.
+pub fn start_sweep(
+    index: Arc<XrefIndex>,
+    worker_exe: PathBuf,
+    module_path: PathBuf,
+    chunks: Vec<(u64, u64)>,
+    on_complete: impl FnOnce(&Arc<XrefIndex>) + Send + 'static,
+) {
+    let workers = std::thread::available_parallelism().map(|n| n.get()).unwrap_or(1).min(chunks.len()).max(1);
+    info!("Sweeping {} for cross-references: {} chunks, {} worker processes", module_path.display(), chunks.len(), workers);
+    let on_complete: Arc<Mutex<Option<Box<dyn FnOnce(&Arc<XrefIndex>) + Send>>>> = Arc::new(Mutex::new(Some(Box::new(on_complete))));
+
+    // Interleave so every worker covers the whole module and early results are spread out
+    let mut shares: Vec<Vec<(u64, u64)>> = vec![Vec::new(); workers];
+    for (i, chunk) in chunks.into_iter().enumerate() {
+        shares[i % workers].push(chunk);
+    }
+
+    for share in shares {
+        let index = index.clone();
+        let module_path = module_path.clone();
+        let worker_exe = worker_exe.clone();
+        let on_complete = on_complete.clone();
+        std::thread::spawn(move || {
+            if let Err(error) = run_worker_process(&worker_exe, &module_path, &share, &index) {
+                warn!("Cross-reference worker for {} failed: {}", module_path.display(), error);
+                for &(start, end) in &share {
+                    index.chunk_failed(start, end, error.clone());
+                }
+            }
+            if index.is_complete() {
+                if let Some(on_complete) = on_complete.lock().unwrap().take() {
+                    on_complete(&index);
+                }
+            }
+        });
+    }
+}
+
+/// Run one share through `incode --xref-worker`, recording chunks as lines arrive
+fn run_worker_process(exe: &Path, module_path: &Path, share: &[(u64, u64)], index: &XrefIndex) -> Result<(), String> {
+    let mut child = Command::new(exe)
+        .arg("--xref-worker")
+        .arg(module_path)
+        .arg("--xref-ranges")
+        .arg(format_ranges(share))
+        .stdin(Stdio::null())
+        .stdout(Stdio::piped())
+        .stderr(Stdio::null())
+        .spawn()
+        .map_err(|e| format!("failed to start worker: {}", e))?;
+
+    // Lines come through a channel so a hung worker can be given up on
+    let stdout = child.stdout.take().expect("worker stdout is piped");
+    let (line_tx, lines) = mpsc::channel();
+    std::thread::spawn(move || {
+        for line in BufReader::new(stdout).lines() {
+            let Ok(line) = line else {
+                break;
+            };
+            if line_tx.send(line).is_err() {
+                break;
+            }
+        }
+    });
+
+    let timeout = WORKER_CHUNK_TIMEOUT * share.len() as u32;
+    let deadline = Instant::now() + timeout;
+    let mut reported = HashSet::new();
+    let timed_out = loop {
+        match lines.recv_timeout(deadline.saturating_duration_since(Instant::now())) {
+            Ok(line) => match record_chunk_json(index, share, &reported, &line) {
+                Some(start) => {
+                    reported.insert(start);
+                }
+                None => debug!("Ignoring unexpected cross-reference worker output: {}", line),
+            },
+            Err(RecvTimeoutError::Timeout) => break true,
+            Err(RecvTimeoutError::Disconnected) => break false,
+        }
+    };
+    if timed_out {
+        warn!("Cross-reference worker for {} timed out after {}s", module_path.display(), timeout.as_secs());
+        let _ = child.kill();
+    }
+    let status = child.wait().map_err(|e| e.to_string())?;
+    debug!("Cross-reference worker reported {} of {} chunks, {}", reported.len(), share.len(), status);
+    // Chunks the worker never reported, because it hung, died or garbled them, failed
+    let reason = if timed_out {
+        format!("worker timed out after {}s", timeout.as_secs())
+    } else {
+        format!("worker exited with {}", status)
+    };
+    for &(start, end) in share.iter().filter(|(start, _)| !reported.contains(start)) {
+        index.chunk_failed(start, end, reason.clone());
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_xref_index_chunks_and_queries() {
+        let function = |start: u64, end: u64, name: &str| FunctionSymbol { start, end, name: name.to_string() };
+        let functions = vec![
+            function(0x1000, 0x1800, "a"),
+            function(0x1800, 0x2400, "b"),
+            function(0x2400, 0x3000, "c"),
+        ];
+
+        // Chunks end at the first function start past the target size
+        let chunks = plan_chunks(&[(0x1000, 0x3000)], &functions, 0x1000);
+        assert_eq!(chunks, vec![(0x1000, 0x2400), (0x2400, 0x3000)]);
+
+        assert_eq!(classify("call", "0x1800", 0x1010, 5), Some((0x1800, XrefKind::Call)));
+        assert_eq!(classify("jne", "0x1020", 0x1010, 2), Some((0x1020, XrefKind::Jump)));
+        assert_eq!(classify("mov", "rax, qword ptr [rip + 0x10]", 0x1010, 7), Some((0x1027, XrefKind::Data)));
+        assert_eq!(classify("ret", "", 0x1010, 1), None);
+
+        let index = XrefIndex::new("/bin/demo".to_string(), None, 0x1000, functions, &chunks);
+        // Second chunk arrives first; queries answer from what has been swept
+        index.add_chunk(0x2400, 0x3000, vec![(0x2410, 0x1800, XrefKind::Call)]);
+        assert_eq!(index.xrefs_to(0x1800, 0x1801).len(), 1);
+        assert!(!index.is_complete());
+
+        index.add_chunk(0x1000, 0x2400, vec![
+            (0x1010, 0x1800, XrefKind::Call),
+            (0x1020, 0x1030, XrefKind::Jump),
+            (0x1900, 0x2400, XrefKind::Call),
+        ]);
+        assert!(index.is_complete());
+        assert_eq!(index.progress().xrefs, 4);
+
+        let callers: Vec<u64> = index.xrefs_to(0x1800, 0x1801).iter().map(|hit| hit.from).collect();
+        assert_eq!(callers, vec![0x1010, 0x2410]);
+        // Whole-function range catches references to any address in b
+        assert_eq!(index.xrefs_to(0x1800, 0x2400).len(), 2);
+
+        let callees = index.xrefs_from(0x1000, 0x1800);
+        assert_eq!(callees.len(), 2);
+        assert_eq!(index.xrefs_from(0x1800, 0x2400)[0].to, 0x2400);
+
+        assert_eq!(index.symbolize(0x1810).as_deref(), Some("b+0x10"));
+        assert_eq!(index.symbolize(0x3000), None);
+    }
+
+    #[test]
+    fn test_xref_sweep_rejects_bad_chunks() {
+        let chunks = vec![(0x1000, 0x2000), (0x2000, 0x3000)];
+        let index = XrefIndex::new("/bin/demo".to_string(), None, 0x1000, Vec::new(), &chunks);
+
+        // Garbage, chunks outside the share and repeats are not reports
+        let mut reported = HashSet::new();
+        assert_eq!(record_chunk_json(&index, &chunks, &reported, "Segmentation fault"), None);
+        assert_eq!(record_chunk_json(&index, &chunks, &reported, r#"{"start": 20480, "end": 24576, "xrefs": []}"#), None);
+        let line = r#"{"start": 4096, "end": 8192, "xrefs": [[4112, 8192, 0]]}"#;
+        reported.extend(record_chunk_json(&index, &chunks, &reported, line));
+        assert_eq!(record_chunk_json(&index, &chunks, &reported, line), None);
+        assert_eq!(index.progress().chunks_done, 1);
+        assert_eq!(index.progress().xrefs, 1);
+
+        // A chunk below the base cannot be stored and fails instead of landing at offset 0
+        index.add_chunk(0x800, 0x900, vec![(0x810, 0x1000, XrefKind::Call)]);
+        let progress = index.progress();
+        assert_eq!(progress.xrefs, 1);
+        assert_eq!(progress.errors.len(), 1);
+        assert_eq!(index.xrefs_to(0x1000, 0x1001).len(), 0);
+    }
+}
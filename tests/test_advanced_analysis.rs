@@ -437,4 +437,364 @@ async fn test_advanced_analysis_integration() {
     // Cleanup
     let _ = fs::remove_file(temp_path);
     session.cleanup().expect("Failed to cleanup session");
-}
\ No newline at end of file
+}
+/// Build a minimal x86-64 ELF core: one thread that took SIGSEGV at 0xdead0000,
+/// one file mapping and a PT_LOAD segment whose tail was not dumped. With
+/// `extended_numbering` the header count is PN_XNUM and the real one is in
+/// section header 0, as kernels write cores with 65535 or more segments.
+fn write_synthetic_core(path: &Path, extended_numbering: bool) {
+    fn note(out: &mut Vec<u8>, note_type: u32, desc: &[u8]) {
+        out.extend_from_slice(&5u32.to_le_bytes());
+        out.extend_from_slice(&(desc.len() as u32).to_le_bytes());
+        out.extend_from_slice(&note_type.to_le_bytes());
+        out.extend_from_slice(b"CORE\0\0\0\0");
+        out.extend_from_slice(desc);
+        while out.len() % 4 != 0 {
+            out.push(0);
+        }
+    }
+
+    let mut prstatus = vec![0u8; 336];
+    prstatus[12..14].copy_from_slice(&11u16.to_le_bytes());
+    prstatus[32..36].copy_from_slice(&4242u32.to_le_bytes());
+    prstatus[112 + 16 * 8..112 + 17 * 8].copy_from_slice(&0x401000u64.to_le_bytes());
+    prstatus[112 + 19 * 8..112 + 20 * 8].copy_from_slice(&0x7ffc0000u64.to_le_bytes());
+
+    let mut siginfo = vec![0u8; 128];
+    siginfo[0..4].copy_from_slice(&11u32.to_le_bytes());
+    siginfo[8..12].copy_from_slice(&1u32.to_le_bytes());
+    siginfo[16..24].copy_from_slice(&0xdead0000u64.to_le_bytes());
+
+    let mut file_note = Vec::new();
+    for value in [1u64, 4096, 0x400000, 0x402000, 0] {
+        file_note.extend_from_slice(&value.to_le_bytes());
+    }
+    file_note.extend_from_slice(b"/usr/bin/fake\0");
+
+    let mut notes = Vec::new();
+    note(&mut notes, 1, &prstatus);
+    note(&mut notes, 0x5349_4749, &siginfo);
+    note(&mut notes, 0x4649_4c45, &file_note);
+
+    let notes_offset = 64 + 2 * 56;
+    let load_offset = notes_offset + notes.len();
+    let load_data = b"0123456789abcdef";
+
+    let mut core = vec![0u8; 64];
+    core[..7].copy_from_slice(b"\x7fELF\x02\x01\x01");
+    core[16..18].copy_from_slice(&4u16.to_le_bytes());
+    core[18..20].copy_from_slice(&62u16.to_le_bytes());
+    core[20..24].copy_from_slice(&1u32.to_le_bytes());
+    core[32..40].copy_from_slice(&64u64.to_le_bytes());
+    core[52..54].copy_from_slice(&64u16.to_le_bytes());
+    core[54..56].copy_from_slice(&56u16.to_le_bytes());
+    if extended_numbering {
+        let shoff = (load_offset + load_data.len()) as u64;
+        core[40..48].copy_from_slice(&shoff.to_le_bytes());
+        core[56..58].copy_from_slice(&0xffffu16.to_le_bytes());
+        core[58..60].copy_from_slice(&64u16.to_le_bytes());
+        core[60..62].copy_from_slice(&1u16.to_le_bytes());
+    } else {
+        core[56..58].copy_from_slice(&2u16.to_le_bytes());
+    }
+
+    // (type, flags, offset, vaddr, filesz, memsz)
+    let headers = [
+        (4u32, 0u32, notes_offset as u64, 0u64, notes.len() as u64, 0u64),
+        (1, 4 | 1, load_offset as u64, 0x400000, load_data.len() as u64, 0x2000),
+    ];
+    for (p_type, flags, offset, vaddr, filesz, memsz) in headers {
+        core.extend_from_slice(&p_type.to_le_bytes());
+        core.extend_from_slice(&flags.to_le_bytes());
+        for value in [offset, vaddr, vaddr, filesz, memsz, 0] {
+            core.extend_from_slice(&value.to_le_bytes());
+        }
+    }
+    core.extend_from_slice(&notes);
+    core.extend_from_slice(load_data);
+    if extended_numbering {
+        let mut shdr = [0u8; 64];
+        shdr[44..48].copy_from_slice(&2u32.to_le_bytes());
+        core.extend_from_slice(&shdr);
+    }
+    fs::write(path, core).expect("Failed to write synthetic core");
+}
+
+#[tokio::test]
+async fn test_core_file_reader() {
+    use incode::core_file::CoreFile;
+
+    let dir = tempfile::tempdir().expect("Failed to create temp dir");
+    let core_path = dir.path().join("core.synthetic");
+    write_synthetic_core(&core_path, false);
+
+    let core = CoreFile::open(&core_path).expect("Failed to open synthetic core");
+    let signal = core.signal.as_ref().expect("Core should carry NT_SIGINFO");
+    assert_eq!(signal.signo, 11);
+    assert_eq!(signal.code, 1);
+    assert_eq!(signal.fault_address, Some(0xdead0000));
+
+    let thread = core.faulting_thread().expect("Core should have a thread");
+    assert_eq!(thread.tid, 4242);
+    assert_eq!(thread.pc, Some(0x401000));
+    assert_eq!(thread.sp, Some(0x7ffc0000));
+    assert_eq!(core.executable_path(), Some("/usr/bin/fake"));
+    assert_eq!(core.segment_at(0x400010).map(|segment| segment.permissions()), Some("r-x".to_string()));
+
+    // Within the dumped bytes, across the end of them, at the segment end and unmapped
+    let mut buffer = [0xffu8; 8];
+    assert_eq!(core.read_memory(0x400004, &mut buffer), 8);
+    assert_eq!(&buffer, b"456789ab");
+    assert_eq!(core.read_memory(0x40000c, &mut buffer), 8);
+    assert_eq!(&buffer, b"cdef\0\0\0\0");
+    let mut buffer = [0u8; 16];
+    assert_eq!(core.read_memory(0x401ff8, &mut buffer), 8);
+    assert_eq!(core.read_memory(0x500000, &mut buffer), 0);
+
+    // Extended program header numbering
+    let extended_path = dir.path().join("core.extended");
+    write_synthetic_core(&extended_path, true);
+    let extended = CoreFile::open(&extended_path).expect("Failed to open core with PN_XNUM");
+    assert_eq!(extended.segments.len(), 1);
+    assert_eq!(extended.faulting_thread().map(|thread| thread.tid), Some(4242));
+
+    // Anything that is not an ELF core is rejected
+    let not_core = dir.path().join("not_core");
+    fs::write(&not_core, vec![0u8; 128]).unwrap();
+    assert!(CoreFile::open(&not_core).is_err(), "Non-ELF file should be rejected");
+    println!("✅ core_file: Parsed notes and served memory from synthetic core");
+
+    match incode::lldb_manager::LldbManager::new(None) {
+        Ok(mut manager) => {
+            assert!(manager.load_core("/nonexistent/core", None).is_err(), "Missing core should fail to load");
+            println!("✅ load_core: Correctly rejected missing core file");
+        }
+        Err(e) => println!("⚠️ load_core: LLDB manager creation failed: {}", e),
+    }
+}
+
+#[tokio::test]
+async fn test_triage_signature_normalization() {
+    use incode::crash_triage::{normalize_frames, signature_hash};
+
+    let stack = vec![
+        "raise (libc.so.6)".to_string(),
+        "abort (libc.so.6)".to_string(),
+        "parse_header + 12 (libproto.so)".to_string(),
+        "handle_request (server)".to_string(),
+        "main (server)".to_string(),
+    ];
+    let frames = normalize_frames(stack, 2);
+    assert_eq!(frames, vec!["parse_header (libproto.so)", "handle_request (server)"]);
+
+    // Same frames, same bucket; the signal is part of the signature
+    assert_eq!(signature_hash(6, &frames), signature_hash(6, &frames.clone()));
+    assert_ne!(signature_hash(6, &frames), signature_hash(11, &frames));
+    assert_ne!(signature_hash(6, &frames), signature_hash(6, &frames[..1]));
+    println!("✅ triage: Signal frames dropped and offsets stripped from signatures");
+}
+
+#[tokio::test]
+async fn test_triage_cores_directory() {
+    use incode::crash_triage::{triage_cores, TriageOptions};
+
+    let dir = tempfile::tempdir().expect("Failed to create temp dir");
+    fs::write(dir.path().join("notes.txt"), "not a core").unwrap();
+    assert!(triage_cores(&dir.path().to_string_lossy(), &TriageOptions::default()).is_err(), "Directory without cores should fail");
+
+    write_synthetic_core(&dir.path().join("core.1"), false);
+    let options = TriageOptions { analyze: false, ..TriageOptions::default() };
+    match triage_cores(&dir.path().to_string_lossy(), &options) {
+        Ok(report) => {
+            assert_eq!(report.cores_found, 1);
+            let bucketed: usize = report.buckets.iter().map(|bucket| bucket.count).sum();
+            assert_eq!(bucketed + report.failures.len(), 1, "Every core is bucketed or reported as failed");
+            println!("✅ triage_cores: {} buckets, {} failures", report.buckets.len(), report.failures.len());
+        }
+        Err(e) => println!("⚠️ triage_cores failed (may be expected without LLDB): {}", e),
+    }
+}
+
+#[tokio::test]
+async fn test_generate_minidump_round_trip() {
+    use incode::core_file::CoreFile;
+    use incode::minidump::MinidumpOptions;
+
+    let dir = tempfile::tempdir().expect("Failed to create temp dir");
+    let dump_path = dir.path().join("compact.core");
+    let dump_str = dump_path.to_string_lossy().to_string();
+
+    let mut session = match TestSession::new(TestMode::Normal) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ minidump: Could not create test session: {}", e);
+            return;
+        }
+    };
+    assert!(session.lldb_manager().generate_minidump(&dump_str, &MinidumpOptions::default()).is_err(),
+        "Compact dump should fail without a process");
+
+    if let Err(e) = session.start() {
+        println!("⚠️ minidump: Could not start debugging session: {}", e);
+        return;
+    }
+    let _ = session.lldb_manager().interrupt_execution();
+
+    match session.lldb_manager().generate_minidump(&dump_str, &MinidumpOptions::default()) {
+        Ok(report) => {
+            println!("✅ minidump: {} bytes, {} threads, {} ranges", report.file_size, report.threads, report.ranges);
+            assert!(report.file_size < 64 * 1024 * 1024, "Compact dump should stay megabyte-scale");
+
+            let core = CoreFile::open(&dump_path).expect("Compact dump should be a readable core");
+            assert_eq!(core.threads.len(), report.threads);
+            assert_eq!(core.region_map.len(), report.regions);
+            assert!(!core.modules.is_empty(), "Compact dump should list modules");
+
+            match session.lldb_manager().load_core(&dump_str, None) {
+                Ok(summary) => {
+                    assert_eq!(summary.threads, report.threads);
+                    let regions = session.lldb_manager().get_memory_regions().expect("Regions from compact dump");
+                    assert_eq!(regions.len(), report.regions);
+                    println!("✅ load_core: Reloaded compact dump with {} threads", summary.threads);
+                }
+                Err(e) => println!("⚠️ load_core of compact dump failed: {}", e),
+            }
+        }
+        Err(e) => println!("⚠️ minidump failed (may be expected): {}", e),
+    }
+
+    let _ = session.cleanup();
+}
+
+#[tokio::test]
+async fn test_crash_database() {
+    use incode::crash_db::{CrashDatabase, CrashObservation};
+
+    let dir = tempfile::tempdir().expect("Failed to create temp dir");
+    let db_path = dir.path().join("crashdb");
+    assert!(CrashDatabase::open_existing(&db_path).unwrap().is_none(), "Lookups must not create a database");
+
+    let frames = vec!["parse_header (libproto.so)".to_string(), "main (server)".to_string()];
+    let observe = |db: &mut CrashDatabase, signature: u64, core: &str, build: &str| {
+        db.observe(&CrashObservation {
+            signature,
+            signal: 11,
+            frames: &frames,
+            core_path: Some(core),
+            build: Some(build),
+            summary: "SIGSEGV in parse_header",
+        }).expect("Failed to record crash")
+    };
+
+    let mut db = CrashDatabase::open(&db_path).expect("Failed to create crash database");
+    let first = observe(&mut db, 0x1234, "/cores/core.1", "build-a");
+    observe(&mut db, 0x1234, "/cores/core.2", "build-b");
+    observe(&mut db, 0x1234, "/cores/core.2", "build-b");
+    let other = observe(&mut db, 0x5678, "/cores/core.3", "build-b");
+    assert_eq!(first.bucket_id, 1);
+    assert_eq!(other.bucket_id, 2);
+    assert_eq!(db.len().unwrap(), 2);
+    drop(db);
+
+    // Reopen: history survives, and a lost index is rebuilt from the log
+    fs::remove_file(db_path.join("index.bin")).unwrap();
+    let db = CrashDatabase::open(&db_path).expect("Failed to reopen crash database");
+    let record = db.lookup(0x1234).unwrap().expect("Known signature");
+    assert_eq!(record.count, 2, "A core seen twice is counted once");
+    assert_eq!(record.first_build.as_deref(), Some("build-a"));
+    assert_eq!(record.last_build.as_deref(), Some("build-b"));
+    assert_eq!(record.representative.as_deref(), Some("/cores/core.1"));
+    assert_eq!(record.frames, frames);
+    assert!(record.describe().contains("bucket #1, seen 2 times since build build-a"));
+    assert!(db.lookup(0x9999).unwrap().is_none());
+    drop(db);
+
+    // A corrupt record is skipped on replay; the valid ones after it are kept
+    let log_path = db_path.join("records.log");
+    let mut log = fs::read(&log_path).unwrap();
+    log[4..8].copy_from_slice(&u32::MAX.to_le_bytes());
+    fs::write(&log_path, &log).unwrap();
+    fs::remove_file(db_path.join("index.bin")).unwrap();
+    let db = CrashDatabase::open(&db_path).expect("A corrupt record must not fail the open");
+    assert_eq!(db.lookup(0x5678).unwrap().map(|record| record.bucket_id), Some(2));
+    assert_eq!(db.lookup(0x1234).unwrap().map(|record| record.count), Some(2));
+    assert_eq!(fs::read(&log_path).unwrap().len(), log.len(), "Records after the corrupt one stay in the log");
+    drop(db);
+
+    // A new dump written over an old one's name is a new sighting
+    let mut db = CrashDatabase::open(&db_path).expect("Failed to reopen crash database");
+    let core_path = dir.path().join("core.reused");
+    fs::write(&core_path, b"first dump").unwrap();
+    let core = core_path.to_string_lossy();
+    assert_eq!(observe(&mut db, 0x5678, &core, "build-b").count, 2);
+    assert_eq!(observe(&mut db, 0x5678, &core, "build-b").count, 2, "The same file is counted once");
+    fs::write(&core_path, b"second, longer dump").unwrap();
+    assert_eq!(observe(&mut db, 0x5678, &core, "build-b").count, 3);
+    println!("✅ crash_db: {}", record.describe());
+}
+
+#[tokio::test]
+async fn test_fault_decoding() {
+    use std::collections::BTreeMap;
+    use incode::fault_decode::{decode_fault, parse_memory_operand, parse_stop_description, FaultingInstruction};
+    use incode::lldb_manager::MemoryRegion;
+
+    let operand = parse_memory_operand("mov", "dword ptr [rax + 4*rcx + 0x10], 0x1").expect("Intel operand");
+    assert_eq!((operand.base.as_deref(), operand.index.as_deref(), operand.scale, operand.displacement), (Some("rax"), Some("rcx"), 4, 0x10));
+    assert!(operand.is_write);
+    assert!(!parse_memory_operand("mov", "rax, qword ptr [rbp - 0x8]").unwrap().is_write);
+    let operand = parse_memory_operand("movq", "%rdi, -0x8(%rbp)").expect("AT&T operand");
+    assert_eq!((operand.base.as_deref(), operand.displacement, operand.is_write), (Some("rbp"), -8, true));
+    let operand = parse_memory_operand("str", "x0, [x1, #0x8]").expect("AArch64 operand");
+    assert_eq!((operand.base.as_deref(), operand.displacement, operand.is_write), (Some("x1"), 8, true));
+    assert!(parse_memory_operand("lea", "rax, [rbx + 0x8]").is_none(), "lea does not access memory");
+    assert_eq!(parse_stop_description(libc::SIGSEGV, "signal SIGSEGV: address not mapped to object (fault address: 0x18)"), (Some(1), Some(0x18)));
+    // The same words mean different codes under different signals
+    assert_eq!(parse_stop_description(libc::SIGBUS, "signal SIGBUS: illegal address (fault address: 0x10)").0, Some(2));
+    assert_eq!(parse_stop_description(libc::SIGILL, "signal SIGILL: illegal addressing mode").0, Some(3));
+    assert_eq!(parse_stop_description(libc::SIGSEGV, "signal SIGSEGV: sent by tkill").0, Some(-6));
+
+    let region = |start: u64, end: u64, permissions: &str, name: Option<&str>| MemoryRegion {
+        start_address: start,
+        end_address: end,
+        size: end - start,
+        permissions: permissions.to_string(),
+        name: name.map(String::from),
+    };
+    let regions = vec![
+        region(0x400000, 0x401000, "r-x", Some("/bin/app")),
+        region(0x402000, 0x403000, "r--", Some("/bin/app")),
+        region(0x7ffffffde000, 0x7ffffffff000, "rw-", Some("[stack]")),
+    ];
+    let registers: BTreeMap<String, u64> = [("rip", 0x400100), ("rsp", 0x7ffffffde010), ("rbx", 0x0), ("rdi", 0x402010), ("rax", 0x1234_5678_9000)]
+        .into_iter()
+        .map(|(name, value)| (name.to_string(), value))
+        .collect();
+    let instruction = |mnemonic: &str, operands: &str| Some(FaultingInstruction {
+        address: 0x400100,
+        size: 4,
+        mnemonic: mnemonic.to_string(),
+        operands: operands.to_string(),
+    });
+
+    let fault = decode_fault(11, Some(1), Some(0x18), &registers, instruction("mov", "rax, qword ptr [rbx + 0x18]"), &regions);
+    assert_eq!(fault.classification, "null_dereference");
+    assert_eq!(fault.computed_address, Some(0x18));
+    assert_eq!(fault.base_register, Some(("rbx".to_string(), 0)));
+
+    let fault = decode_fault(11, Some(2), Some(0x402010), &registers, instruction("mov", "byte ptr [rdi], 0x0"), &regions);
+    assert_eq!((fault.classification, fault.access), ("write_to_readonly", "write"));
+
+    let fault = decode_fault(11, Some(1), Some(0x12345678a000), &registers, instruction("mov", "qword ptr [rax + 0x1000], rdi"), &regions);
+    assert_eq!(fault.classification, "wild_write");
+
+    let fault = decode_fault(11, Some(1), Some(0x7ffffffdd008), &registers, instruction("push", "rbp"), &regions);
+    assert_eq!(fault.classification, "stack_overflow");
+
+    // A general protection fault reports address 0; the operand has the real one
+    let mut gp_registers = registers.clone();
+    gp_registers.insert("rbx".to_string(), 0xdead_beef_dead_beef);
+    let fault = decode_fault(11, Some(0x80), Some(0), &gp_registers, instruction("mov", "rax, qword ptr [rbx]"), &regions);
+    assert_eq!(fault.classification, "non_canonical");
+    println!("✅ fault decoding: {}", fault.description);
+}
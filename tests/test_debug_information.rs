@@ -354,4 +354,98 @@ async fn test_debug_information_error_handling() {
     }
     
     session.cleanup().expect("Failed to cleanup session");
-}
\ No newline at end of file
+}
+
+#[tokio::test]
+async fn test_function_cfg_for_main() {
+    println!("Testing function_cfg");
+
+    let mut session = match TestSession::new(TestMode::Normal) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ function_cfg: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    match session.start() {
+        Ok(_pid) => {
+            let address = match session.lldb_manager().function_address("main") {
+                Ok(address) => address,
+                Err(e) => {
+                    println!("⚠️ function_cfg: Could not resolve main: {}", e);
+                    let _ = session.cleanup();
+                    return;
+                }
+            };
+            match session.lldb_manager().function_cfg(address) {
+                Ok((start, cfg)) => {
+                    assert_eq!(start, address);
+                    assert!(!cfg.blocks.is_empty());
+                    println!("✅ function_cfg: main has {} blocks, {} edges, {} loops",
+                             cfg.blocks.len(), cfg.edge_count(), cfg.loops.len());
+
+                    let (_, again) = session.lldb_manager().function_cfg(address).unwrap();
+                    assert!(std::sync::Arc::ptr_eq(&cfg, &again), "Second request should come from the cache");
+                }
+                Err(e) => {
+                    println!("⚠️ function_cfg: failed: {}", e);
+                }
+            }
+        }
+        Err(e) => {
+            println!("⚠️ function_cfg: Could not start debugging session: {}", e);
+        }
+    }
+
+    let _ = session.cleanup();
+}
+
+#[tokio::test]
+async fn test_xrefs_for_main() {
+    println!("Testing xrefs_from");
+
+    let mut session = match TestSession::new(TestMode::Normal) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ xrefs_from: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    match session.start() {
+        Ok(_pid) => {
+            let address = match session.lldb_manager().function_address("main") {
+                Ok(address) => address,
+                Err(e) => {
+                    println!("⚠️ xrefs_from: Could not resolve main: {}", e);
+                    let _ = session.cleanup();
+                    return;
+                }
+            };
+            match session.lldb_manager().xrefs_from(address, false, std::time::Duration::from_secs(30)) {
+                Ok(query) => {
+                    let calls = query.hits.iter().filter(|hit| hit.kind == incode::xref_index::XrefKind::Call).count();
+                    println!("✅ xrefs_from: main makes {} calls ({} references)", calls, query.hits.len());
+                    assert!(query.hits.iter().all(|hit| (query.start..query.end).contains(&hit.from)));
+
+                    // Every call main makes should show up as a reference to its target
+                    if let Some(call) = query.hits.iter().find(|hit| hit.kind == incode::xref_index::XrefKind::Call) {
+                        let callee = call.to.wrapping_add(query.slide);
+                        if let Ok(callers) = session.lldb_manager().xrefs_to(callee, false, std::time::Duration::from_secs(30)) {
+                            assert!(callers.hits.iter().any(|hit| hit.from == call.from));
+                        }
+                    }
+                }
+                Err(e) => {
+                    println!("⚠️ xrefs_from: failed: {}", e);
+                }
+            }
+        }
+        Err(e) => {
+            println!("⚠️ xrefs_from: Could not start debugging session: {}", e);
+        }
+    }
+
+    let _ = session.cleanup();
+}
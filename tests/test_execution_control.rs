@@ -535,4 +535,154 @@ async fn test_execution_control_performance() {
     }
     
     let _ = session.cleanup();
-}
\ No newline at end of file
+}
+
+#[tokio::test]
+async fn test_continue_async_no_process() {
+    // continue_async - Test error handling when no process attached
+    println!("Testing continue_async with no process");
+
+    let manager = match LldbManager::new(None) {
+        Ok(m) => m,
+        Err(e) => {
+            println!("⚠️ continue_async: LLDB manager creation failed: {}", e);
+            return;
+        }
+    };
+
+    let result = manager.continue_async();
+    assert!(result.is_err(), "continue_async should fail without a process");
+    println!("✅ continue_async: Correctly rejected with no process");
+}
+
+#[tokio::test]
+async fn test_wait_for_stop_no_process() {
+    // wait_for_stop - Test error handling when no process attached
+    println!("Testing wait_for_stop with no process");
+
+    let mut manager = match LldbManager::new(None) {
+        Ok(m) => m,
+        Err(e) => {
+            println!("⚠️ wait_for_stop: LLDB manager creation failed: {}", e);
+            return;
+        }
+    };
+
+    match manager.wait_for_stop(100) {
+        Err(IncodeError::Timeout) => panic!("wait_for_stop should not time out without a process"),
+        Err(e) => println!("✅ wait_for_stop: Correctly rejected with no process: {}", e),
+        Ok(_) => panic!("wait_for_stop should fail without a process"),
+    }
+}
+
+#[tokio::test]
+async fn test_continue_async_infinite_times_out_and_interrupts() {
+    // continue_async + wait_for_stop - a process that never stops must not block the caller
+    println!("Testing continue_async with an infinite loop debuggee");
+
+    let mut session = match TestSession::new(TestMode::Infinite) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ continue_async: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    match session.start() {
+        Ok(pid) => {
+            println!("✅ continue_async: Test session started with PID {}", pid);
+
+            // Make sure the process is at rest before resuming it asynchronously
+            let _ = session.lldb_manager().interrupt_execution();
+
+            let start_time = std::time::Instant::now();
+            match session.lldb_manager().continue_async() {
+                Ok(_) => {
+                    assert!(start_time.elapsed() < Duration::from_secs(5), "continue_async should return immediately");
+
+                    let result: IncodeResult<_> = session.lldb_manager().wait_for_stop(200);
+                    match result {
+                        Err(IncodeError::Timeout) => println!("✅ wait_for_stop: Timed out while process kept running"),
+                        other => println!("⚠️ wait_for_stop: Unexpected result: {:?}", other),
+                    }
+
+                    match session.lldb_manager().interrupt_execution() {
+                        Ok(_) => println!("✅ interrupt_execution: Stopped asynchronously running process"),
+                        Err(e) => println!("⚠️ interrupt_execution failed: {}", e),
+                    }
+                }
+                Err(e) => println!("⚠️ continue_async failed (may be expected): {}", e),
+            }
+        }
+        Err(e) => {
+            println!("⚠️ continue_async: Could not start debugging session: {}", e);
+        }
+    }
+
+    let _ = session.cleanup();
+}
+
+#[tokio::test]
+async fn test_checkpoints_no_process() {
+    // checkpoint / restore_checkpoint / delete_checkpoint - Test error handling without a process
+    println!("Testing checkpoints with no process");
+
+    let mut manager = match LldbManager::new(None) {
+        Ok(m) => m,
+        Err(e) => {
+            println!("⚠️ checkpoint: LLDB manager creation failed: {}", e);
+            return;
+        }
+    };
+
+    assert!(manager.checkpoint(Some("start")).is_err(), "checkpoint should fail without a process");
+    assert!(manager.list_checkpoints().is_empty());
+    assert!(manager.restore_checkpoint(1, false).is_err(), "restoring an unknown checkpoint should fail");
+    assert!(manager.delete_checkpoint(1).is_err(), "deleting an unknown checkpoint should fail");
+    println!("✅ checkpoints: Correctly rejected with no process");
+}
+
+#[tokio::test]
+async fn test_checkpoint_round_trip() {
+    // checkpoint / restore_checkpoint - Take a checkpoint, move on, and go back to it
+    println!("Testing checkpoint and restore_checkpoint");
+
+    let mut session = match TestSession::new(TestMode::StepDebug) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ checkpoint: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    if let Err(e) = session.start() {
+        println!("⚠️ checkpoint: Could not start debugging session: {}", e);
+        return;
+    }
+
+    let manager = session.lldb_manager();
+    match manager.checkpoint(Some("before step")) {
+        Ok(checkpoint) => {
+            println!("✅ checkpoint: Clone PID {} at 0x{:x}", checkpoint.pid, checkpoint.pc);
+            assert_eq!(manager.list_checkpoints().len(), 1);
+
+            let _ = manager.step_over();
+            match manager.restore_checkpoint(checkpoint.id, true) {
+                Ok(restore) => {
+                    println!(
+                        "✅ restore_checkpoint: PID {} at 0x{:x}, {} registers restored",
+                        restore.pid, restore.pc, restore.registers_restored
+                    );
+                    assert_eq!(restore.pid, checkpoint.pid);
+                    let kept = restore.kept.expect("checkpoint should be kept");
+                    assert_eq!(kept.id, checkpoint.id);
+                    assert!(manager.delete_checkpoint(kept.id).is_ok());
+                }
+                Err(e) => println!("⚠️ restore_checkpoint failed (may be expected): {}", e),
+            }
+        }
+        Err(e) => println!("⚠️ checkpoint failed (may be expected): {}", e),
+    }
+
+    let _ = session.cleanup();
+}
@@ -669,4 +669,75 @@ async fn test_memory_modification_verification() {
     }
     
     let _ = session.cleanup();
-}
\ No newline at end of file
+}
+
+#[tokio::test]
+async fn test_disassembly_cache_and_symbolic_operands() {
+    println!("Testing disassembly cache and symbolic operands");
+
+    use incode::disassembly::operand_target;
+    assert_eq!(operand_target("call", "0x401136", 0x401000, 5), Some(0x401136));
+    assert_eq!(operand_target("jne", "0x401020", 0x401000, 2), Some(0x401020));
+    assert_eq!(operand_target("lea", "rdi, [rip + 0x2ee5]", 0x401000, 7), Some(0x401007 + 0x2ee5));
+    assert_eq!(operand_target("mov", "rax, qword ptr [rip - 0x10]", 0x401000, 7), Some(0x401007 - 0x10));
+    assert_eq!(operand_target("cbz", "x0, 0x100003f50", 0x100003f00, 4), Some(0x100003f50));
+    assert_eq!(operand_target("call", "rax", 0x401000, 2), None);
+    assert_eq!(operand_target("mov", "rax, rbx", 0x401000, 3), None);
+
+    let mut session = match TestSession::new(TestMode::Normal) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ Disassembly: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    match session.start() {
+        Ok(_pid) => {
+            let address = match session.lldb_manager().function_address("main") {
+                Ok(address) => address,
+                Err(e) => {
+                    println!("⚠️ Disassembly: Could not resolve main: {}", e);
+                    let _ = session.cleanup();
+                    return;
+                }
+            };
+
+            match session.lldb_manager().disassemble_instructions(address, 20) {
+                Ok(first) => {
+                    assert!(!first.instructions.is_empty());
+                    assert_eq!(first.instructions[0].address, address);
+                    println!("✅ Disassembly: {} instructions in {:?}", first.instructions.len(), first.function);
+
+                    // Same function again, and a prefix of it, come from the cache
+                    let again = session.lldb_manager().disassemble_instructions(address, 20).unwrap();
+                    assert!(again.cached, "Repeated disassembly should hit the cache");
+                    assert_eq!(again.instructions, first.instructions);
+                    let prefix = session.lldb_manager().disassemble_instructions(address, 5).unwrap();
+                    assert!(prefix.cached);
+                    assert_eq!(prefix.instructions[..], first.instructions[..prefix.instructions.len()]);
+
+                    let calls = first.instructions.iter().filter(|inst| inst.symbol.is_some()).count();
+                    println!("✅ Disassembly: {} operands resolved to symbols", calls);
+
+                    // A write into the decoded range, even of the same bytes, drops the run
+                    if let Ok(original) = session.lldb_manager().read_memory(address + 2, 2) {
+                        if session.lldb_manager().write_memory(address + 2, &original).is_ok() {
+                            let redecoded = session.lldb_manager().disassemble_instructions(address, 5).unwrap();
+                            assert!(!redecoded.cached, "Writing code should evict its cached run");
+                            assert_eq!(redecoded.instructions[..], first.instructions[..redecoded.instructions.len()]);
+                        }
+                    }
+                }
+                Err(e) => {
+                    println!("⚠️ Disassembly: disassemble_instructions failed: {}", e);
+                }
+            }
+        }
+        Err(e) => {
+            println!("⚠️ Disassembly: Could not start debugging session: {}", e);
+        }
+    }
+
+    let _ = session.cleanup();
+}
@@ -436,4 +436,222 @@ async fn test_f0001_launch_process_async_behavior() {
             assert!(elapsed.as_secs() < 5, "launch_process should return reasonably quickly even on failure");
         }
     }
-}
\ No newline at end of file
+}
+
+#[tokio::test]
+async fn test_f0006_find_processes_filters() {
+    use incode::process_table::ProcessFilter;
+
+    let manager = LldbManager::new(None).expect("Failed to create LLDB manager");
+    let own_pid = std::process::id();
+
+    // Spawn a child with a distinctive command line and find it by parent PID
+    let mut child = Command::new("sleep")
+        .arg("7.25")
+        .stdout(Stdio::null())
+        .spawn()
+        .expect("Failed to spawn sleep");
+
+    let filter = ProcessFilter {
+        parent_pid: Some(own_pid),
+        cmdline: Some("7.25".to_string()),
+        ..Default::default()
+    };
+
+    match manager.find_processes(&filter) {
+        Ok(processes) => {
+            println!("✅ F0006: Filtered listing returned {} processes", processes.len());
+            for process in &processes {
+                assert_eq!(process.ppid, Some(own_pid), "parent_pid filter must hold");
+                assert!(process.cmdline.as_deref().unwrap_or("").contains("7.25"));
+            }
+            if cfg!(target_os = "linux") {
+                assert!(processes.iter().any(|p| p.pid == child.id()), "spawned child should be listed");
+            }
+        }
+        Err(e) => println!("⚠️ F0006: Process enumeration failed: {}", e),
+    }
+
+    let _ = child.kill();
+    let _ = child.wait();
+}
+
+#[tokio::test]
+async fn test_console_buffer_cursor_reads() {
+    use incode::console_buffer::{ConsoleBuffer, ConsoleStream};
+
+    let buffer = ConsoleBuffer::new(32);
+    buffer.append(ConsoleStream::Stdout, b"alpha\nbeta\n");
+    buffer.append(ConsoleStream::Stderr, b"warn: gamma\n");
+
+    // Cursor reads return each byte exactly once
+    let first = buffer.read(0, 8, None);
+    assert_eq!(first.text(), "alpha\nbe");
+    assert!(first.has_more);
+    let second = buffer.read(first.next_cursor, 1024, None);
+    assert_eq!(second.text(), "ta\nwarn: gamma\n");
+    assert_eq!(second.segments.len(), 2);
+    assert_eq!(second.segments[1].stream, ConsoleStream::Stderr);
+    assert!(!second.has_more);
+
+    // A line cut by max_bytes is matched whole by the read that reaches its newline
+    let filtered = buffer.read(0, 8, Some("beta"));
+    assert_eq!(filtered.next_cursor, 8);
+    assert!(filtered.segments.is_empty());
+    let filtered = buffer.read(filtered.next_cursor, 1024, Some("beta"));
+    assert_eq!(filtered.text(), "beta\n");
+    assert_eq!(filtered.segments[0].seq, 6);
+
+    // Overflowing the capacity evicts the oldest bytes and reports them
+    buffer.append(ConsoleStream::Stdout, b"0123456789abcdef");
+    let evicted = buffer.read(5, 1024, None);
+    assert_eq!(evicted.dropped_bytes, 2);
+    assert_eq!(evicted.next_cursor, buffer.end_cursor());
+
+    // Lines split across appends and interleaved with the other stream
+    let buffer = ConsoleBuffer::new(1024);
+    buffer.append(ConsoleStream::Stdout, b"first ha");
+    buffer.append(ConsoleStream::Stderr, b"err ");
+    let partial = buffer.read(0, 1024, Some("half"));
+    assert!(partial.segments.is_empty());
+    buffer.append(ConsoleStream::Stdout, b"lf\nnext\n");
+    buffer.append(ConsoleStream::Stderr, b"half\n");
+    let split = buffer.read(partial.next_cursor, 1024, Some("half"));
+    assert_eq!(split.segments.len(), 2);
+    assert_eq!(split.segments[0].text, "first half\n");
+    assert_eq!(split.segments[0].seq, 0);
+    assert_eq!(split.segments[1].text, "err half\n");
+    assert_eq!(split.segments[1].stream, ConsoleStream::Stderr);
+
+    // Clearing for a new process reports the old output as dropped, never as new
+    buffer.clear();
+    buffer.append(ConsoleStream::Stdout, b"new\n");
+    let fresh = buffer.read(split.next_cursor, 1024, None);
+    assert_eq!(fresh.text(), "new\n");
+    assert_eq!(fresh.dropped_bytes, 0);
+    let stale = buffer.read(0, 1024, None);
+    assert_eq!(stale.text(), "new\n");
+    assert!(stale.dropped_bytes > 0);
+    println!("✅ Console buffer cursor semantics verified");
+}
+
+#[tokio::test]
+async fn test_get_console_output_without_process() {
+    let manager = LldbManager::new(None).expect("Failed to create LLDB manager");
+    match manager.get_console_output(None, 1024, None) {
+        Ok(read) => panic!("expected an error without a process, got {:?}", read),
+        Err(e) => println!("✅ get_console_output without process: {}", e),
+    }
+}
+
+#[tokio::test]
+async fn test_f0001_launch_with_options_stop_at_entry() {
+    use incode::lldb_manager::LaunchOptions;
+
+    let debuggee = match TestDebuggee::new(TestMode::Normal) {
+        Ok(debuggee) => debuggee,
+        Err(e) => {
+            println!("⚠️ F0001: test_debuggee unavailable: {}", e);
+            return;
+        }
+    };
+    let mut manager = LldbManager::new(None).expect("Failed to create LLDB manager");
+
+    let mut env = HashMap::new();
+    env.insert("INCODE_TEST_VAR".to_string(), "1".to_string());
+    let options = LaunchOptions {
+        args: vec![TestMode::Normal.as_arg().to_string()],
+        env,
+        working_dir: Some(std::env::temp_dir().to_string_lossy().into_owned()),
+        stop_at_entry: true,
+        ..Default::default()
+    };
+
+    match manager.launch_process_with(&debuggee.binary_path().to_string_lossy(), &options) {
+        Ok(report) => {
+            println!("✅ F0001: Launched PID {} in state {} with timing {:?}", report.pid, report.state, report.timing);
+            assert_eq!(report.state, "Stopped", "stop_at_entry should leave the process stopped");
+            assert!(report.timing.first_stop_ms.is_some());
+            assert!(report.timing.total_ms >= report.timing.target_create_ms);
+            let _ = manager.kill_process();
+        }
+        Err(e) => println!("⚠️ F0001: Launch with options failed (may be expected in test environment): {}", e),
+    }
+
+    let bad_dir = LaunchOptions {
+        working_dir: Some("/nonexistent/incode/dir".to_string()),
+        ..Default::default()
+    };
+    assert!(manager.launch_process_with(&debuggee.binary_path().to_string_lossy(), &bad_dir).is_err());
+}
+
+#[tokio::test]
+async fn test_fork_policy_and_child_sessions() {
+    use incode::fork_follower::{ChildCommand, ForkPolicy};
+
+    assert_eq!(ForkPolicy::parse("both").unwrap(), ForkPolicy::Both);
+    assert_eq!(ForkPolicy::parse("child").unwrap().follow_fork_mode(), "child");
+    assert_eq!(ForkPolicy::Both.follow_fork_mode(), "parent");
+    assert!(ForkPolicy::parse("sideways").is_err());
+
+    let mut manager = LldbManager::new(None).expect("Failed to create LLDB manager");
+    match manager.set_fork_policy(ForkPolicy::Both, Some(false)) {
+        Ok(()) => {
+            assert_eq!(manager.fork_policy(), ForkPolicy::Both);
+            println!("✅ Fork policy set to both");
+        }
+        Err(e) => println!("⚠️ Setting fork policy failed (may be expected without LLDB): {}", e),
+    }
+
+    // Without a running process there is nothing to follow
+    assert!(manager.list_child_sessions().is_empty());
+    assert!(manager.control_child_session(12345, ChildCommand::Continue).is_err());
+}
+
+#[tokio::test]
+async fn test_snapshot_processes_fleet() {
+    use incode::fleet_snapshot::SnapshotOptions;
+    use incode::process_table::ProcessFilter;
+
+    let manager = LldbManager::new(None).expect("Failed to create LLDB manager");
+
+    // Three identical workers should fold into shared stacks
+    let mut workers: Vec<_> = (0..3)
+        .filter_map(|_| Command::new("sleep").arg("31.5").stdout(Stdio::null()).spawn().ok())
+        .collect();
+    std::thread::sleep(Duration::from_millis(100));
+
+    let options = SnapshotOptions {
+        filter: ProcessFilter {
+            cmdline: Some("sleep 31.5".to_string()),
+            parent_pid: Some(std::process::id()),
+            ..Default::default()
+        },
+        max_concurrency: 2,
+        ..Default::default()
+    };
+
+    match manager.snapshot_processes(&options) {
+        Ok(snapshot) => {
+            println!("✅ Fleet snapshot: {} processes, {} threads, {} unique stacks in {}ms",
+                snapshot.processes.len(), snapshot.thread_count, snapshot.unique_stacks.len(), snapshot.elapsed_ms);
+            assert_eq!(snapshot.processes.len(), workers.len());
+            let attached = snapshot.processes.iter().filter(|p| p.error.is_none()).count();
+            if attached == workers.len() {
+                assert!(snapshot.unique_stacks.len() < snapshot.thread_count.max(2),
+                    "identical workers should share stacks");
+            } else {
+                println!("⚠️ Only {} of {} processes could be attached (ptrace restrictions?)", attached, workers.len());
+            }
+        }
+        Err(e) => println!("⚠️ Fleet snapshot failed (may be expected in test environment): {}", e),
+    }
+
+    for worker in &mut workers {
+        let _ = worker.kill();
+        let _ = worker.wait();
+    }
+
+    // The workers are gone, so the same filter now matches nothing
+    assert!(manager.snapshot_processes(&options).is_err());
+}
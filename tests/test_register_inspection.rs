@@ -658,4 +658,62 @@ async fn test_register_modification_safety() {
     }
     
     let _ = session.cleanup();
-}
\ No newline at end of file
+}
+
+#[tokio::test]
+async fn test_all_thread_register_snapshot() {
+    // Every thread's registers in one pass, sharing one cached schema
+    println!("Testing all-thread register snapshot");
+
+    assert_eq!(incode::register_schema::register_kind("rip", "General Purpose Registers", 8), "program_counter");
+    assert_eq!(incode::register_schema::register_kind("ymm3", "Advanced Vector Extensions", 32), "vector");
+    assert_eq!(incode::register_schema::register_kind("rax", "General Purpose Registers", 8), "general");
+
+    let mut session = match TestSession::new(TestMode::Threads) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ Register snapshot: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    match session.start() {
+        Ok(_pid) => {
+            thread::sleep(Duration::from_millis(500));
+
+            match session.lldb_manager().read_all_thread_registers() {
+                Ok(threads) => {
+                    for values in &threads {
+                        assert!(std::sync::Arc::ptr_eq(&values.schema, &threads[0].schema),
+                               "All threads should share one register schema");
+                        for (index, def) in values.iter() {
+                            assert_eq!(values.bytes(index).map(|bytes| bytes.len()), Some(def.size as usize),
+                                      "Register {} should be read at full width", def.name);
+                        }
+                    }
+                    let widest = threads.first()
+                        .and_then(|values| values.schema.registers.iter().map(|def| def.size).max())
+                        .unwrap_or(0);
+                    println!("✅ Register snapshot: {} threads, widest register {} bytes", threads.len(), widest);
+
+                    // The single-thread path hits the cached schema
+                    if let Ok(values) = session.lldb_manager().read_registers(None) {
+                        if let Some(first) = threads.first() {
+                            assert!(std::sync::Arc::ptr_eq(&values.schema, &first.schema),
+                                   "Schema should be reused from the cache");
+                        }
+                        println!("✅ Register snapshot: current thread has {} registers", values.len());
+                    }
+                }
+                Err(e) => {
+                    println!("⚠️ Register snapshot: read_all_thread_registers failed: {}", e);
+                }
+            }
+        }
+        Err(e) => {
+            println!("⚠️ Register snapshot: Could not start debugging session: {}", e);
+        }
+    }
+
+    let _ = session.cleanup();
+}
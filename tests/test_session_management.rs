@@ -11,7 +11,7 @@ mod test_setup;
 use test_setup::{TestDebuggee, TestMode, TestSession};
 
 use incode::tools::session_management::{
-    CreateSessionTool, SaveSessionTool, LoadSessionTool, CleanupSessionTool
+    CreateSessionTool, SaveSessionTool, LoadSessionTool, CleanupSessionTool, ManageMemoryTool
 };
 use incode::tools::{Tool, ToolResponse};
 
@@ -116,6 +116,7 @@ async fn test_save_session_comprehensive() {
     args_full.insert("session_name".to_string(), Value::String("test_full_session".to_string()));
     args_full.insert("include_breakpoints".to_string(), Value::Bool(true));
     args_full.insert("include_variables".to_string(), Value::Bool(true));
+    args_full.insert("format".to_string(), Value::String("json".to_string()));
     
     let result_full = save_tool.execute(args_full, session.lldb_manager()).await.expect("save_session full failed");
     let result_full_str = match result_full {
@@ -449,4 +450,142 @@ async fn test_session_management_error_handling() {
     if !response_no_perm["success"].as_bool().unwrap_or(false) {
         assert!(response_no_perm["error"].is_string(), "Should provide error for permission issues");
     }
-}
\ No newline at end of file
+}
+
+#[tokio::test]
+async fn test_session_snapshot_roundtrip() {
+    use incode::console_buffer::ConsoleStream;
+    use incode::lldb_manager::LaunchOptions;
+    use incode::session_snapshot::{
+        parse_breakpoint_spec, BreakpointSnapshot, ModuleOffset, ModuleSnapshot, SessionSnapshot, WatchpointSnapshot,
+    };
+
+    let mut snapshot = SessionSnapshot::new(uuid::Uuid::new_v4());
+    snapshot.created_at = 1_700_000_000;
+    snapshot.saved_at = 1_700_000_100;
+    snapshot.target_path = Some("/usr/local/bin/server".to_string());
+    snapshot.process_id = Some(4242);
+    snapshot.launch = Some(LaunchOptions {
+        args: vec!["--port".to_string(), "8080".to_string()],
+        env: [("MODE".to_string(), "debug".to_string())].into_iter().collect(),
+        working_dir: Some("/tmp".to_string()),
+        ..Default::default()
+    });
+    snapshot.selected_thread_id = Some(4243);
+    snapshot.selected_frame_index = 2;
+    snapshot.modules = vec![ModuleSnapshot {
+        path: "/usr/local/bin/server".to_string(),
+        uuid: Some("1234ABCD".to_string()),
+    }];
+    let location = ModuleOffset {
+        module: "/usr/local/bin/server".to_string(),
+        uuid: Some("1234ABCD".to_string()),
+        file_address: 0x401136,
+    };
+    snapshot.breakpoints = (1..=500)
+        .map(|id| BreakpointSnapshot {
+            id,
+            spec: format!("handler_{}", id),
+            enabled: id % 3 != 0,
+            one_shot: id % 7 == 0,
+            ignore_count: id % 4,
+            hit_count: id * 2,
+            condition: (id % 5 == 0).then(|| "count > 10".to_string()),
+            locations: vec![ModuleOffset { file_address: 0x401000 + id as u64 * 16, ..location.clone() }],
+        })
+        .collect();
+    snapshot.watchpoints = vec![
+        WatchpointSnapshot { id: 1, address: 0x404040, size: 8, read: false, write: true, enabled: true, condition: None, location: Some(location.clone()) },
+        WatchpointSnapshot { id: 2, address: 0x7ffd_0000_1000, size: 4, read: true, write: true, enabled: false, condition: Some("x == 3".to_string()), location: None },
+    ];
+    snapshot.console = vec![(ConsoleStream::Stdout, "listening on 8080\n".to_string()), (ConsoleStream::Stderr, "warning: ü\n".to_string())];
+
+    // Binary round trip
+    let encoded = snapshot.encode();
+    assert!(incode::session_snapshot::is_binary_snapshot(&encoded));
+    let decoded = SessionSnapshot::decode(&encoded).expect("snapshot should decode");
+    assert_eq!(decoded, snapshot, "binary round trip should be lossless");
+
+    // JSON export round trip
+    let exported = snapshot.to_json();
+    assert!(exported["session_id"].is_string() && exported["process_info"].is_object());
+    let imported = SessionSnapshot::from_json(&exported).expect("JSON export should load");
+    assert_eq!(imported, snapshot, "JSON round trip should be lossless");
+
+    let json_size = serde_json::to_vec(&exported).unwrap().len();
+    println!("✅ Snapshot with {} breakpoints: {} bytes binary, {} bytes JSON", snapshot.breakpoints.len(), encoded.len(), json_size);
+    assert!(encoded.len() * 3 < json_size, "binary snapshot should be much smaller than JSON");
+
+    // Truncated files are rejected, sections from newer versions are skipped
+    assert!(SessionSnapshot::decode(&encoded[..encoded.len() - 3]).is_err());
+    let mut extended = encoded.clone();
+    extended.extend_from_slice(&[0x7f, 3, 1, 2, 3]);
+    assert_eq!(SessionSnapshot::decode(&extended).expect("unknown section should be skipped"), snapshot);
+
+    // Breakpoint specs recovered from LLDB descriptions
+    assert_eq!(parse_breakpoint_spec("SBBreakpoint: id = 1, name = 'main', locations = 1").as_deref(), Some("main"));
+    assert_eq!(parse_breakpoint_spec("SBBreakpoint: id = 2, file = 'main.c', line = 42, exact_match = 0, locations = 1").as_deref(), Some("main.c:42"));
+    assert_eq!(parse_breakpoint_spec("SBBreakpoint: id = 3, address = 0x0000000000401136, locations = 1").as_deref(), Some("0x401136"));
+}
+
+#[tokio::test]
+async fn test_cache_budget_eviction() {
+    use incode::cache_manager::{BudgetedCache, CacheConfig, CacheManager, ManagedCache};
+
+    let manager = CacheManager::new(CacheConfig { budget_bytes: 64 * 1024, ..Default::default() });
+    let cheap: std::sync::Arc<BudgetedCache<u64, Vec<u8>>> = BudgetedCache::new("cheap", &manager);
+    let costly: std::sync::Arc<BudgetedCache<u64, Vec<u8>>> = BudgetedCache::new("costly", &manager);
+
+    // 128 KiB offered to a 64 KiB budget: 1 KiB entries, the costly ones 50x dearer to rebuild
+    for key in 0..64u64 {
+        cheap.insert(key, vec![0u8; 1024], 1024, 10);
+        costly.insert(key, vec![1u8; 1024], 1024, 500);
+    }
+    let report = manager.enforce();
+    let used = manager.used_bytes();
+    println!("✅ {} bytes cached after evicting {} entries", used, report.evicted_entries);
+    assert!(used <= 64 * 1024, "caches should fit the budget, used {}", used);
+    let (cheap_left, costly_left) = (cheap.usage().entries, costly.usage().entries);
+    assert!(costly_left > cheap_left, "cheap entries should be evicted first ({} cheap, {} costly left)", cheap_left, costly_left);
+    assert!(cheap.get(&0).is_none(), "the oldest cheap entry should be evicted");
+    assert!(costly.get(&0).is_some(), "the oldest costly entry should survive");
+
+    // A hit renews an entry: of equally cheap entries the least recently used goes
+    let lru_manager = CacheManager::new(CacheConfig { budget_bytes: 8 * 1024, ..Default::default() });
+    let lru: std::sync::Arc<BudgetedCache<u64, Vec<u8>>> = BudgetedCache::new("lru", &lru_manager);
+    for key in 0..8u64 {
+        lru.insert(key, vec![0u8; 1024], 1024, 10);
+    }
+    assert_eq!(lru.usage().entries, 8, "a full budget needs no eviction");
+    assert!(lru.get(&0).is_some());
+    lru.insert(8, vec![0u8; 1024], 1024, 10);
+    lru_manager.enforce();
+    assert!(lru.get(&0).is_some(), "the entry just hit should survive");
+    assert!(lru.get(&1).is_none(), "the least recently used entry should be evicted");
+    assert_eq!(lru.usage().entries, 8);
+
+    let usage = manager.usage();
+    assert_eq!(usage.len(), 2);
+    assert!(usage.iter().all(|cache| cache.bytes <= 64 * 1024));
+    assert!(usage.iter().map(|cache| cache.evictions).sum::<u64>() > 0);
+
+    // Dropped caches stop being tracked
+    drop(cheap);
+    assert_eq!(manager.usage().len(), 1);
+
+    // Through the tool, when LLDB is available
+    if let Ok(mut session) = TestSession::new(TestMode::Normal) {
+        let mut args = HashMap::new();
+        args.insert("budget_mb".to_string(), Value::from(32));
+        args.insert("idle_session_secs".to_string(), Value::from(0));
+        match ManageMemoryTool.execute(args, session.lldb_manager()).await {
+            Ok(ToolResponse::Success(body)) => {
+                let response: Value = serde_json::from_str(&body).expect("Invalid JSON response");
+                assert_eq!(response["budget_bytes"].as_u64(), Some(32 * 1024 * 1024));
+                assert!(response["caches"].is_array(), "Should report per-cache usage");
+                println!("✅ manage_memory: {}", response["caches"]);
+            }
+            other => println!("⚠️ manage_memory unavailable: {:?}", other.map(|_| ())),
+        }
+    }
+}
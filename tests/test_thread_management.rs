@@ -589,4 +589,50 @@ async fn test_thread_state_transitions() {
     }
     
     let _ = session.cleanup();
-}
\ No newline at end of file
+}
+
+#[tokio::test]
+async fn test_read_thread_local_across_threads() {
+    println!("Testing read_thread_local");
+
+    let mut session = match TestSession::new(TestMode::Threads) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ read_thread_local: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    match session.start() {
+        Ok(_pid) => {
+            thread::sleep(Duration::from_millis(1000));
+            let _ = session.lldb_manager().interrupt_execution();
+
+            for name in ["thread_local_id", "thread_local_name"] {
+                match session.lldb_manager().read_thread_local(name, None) {
+                    Ok(view) => {
+                        println!("✅ read_thread_local: {} ({}) via {} in {} threads with {} reads",
+                                 name, view.type_name, view.location.method(), view.threads.len(), view.reads);
+                        for thread in &view.threads {
+                            println!("  thread {}: {}", thread.thread_id, thread.value);
+                        }
+                    }
+                    Err(e) => println!("⚠️ read_thread_local: {} failed: {}", name, e),
+                }
+            }
+
+            // Every thread sets its own id, so the copies must differ
+            let view = session.lldb_manager().read_thread_local("thread_local_id", None)
+                .expect("read_thread_local(thread_local_id)");
+            let ids: Vec<i64> = view.threads.iter().filter_map(|thread| thread.value.as_i64()).collect();
+            assert!(ids.len() > 1, "thread_local_id read in several threads: {:?}", view.to_json());
+            let distinct: std::collections::HashSet<i64> = ids.iter().copied().collect();
+            assert_eq!(distinct.len(), ids.len(), "thread_local_id differs per thread: {:?}", ids);
+        }
+        Err(e) => {
+            println!("⚠️ read_thread_local: Could not start debugging session: {}", e);
+        }
+    }
+
+    let _ = session.cleanup();
+}
@@ -662,4 +662,231 @@ async fn test_variable_inspection_workflow() {
     }
     
     let _ = session.cleanup();
-}
\ No newline at end of file
+}
+
+#[tokio::test]
+async fn test_f0037_evaluate_lvalue_fast_path() {
+    println!("Testing F0037: evaluate_expression lvalue fast path");
+
+    let mut session = match TestSession::new(TestMode::Normal) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ F0037: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    match session.start() {
+        Ok(_pid) => {
+            let _ = session.lldb_manager().set_breakpoint("demonstrate_local_variables");
+            let _ = session.lldb_manager().continue_execution();
+            let timeout = std::time::Duration::from_secs(5);
+
+            for expression in ["local_int", "local_array[2]", "*local_int_ptr", "**local_int_ptr_ptr"] {
+                match session.lldb_manager().evaluate(None, expression, timeout) {
+                    Ok(value) => {
+                        println!("✅ F0037: {} = {} in {}us (fast path: {})",
+                                 expression, value.display(), value.elapsed_us, value.fast_path);
+                        assert!(value.fast_path, "{} should not need the expression evaluator", expression);
+                    }
+                    Err(e) => println!("⚠️ F0037: {} failed: {}", expression, e),
+                }
+            }
+
+            match session.lldb_manager().evaluate(None, "local_int + 1", timeout) {
+                Ok(value) => assert!(!value.fast_path),
+                Err(e) => println!("⚠️ F0037: evaluator failed: {}", e),
+            }
+        }
+        Err(e) => {
+            println!("⚠️ F0037: Could not start debugging session: {}", e);
+        }
+    }
+
+    let _ = session.cleanup();
+}
+
+#[tokio::test]
+async fn test_prepare_expression_reuses_plan() {
+    println!("Testing prepare_expression");
+
+    let mut session = match TestSession::new(TestMode::Normal) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ prepare_expression: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    match session.start() {
+        Ok(_pid) => {
+            let _ = session.lldb_manager().set_breakpoint("demonstrate_local_variables");
+            let _ = session.lldb_manager().continue_execution();
+            let timeout = std::time::Duration::from_secs(5);
+
+            match session.lldb_manager().prepare_expression("local_array[1]", None) {
+                Ok((handle, plan)) => {
+                    println!("✅ prepare_expression: handle {} planned as {}", handle, plan.kind());
+                    for _ in 0..3 {
+                        match session.lldb_manager().evaluate_prepared(handle, None, timeout) {
+                            Ok((value, hits, misses)) => {
+                                println!("  {} in {}us (hits {}, misses {})", value.display(), value.elapsed_us, hits, misses);
+                                assert_eq!(misses, 1);
+                            }
+                            Err(e) => println!("⚠️ prepare_expression: evaluation failed: {}", e),
+                        }
+                    }
+                    assert!(session.lldb_manager().release_expression(handle));
+                }
+                Err(e) => println!("⚠️ prepare_expression: failed: {}", e),
+            }
+
+            // Refused before any plan is made, so no handle can evaluate it later
+            assert!(session.lldb_manager().prepare_expression("free(local_int_ptr)", None).is_err());
+        }
+        Err(e) => {
+            println!("⚠️ prepare_expression: Could not start debugging session: {}", e);
+        }
+    }
+
+    let _ = session.cleanup();
+}
+
+#[tokio::test]
+async fn test_decode_container_for_locals() {
+    use serde_json::json;
+
+    println!("Testing decode_container");
+
+    let mut session = match TestSession::new(TestMode::Normal) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ decode_container: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    match session.start() {
+        Ok(_pid) => {
+            // After every container in demonstrate_local_variables is constructed
+            let _ = session.lldb_manager().set_breakpoint("variables.cpp:161");
+            let _ = session.lldb_manager().continue_execution();
+
+            let decoded = |session: &mut TestSession, expression: &str| {
+                let view = session.lldb_manager().decode_container(expression, None, 0, 100)
+                    .unwrap_or_else(|e| panic!("decode_container({}) failed: {}", expression, e));
+                println!("✅ decode_container: {} ({}) = {} elements via {} reads",
+                         expression, view.kind.name(), view.size, view.reads);
+                view.elements
+            };
+            assert_eq!(decoded(&mut session, "local_std_string"), vec![json!("Local std::string")]);
+            assert_eq!(decoded(&mut session, "local_string_vector"), vec![json!("one"), json!("two"), json!("three")]);
+            assert_eq!(decoded(&mut session, "global_vector"), vec![json!(10), json!(20), json!(30), json!(40), json!(50)]);
+            assert_eq!(decoded(&mut session, "local_int_string_map"), vec![
+                json!({"key": 1, "value": "first"}),
+                json!({"key": 2, "value": "second"}),
+                json!({"key": 3, "value": "third"}),
+            ]);
+            assert!(session.lldb_manager().decode_container("free(local_int_ptr)", None, 0, 100).is_err());
+        }
+        Err(e) => {
+            println!("⚠️ decode_container: Could not start debugging session: {}", e);
+        }
+    }
+
+    let _ = session.cleanup();
+}
+
+#[tokio::test]
+async fn test_list_globals_pages() {
+    use incode::global_vars::GlobalFilter;
+
+    println!("Testing get_global_variables paging");
+
+    let mut session = match TestSession::new(TestMode::Normal) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ list_globals: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    match session.start() {
+        Ok(_pid) => {
+            let _ = session.lldb_manager().set_breakpoint("main");
+            let _ = session.lldb_manager().continue_execution();
+
+            let filter = GlobalFilter { module: Some("test_debuggee".to_string()), name: Some("global_".to_string()), include_static: true };
+            match session.lldb_manager().list_globals(&filter, 0, 10) {
+                Ok(page) => {
+                    println!("✅ list_globals: {} of {} globals in {:?} via {} reads",
+                             page.globals.len(), page.total, page.modules, page.reads);
+                    for global in &page.globals {
+                        println!("  {} {} = {} ({:?})", global.type_name, global.name, global.display(), global.section);
+                    }
+                    assert!(page.reads <= page.globals.len().max(1), "one read per section, not per global");
+                }
+                Err(e) => println!("⚠️ list_globals failed: {}", e),
+            }
+        }
+        Err(e) => {
+            println!("⚠️ list_globals: Could not start debugging session: {}", e);
+        }
+    }
+
+    let _ = session.cleanup();
+}
+
+#[tokio::test]
+async fn test_watch_expressions_across_steps() {
+    println!("Testing watch expressions");
+
+    let mut session = match TestSession::new(TestMode::Normal) {
+        Ok(s) => s,
+        Err(e) => {
+            println!("⚠️ watches: Could not create test session: {}", e);
+            return;
+        }
+    };
+
+    match session.start() {
+        Ok(_pid) => {
+            let _ = session.lldb_manager().set_breakpoint("demonstrate_local_variables");
+            let _ = session.lldb_manager().continue_execution();
+
+            for expression in ["local_int", "local_float * 2", "global_int"] {
+                match session.lldb_manager().add_watch(expression) {
+                    Ok(watch) => println!("✅ watches: {} = {}", expression, watch.to_json()),
+                    Err(e) => println!("⚠️ watches: add {} failed: {}", expression, e),
+                }
+            }
+            assert!(session.lldb_manager().add_watch("free(local_int_ptr)").is_err(), "unsafe watch refused");
+
+            for step in 0..3 {
+                if session.lldb_manager().step_over().is_err() {
+                    break;
+                }
+                match session.lldb_manager().evaluate_watches() {
+                    Ok(changed) => {
+                        let changes = session.lldb_manager().take_watch_changes();
+                        assert_eq!(changes.len(), changed);
+                        for watch in &changes {
+                            println!("  step {}: {} -> {}", step + 1, watch.expression, watch.to_json()["value"]);
+                        }
+                    }
+                    Err(e) => println!("⚠️ watches: evaluation failed: {}", e),
+                }
+            }
+            // Nothing new without another stop
+            if let Ok(changed) = session.lldb_manager().evaluate_watches() {
+                assert_eq!(changed, 0);
+            }
+            assert_eq!(session.lldb_manager().clear_watches(), 3);
+        }
+        Err(e) => {
+            println!("⚠️ watches: Could not start debugging session: {}", e);
+        }
+    }
+
+    let _ = session.cleanup();
+}